@@ -0,0 +1,209 @@
+/**
+ * @file actuator.c
+ * @brief 执行器服务实现
+ */
+
+#include "actuator.h"
+#include "config.h"
+#include "hal.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include <string.h>
+
+static const char *TAG = "ACTUATOR";
+
+#define ACTUATOR_STACK_SIZE (3 * 1024)
+
+typedef struct {
+    uint8_t target;             // actuator_target_t
+    uint8_t source;             // actuator_source_t
+    uint16_t fade_ms;           // LED / 风扇渐变时间
+    uint32_t value;
+    int64_t t0_us;
+} actuator_cmd_t;
+
+static QueueHandle_t s_queue = NULL;
+static TaskHandle_t s_task = NULL;
+
+static actuator_stats_t s_stats;
+static uint64_t s_latency_sum_us[ACTUATOR_SRC_MAX];
+static portMUX_TYPE s_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static esp_err_t apply(const actuator_cmd_t *cmd)
+{
+    switch (cmd->target) {
+        case ACTUATOR_LED:
+            return hal_led_fade((uint8_t)cmd->value, cmd->fade_ms);
+        case ACTUATOR_FAN:
+            return hal_fan_fade((uint8_t)cmd->value, cmd->fade_ms);
+        case ACTUATOR_CURTAIN:
+            return hal_curtain_set((uint8_t)cmd->value);
+        case ACTUATOR_RGB_COLOR:
+            return hal_rgb_set_color((rgb_color_t)cmd->value);
+        case ACTUATOR_RGB_RGB:
+            return hal_rgb_set_rgb((uint8_t)(cmd->value >> 16), (uint8_t)(cmd->value >> 8),
+                                   (uint8_t)cmd->value);
+        case ACTUATOR_RGB_BRIGHTNESS:
+            hal_rgb_set_brightness((uint8_t)cmd->value);
+            return ESP_OK;
+        default:
+            return ESP_ERR_INVALID_ARG;
+    }
+}
+
+static void execute(const actuator_cmd_t *cmd)
+{
+    esp_err_t ret = apply(cmd);
+    uint32_t latency_us = (uint32_t)(esp_timer_get_time() - cmd->t0_us);
+
+    portENTER_CRITICAL(&s_stats_lock);
+    s_stats.executed++;
+    if (ret != ESP_OK) {
+        s_stats.failed++;
+    } else if (cmd->source < ACTUATOR_SRC_MAX) {
+        actuator_latency_t *lat = &s_stats.source[cmd->source];
+        lat->count++;
+        lat->latency_last_us = latency_us;
+        if (latency_us > lat->latency_max_us) {
+            lat->latency_max_us = latency_us;
+        }
+        s_latency_sum_us[cmd->source] += latency_us;
+        lat->latency_avg_us = (uint32_t)(s_latency_sum_us[cmd->source] / lat->count);
+    }
+    portEXIT_CRITICAL(&s_stats_lock);
+}
+
+// 批处理槽位：预设色与任意 RGB 写同一个灯，共用槽位 (后到者生效)
+static int batch_slot(uint8_t target)
+{
+    return (target == ACTUATOR_RGB_RGB) ? ACTUATOR_RGB_COLOR : target;
+}
+
+// 提交顺序：亮度须先于颜色写入才能在本批生效
+static const uint8_t s_commit_order[] = {
+    ACTUATOR_LED, ACTUATOR_FAN, ACTUATOR_CURTAIN, ACTUATOR_RGB_BRIGHTNESS, ACTUATOR_RGB_COLOR,
+};
+
+static void actuator_task(void *pvParameters)
+{
+    actuator_cmd_t cmd;
+    actuator_cmd_t batch[ACTUATOR_MAX];
+    uint32_t pending = 0;
+
+    ESP_LOGI(TAG, "Actuator task started");
+
+    while (1) {
+        if (xQueueReceive(s_queue, &cmd, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+
+        // 取空队列中已积压的命令，同一通道只保留最新值
+        do {
+            int slot = batch_slot(cmd.target);
+            if (pending & (1u << slot)) {
+                portENTER_CRITICAL(&s_stats_lock);
+                s_stats.coalesced++;
+                portEXIT_CRITICAL(&s_stats_lock);
+            }
+            batch[slot] = cmd;
+            pending |= 1u << slot;
+        } while (xQueueReceive(s_queue, &cmd, 0) == pdTRUE);
+
+        for (size_t i = 0; i < sizeof(s_commit_order); i++) {
+            uint8_t slot = s_commit_order[i];
+            if (pending & (1u << slot)) {
+                execute(&batch[slot]);
+            }
+        }
+        pending = 0;
+    }
+}
+
+esp_err_t actuator_init(uint32_t task_priority)
+{
+    if (s_task != NULL) {
+        return ESP_OK;
+    }
+
+    memset(&s_stats, 0, sizeof(s_stats));
+    memset(s_latency_sum_us, 0, sizeof(s_latency_sum_us));
+
+    QueueHandle_t queue = xQueueCreate(ACTUATOR_QUEUE_LEN, sizeof(actuator_cmd_t));
+    if (queue == NULL) {
+        ESP_LOGE(TAG, "Failed to create command queue");
+        return ESP_ERR_NO_MEM;
+    }
+    s_queue = queue;
+
+    if (xTaskCreate(actuator_task, "actuator_task", ACTUATOR_STACK_SIZE, NULL,
+                    task_priority, &s_task) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create actuator task");
+        s_queue = NULL;
+        vQueueDelete(queue);
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "Actuator service started (queue=%d, priority=%lu)",
+             ACTUATOR_QUEUE_LEN, (unsigned long)task_priority);
+    return ESP_OK;
+}
+
+esp_err_t actuator_post(actuator_target_t target, uint32_t value,
+                        actuator_source_t source, int64_t t0_us)
+{
+    uint32_t fade_ms = (target == ACTUATOR_LED) ? LED_FADE_MS :
+                       (target == ACTUATOR_FAN) ? FAN_FADE_MS : 0;
+    return actuator_post_fade(target, value, fade_ms, source, t0_us);
+}
+
+esp_err_t actuator_post_fade(actuator_target_t target, uint32_t value, uint32_t fade_ms,
+                             actuator_source_t source, int64_t t0_us)
+{
+    if (target >= ACTUATOR_MAX || source >= ACTUATOR_SRC_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    actuator_cmd_t cmd = {
+        .target = (uint8_t)target,
+        .source = (uint8_t)source,
+        .fade_ms = (uint16_t)((fade_ms > UINT16_MAX) ? UINT16_MAX : fade_ms),
+        .value = value,
+        .t0_us = (t0_us != 0) ? t0_us : esp_timer_get_time(),
+    };
+
+    // 服务任务未启动：在调用方上下文直接执行
+    if (s_queue == NULL) {
+        execute(&cmd);
+        return ESP_OK;
+    }
+
+    if (xQueueSend(s_queue, &cmd, pdMS_TO_TICKS(ACTUATOR_POST_TIMEOUT_MS)) != pdTRUE) {
+        portENTER_CRITICAL(&s_stats_lock);
+        s_stats.dropped++;
+        portEXIT_CRITICAL(&s_stats_lock);
+        ESP_LOGW(TAG, "Queue full, dropped command %d from source %d", target, source);
+        return ESP_ERR_TIMEOUT;
+    }
+
+    uint32_t pending = (uint32_t)uxQueueMessagesWaiting(s_queue);
+    portENTER_CRITICAL(&s_stats_lock);
+    s_stats.posted++;
+    if (pending > s_stats.queue_peak) {
+        s_stats.queue_peak = pending;
+    }
+    portEXIT_CRITICAL(&s_stats_lock);
+    return ESP_OK;
+}
+
+void actuator_get_stats(actuator_stats_t *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    portENTER_CRITICAL(&s_stats_lock);
+    *stats = s_stats;
+    portEXIT_CRITICAL(&s_stats_lock);
+}
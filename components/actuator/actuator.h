@@ -0,0 +1,111 @@
+/**
+ * @file actuator.h
+ * @brief 执行器服务：HTTP / 语音 / 自动控制的输出命令统一入队，由专用任务下发
+ *
+ * - 调用方不等待硬件写入完成；服务任务每次取空队列，同一通道只下发最新值
+ * - 每条命令携带起始时刻 (HTTP 为收到请求时)，执行完成后按来源统计端到端延迟
+ * - 服务任务未启动时 (启动早期 / 主机回放) 命令在调用方上下文同步执行
+ * - LED / 风扇命令默认按 config.h 的渐变时间由 LEDC 硬件渐变，命令本身立即完成
+ * - 烟雾报警快速通路不经过队列；蜂鸣器由自带的非阻塞序列器播放，同样不经过队列
+ */
+
+#ifndef ACTUATOR_H
+#define ACTUATOR_H
+
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 命令队列深度
+#define ACTUATOR_QUEUE_LEN        16
+// 队列满时的最长等待 (毫秒)
+#define ACTUATOR_POST_TIMEOUT_MS  10
+
+/**
+ * @brief 输出目标
+ */
+typedef enum {
+    ACTUATOR_LED = 0,           // value: 亮度 (0 关闭)
+    ACTUATOR_FAN,               // value: 转速
+    ACTUATOR_CURTAIN,           // value: 开度 0-100
+    ACTUATOR_RGB_COLOR,         // value: rgb_color_t
+    ACTUATOR_RGB_RGB,           // value: (r << 16) | (g << 8) | b
+    ACTUATOR_RGB_BRIGHTNESS,    // value: 亮度百分比
+    ACTUATOR_MAX,
+} actuator_target_t;
+
+/**
+ * @brief 命令来源
+ */
+typedef enum {
+    ACTUATOR_SRC_HTTP = 0,
+    ACTUATOR_SRC_VOICE,
+    ACTUATOR_SRC_AUTO,
+    ACTUATOR_SRC_MAX,
+} actuator_source_t;
+
+/**
+ * @brief 单个来源的延迟统计 (起始时刻到硬件写入返回)
+ */
+typedef struct {
+    uint32_t count;
+    uint32_t latency_last_us;
+    uint32_t latency_avg_us;
+    uint32_t latency_max_us;
+} actuator_latency_t;
+
+/**
+ * @brief 服务统计
+ */
+typedef struct {
+    uint32_t posted;            // 入队命令数
+    uint32_t executed;          // 已执行命令数 (含同步执行)
+    uint32_t failed;            // 硬件写入返回错误的命令数
+    uint32_t dropped;           // 队列满丢弃的命令数
+    uint32_t coalesced;         // 被同批次更新命令覆盖的命令数
+    uint32_t queue_peak;        // 队列最大积压
+    actuator_latency_t source[ACTUATOR_SRC_MAX];
+} actuator_stats_t;
+
+/**
+ * @brief 创建命令队列并启动服务任务
+ *
+ * @param task_priority 服务任务优先级 (应高于控制任务)
+ * @return esp_err_t ESP_ERR_NO_MEM 队列或任务创建失败
+ */
+esp_err_t actuator_init(uint32_t task_priority);
+
+/**
+ * @brief 投递一条输出命令 (LED / 风扇使用默认渐变时间 LED_FADE_MS / FAN_FADE_MS)
+ *
+ * @param target 输出目标
+ * @param value 目标值 (编码见 actuator_target_t)
+ * @param source 命令来源
+ * @param t0_us 延迟统计起点 (esp_timer_get_time)，0 表示以入队时刻为起点
+ * @return esp_err_t ESP_ERR_TIMEOUT 队列满，命令被丢弃
+ */
+esp_err_t actuator_post(actuator_target_t target, uint32_t value,
+                        actuator_source_t source, int64_t t0_us);
+
+/**
+ * @brief 投递一条带指定渐变时间的输出命令
+ *
+ * @param fade_ms 渐变时间（毫秒），0 表示立即生效；仅 LED / 风扇支持渐变，其他目标忽略
+ * @return esp_err_t 同 actuator_post
+ */
+esp_err_t actuator_post_fade(actuator_target_t target, uint32_t value, uint32_t fade_ms,
+                             actuator_source_t source, int64_t t0_us);
+
+/**
+ * @brief 获取服务统计
+ */
+void actuator_get_stats(actuator_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ACTUATOR_H
@@ -1,17 +1,16 @@
 #include "app_control.h"
 #include "app_state.h"
-#include "voice_recognition.h"
 #include "esp_log.h"
 #include "config.h"
-// 引入硬件驱动
-#include "led.h"
-#include "fan.h"
-#include "servo_driver.h"  // 使用 espressif/servo 官方组件
-#include "buzzer.h"
-#include "mq2.h" // 需要用到 mq2_is_smoke_detected
-#include "rgb_led.h"
+// 硬件经由抽象层访问，输出命令经执行器服务下发
+#include "hal.h"
+#include "actuator.h"
+#include "rules.h"
+#include "trace.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "esp_timer.h"
+#include <math.h>
 
 static const char *TAG = "APP_CTRL";
 
@@ -26,30 +25,119 @@ static rgb_color_t s_current_rgb_color = RGB_COLOR_GREEN;
 static rgb_color_t s_saved_rgb_color = RGB_COLOR_GREEN;  // 唤醒前保存的颜色
 static uint8_t s_last_brightness = 0;  // 缓存上次亮度，避免冗余硬件操作
 
-// 滞回状态记录
-static struct {
-    bool fan_on;       // 风扇当前是否开启
-    bool led_on;       // LED当前是否开启
-} hysteresis_state = {false, false};
-
 // 烟雾报警状态，避免每个控制周期都重复蜂鸣与错误日志
+// 控制任务与报警任务共享，由 s_alarm_lock 保护
 static bool s_smoke_alarm_active = false;
 static TickType_t s_last_smoke_beep_tick = 0;
+static portMUX_TYPE s_alarm_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// 风扇 PI 调速：控制任务内更新，参数由 HTTP 任务修改，s_fan_pi_lock 保护
+static fan_pi_t s_fan_pi;
+static bool s_fan_pi_enabled = FAN_PI_ENABLE;
+static int64_t s_fan_pi_last_us = 0;
+static uint32_t s_fan_pi_resyncs = 0;
+static portMUX_TYPE s_fan_pi_lock = portMUX_INITIALIZER_UNLOCKED;
+static int64_t (*s_now_us)(void) = esp_timer_get_time;
+
+// 中断报警通路延迟统计
+static app_alarm_stats_t s_alarm_stats;
+static uint64_t s_alarm_latency_sum_us = 0;
+
+/**
+ * @brief 进入/保持报警状态
+ *
+ * @return true 需要蜂鸣 (首次进入或距上次蜂鸣超过间隔)
+ */
+static bool smoke_alarm_enter(TickType_t now, bool *first)
+{
+    bool should_beep = false;
+
+    portENTER_CRITICAL(&s_alarm_lock);
+    *first = !s_smoke_alarm_active;
+    if (!s_smoke_alarm_active) {
+        s_smoke_alarm_active = true;
+        should_beep = true;
+    } else if ((now - s_last_smoke_beep_tick) >= pdMS_TO_TICKS(SMOKE_ALARM_BEEP_INTERVAL_MS)) {
+        should_beep = true;
+    }
+    if (should_beep) {
+        s_last_smoke_beep_tick = now;
+    }
+    portEXIT_CRITICAL(&s_alarm_lock);
+
+    return should_beep;
+}
+
+/**
+ * @brief 解除报警状态
+ *
+ * @return true 之前处于报警状态
+ */
+static bool smoke_alarm_clear(void)
+{
+    portENTER_CRITICAL(&s_alarm_lock);
+    bool was_active = s_smoke_alarm_active;
+    s_smoke_alarm_active = false;
+    portEXIT_CRITICAL(&s_alarm_lock);
+    return was_active;
+}
 
 esp_err_t app_control_init(void)
 {
-    hysteresis_state.fan_on = false;
-    hysteresis_state.led_on = false;
+    // 自动化规则 (NVS 中的规则或内置默认规则)，滞回状态由引擎保存
+    if (rules_init() != ESP_OK) {
+        ESP_LOGW(TAG, "Rule engine unavailable, automation disabled");
+    }
+
+    // 风扇 PI：首次使用 config.h 参数，重复初始化 (轨迹回放) 保留在线调整过的参数
+    fan_pi_cfg_t pi_cfg = s_fan_pi.cfg;
+    if (pi_cfg.max_duty == 0) {
+        pi_cfg = (fan_pi_cfg_t){
+            .setpoint = (int32_t)lroundf(FAN_PI_SETPOINT * FILTER_TEMP_SCALE),
+            .kp_x10 = (int32_t)lroundf(FAN_PI_KP * 10.0f),
+            .ki_x1000 = (int32_t)lroundf(FAN_PI_KI * 1000.0f),
+            .min_duty = FAN_PI_MIN_DUTY,
+            .max_duty = FAN_SPEED_HIGH,
+        };
+    }
+    portENTER_CRITICAL(&s_fan_pi_lock);
+    fan_pi_init(&s_fan_pi, &pi_cfg);
+    s_fan_pi_resyncs = 0;
+    portEXIT_CRITICAL(&s_fan_pi_lock);
 
     // 初始化 RGB 为绿色常亮 (基础亮度)
     s_last_brightness = RGB_BRIGHTNESS_BASE;
-    rgb_led_set_brightness(RGB_BRIGHTNESS_BASE);
-    rgb_led_set_color(s_current_rgb_color);
+    hal_rgb_set_brightness(RGB_BRIGHTNESS_BASE);
+    hal_rgb_set_color(s_current_rgb_color);
 
     ESP_LOGI(TAG, "App Control Initialized (RGB Green)");
     return ESP_OK;
 }
 
+/**
+ * @brief 风扇 PI 调速一步
+ *
+ * 当前转速与上次输出不一致 (手动/语音/报警改变了风扇) 时先从该转速无扰接管。
+ */
+static uint8_t fan_pi_step(const sensor_data_t *data)
+{
+    int32_t temp = (int32_t)lroundf(data->temperature * FILTER_TEMP_SCALE);
+    int64_t now_us = s_now_us();
+
+    portENTER_CRITICAL(&s_fan_pi_lock);
+    if (!s_fan_pi.primed || data->fan_speed != s_fan_pi.output) {
+        fan_pi_reset(&s_fan_pi, temp, data->fan_speed);
+        s_fan_pi_last_us = now_us;
+        s_fan_pi_resyncs++;
+    }
+    uint32_t dt_ms = (uint32_t)((now_us - s_fan_pi_last_us) / 1000);
+    s_fan_pi_last_us = now_us;
+    uint8_t speed = fan_pi_update(&s_fan_pi, temp, dt_ms);
+    portEXIT_CRITICAL(&s_fan_pi_lock);
+
+    return speed;
+}
+
 void app_control_process(sensor_data_t *data)
 {
     if (data == NULL) return;
@@ -57,133 +145,193 @@ void app_control_process(sensor_data_t *data)
     // 检查控制模式 - 手动模式下跳过自动控制逻辑（烟雾报警除外）
     bool is_auto_mode = (data->control_mode == CONTROL_MODE_AUTO);
 
+    // 自动模式：规则引擎求值 (滞回状态由引擎保存)
+    rule_outputs_t rules = {0};
+    if (is_auto_mode) {
+        rules_evaluate(data, &rules);
+    }
+
     // 1. 烟雾报警逻辑（安全优先 - 任何模式下都执行）
     uint8_t fan_speed = data->fan_speed;
     uint8_t fan_state = data->fan_state;
-    if (mq2_is_smoke_detected(data->smoke, data->smoke_threshold)) {
-        TickType_t now = xTaskGetTickCount();
-        bool should_beep = false;
+    // 中断通路的比较器处于越限状态时同样视为报警，避免滤波延迟导致报警抖动
+    bool smoke_alarm = (data->smoke > data->smoke_threshold) || hal_smoke_alarm_active();
+    if (smoke_alarm) {
+        bool first = false;
+        bool should_beep = smoke_alarm_enter(xTaskGetTickCount(), &first);
 
-        if (!s_smoke_alarm_active) {
-            s_smoke_alarm_active = true;
+        if (first) {
             ESP_LOGE(TAG, "Smoke detected! Alarm active (value=%lu, threshold=%d)",
                      (unsigned long)data->smoke, (int)data->smoke_threshold);
-            should_beep = true;
-        } else if ((now - s_last_smoke_beep_tick) >= pdMS_TO_TICKS(SMOKE_ALARM_BEEP_INTERVAL_MS)) {
+            // 比较器不可用或报警任务未启动时这里是唯一的报警通路：与快速通路相同，
+            // 强制写入全速，不等执行器队列，也不被进行中的渐变按影子值跳过
+            hal_fan_force(FAN_SPEED_HIGH);
+        } else if (should_beep) {
             ESP_LOGW(TAG, "Smoke still detected (value=%lu, threshold=%d), periodic alarm beep",
                      (unsigned long)data->smoke, (int)data->smoke_threshold);
-            should_beep = true;
         }
 
         if (should_beep) {
-            buzzer_beep(BUZZER_GPIO, BUZZER_BEEP_DURATION_MS);
-            s_last_smoke_beep_tick = now;
+            hal_buzzer_alarm();
         }
 
         fan_speed = FAN_SPEED_HIGH;
         fan_state = 1;
-        hysteresis_state.fan_on = true;
-    } else if (is_auto_mode) {
-        if (s_smoke_alarm_active) {
+        rules_sync_target(RULE_TARGET_FAN, true);
+    } else {
+        if (smoke_alarm_clear()) {
             ESP_LOGI(TAG, "Smoke alarm cleared (value=%lu)", (unsigned long)data->smoke);
-            s_smoke_alarm_active = false;
         }
 
-        // 2. 自动模式：温度控制逻辑（带滞回）
-        if (AUTO_FAN_ENABLE) {
-            float temp = data->temperature;
-
-            // 滞回逻辑：开启阈值和关闭阈值不同
-            if (hysteresis_state.fan_on) {
-                // 当前开启状态，需要低于 (阈值 - 滞回值) 才关闭
-                if (temp < (TEMP_HIGH_THRESHOLD - TEMP_HYSTERESIS)) {
-                    fan_speed = FAN_SPEED_OFF;
-                    fan_state = 0;
-                    hysteresis_state.fan_on = false;
-                } else if (temp > TEMP_CRITICAL_THRESHOLD) {
-                    fan_speed = FAN_SPEED_HIGH;
-                    fan_state = 1;
-                } else if (temp > TEMP_MEDIUM_THRESHOLD) {
-                    fan_speed = FAN_SPEED_MEDIUM;
-                    fan_state = 1;
-                } else {
-                    fan_speed = FAN_SPEED_LOW;
-                    fan_state = 1;
-                }
-            } else {
-                // 当前关闭状态，需要高于阈值才开启
-                if (temp > TEMP_CRITICAL_THRESHOLD) {
-                    fan_speed = FAN_SPEED_HIGH;
-                    fan_state = 1;
-                    hysteresis_state.fan_on = true;
-                } else if (temp > TEMP_MEDIUM_THRESHOLD) {
-                    fan_speed = FAN_SPEED_MEDIUM;
-                    fan_state = 1;
-                    hysteresis_state.fan_on = true;
-                } else if (temp > TEMP_HIGH_THRESHOLD) {
-                    fan_speed = FAN_SPEED_LOW;
-                    fan_state = 1;
-                    hysteresis_state.fan_on = true;
-                } else {
-                    fan_speed = FAN_SPEED_OFF;
-                    fan_state = 0;
-                }
-            }
-        }
-    }
-    else {
-        if (s_smoke_alarm_active) {
-            ESP_LOGI(TAG, "Smoke alarm cleared (value=%lu)", (unsigned long)data->smoke);
-            s_smoke_alarm_active = false;
+        // 2. 自动模式：风扇 PI 连续调速，或按风扇规则分档
+        if (is_auto_mode && s_fan_pi_enabled) {
+            fan_speed = fan_pi_step(data);
+            fan_state = (fan_speed > 0) ? 1 : 0;
+        } else if (rules.mask & (1 << RULE_TARGET_FAN)) {
+            fan_speed = rules.value[RULE_TARGET_FAN];
+            fan_state = (fan_speed > 0) ? 1 : 0;
         }
     }
     // 手动模式：保持用户设置的风扇状态，不自动调整
 
-    // 3. 灯光控制逻辑（带滞回）- 仅自动模式
+    // 3. 灯光规则 - 仅自动模式
     uint8_t led_brightness = data->led_brightness;
     uint8_t led_state = data->led_state;
-    if (is_auto_mode && AUTO_LIGHT_ENABLE) {
-        float light = data->light;
-
-        // 滞回逻辑
-        if (hysteresis_state.led_on) {
-            // 当前开启状态，需要高于 (阈值 + 滞回值) 才关闭
-            if (light > (LIGHT_LOW_THRESHOLD + LIGHT_HYSTERESIS)) {
-                led_state = 0;
-                led_brightness = LED_BRIGHTNESS_OFF;
-                hysteresis_state.led_on = false;
-            }
-        } else {
-            // 当前关闭状态，需要低于阈值才开启
-            if (light < LIGHT_LOW_THRESHOLD) {
-                led_state = 1;
-                led_brightness = LED_BRIGHTNESS_MAX;
-                hysteresis_state.led_on = true;
-            }
-        }
+    if (rules.mask & (1 << RULE_TARGET_LED)) {
+        led_brightness = rules.value[RULE_TARGET_LED];
+        led_state = (led_brightness > 0) ? 1 : 0;
+    }
+    if (rules.mask & (1 << RULE_TARGET_CURTAIN)) {
+        uint8_t percent = rules.value[RULE_TARGET_CURTAIN];
+        data->curtain_state = (percent > 100) ? 100 : percent;
     }
     // 手动模式：保持用户设置的LED状态，不自动调整
 
     // 4. 窗帘控制逻辑
     static uint8_t last_curtain_state = 0;
     if (data->curtain_state != last_curtain_state) {
-        curtain_control(data->curtain_state);
+        actuator_post(ACTUATOR_CURTAIN, data->curtain_state, ACTUATOR_SRC_AUTO, 0);
         last_curtain_state = data->curtain_state;
     }
 
     // 5. 同步风扇速度与状态
     data->fan_speed = fan_speed;
     data->fan_state = fan_state;
-    fan_set_speed(fan_speed);
+    if (smoke_alarm) {
+        // 报警期间立即生效，不使用默认渐变
+        actuator_post_fade(ACTUATOR_FAN, fan_speed, 0, ACTUATOR_SRC_AUTO, 0);
+    } else {
+        actuator_post(ACTUATOR_FAN, fan_speed, ACTUATOR_SRC_AUTO, 0);
+    }
 
     // 6. 同步LED亮度和状态
     data->led_state = led_state;
     data->led_brightness = led_brightness;
-    if (led_state == 0) {
-        led_off(LED_PWM_CHANNEL);
-    } else {
-        led_set_brightness(LED_PWM_CHANNEL, led_brightness);
+    actuator_post(ACTUATOR_LED, led_state ? led_brightness : 0, ACTUATOR_SRC_AUTO, 0);
+}
+
+void app_control_smoke_alarm(uint32_t value, int64_t detect_us)
+{
+    trace_record(TRACE_EV_ALARM, 0, (int32_t)value);
+
+    // 1. 先驱动硬件，安全响应不依赖共享状态锁，也不经过执行器队列；
+    //    强制写入：渐变中的影子值是目标值而非实际输出，按影子值跳过会让风扇继续慢速爬升
+    hal_fan_force(FAN_SPEED_HIGH);
+
+    uint32_t latency_us = (uint32_t)(s_now_us() - detect_us);
+    portENTER_CRITICAL(&s_alarm_lock);
+    s_alarm_stats.triggers++;
+    s_alarm_stats.latency_last_us = latency_us;
+    if (latency_us > s_alarm_stats.latency_max_us) {
+        s_alarm_stats.latency_max_us = latency_us;
+    }
+    s_alarm_latency_sum_us += latency_us;
+    s_alarm_stats.latency_avg_us = (uint32_t)(s_alarm_latency_sum_us / s_alarm_stats.triggers);
+    portEXIT_CRITICAL(&s_alarm_lock);
+
+    // 2. 同步共享状态 (获取锁失败时由周期通路补齐)
+    sensor_data_t *data = app_state_get();
+    if (data != NULL && app_state_lock() == ESP_OK) {
+        if (value > data->smoke) {
+            data->smoke = value;
+        }
+        data->fan_speed = FAN_SPEED_HIGH;
+        data->fan_state = 1;
+        app_state_unlock();
+    }
+
+    // 3. 蜂鸣 (与周期通路共用节流)
+    bool first = false;
+    if (smoke_alarm_enter(xTaskGetTickCount(), &first)) {
+        hal_buzzer_alarm();
+    }
+
+    ESP_LOGE(TAG, "Smoke alarm (interrupt path): value=%lu, latency=%luus",
+             (unsigned long)value, (unsigned long)latency_us);
+}
+
+void app_control_get_alarm_stats(app_alarm_stats_t *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    portENTER_CRITICAL(&s_alarm_lock);
+    *stats = s_alarm_stats;
+    portEXIT_CRITICAL(&s_alarm_lock);
+}
+
+void app_control_get_fan_pi(app_fan_pi_status_t *status)
+{
+    if (status == NULL) {
+        return;
     }
+    portENTER_CRITICAL(&s_fan_pi_lock);
+    status->enabled = s_fan_pi_enabled;
+    status->cfg = s_fan_pi.cfg;
+    status->error = s_fan_pi.error;
+    status->integral = (uint8_t)((s_fan_pi.integral + (1 << 15)) >> 16);
+    status->output = s_fan_pi.output;
+    status->windup_holds = s_fan_pi.windup_holds;
+    status->resyncs = s_fan_pi_resyncs;
+    portEXIT_CRITICAL(&s_fan_pi_lock);
+}
+
+esp_err_t app_control_set_fan_pi(bool enabled, const fan_pi_cfg_t *cfg)
+{
+    if (cfg != NULL &&
+        (cfg->setpoint < 0 || cfg->setpoint > 60 * FILTER_TEMP_SCALE ||
+         cfg->kp_x10 < 0 || cfg->ki_x1000 < 0 ||
+         cfg->max_duty == 0 || cfg->min_duty > cfg->max_duty)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&s_fan_pi_lock);
+    if (cfg != NULL) {
+        fan_pi_set_cfg(&s_fan_pi, cfg);
+    }
+    bool was_enabled = s_fan_pi_enabled;
+    s_fan_pi_enabled = enabled;
+    if (enabled && !was_enabled) {
+        s_fan_pi.primed = false;
+    }
+    bool fan_on = (s_fan_pi.output > 0);
+    portEXIT_CRITICAL(&s_fan_pi_lock);
+
+    // 交还风扇规则：清除其输出记忆，下一次求值重新下发档位
+    if (was_enabled && !enabled) {
+        rules_sync_target(RULE_TARGET_FAN, fan_on);
+    }
+
+    ESP_LOGI(TAG, "Fan PI %s (setpoint=%ld, kp=%ld/10, ki=%ld/1000, min=%u)",
+             enabled ? "enabled" : "disabled", (long)s_fan_pi.cfg.setpoint,
+             (long)s_fan_pi.cfg.kp_x10, (long)s_fan_pi.cfg.ki_x1000,
+             (unsigned)s_fan_pi.cfg.min_duty);
+    return ESP_OK;
+}
+
+void app_control_set_clock(int64_t (*now_us)(void))
+{
+    s_now_us = (now_us != NULL) ? now_us : esp_timer_get_time;
 }
 
 void app_control_set_mode(sensor_data_t *data, control_mode_t mode)
@@ -193,22 +341,24 @@ void app_control_set_mode(sensor_data_t *data, control_mode_t mode)
     data->control_mode = mode;
     if (mode == CONTROL_MODE_AUTO) {
         // 切回自动模式时，同步滞回状态与当前设备状态
-        hysteresis_state.fan_on = (data->fan_state != 0);
-        hysteresis_state.led_on = (data->led_state != 0);
+        rules_sync_target(RULE_TARGET_FAN, data->fan_state != 0);
+        rules_sync_target(RULE_TARGET_LED, data->led_state != 0);
     }
 }
 
 void app_control_handle_voice_command(vr_command_t command)
 {
+    trace_record(TRACE_EV_VOICE, (uint8_t)command, 0);
+
     // 唤醒命令
     if (command == VR_CMD_WAKE_UP) {
         ESP_LOGI(TAG, "Voice: Wake up detected");
-        buzzer_beep(BUZZER_GPIO, 100);
+        hal_buzzer_beep(100);
 
         // 保存当前颜色并切换到橙色
         s_saved_rgb_color = s_current_rgb_color;
         s_current_rgb_color = RGB_COLOR_ORANGE;
-        rgb_led_set_color(RGB_COLOR_ORANGE);
+        actuator_post(ACTUATOR_RGB_COLOR, RGB_COLOR_ORANGE, ACTUATOR_SRC_VOICE, 0);
         return;
     }
 
@@ -218,7 +368,7 @@ void app_control_handle_voice_command(vr_command_t command)
 
         // 恢复唤醒前的颜色
         s_current_rgb_color = s_saved_rgb_color;
-        rgb_led_set_color(s_current_rgb_color);
+        actuator_post(ACTUATOR_RGB_COLOR, s_current_rgb_color, ACTUATOR_SRC_VOICE, 0);
         return;
     }
 
@@ -249,7 +399,7 @@ void app_control_handle_voice_command(vr_command_t command)
             data->led_brightness = LED_BRIGHTNESS_MAX;
             apply_led = true;
             led_brightness = LED_BRIGHTNESS_MAX;
-            hysteresis_state.led_on = true;
+            rules_sync_target(RULE_TARGET_LED, true);
             break;
 
         case VR_CMD_LIGHT_OFF:
@@ -258,7 +408,7 @@ void app_control_handle_voice_command(vr_command_t command)
             data->led_brightness = LED_BRIGHTNESS_OFF;
             apply_led = true;
             led_brightness = LED_BRIGHTNESS_OFF;
-            hysteresis_state.led_on = false;
+            rules_sync_target(RULE_TARGET_LED, false);
             break;
 
         case VR_CMD_FAN_ON:
@@ -267,7 +417,7 @@ void app_control_handle_voice_command(vr_command_t command)
             data->fan_speed = FAN_SPEED_MEDIUM;
             apply_fan = true;
             fan_speed = FAN_SPEED_MEDIUM;
-            hysteresis_state.fan_on = true;
+            rules_sync_target(RULE_TARGET_FAN, true);
             break;
 
         case VR_CMD_FAN_OFF:
@@ -276,7 +426,7 @@ void app_control_handle_voice_command(vr_command_t command)
             data->fan_speed = FAN_SPEED_OFF;
             apply_fan = true;
             fan_speed = FAN_SPEED_OFF;
-            hysteresis_state.fan_on = false;
+            rules_sync_target(RULE_TARGET_FAN, false);
             break;
 
         case VR_CMD_RGB_RED:
@@ -305,9 +455,9 @@ void app_control_handle_voice_command(vr_command_t command)
 
         case VR_CMD_CURTAIN_OPEN:
             ESP_LOGI(TAG, "Voice: Open curtain");
-            data->curtain_state = 1;
+            data->curtain_state = 100;
             apply_curtain = true;
-            curtain_state = 1;
+            curtain_state = 100;
             break;
 
         case VR_CMD_CURTAIN_CLOSE:
@@ -339,27 +489,23 @@ void app_control_handle_voice_command(vr_command_t command)
     app_state_unlock();
 
     if (apply_led) {
-        if (led_brightness == LED_BRIGHTNESS_OFF) {
-            led_off(LED_PWM_CHANNEL);
-        } else {
-            led_set_brightness(LED_PWM_CHANNEL, led_brightness);
-        }
+        actuator_post(ACTUATOR_LED, led_brightness, ACTUATOR_SRC_VOICE, 0);
     }
 
     if (apply_fan) {
-        fan_set_speed(fan_speed);
+        actuator_post(ACTUATOR_FAN, fan_speed, ACTUATOR_SRC_VOICE, 0);
     }
 
     if (apply_curtain) {
-        curtain_control(curtain_state);
+        actuator_post(ACTUATOR_CURTAIN, curtain_state, ACTUATOR_SRC_VOICE, 0);
     }
 
     if (apply_rgb) {
-        rgb_led_set_color(rgb_color);
+        actuator_post(ACTUATOR_RGB_COLOR, rgb_color, ACTUATOR_SRC_VOICE, 0);
     }
 
     if (apply_beep) {
-        buzzer_beep(BUZZER_GPIO, beep_duration_ms);
+        hal_buzzer_beep(beep_duration_ms);
     }
 }
 
@@ -370,8 +516,9 @@ void app_control_handle_vad_state(vr_vad_state_t state)
 
     // 仅在亮度变化时才操作硬件，避免冗余 I2C/GPIO 调用
     if (s_last_brightness != target_brightness) {
+        trace_record(TRACE_EV_VAD, (uint8_t)state, 0);
         s_last_brightness = target_brightness;
-        rgb_led_set_brightness(target_brightness);
-        rgb_led_set_color(s_current_rgb_color);
+        // 亮度包络在下一帧作用于当前画面，无需重发颜色
+        actuator_post(ACTUATOR_RGB_BRIGHTNESS, target_brightness, ACTUATOR_SRC_VOICE, 0);
     }
 }
@@ -1,9 +1,33 @@
 #ifndef APP_CONTROL_H
 #define APP_CONTROL_H
 
+#include <stdint.h>
 #include "app_types.h"
 #include "esp_err.h"
-#include "voice_recognition.h"
+#include "fan_pi.h"
+
+/**
+ * @brief 中断报警通路统计 (检测时刻到风扇输出完成)
+ */
+typedef struct {
+    uint32_t triggers;          // 中断通路触发次数
+    uint32_t latency_last_us;
+    uint32_t latency_max_us;
+    uint32_t latency_avg_us;
+} app_alarm_stats_t;
+
+/**
+ * @brief 风扇 PI 调速状态
+ */
+typedef struct {
+    bool enabled;               // 自动模式下由 PI 控制风扇 (否则由风扇规则分档)
+    fan_pi_cfg_t cfg;
+    int32_t error;              // 最近一次误差 (0.1℃)
+    uint8_t integral;           // 积分项 (占空)
+    uint8_t output;             // 最近一次输出占空
+    uint32_t windup_holds;      // 抗积分饱和暂停积分次数
+    uint32_t resyncs;           // 无扰接管外部设定转速的次数
+} app_fan_pi_status_t;
 
 /**
  * @brief 初始化应用控制模块
@@ -20,6 +44,45 @@ esp_err_t app_control_init(void);
  */
 void app_control_process(sensor_data_t *data);
 
+/**
+ * @brief 烟雾报警快速通路 (由报警任务在阈值比较器越限后调用)
+ *
+ * 立即将风扇切到最高档并蜂鸣，不等待周期控制逻辑；
+ * 周期通路仍独立判断烟雾值作为兜底。
+ *
+ * @param value 触发时的烟雾值
+ * @param detect_us 检测时刻 (与 app_control_set_clock 同一时间源，默认 esp_timer_get_time)
+ */
+void app_control_smoke_alarm(uint32_t value, int64_t detect_us);
+
+/**
+ * @brief 获取中断报警通路统计
+ */
+void app_control_get_alarm_stats(app_alarm_stats_t *stats);
+
+/**
+ * @brief 获取风扇 PI 调速状态
+ */
+void app_control_get_fan_pi(app_fan_pi_status_t *status);
+
+/**
+ * @brief 启用/停用风扇 PI 调速并更新参数
+ *
+ * 启用后下一个控制周期从当前转速无扰接管；停用后风扇规则重新输出当前档位。
+ *
+ * @param enabled 是否启用
+ * @param cfg 新参数，NULL 表示保持不变
+ * @return esp_err_t ESP_ERR_INVALID_ARG 参数超出范围
+ */
+esp_err_t app_control_set_fan_pi(bool enabled, const fan_pi_cfg_t *cfg);
+
+/**
+ * @brief 设置控制逻辑的时间源 (默认 esp_timer_get_time)
+ *
+ * 轨迹回放注入虚拟时钟，使 PI 积分步长与记录时一致。
+ */
+void app_control_set_clock(int64_t (*now_us)(void));
+
 /**
  * @brief 切换控制模式（调用方需持有 app_state 锁）
  *
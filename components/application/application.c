@@ -15,14 +15,15 @@
  * │           ┌──────────────┐            ┌───────────────┐      │
  * │           │  app_state   │            │  app_control  │      │
  * │           │ (共享数据)    │◄──────────│  (语音回调)    │      │
- * │           └──────────────┘            └───────────────┘      │
+ * │           └──────────────┘            └───────┬───────┘      │
+ * │   control / voice / HTTP ──► 命令队列 ──► actuator_task (5)  │
  * └─────────────────────────────────────────────────────────────┘
  * ┌─────────────────────────────────────────────────────────────┐
  * │                      Network Layer                           │
  * │           WiFi Station  +  HTTP Server                       │
  * └─────────────────────────────────────────────────────────────┘
  * ┌─────────────────────────────────────────────────────────────┐
- * │                      Hardware Layer                          │
+ * │                 HAL (hal_esp32 / hal_sim)                    │
  * │  DHT11 | BH1750 | MQ2 | LED | FAN | BUZZER | MOTOR | RGB    │
  * └─────────────────────────────────────────────────────────────┘
  */
@@ -30,44 +31,68 @@
 #include "application.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
-#include "freertos/semphr.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "nvs_flash.h"
+#include <time.h>
+#include <math.h>
 
 // 配置和状态
 #include "config.h"
 #include "app_types.h"
 #include "app_state.h"
 #include "app_control.h"
+#include "actuator.h"
+#include "sensor_sched.h"
+#include "sensor_history.h"
+#include "sensor_log.h"
+#include "sensor_filter.h"
+#include "trace.h"
 
 // 网络
 #include "wifi.h"
 #include "http_server.h"
-
-// 硬件驱动 (使用官方组件封装)
-#include "dht_driver.h"      // esp-idf-lib/dht
-#include "bh1750_driver.h"   // esp-idf-lib/bh1750
-#include "servo_driver.h"    // espressif/servo
-// 保留原有驱动
-#include "mq2.h"
-#include "led.h"
-#include "fan.h"
-#include "buzzer.h"
-#include "rgb_led.h"
+#if !CONFIG_IDF_TARGET_LINUX
+#include "esp_netif_sntp.h"
+#endif
+
+// 硬件抽象层 (目标板为 ESP32 驱动，linux 目标为仿真后端)
+#include "hal.h"
+#include "hal_sim.h"
+#if !CONFIG_IDF_TARGET_LINUX
 #include "voice_recognition.h"
+#endif
 
 static const char *TAG = "APP";
 
 // ==================== 模块状态 ====================
 static app_init_status_t s_init_status = {0};
+static hal_status_t s_hal_status = {0};
 static volatile bool s_running = false;
+static bool s_archive_ok = false;
+static bool s_trace_ok = false;
 
 // ==================== 任务句柄 ====================
 static TaskHandle_t s_sensor_task_handle = NULL;
 static TaskHandle_t s_control_task_handle = NULL;
+static TaskHandle_t s_alarm_task_handle = NULL;
 
 // ==================== 任务间通信 ====================
-static SemaphoreHandle_t s_sensor_data_ready = NULL;
+// 控制任务订阅的字段：控制输入 + 设备状态 (HTTP 手动命令写入后由控制任务下发)
+#define CONTROL_WATCH_FIELDS (APP_FIELD_TEMPERATURE | APP_FIELD_LIGHT | APP_FIELD_SMOKE | \
+                              APP_FIELD_SMOKE_THRESHOLD | APP_FIELD_CONTROL_MODE | \
+                              APP_FIELD_LED | APP_FIELD_FAN | APP_FIELD_CURTAIN)
+
+// 烟雾比较器越限事件 (ADC 中断写，报警任务读)
+static volatile uint32_t s_alarm_value = 0;
+static volatile int64_t s_alarm_detect_us = 0;
+
+// ==================== 信号调理 ====================
+// 位于驱动与 app_state 之间，仅由 sensor_task 访问
+static sensor_filter_t s_filter_temp;
+static sensor_filter_t s_filter_humi;
+static sensor_filter_t s_filter_light;
+static sensor_filter_t s_filter_smoke;
 
 // ==================== 私有函数声明 ====================
 static esp_err_t init_nvs(void);
@@ -77,10 +102,21 @@ static esp_err_t init_voice(void);
 static esp_err_t start_tasks(void);
 static void run_control_once(sensor_data_t *sensor_data);
 
+static void init_filters(void);
+static float filter_apply(sensor_filter_t *f, float value, int32_t scale);
+static esp_err_t sample_dht11(void *ctx);
+static esp_err_t sample_bh1750(void *ctx);
+static esp_err_t sample_mq2(void *ctx);
+static esp_err_t sample_curtain(void *ctx);
+static esp_err_t archive_snapshot(void *ctx);
+static esp_err_t trace_keyframe(void *ctx);
 static void sensor_task(void *pvParameters);
 static void control_task(void *pvParameters);
+static void smoke_alarm_task(void *pvParameters);
+static bool on_smoke_threshold(uint32_t value, int64_t detect_us, void *ctx);
 static void on_wifi_connected(void);
 static void on_wifi_disconnected(void);
+static void init_time_sync(void);
 
 // ==================== 公共接口实现 ====================
 
@@ -108,34 +144,44 @@ esp_err_t app_start_with_config(const app_config_t *config)
     // 1. 初始化应用状态
     app_state_init();
 
-    // 2. 创建任务间信号量
-    s_sensor_data_ready = xSemaphoreCreateBinary();
-    if (s_sensor_data_ready == NULL) {
-        ESP_LOGE(TAG, "Failed to create semaphore");
-        return ESP_ERR_NO_MEM;
+    // 历史数据存储 (PSRAM)，失败时仅影响 /api/history
+    if (history_init() != ESP_OK) {
+        ESP_LOGW(TAG, "History store unavailable");
+    }
+
+    // Flash 归档 (sensorlog 分区)，失败时不影响实时功能
+    s_archive_ok = (sensor_log_init(APP_TASK_PRIORITY_LOW) == ESP_OK);
+    if (!s_archive_ok) {
+        ESP_LOGW(TAG, "Sensor archive unavailable");
+    }
+
+    // 控制回路轨迹，失败时仅影响 /api/trace
+    s_trace_ok = (trace_init(TRACE_CAPACITY) == ESP_OK);
+    if (!s_trace_ok) {
+        ESP_LOGW(TAG, "Trace recorder unavailable");
     }
 
-    // 3. 初始化 NVS
+    // 2. 初始化 NVS
     ESP_LOGI(TAG, "[1/5] Initializing NVS...");
     if (init_nvs() != ESP_OK) {
         return ESP_FAIL;
     }
 
-    // 4. 初始化硬件
+    // 3. 初始化硬件
     ESP_LOGI(TAG, "[2/5] Initializing Hardware...");
     init_hardware();  // 硬件初始化采用容错模式，不返回失败
 
-    // 5. 初始化网络
+    // 4. 初始化网络
     ESP_LOGI(TAG, "[3/5] Initializing Network...");
     init_network(config);
 
-    // 6. 启动任务
+    // 5. 启动任务
     ESP_LOGI(TAG, "[4/5] Starting Tasks...");
     if (start_tasks() != ESP_OK) {
         return ESP_FAIL;
     }
 
-    // 7. 初始化语音识别
+    // 6. 初始化语音识别
     if (config->enable_voice) {
         ESP_LOGI(TAG, "[5/5] Initializing Voice Recognition...");
         init_voice();
@@ -143,7 +189,7 @@ esp_err_t app_start_with_config(const app_config_t *config)
 
     // 开机提示
     if (s_init_status.buzzer_ok) {
-        buzzer_beep(BUZZER_GPIO, 100);
+        hal_buzzer_beep(100);
     }
 
     s_running = true;
@@ -198,61 +244,23 @@ static esp_err_t init_nvs(void)
 
 static esp_err_t init_hardware(void)
 {
-    // ===== 传感器初始化 (容错模式) =====
-    if (dht11_init(DHT11_GPIO) == ESP_OK) {
-        s_init_status.dht11_ok = true;
-        ESP_LOGI(TAG, "  DHT11: OK (GPIO %d)", DHT11_GPIO);
-    } else {
-        ESP_LOGW(TAG, "  DHT11: FAILED");
-    }
-
-    if (bh1750_sensor_init(BH1750_SDA_GPIO, BH1750_SCL_GPIO) == ESP_OK) {
-        s_init_status.bh1750_ok = true;
-        ESP_LOGI(TAG, "  BH1750: OK (SDA=%d, SCL=%d)", BH1750_SDA_GPIO, BH1750_SCL_GPIO);
-    } else {
-        ESP_LOGW(TAG, "  BH1750: FAILED");
-    }
-
-    if (mq2_init(MQ2_ADC_CHANNEL) == ESP_OK) {
-        s_init_status.mq2_ok = true;
-        ESP_LOGI(TAG, "  MQ2: OK (ADC CH%d)", MQ2_ADC_CHANNEL);
-    } else {
-        ESP_LOGW(TAG, "  MQ2: FAILED");
-    }
-
-    // ===== 执行器初始化 (关键模块) =====
-    if (led_init(LED_GPIO, LED_PWM_CHANNEL) == ESP_OK) {
-        s_init_status.led_ok = true;
-    } else {
-        ESP_LOGE(TAG, "  LED: FAILED - Critical!");
-    }
-
-    if (fan_init(FAN_GPIO, FAN_PWM_CHANNEL) == ESP_OK) {
-        s_init_status.fan_ok = true;
-    } else {
-        ESP_LOGE(TAG, "  FAN: FAILED - Critical!");
-    }
-
-    if (buzzer_init(BUZZER_GPIO) == ESP_OK) {
-        s_init_status.buzzer_ok = true;
-    } else {
-        ESP_LOGW(TAG, "  BUZZER: FAILED");
-    }
-
-    if (motor_init(SERVO_GPIO) == ESP_OK) {
-        s_init_status.motor_ok = true;
-    } else {
-        ESP_LOGW(TAG, "  MOTOR: FAILED");
-    }
-
-    // ===== RGB LED (可选) =====
-    if (rgb_led_init(RGB_LED_GPIO) == ESP_OK) {
-        s_init_status.rgb_led_ok = true;
-        rgb_led_set_brightness(30);
-        rgb_led_blink(RGB_COLOR_GREEN, 2, 100);  // 启动指示
-    } else {
-        ESP_LOGW(TAG, "  RGB LED: FAILED");
-    }
+#if CONFIG_IDF_TARGET_LINUX
+    hal_register(hal_sim_ops());
+#else
+    hal_register(hal_esp32_ops());
+#endif
+
+    // 各设备容错初始化，单个失败不影响其他设备
+    hal_init(&s_hal_status);
+
+    s_init_status.dht11_ok = s_hal_status.climate_ok;
+    s_init_status.bh1750_ok = s_hal_status.light_ok;
+    s_init_status.mq2_ok = s_hal_status.smoke_ok;
+    s_init_status.led_ok = s_hal_status.led_ok;
+    s_init_status.fan_ok = s_hal_status.fan_ok;
+    s_init_status.buzzer_ok = s_hal_status.buzzer_ok;
+    s_init_status.motor_ok = s_hal_status.curtain_ok;
+    s_init_status.rgb_led_ok = s_hal_status.rgb_ok;
 
     return ESP_OK;
 }
@@ -274,6 +282,7 @@ static esp_err_t init_network(const app_config_t *config)
 {
     if (wifi_start(on_wifi_connected, on_wifi_disconnected) == ESP_OK) {
         s_init_status.wifi_ok = true;
+        init_time_sync();
 
         if (config->enable_http_server) {
             sensor_data_t *sensor_data = app_state_get();
@@ -289,8 +298,23 @@ static esp_err_t init_network(const app_config_t *config)
     return ESP_OK;
 }
 
+// SNTP 在后台重试，连上网络后设置系统时间；linux 目标直接使用主机时间
+static void init_time_sync(void)
+{
+#if !CONFIG_IDF_TARGET_LINUX
+    esp_sntp_config_t cfg = ESP_NETIF_SNTP_DEFAULT_CONFIG(SNTP_SERVER);
+    if (esp_netif_sntp_init(&cfg) != ESP_OK) {
+        ESP_LOGW(TAG, "SNTP init failed, archive keeps uptime timestamps");
+    }
+#endif
+}
+
 static esp_err_t init_voice(void)
 {
+#if CONFIG_IDF_TARGET_LINUX
+    // linux 目标无麦克风，sr 组件为空
+    ESP_LOGI(TAG, "Voice Recognition not available on linux target");
+#else
     if (vr_init(INMP441_I2S_SCK, INMP441_I2S_WS, INMP441_I2S_SD,
                 app_control_handle_voice_command) == ESP_OK) {
         vr_set_vad_callback(app_control_handle_vad_state);
@@ -300,11 +324,17 @@ static esp_err_t init_voice(void)
     } else {
         ESP_LOGW(TAG, "Voice Recognition Init Failed");
     }
+#endif
     return ESP_OK;
 }
 
 static esp_err_t start_tasks(void)
 {
+    // 执行器服务 (失败时输出命令在调用方上下文同步执行)
+    if (actuator_init(APP_TASK_PRIORITY_ACTUATOR) != ESP_OK) {
+        ESP_LOGW(TAG, "Actuator service unavailable, commands run synchronously");
+    }
+
     // 初始化控制逻辑
     app_control_init();
 
@@ -340,79 +370,321 @@ static esp_err_t start_tasks(void)
         return ESP_FAIL;
     }
 
+    // 烟雾报警快速通路 (仅 MQ2 连续采集模式；失败时仅保留周期通路)
+    if (s_hal_status.smoke_comparator) {
+        ret = xTaskCreate(
+            smoke_alarm_task,
+            "alarm_task",
+            APP_STACK_SIZE_ALARM,
+            NULL,
+            APP_TASK_PRIORITY_ALARM,
+            &s_alarm_task_handle
+        );
+        if (ret == pdPASS) {
+            hal_smoke_alarm_enable(app_state_get()->smoke_threshold, SMOKE_ALARM_HYSTERESIS,
+                                   on_smoke_threshold, NULL);
+        } else {
+            ESP_LOGW(TAG, "Failed to create alarm task, periodic smoke check only");
+            s_alarm_task_handle = NULL;
+        }
+    }
+
     ESP_LOGI(TAG, "Tasks created:");
     ESP_LOGI(TAG, "  sensor_task:  Pri=%d, Stack=%d bytes",
              APP_TASK_PRIORITY_SENSOR, APP_STACK_SIZE_SENSOR);
     ESP_LOGI(TAG, "  control_task: Pri=%d, Stack=%d bytes",
              APP_TASK_PRIORITY_CONTROL, APP_STACK_SIZE_CONTROL);
+    if (s_alarm_task_handle != NULL) {
+        ESP_LOGI(TAG, "  alarm_task:   Pri=%d, Stack=%d bytes",
+                 APP_TASK_PRIORITY_ALARM, APP_STACK_SIZE_ALARM);
+    }
 
     return ESP_OK;
 }
 
+// ==================== 信号调理 ====================
+
+static void init_filters(void)
+{
+    const sensor_filter_cfg_t temp_cfg = {
+        .median_window = FILTER_TEMP_MEDIAN,
+        .ema_shift = FILTER_TEMP_EMA_SHIFT,
+        .max_slew = FILTER_TEMP_SLEW,
+        .outlier_thresh = FILTER_TEMP_OUTLIER,
+        .outlier_max_run = FILTER_OUTLIER_MAX_RUN,
+    };
+    const sensor_filter_cfg_t humi_cfg = {
+        .median_window = FILTER_HUMI_MEDIAN,
+        .ema_shift = FILTER_HUMI_EMA_SHIFT,
+        .max_slew = FILTER_HUMI_SLEW,
+        .outlier_thresh = FILTER_HUMI_OUTLIER,
+        .outlier_max_run = FILTER_OUTLIER_MAX_RUN,
+    };
+    const sensor_filter_cfg_t light_cfg = {
+        .median_window = FILTER_LIGHT_MEDIAN,
+    };
+    const sensor_filter_cfg_t smoke_cfg = {
+        .median_window = FILTER_SMOKE_MEDIAN,
+    };
+
+    sensor_filter_init(&s_filter_temp, &temp_cfg);
+    sensor_filter_init(&s_filter_humi, &humi_cfg);
+    sensor_filter_init(&s_filter_light, &light_cfg);
+    sensor_filter_init(&s_filter_smoke, &smoke_cfg);
+}
+
+// 浮点读数按 scale 转为定点滤波后再转回
+static float filter_apply(sensor_filter_t *f, float value, int32_t scale)
+{
+    int32_t out = 0;
+    sensor_filter_update(f, (int32_t)lroundf(value * scale), &out);
+    return (float)out / scale;
+}
+
 // ==================== 任务实现 ====================
 
+static esp_err_t sample_dht11(void *ctx)
+{
+    sensor_data_t *sensor_data = (sensor_data_t *)ctx;
+    float temperature = 0;
+    float humidity = 0;
+
+    // 转换进行中时返回 ESP_ERR_NOT_FINISHED，由调度器稍后重新轮询
+    esp_err_t ret = hal_climate_read(&temperature, &humidity);
+    if (ret == ESP_ERR_NOT_FINISHED) {
+        return ret;
+    }
+    if (ret != ESP_OK) {
+        return ESP_FAIL;
+    }
+
+    temperature = filter_apply(&s_filter_temp, temperature, FILTER_TEMP_SCALE);
+    humidity = filter_apply(&s_filter_humi, humidity, FILTER_HUMI_SCALE);
+    trace_record(TRACE_EV_SENSOR, TRACE_SENSOR_TEMPERATURE,
+                 lroundf(temperature * TRACE_CLIMATE_SCALE));
+    trace_record(TRACE_EV_SENSOR, TRACE_SENSOR_HUMIDITY,
+                 lroundf(humidity * TRACE_CLIMATE_SCALE));
+
+    ret = app_state_lock();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    sensor_data->temperature = temperature;
+    sensor_data->humidity = humidity;
+    app_state_unlock();
+
+    uint32_t now = history_now();
+    history_record(HISTORY_CH_TEMPERATURE, now, temperature);
+    history_record(HISTORY_CH_HUMIDITY, now, humidity);
+    return ESP_OK;
+}
+
+static esp_err_t sample_bh1750(void *ctx)
+{
+    sensor_data_t *sensor_data = (sensor_data_t *)ctx;
+    float lux = 0;
+    bool fast = false;
+
+    // 首次调用启动转换，转换完成前返回 ESP_ERR_NOT_FINISHED
+    esp_err_t ret = hal_light_read(&lux, &fast);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    // 光照快速变化时缩短采样周期，稳定后恢复
+    sensor_sched_set_period("bh1750", fast ?
+                            BH1750_FAST_PERIOD_MS : BH1750_SAMPLE_PERIOD_MS);
+
+    lux = filter_apply(&s_filter_light, lux, FILTER_LIGHT_SCALE);
+    trace_record(TRACE_EV_SENSOR, TRACE_SENSOR_LIGHT, lroundf(lux));
+
+    ret = app_state_lock();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    sensor_data->light = lux;
+    app_state_unlock();
+
+    history_record(HISTORY_CH_LIGHT, history_now(), lux);
+    return ESP_OK;
+}
+
+static esp_err_t sample_mq2(void *ctx)
+{
+    sensor_data_t *sensor_data = (sensor_data_t *)ctx;
+    uint32_t smoke_val = 0;
+
+    esp_err_t ret = hal_smoke_read(&smoke_val);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    int32_t filtered = 0;
+    sensor_filter_update(&s_filter_smoke, (int32_t)smoke_val, &filtered);
+    smoke_val = (uint32_t)filtered;
+    trace_record(TRACE_EV_SENSOR, TRACE_SENSOR_SMOKE, (int32_t)smoke_val);
+
+    ret = app_state_lock();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    sensor_data->smoke = smoke_val;
+    app_state_unlock();
+
+    history_record(HISTORY_CH_SMOKE, history_now(), (float)smoke_val);
+    return ESP_OK;
+}
+
+// 回读舵机插值位置，运动过程中开度逐步变化，静止时不加锁
+static esp_err_t sample_curtain(void *ctx)
+{
+    sensor_data_t *sensor_data = (sensor_data_t *)ctx;
+    uint8_t percent = 0;
+
+    esp_err_t ret = hal_curtain_get_position(&percent);
+    if (ret != ESP_OK || percent == sensor_data->curtain_position) {
+        return ret;
+    }
+
+    ret = app_state_lock();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    sensor_data->curtain_position = percent;
+    app_state_unlock();
+    return ESP_OK;
+}
+
+static esp_err_t archive_snapshot(void *ctx)
+{
+    sensor_data_t snapshot;
+    sensor_log_record_t rec;
+
+    app_state_read_snapshot(&snapshot);
+    rec.temperature = snapshot.temperature;
+    rec.humidity = snapshot.humidity;
+    rec.light = snapshot.light;
+    rec.smoke = snapshot.smoke;
+
+    // 已校时 (RTC 跨软复位保持) 用墙钟；否则用上电以来秒数，读取方按页序号排序
+    time_t now = time(NULL);
+    rec.ts = (now >= (time_t)SENSOR_LOG_TS_WALL_MIN) ?
+             (uint32_t)now : (uint32_t)(esp_timer_get_time() / 1000000);
+    return sensor_log_append(&rec);
+}
+
+// 周期记录控制相关状态，轨迹被环形覆盖后回放可从关键帧重建
+static esp_err_t trace_keyframe(void *ctx)
+{
+    sensor_data_t snapshot;
+    app_state_read_snapshot(&snapshot);
+
+    int32_t led = (snapshot.led_state << 8) | snapshot.led_brightness;
+    int32_t fan = (snapshot.fan_state << 8) | snapshot.fan_speed;
+    int32_t curtain = snapshot.curtain_state;
+    int32_t threshold = (int32_t)snapshot.smoke_threshold;
+    int32_t mode = snapshot.control_mode;
+
+    // 模式最后记录：回放切换模式时按已恢复的设备状态同步滞回
+    trace_record(TRACE_EV_STATE, TRACE_STATE_LED, led);
+    trace_record(TRACE_EV_STATE, TRACE_STATE_FAN, fan);
+    trace_record(TRACE_EV_STATE, TRACE_STATE_CURTAIN, curtain);
+    trace_record(TRACE_EV_STATE, TRACE_STATE_SMOKE_THRESHOLD, threshold);
+    trace_record(TRACE_EV_STATE, TRACE_STATE_MODE, mode);
+    return ESP_OK;
+}
+
 /**
  * @brief 传感器采集任务
  *
- * 职责：定期读取所有传感器数据并更新到共享状态
+ * 职责：按各自周期读取传感器数据并更新到共享状态
  * 特点：
- * - 独立的传感器读取任务，不阻塞控制逻辑
- * - 读取完成后通过信号量通知控制任务
- * - 容错处理：传感器读取失败不影响其他传感器
+ * - 多速率调度：MQ2 (安全相关) 高频采样，BH1750 次之，DHT11 受物理限制低频采样
+ * - 采样结果写入共享状态，值有变化时由订阅机制唤醒控制任务
+ * - 容错处理：初始化失败的传感器不参与调度
  */
 static void sensor_task(void *pvParameters)
 {
     sensor_data_t *sensor_data = app_state_get();
-    dht11_data_t dht_data;
-    float lux = 0;
-    uint32_t smoke_val = 0;
 
     ESP_LOGI(TAG, "Sensor task started");
 
-    while (1) {
-        bool any_update = false;
-
-        // 读取 DHT11
-        if (s_init_status.dht11_ok) {
-            if (dht11_read(&dht_data) == ESP_OK && dht_data.valid) {
-                if (app_state_lock() == ESP_OK) {
-                    sensor_data->temperature = dht_data.temperature;
-                    sensor_data->humidity = dht_data.humidity;
-                    app_state_unlock();
-                    any_update = true;
-                }
-            }
-        }
+    init_filters();
+    sensor_sched_init();
+
+    if (s_init_status.mq2_ok) {
+        sensor_sched_entry_t entry = {
+            .name = "mq2",
+            .period_ms = MQ2_SAMPLE_PERIOD_MS,
+            .deadline_ms = MQ2_SAMPLE_DEADLINE_MS,
+            .priority = 3,
+            .read = sample_mq2,
+            .ctx = sensor_data,
+        };
+        sensor_sched_add(&entry);
+    }
 
-        // 读取 BH1750
-        if (s_init_status.bh1750_ok) {
-            if (bh1750_sensor_read(&lux) == ESP_OK) {
-                if (app_state_lock() == ESP_OK) {
-                    sensor_data->light = lux;
-                    app_state_unlock();
-                    any_update = true;
-                }
-            }
-        }
+    if (s_init_status.bh1750_ok) {
+        sensor_sched_entry_t entry = {
+            .name = "bh1750",
+            .period_ms = BH1750_SAMPLE_PERIOD_MS,
+            .deadline_ms = BH1750_SAMPLE_DEADLINE_MS,
+            .priority = 2,
+            .poll_ms = BH1750_SAMPLE_POLL_MS,
+            .read = sample_bh1750,
+            .ctx = sensor_data,
+        };
+        sensor_sched_add(&entry);
+    }
 
-        // 读取 MQ2
-        if (s_init_status.mq2_ok) {
-            if (mq2_read(MQ2_ADC_CHANNEL, &smoke_val) == ESP_OK) {
-                if (app_state_lock() == ESP_OK) {
-                    sensor_data->smoke = smoke_val;
-                    app_state_unlock();
-                    any_update = true;
-                }
-            }
-        }
+    if (s_init_status.dht11_ok) {
+        sensor_sched_entry_t entry = {
+            .name = "dht11",
+            .period_ms = DHT11_SAMPLE_PERIOD_MS,
+            .deadline_ms = DHT11_SAMPLE_DEADLINE_MS,
+            .priority = 1,
+            .poll_ms = DHT11_SAMPLE_POLL_MS,
+            .read = sample_dht11,
+            .ctx = sensor_data,
+        };
+        sensor_sched_add(&entry);
+    }
 
-        // 通知控制任务有新数据
-        if (any_update) {
-            xSemaphoreGive(s_sensor_data_ready);
-        }
+    if (s_init_status.motor_ok) {
+        sensor_sched_entry_t entry = {
+            .name = "curtain",
+            .period_ms = CURTAIN_POSITION_PERIOD_MS,
+            .priority = 0,
+            .read = sample_curtain,
+            .ctx = sensor_data,
+        };
+        sensor_sched_add(&entry);
+    }
 
-        vTaskDelay(pdMS_TO_TICKS(SENSOR_READ_INTERVAL));
+    // 归档优先级最低
+    if (s_archive_ok) {
+        sensor_sched_entry_t entry = {
+            .name = "archive",
+            .period_ms = SENSOR_LOG_INTERVAL_MS,
+            .priority = 0,
+            .read = archive_snapshot,
+            .ctx = sensor_data,
+        };
+        sensor_sched_add(&entry);
     }
+
+    if (s_trace_ok) {
+        sensor_sched_entry_t entry = {
+            .name = "trace",
+            .period_ms = TRACE_KEYFRAME_INTERVAL_MS,
+            .priority = 0,
+            .read = trace_keyframe,
+            .ctx = sensor_data,
+        };
+        sensor_sched_add(&entry);
+    }
+
+    sensor_sched_run();
 }
 
 /**
@@ -420,7 +692,8 @@ static void sensor_task(void *pvParameters)
  *
  * 职责：根据传感器数据执行自动化控制逻辑
  * 特点：
- * - 等待传感器数据更新信号
+ * - 订阅 app_state 字段变化，仅在控制输入或设备状态变化时执行
+ *   (滤波后读数不变的采样不会唤醒)
  * - 优先级高于传感器任务，确保及时响应
  * - 处理烟雾报警等紧急情况
  */
@@ -430,33 +703,62 @@ static void control_task(void *pvParameters)
 
     ESP_LOGI(TAG, "Control task started");
 
+    app_state_sub_t sub;
+    if (app_state_subscribe(CONTROL_WATCH_FIELDS, &sub) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to subscribe to state changes");
+        vTaskDelete(NULL);
+        return;
+    }
+
     while (1) {
-        // 等待传感器数据更新 (最多等待 2 倍采样周期)
-        xSemaphoreTake(s_sensor_data_ready, pdMS_TO_TICKS(SENSOR_READ_INTERVAL * 2));
+        // 等待订阅字段变化 (最多等待 2 倍采样周期，超时也执行一次兜底控制)
+        app_state_wait(sub, pdMS_TO_TICKS(SENSOR_READ_INTERVAL * 2));
         run_control_once(sensor_data);
     }
 }
 
+// ADC 中断上下文：记录越限值与时刻，唤醒报警任务
+static bool on_smoke_threshold(uint32_t value, int64_t detect_us, void *ctx)
+{
+    BaseType_t woken = pdFALSE;
+    s_alarm_value = value;
+    s_alarm_detect_us = detect_us;
+    vTaskNotifyGiveFromISR(s_alarm_task_handle, &woken);
+    return woken == pdTRUE;
+}
+
+/**
+ * @brief 烟雾报警任务
+ *
+ * 职责：阈值比较器越限后立即驱动风扇/蜂鸣
+ * 特点：
+ * - 最高应用优先级，不经过采样调度与控制任务
+ * - 周期控制通路仍独立检查烟雾值，作为兜底
+ */
+static void smoke_alarm_task(void *pvParameters)
+{
+    ESP_LOGI(TAG, "Alarm task started");
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        app_control_smoke_alarm(s_alarm_value, s_alarm_detect_us);
+    }
+}
+
 static void run_control_once(sensor_data_t *sensor_data)
 {
     if (sensor_data == NULL) {
         return;
     }
 
+    // 无锁读取快照，仅回写时加锁
     sensor_data_t snapshot;
-    uint8_t baseline_fan_state = 0;
-    uint8_t baseline_fan_speed = 0;
-    uint8_t baseline_led_state = 0;
-    uint8_t baseline_led_brightness = 0;
-    if (app_state_lock() != ESP_OK) {
-        return;
-    }
-    snapshot = *sensor_data;
-    baseline_fan_state = sensor_data->fan_state;
-    baseline_fan_speed = sensor_data->fan_speed;
-    baseline_led_state = sensor_data->led_state;
-    baseline_led_brightness = sensor_data->led_brightness;
-    app_state_unlock();
+    app_state_read_snapshot(&snapshot);
+    uint8_t baseline_fan_state = snapshot.fan_state;
+    uint8_t baseline_fan_speed = snapshot.fan_speed;
+    uint8_t baseline_led_state = snapshot.led_state;
+    uint8_t baseline_led_brightness = snapshot.led_brightness;
+    uint8_t baseline_curtain_state = snapshot.curtain_state;
 
     app_control_process(&snapshot);
 
@@ -492,17 +794,19 @@ static void run_control_once(sensor_data_t *sensor_data)
         latest_led_brightness = sensor_data->led_brightness;
     }
 
+    // 窗帘可由规则引擎改变，同样只在未被并发更新时回写
+    if (sensor_data->curtain_state == baseline_curtain_state) {
+        sensor_data->curtain_state = snapshot.curtain_state;
+    }
+
     app_state_unlock();
 
     // 发生并发冲突时，按共享状态重放一次硬件输出，避免短暂回退
     if (apply_latest_fan) {
-        fan_set_speed(latest_fan_speed);
+        actuator_post(ACTUATOR_FAN, latest_fan_speed, ACTUATOR_SRC_AUTO, 0);
     }
     if (apply_latest_led) {
-        if (latest_led_state == 0) {
-            led_off(LED_PWM_CHANNEL);
-        } else {
-            led_set_brightness(LED_PWM_CHANNEL, latest_led_brightness);
-        }
+        actuator_post(ACTUATOR_LED, latest_led_state ? latest_led_brightness : 0,
+                      ACTUATOR_SRC_AUTO, 0);
     }
 }
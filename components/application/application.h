@@ -34,6 +34,8 @@ extern "C" {
 #define APP_TASK_PRIORITY_CONTROL   4   // 控制逻辑
 #define APP_TASK_PRIORITY_VR_DETECT 5   // 语音检测
 #define APP_TASK_PRIORITY_VR_FEED   5   // 音频采集 
+#define APP_TASK_PRIORITY_ACTUATOR  5   // 执行器服务 (高于控制任务，与 HTTP 服务器同级)
+#define APP_TASK_PRIORITY_ALARM     6   // 烟雾报警快速通路
 
 /**
  * @brief 任务栈大小定义 (单位: 字节)
@@ -47,6 +49,7 @@ extern "C" {
  */
 #define APP_STACK_SIZE_SENSOR    (6 * 1024)   // 传感器任务 (DHT/I2C/ADC + 错误日志)
 #define APP_STACK_SIZE_CONTROL   (3 * 1024)   // 控制任务 (逻辑处理)
+#define APP_STACK_SIZE_ALARM     (3 * 1024)   // 报警任务 (风扇/蜂鸣 + 日志)
 #define APP_STACK_SIZE_VR_FEED   (4 * 1024)   // 音频采集 (I2S缓冲)
 #define APP_STACK_SIZE_VR_DETECT (8 * 1024)   // 语音识别 (神经网络)
 
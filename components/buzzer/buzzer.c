@@ -1,47 +1,370 @@
 #include "buzzer.h"
-#include "driver/gpio.h"
+#include "driver/ledc.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include <string.h>
 
 static const char *TAG = "BUZZER";
 
+// LEDC 资源：LED 用 TIMER_0/通道0，风扇 TIMER_2/通道1，舵机 TIMER_3/通道2
+#define BUZZER_PWM_TIMER      LEDC_TIMER_1
+#define BUZZER_PWM_CHANNEL    LEDC_CHANNEL_3
+#define BUZZER_PWM_RESOLUTION LEDC_TIMER_10_BIT
+#define BUZZER_DUTY_FULL      (1 << 10)        // 100% 占空：直流驱动
+#define BUZZER_DUTY_HALF      (1 << 9)         // 50% 占空：方波音调
+#define BUZZER_BASE_FREQ_HZ   2000
+
+/**
+ * @brief 播放项 (单音播放时音符存放在 inline_note 中)
+ */
+typedef struct {
+    buzzer_note_t inline_note;
+    const buzzer_note_t *notes;     // NULL 表示使用 inline_note
+    uint8_t count;
+    uint8_t repeat;
+    uint8_t prio;
+} play_item_t;
+
+static SemaphoreHandle_t s_lock = NULL;
+static esp_timer_handle_t s_timer = NULL;
+static uint8_t s_gpio = 0xFF;
+
+// 以下状态由 s_lock 保护 (调用方任务与 esp_timer 任务共享)
+static play_item_t s_queue[BUZZER_QUEUE_LEN];   // 按优先级降序，同级先到在前
+static uint8_t s_queue_len = 0;
+static play_item_t s_current;
+static bool s_playing = false;
+static bool s_on_phase = false;
+static uint8_t s_note_idx = 0;
+static uint8_t s_repeat_left = 0;
+static int64_t s_due_us = 0;
+static uint32_t s_freq_hz = BUZZER_BASE_FREQ_HZ;
+static buzzer_stats_t s_stats;
+
+// 报警节奏：··· ——— ···
+static const buzzer_note_t s_sos_notes[] = {
+    {0, 100, 100}, {0, 100, 100}, {0, 100, 300},
+    {0, 300, 100}, {0, 300, 100}, {0, 300, 300},
+    {0, 100, 100}, {0, 100, 100}, {0, 100, 700},
+};
+
+const buzzer_pattern_t BUZZER_PATTERN_SOS = {
+    .notes = s_sos_notes,
+    .count = sizeof(s_sos_notes) / sizeof(s_sos_notes[0]),
+    .repeat = 0,
+};
+
+static const buzzer_note_t s_alarm_note = {0, 200, 200};
+
+// ==================== 输出 ====================
+
+static void output_set(uint32_t duty)
+{
+    ledc_set_duty(LEDC_LOW_SPEED_MODE, BUZZER_PWM_CHANNEL, duty);
+    ledc_update_duty(LEDC_LOW_SPEED_MODE, BUZZER_PWM_CHANNEL);
+}
+
+static void output_on(uint16_t freq_hz)
+{
+    if (freq_hz == 0) {
+        output_set(BUZZER_DUTY_FULL);
+        return;
+    }
+    if (freq_hz != s_freq_hz &&
+        ledc_set_freq(LEDC_LOW_SPEED_MODE, BUZZER_PWM_TIMER, freq_hz) == ESP_OK) {
+        s_freq_hz = freq_hz;
+    }
+    output_set(BUZZER_DUTY_HALF);
+}
+
+static void output_off(void)
+{
+    output_set(0);
+}
+
+// ==================== 序列器 (调用方持有 s_lock) ====================
+
+static const buzzer_note_t *current_note(void)
+{
+    const buzzer_note_t *notes = (s_current.notes != NULL) ? s_current.notes : &s_current.inline_note;
+    return &notes[s_note_idx];
+}
+
+static void schedule(uint32_t delay_ms)
+{
+    uint64_t delay_us = (uint64_t)delay_ms * 1000;
+    esp_timer_stop(s_timer);
+    s_due_us = esp_timer_get_time() + (int64_t)delay_us;
+    esp_timer_start_once(s_timer, delay_us);
+}
+
+static void start_note(void)
+{
+    const buzzer_note_t *note = current_note();
+    output_on(note->freq_hz);
+    s_on_phase = true;
+    schedule(note->on_ms);
+}
+
+static void start_item(const play_item_t *item)
+{
+    s_current = *item;
+    s_playing = true;
+    s_note_idx = 0;
+    s_repeat_left = item->repeat;
+    s_stats.played++;
+    start_note();
+}
+
+static bool queue_push(const play_item_t *item)
+{
+    if (s_queue_len >= BUZZER_QUEUE_LEN) {
+        return false;
+    }
+    uint8_t pos = s_queue_len;
+    while (pos > 0 && s_queue[pos - 1].prio < item->prio) {
+        s_queue[pos] = s_queue[pos - 1];
+        pos--;
+    }
+    s_queue[pos] = *item;
+    s_queue_len++;
+    return true;
+}
+
+// 丢弃排队中优先级 <= prio 的节奏
+static void queue_drop_upto(uint8_t prio)
+{
+    uint8_t kept = 0;
+    for (uint8_t i = 0; i < s_queue_len; i++) {
+        if (s_queue[i].prio > prio) {
+            s_queue[kept++] = s_queue[i];
+        } else {
+            s_stats.dropped++;
+        }
+    }
+    s_queue_len = kept;
+}
+
+static void start_next_queued(void)
+{
+    if (s_queue_len == 0) {
+        return;
+    }
+    play_item_t next = s_queue[0];
+    memmove(&s_queue[0], &s_queue[1], (size_t)(s_queue_len - 1) * sizeof(s_queue[0]));
+    s_queue_len--;
+    start_item(&next);
+}
+
+static void advance(void)
+{
+    if (s_on_phase) {
+        const buzzer_note_t *note = current_note();
+        output_off();
+        s_on_phase = false;
+        if (note->off_ms > 0) {
+            schedule(note->off_ms);
+            return;
+        }
+    }
+
+    if (++s_note_idx >= s_current.count) {
+        if (s_repeat_left == 0) {
+            s_playing = false;
+            start_next_queued();
+            return;
+        }
+        s_repeat_left--;
+        s_note_idx = 0;
+    }
+    start_note();
+}
+
+static void buzzer_timer_cb(void *arg)
+{
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    // 打断/停止后重新调度时，已经在等锁的旧回调按到期时间忽略
+    if (s_playing && esp_timer_get_time() >= s_due_us) {
+        advance();
+    }
+    xSemaphoreGive(s_lock);
+}
+
+static esp_err_t submit(const play_item_t *item)
+{
+    if (s_lock == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_err_t ret = ESP_OK;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    if (!s_playing) {
+        start_item(item);
+    } else if (item->prio > s_current.prio) {
+        // 打断当前节奏，排队中更低优先级的节奏已过时
+        s_stats.preempted++;
+        queue_drop_upto(item->prio - 1);
+        start_item(item);
+    } else if (!queue_push(item)) {
+        s_stats.dropped++;
+        ret = ESP_ERR_NO_MEM;
+    }
+    xSemaphoreGive(s_lock);
+    return ret;
+}
+
+// ==================== 公共接口 ====================
+
 esp_err_t buzzer_init(uint8_t gpio_num)
 {
-    gpio_config_t io_conf = {
-        .pin_bit_mask = (1ULL << gpio_num),
-        .mode = GPIO_MODE_OUTPUT,
-        .pull_up_en = GPIO_PULLUP_DISABLE,
-        .pull_down_en = GPIO_PULLDOWN_DISABLE,
-        .intr_type = GPIO_INTR_DISABLE
+    if (s_lock != NULL) {
+        return ESP_OK;
+    }
+
+    ledc_timer_config_t ledc_timer = {
+        .speed_mode = LEDC_LOW_SPEED_MODE,
+        .timer_num = BUZZER_PWM_TIMER,
+        .duty_resolution = BUZZER_PWM_RESOLUTION,
+        .freq_hz = BUZZER_BASE_FREQ_HZ,
+        .clk_cfg = LEDC_AUTO_CLK
     };
-    
-    esp_err_t ret = gpio_config(&io_conf);
+    esp_err_t ret = ledc_timer_config(&ledc_timer);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "GPIO config failed");
+        ESP_LOGE(TAG, "LEDC timer config failed");
         return ret;
     }
-    
-    gpio_set_level(gpio_num, 1); // 默认高电平（不响）
-    ESP_LOGI(TAG, "Buzzer initialized on GPIO %d (Active Low)", gpio_num);
+
+    // 低电平触发：输出反相，占空 0 即高电平（不响）
+    ledc_channel_config_t ledc_channel = {
+        .speed_mode = LEDC_LOW_SPEED_MODE,
+        .channel = BUZZER_PWM_CHANNEL,
+        .timer_sel = BUZZER_PWM_TIMER,
+        .intr_type = LEDC_INTR_DISABLE,
+        .gpio_num = gpio_num,
+        .duty = 0,
+        .hpoint = 0,
+        .flags.output_invert = 1,
+    };
+    ret = ledc_channel_config(&ledc_channel);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "LEDC channel config failed");
+        return ret;
+    }
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = buzzer_timer_cb,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "buzzer",
+    };
+    ret = esp_timer_create(&timer_args, &s_timer);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Sequencer timer create failed");
+        return ret;
+    }
+
+    SemaphoreHandle_t lock = xSemaphoreCreateMutex();
+    if (lock == NULL) {
+        esp_timer_delete(s_timer);
+        s_timer = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_gpio = gpio_num;
+    s_lock = lock;
+
+    ESP_LOGI(TAG, "Buzzer initialized on GPIO %d (Active Low, LEDC ch%d)", gpio_num,
+             BUZZER_PWM_CHANNEL);
     return ESP_OK;
 }
 
 esp_err_t buzzer_beep(uint8_t gpio_num, uint32_t duration_ms)
 {
-    gpio_set_level(gpio_num, 0); // 拉低响
-    vTaskDelay(pdMS_TO_TICKS(duration_ms));
-    gpio_set_level(gpio_num, 1); // 拉高停
-    return ESP_OK;
+    if (gpio_num != s_gpio) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return buzzer_play_tone(0, duration_ms, BUZZER_PRIO_NOTICE);
 }
 
 esp_err_t buzzer_alarm(uint8_t gpio_num, uint8_t times)
 {
-    for (uint8_t i = 0; i < times; i++) {
-        gpio_set_level(gpio_num, 0); // 拉低响
-        vTaskDelay(pdMS_TO_TICKS(200));
-        gpio_set_level(gpio_num, 1); // 拉高停
-        vTaskDelay(pdMS_TO_TICKS(200));
+    if (gpio_num != s_gpio || times == 0) {
+        return ESP_ERR_INVALID_ARG;
     }
-    return ESP_OK;
+    buzzer_pattern_t pattern = {
+        .notes = &s_alarm_note,
+        .count = 1,
+        .repeat = times - 1,
+    };
+    return buzzer_play(&pattern, BUZZER_PRIO_ALARM);
+}
+
+esp_err_t buzzer_play(const buzzer_pattern_t *pattern, buzzer_prio_t prio)
+{
+    if (pattern == NULL || pattern->notes == NULL || pattern->count == 0 ||
+        prio >= BUZZER_PRIO_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    play_item_t item = {
+        .notes = pattern->notes,
+        .count = pattern->count,
+        .repeat = pattern->repeat,
+        .prio = (uint8_t)prio,
+    };
+    return submit(&item);
+}
+
+esp_err_t buzzer_play_tone(uint16_t freq_hz, uint32_t duration_ms, buzzer_prio_t prio)
+{
+    if (duration_ms == 0 || prio >= BUZZER_PRIO_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    play_item_t item = {
+        .inline_note = {
+            .freq_hz = freq_hz,
+            .on_ms = (uint16_t)((duration_ms > UINT16_MAX) ? UINT16_MAX : duration_ms),
+            .off_ms = 0,
+        },
+        .notes = NULL,
+        .count = 1,
+        .repeat = 0,
+        .prio = (uint8_t)prio,
+    };
+    return submit(&item);
+}
+
+void buzzer_stop(buzzer_prio_t prio)
+{
+    if (s_lock == NULL) {
+        return;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    queue_drop_upto(prio);
+    if (s_playing && s_current.prio <= prio) {
+        esp_timer_stop(s_timer);
+        output_off();
+        s_playing = false;
+        start_next_queued();
+    }
+    xSemaphoreGive(s_lock);
+}
+
+bool buzzer_is_playing(void)
+{
+    return s_playing;
+}
+
+void buzzer_get_stats(buzzer_stats_t *stats)
+{
+    if (stats == NULL || s_lock == NULL) {
+        return;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    *stats = s_stats;
+    xSemaphoreGive(s_lock);
 }
@@ -1,33 +1,120 @@
+/**
+ * @file buzzer.h
+ * @brief 蜂鸣器：LEDC 输出 + esp_timer 驱动的节奏序列器
+ *
+ * 所有播放接口只把节奏放入序列器后立即返回，不阻塞调用方。
+ * - 音符 = 频率 + 响/停时长；频率为 0 时以 100% 占空直流驱动 (有源蜂鸣器)
+ * - 高优先级节奏打断正在播放的低优先级节奏，并丢弃排队中更低优先级的节奏
+ * - 同级或低优先级节奏排队，当前节奏结束后按优先级 (同级先到先播) 播放
+ */
+
 #ifndef BUZZER_H
 #define BUZZER_H
 
 #include <stdint.h>
+#include <stdbool.h>
 #include "esp_err.h"
 
+// 排队节奏数上限 (不含正在播放的节奏)
+#define BUZZER_QUEUE_LEN 4
+
+/**
+ * @brief 播放优先级
+ */
+typedef enum {
+    BUZZER_PRIO_FEEDBACK = 0,   // 操作反馈 (语音命令确认等)
+    BUZZER_PRIO_NOTICE,         // 提示 (唤醒、启动)
+    BUZZER_PRIO_ALARM,          // 报警，打断其他声音
+    BUZZER_PRIO_MAX,
+} buzzer_prio_t;
+
+/**
+ * @brief 音符
+ */
+typedef struct {
+    uint16_t freq_hz;           // 音调 (0 = 直流驱动)
+    uint16_t on_ms;             // 响的时长
+    uint16_t off_ms;            // 其后静音时长
+} buzzer_note_t;
+
+/**
+ * @brief 节奏 (音符表须在播放期间有效，通常为静态常量)
+ */
+typedef struct {
+    const buzzer_note_t *notes;
+    uint8_t count;
+    uint8_t repeat;             // 额外重复次数 (0 = 播放一遍)
+} buzzer_pattern_t;
+
+/**
+ * @brief 序列器统计
+ */
+typedef struct {
+    uint32_t played;            // 开始播放的节奏数
+    uint32_t preempted;         // 被更高优先级打断的节奏数
+    uint32_t dropped;           // 队列满或被高优先级清除的节奏数
+} buzzer_stats_t;
+
+// 预置节奏
+extern const buzzer_pattern_t BUZZER_PATTERN_SOS;       // 报警：··· ——— ···
+
 /**
- * @brief 初始化蜂鸣器
- * 
+ * @brief 初始化蜂鸣器 (LEDC 通道 + 序列器定时器)
+ *
  * @param gpio_num GPIO引脚
  * @return esp_err_t ESP_OK 成功，其他值失败
  */
 esp_err_t buzzer_init(uint8_t gpio_num);
 
 /**
- * @brief 蜂鸣器响
- * 
- * @param gpio_num GPIO引脚
+ * @brief 蜂鸣器响 (非阻塞，提示优先级)
+ *
+ * @param gpio_num GPIO引脚 (须与 buzzer_init 一致)
  * @param duration_ms 持续时间（毫秒）
  * @return esp_err_t ESP_OK 成功，其他值失败
  */
 esp_err_t buzzer_beep(uint8_t gpio_num, uint32_t duration_ms);
 
 /**
- * @brief 蜂鸣器报警（连续响）
- * 
- * @param gpio_num GPIO引脚
+ * @brief 蜂鸣器报警（连续响 times 次，非阻塞，报警优先级）
+ *
+ * @param gpio_num GPIO引脚 (须与 buzzer_init 一致)
  * @param times 响的次数
  * @return esp_err_t ESP_OK 成功，其他值失败
  */
 esp_err_t buzzer_alarm(uint8_t gpio_num, uint8_t times);
 
+/**
+ * @brief 播放节奏
+ *
+ * @param pattern 节奏 (内容被复制，音符表须保持有效)
+ * @param prio 优先级
+ * @return esp_err_t ESP_ERR_NO_MEM 队列已满被丢弃，ESP_ERR_INVALID_STATE 未初始化
+ */
+esp_err_t buzzer_play(const buzzer_pattern_t *pattern, buzzer_prio_t prio);
+
+/**
+ * @brief 播放单个音 (非阻塞)
+ *
+ * @param freq_hz 音调 (0 = 直流驱动)
+ * @param duration_ms 时长
+ * @param prio 优先级
+ */
+esp_err_t buzzer_play_tone(uint16_t freq_hz, uint32_t duration_ms, buzzer_prio_t prio);
+
+/**
+ * @brief 停止不高于 prio 的正在播放与排队中的节奏
+ */
+void buzzer_stop(buzzer_prio_t prio);
+
+/**
+ * @brief 是否正在播放
+ */
+bool buzzer_is_playing(void);
+
+/**
+ * @brief 获取序列器统计
+ */
+void buzzer_get_stats(buzzer_stats_t *stats);
+
 #endif // BUZZER_H
@@ -2,6 +2,7 @@
 
 #include "config.h"
 #include "esp_assert.h"
+#include "esp_timer.h"
 #include <string.h>
 #include "esp_log.h"
 
@@ -9,12 +10,102 @@ static const char *TAG = "APP_STATE";
 static sensor_data_t g_sensor_data;
 static SemaphoreHandle_t g_sensor_mutex = NULL;
 
+// 只读快照双缓冲：s_pub_seq[i] 为奇数表示缓冲区 i 正在写入
+static sensor_data_t s_pub[2];
+static uint32_t s_pub_version[2];
+static volatile uint32_t s_pub_seq[2];
+static volatile uint32_t s_pub_active = 0;
+
+// 版本号与各字段最近一次变化时的版本 (字段数由变化位推导，新增字段无需手动同步)
+#define APP_FIELD_COUNT __builtin_popcount(APP_FIELD_ALL)
+_Static_assert(APP_FIELD_ALL == (1u << APP_FIELD_COUNT) - 1,
+               "APP_FIELD_ALL must be contiguous from bit 0");
+_Static_assert((APP_FIELD_CURTAIN_POSITION << 1) == (APP_FIELD_ALL + 1),
+               "highest APP_FIELD_* bit must be the top bit of APP_FIELD_ALL");
+#define FIELD_BIT(name, fmt, bit) | APP_FIELD_##bit
+_Static_assert((0 SENSOR_DATA_FIELDS(FIELD_BIT)) == APP_FIELD_ALL,
+               "SENSOR_DATA_FIELDS and APP_FIELD_ALL disagree");
+#undef FIELD_BIT
+static volatile uint32_t s_version = 0;
+static volatile uint32_t s_field_version[APP_FIELD_COUNT];
+
+// 订阅者 (pending 累积两次 wait 之间的变化)
+typedef struct {
+    bool used;
+    uint32_t mask;
+    uint32_t pending;
+    SemaphoreHandle_t sem;
+} subscriber_t;
+
+static subscriber_t s_subs[APP_STATE_MAX_SUBSCRIBERS];
+static portMUX_TYPE s_sub_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static app_state_stats_t s_stats;
+
+#define STAT_INC(field) __atomic_fetch_add(&s_stats.field, 1, __ATOMIC_RELAXED)
+
+// 逐字段比较，返回变化位 (字段表见 app_types.h)
+static uint32_t diff_fields(const sensor_data_t *a, const sensor_data_t *b)
+{
+    uint32_t diff = 0;
+#define DIFF_FIELD(name, fmt, bit) \
+    if (a->name != b->name) diff |= APP_FIELD_##bit;
+    SENSOR_DATA_FIELDS(DIFF_FIELD)
+#undef DIFF_FIELD
+    return diff;
+}
+
+static void notify_subscribers(uint32_t diff)
+{
+    for (int i = 0; i < APP_STATE_MAX_SUBSCRIBERS; i++) {
+        bool wake = false;
+        portENTER_CRITICAL(&s_sub_lock);
+        if (s_subs[i].used && (s_subs[i].mask & diff)) {
+            s_subs[i].pending |= s_subs[i].mask & diff;
+            wake = true;
+        }
+        portEXIT_CRITICAL(&s_sub_lock);
+
+        if (wake) {
+            xSemaphoreGive(s_subs[i].sem);
+            s_stats.notifications++;
+        }
+    }
+}
+
+// 发布当前数据 (调用方持有互斥锁，写者串行)
+static void publish_locked(uint32_t diff)
+{
+    uint32_t next = s_pub_active ^ 1;
+    uint32_t version = s_version + 1;
+
+    s_pub_seq[next]++;
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    s_pub[next] = g_sensor_data;
+    s_pub_version[next] = version;
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    s_pub_seq[next]++;
+
+    for (int i = 0; i < APP_FIELD_COUNT; i++) {
+        if (diff & (1u << i)) {
+            s_field_version[i] = version;
+        }
+    }
+    __atomic_store_n(&s_version, version, __ATOMIC_RELEASE);
+    __atomic_store_n(&s_pub_active, next, __ATOMIC_RELEASE);
+    s_stats.publishes++;
+
+    notify_subscribers(diff);
+}
+
 void app_state_init(void)
 {
     memset(&g_sensor_data, 0, sizeof(g_sensor_data));
     g_sensor_data.smoke_threshold = SMOKE_THRESHOLD;
+    memset(&s_stats, 0, sizeof(s_stats));
     g_sensor_mutex = xSemaphoreCreateMutex();
     assert(g_sensor_mutex != NULL);
+    publish_locked(APP_FIELD_ALL);
 }
 
 void app_state_deinit(void)
@@ -37,16 +128,149 @@ esp_err_t app_state_lock(void)
         return ESP_ERR_INVALID_STATE;
     }
 
-    if (xSemaphoreTake(g_sensor_mutex, pdMS_TO_TICKS(APP_STATE_LOCK_TIMEOUT_MS)) != pdTRUE) {
-        ESP_LOGW(TAG, "Lock timeout");
-        return ESP_ERR_TIMEOUT;
+    // 先尝试不等待加锁，用于统计竞争
+    if (xSemaphoreTake(g_sensor_mutex, 0) != pdTRUE) {
+        STAT_INC(lock_contended);
+        int64_t start_us = esp_timer_get_time();
+        if (xSemaphoreTake(g_sensor_mutex, pdMS_TO_TICKS(APP_STATE_LOCK_TIMEOUT_MS)) != pdTRUE) {
+            STAT_INC(lock_timeouts);
+            ESP_LOGW(TAG, "Lock timeout");
+            return ESP_ERR_TIMEOUT;
+        }
+        uint32_t waited_us = (uint32_t)(esp_timer_get_time() - start_us);
+        if (waited_us > s_stats.lock_wait_max_us) {
+            s_stats.lock_wait_max_us = waited_us;
+        }
     }
+    s_stats.lock_acquired++;
     return ESP_OK;
 }
 
 void app_state_unlock(void)
 {
     if (g_sensor_mutex != NULL) {
+        // 仅在有字段变化时发布，版本号与订阅通知随之更新
+        uint32_t diff = diff_fields(&g_sensor_data, &s_pub[s_pub_active]);
+        if (diff != 0) {
+            publish_locked(diff);
+        } else {
+            s_stats.unchanged_unlocks++;
+        }
         xSemaphoreGive(g_sensor_mutex);
     }
 }
+
+uint32_t app_state_read_snapshot(sensor_data_t *out)
+{
+    if (out == NULL) {
+        return 0;
+    }
+
+    STAT_INC(snapshot_reads);
+    while (1) {
+        uint32_t idx = __atomic_load_n(&s_pub_active, __ATOMIC_ACQUIRE);
+        uint32_t seq = s_pub_seq[idx];
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+        // 活动缓冲区只有在写者连续发布两次时才会被改写
+        if ((seq & 1) == 0) {
+            *out = s_pub[idx];
+            uint32_t version = s_pub_version[idx];
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (s_pub_seq[idx] == seq) {
+                return version;
+            }
+        }
+        STAT_INC(snapshot_retries);
+    }
+}
+
+uint32_t app_state_version(void)
+{
+    return __atomic_load_n(&s_version, __ATOMIC_ACQUIRE);
+}
+
+uint32_t app_state_changed_since(uint32_t version)
+{
+    uint32_t mask = 0;
+    for (int i = 0; i < APP_FIELD_COUNT; i++) {
+        if ((int32_t)(s_field_version[i] - version) > 0) {
+            mask |= 1u << i;
+        }
+    }
+    return mask;
+}
+
+esp_err_t app_state_subscribe(uint32_t mask, app_state_sub_t *sub)
+{
+    if (sub == NULL || mask == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    SemaphoreHandle_t sem = xSemaphoreCreateBinary();
+    if (sem == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    portENTER_CRITICAL(&s_sub_lock);
+    for (int i = 0; i < APP_STATE_MAX_SUBSCRIBERS; i++) {
+        if (!s_subs[i].used) {
+            s_subs[i].used = true;
+            s_subs[i].mask = mask;
+            s_subs[i].pending = 0;
+            s_subs[i].sem = sem;
+            portEXIT_CRITICAL(&s_sub_lock);
+            *sub = i;
+            return ESP_OK;
+        }
+    }
+    portEXIT_CRITICAL(&s_sub_lock);
+
+    vSemaphoreDelete(sem);
+    ESP_LOGE(TAG, "Too many subscribers");
+    return ESP_ERR_NO_MEM;
+}
+
+uint32_t app_state_wait(app_state_sub_t sub, TickType_t timeout)
+{
+    if (sub < 0 || sub >= APP_STATE_MAX_SUBSCRIBERS || !s_subs[sub].used) {
+        return 0;
+    }
+
+    xSemaphoreTake(s_subs[sub].sem, timeout);
+
+    portENTER_CRITICAL(&s_sub_lock);
+    uint32_t changed = s_subs[sub].pending;
+    s_subs[sub].pending = 0;
+    portEXIT_CRITICAL(&s_sub_lock);
+    return changed;
+}
+
+void app_state_unsubscribe(app_state_sub_t sub)
+{
+    if (sub < 0 || sub >= APP_STATE_MAX_SUBSCRIBERS) {
+        return;
+    }
+
+    SemaphoreHandle_t sem = NULL;
+    portENTER_CRITICAL(&s_sub_lock);
+    if (s_subs[sub].used) {
+        sem = s_subs[sub].sem;
+        s_subs[sub].used = false;
+        s_subs[sub].sem = NULL;
+    }
+    portEXIT_CRITICAL(&s_sub_lock);
+
+    if (sem != NULL) {
+        vSemaphoreDelete(sem);
+    }
+}
+
+void app_state_get_stats(app_state_stats_t *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    // 各字段独立读取，仅用于观测
+    memcpy(stats, &s_stats, sizeof(*stats));
+}
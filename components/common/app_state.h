@@ -9,14 +9,105 @@
 // 锁超时时间 (毫秒)
 #define APP_STATE_LOCK_TIMEOUT_MS 100
 
+// 最大订阅者数
+#define APP_STATE_MAX_SUBSCRIBERS 4
+
+// 字段变化位 (解锁发布时与上一快照逐字段比较)
+#define APP_FIELD_TEMPERATURE     (1 << 0)
+#define APP_FIELD_HUMIDITY        (1 << 1)
+#define APP_FIELD_LIGHT           (1 << 2)
+#define APP_FIELD_SMOKE           (1 << 3)
+#define APP_FIELD_SMOKE_THRESHOLD (1 << 4)
+#define APP_FIELD_LED             (1 << 5)    // led_state / led_brightness
+#define APP_FIELD_FAN             (1 << 6)    // fan_state / fan_speed
+#define APP_FIELD_CURTAIN         (1 << 7)
+#define APP_FIELD_CONTROL_MODE    (1 << 8)
+#define APP_FIELD_CURTAIN_POSITION (1 << 9)   // 驱动上报的实际开度 (新增位须同时更新 APP_FIELD_ALL，app_state.c 编译期检查)
+#define APP_FIELD_ALL             0x3FF
+
+/**
+ * @brief 订阅句柄
+ */
+typedef int app_state_sub_t;
+
+/**
+ * @brief 共享状态访问统计
+ */
+typedef struct {
+    uint32_t lock_acquired;     // 成功加锁次数
+    uint32_t lock_contended;    // 加锁时需要等待的次数
+    uint32_t lock_timeouts;     // 加锁超时次数
+    uint32_t lock_wait_max_us;  // 最长等待时间
+    uint32_t publishes;         // 快照发布次数
+    uint32_t snapshot_reads;    // 无锁快照读取次数
+    uint32_t snapshot_retries;  // 快照读取重试次数 (读取期间写者连续发布两次)
+    uint32_t unchanged_unlocks; // 解锁时无字段变化 (跳过发布)
+    uint32_t notifications;     // 向订阅者投递的通知次数
+} app_state_stats_t;
+
 void app_state_init(void);
 void app_state_deinit(void);
 sensor_data_t *app_state_get(void);
 
 // 带超时的锁操作，返回 ESP_OK 或 ESP_ERR_TIMEOUT
+// 写者仍需加锁；解锁时把当前数据发布为只读快照
 esp_err_t app_state_lock(void);
 void app_state_unlock(void);
 
+/**
+ * @brief 无锁读取最近一次发布的快照
+ *
+ * 双缓冲 + 序号校验：写者总是写入非活动缓冲区再切换，读者不会等待进行中的写入，
+ * 仅在复制期间写者连续发布两次时重试。可在任意任务中调用，不能在中断中调用。
+ *
+ * @param out 输出快照
+ * @return uint32_t 快照对应的状态版本号
+ */
+uint32_t app_state_read_snapshot(sensor_data_t *out);
+
+/**
+ * @brief 当前状态版本号 (每次有字段变化的发布加 1，单调递增)
+ */
+uint32_t app_state_version(void);
+
+/**
+ * @brief 查询自某版本以来发生过变化的字段
+ *
+ * @param version 调用方上次看到的版本号
+ * @return uint32_t APP_FIELD_* 位掩码
+ */
+uint32_t app_state_changed_since(uint32_t version);
+
+/**
+ * @brief 订阅字段变化
+ *
+ * @param mask 关心的 APP_FIELD_* 位
+ * @param sub 输出订阅句柄
+ * @return esp_err_t ESP_ERR_NO_MEM 订阅者已满
+ */
+esp_err_t app_state_subscribe(uint32_t mask, app_state_sub_t *sub);
+
+/**
+ * @brief 等待订阅的字段发生变化
+ *
+ * 两次调用之间的多次变化合并为一次返回。
+ *
+ * @param sub 订阅句柄
+ * @param timeout 最长等待时间
+ * @return uint32_t 变化的字段位 (已按订阅掩码过滤)，超时返回 0
+ */
+uint32_t app_state_wait(app_state_sub_t sub, TickType_t timeout);
+
+/**
+ * @brief 取消订阅
+ */
+void app_state_unsubscribe(app_state_sub_t sub);
+
+/**
+ * @brief 获取访问统计
+ */
+void app_state_get_stats(app_state_stats_t *stats);
+
 // 便捷宏：带超时保护的临界区
 #define APP_STATE_CRITICAL_SECTION(code) \
     do { \
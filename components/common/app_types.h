@@ -11,6 +11,50 @@ typedef enum {
     CONTROL_MODE_MANUAL       // 手动模式 - 仅响应用户指令，不自动控制
 } control_mode_t;
 
+/**
+ * @brief RGB LED 预定义颜色
+ */
+typedef enum {
+    RGB_COLOR_OFF = 0,
+    RGB_COLOR_RED,
+    RGB_COLOR_GREEN,
+    RGB_COLOR_BLUE,
+    RGB_COLOR_YELLOW,
+    RGB_COLOR_CYAN,
+    RGB_COLOR_MAGENTA,
+    RGB_COLOR_WHITE,
+    RGB_COLOR_ORANGE,
+    RGB_COLOR_PURPLE,
+} rgb_color_t;
+
+/**
+ * @brief 语音命令枚举 (由 sr 组件产生，控制逻辑消费)
+ */
+typedef enum {
+    VR_CMD_WAKE_UP = 0,     // 唤醒
+    VR_CMD_LIGHT_ON,        // 打开灯光
+    VR_CMD_LIGHT_OFF,       // 关闭灯光
+    VR_CMD_FAN_ON,          // 打开风扇
+    VR_CMD_FAN_OFF,         // 关闭风扇
+    VR_CMD_CURTAIN_OPEN,    // 打开窗帘
+    VR_CMD_CURTAIN_CLOSE,   // 关闭窗帘
+    VR_CMD_RGB_RED,         // RGB 红色
+    VR_CMD_RGB_GREEN,       // RGB 绿色
+    VR_CMD_RGB_BLUE,        // RGB 蓝色
+    VR_CMD_MODE_AUTO,       // 自动模式
+    VR_CMD_MODE_MANUAL,     // 手动模式
+    VR_CMD_TIMEOUT,         // 语音超时 (退出唤醒)
+    VR_CMD_UNKNOWN          // 未知命令
+} vr_command_t;
+
+/**
+ * @brief VAD 状态枚举
+ */
+typedef enum {
+    VR_VAD_SILENCE = 0,     // 静音
+    VR_VAD_SPEECH           // 检测到语音
+} vr_vad_state_t;
+
 /**
  * @brief 系统全局传感器与状态数据结构
  */
@@ -27,10 +71,34 @@ typedef struct {
     uint8_t led_brightness;
     uint8_t fan_state;
     uint8_t fan_speed;
-    uint8_t curtain_state;
+    uint8_t curtain_state;      // 窗帘目标开度 (0 关闭, 100 全开)
+    uint8_t curtain_position;   // 窗帘当前开度 (舵机运动中的插值位置)
 
     // 控制模式
     control_mode_t control_mode;  // 0=自动, 1=手动
 } sensor_data_t;
 
+/**
+ * @brief sensor_data_t 对外字段表 (唯一定义处)
+ *
+ * 变化检测 (app_state) 与 JSON 输出 (state_json) 都由此展开，新增字段只需改结构体与此表。
+ * X(成员, 格式, 变化位)：
+ * - 格式：F1 一位小数浮点，U 无符号整数，I 有符号整数
+ * - 变化位：APP_FIELD_ 之后的部分 (见 app_state.h)，同一变化位可对应多个成员
+ * 表中顺序即 JSON 中的字段顺序。
+ */
+#define SENSOR_DATA_FIELDS(X)                       \
+    X(temperature,      F1, TEMPERATURE)            \
+    X(humidity,         F1, HUMIDITY)               \
+    X(light,            F1, LIGHT)                  \
+    X(smoke,            U,  SMOKE)                  \
+    X(smoke_threshold,  U,  SMOKE_THRESHOLD)        \
+    X(led_state,        U,  LED)                    \
+    X(led_brightness,   U,  LED)                    \
+    X(fan_state,        U,  FAN)                    \
+    X(fan_speed,        U,  FAN)                    \
+    X(curtain_state,    U,  CURTAIN)                \
+    X(curtain_position, U,  CURTAIN_POSITION)       \
+    X(control_mode,     I,  CONTROL_MODE)
+
 #endif // APP_TYPES_H
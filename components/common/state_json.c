@@ -0,0 +1,89 @@
+#include "state_json.h"
+
+#include "app_state.h"
+#include <math.h>
+#include <stdbool.h>
+#include <string.h>
+
+typedef struct {
+    char *p;
+    char *end;          // 预留 '\0' 之后的可写末尾
+    bool overflow;
+} writer_t;
+
+static void put(writer_t *w, const char *s, size_t n)
+{
+    if (w->overflow || (size_t)(w->end - w->p) < n) {
+        w->overflow = true;
+        return;
+    }
+    memcpy(w->p, s, n);
+    w->p += n;
+}
+
+static void put_U(writer_t *w, uint32_t v)
+{
+    char tmp[STATE_JSON_U_MAX];
+    char *q = tmp + sizeof(tmp);
+    do {
+        *--q = (char)('0' + v % 10);
+        v /= 10;
+    } while (v != 0);
+    put(w, q, tmp + sizeof(tmp) - q);
+}
+
+static void put_I(writer_t *w, int32_t v)
+{
+    if (v < 0) {
+        put(w, "-", 1);
+        put_U(w, 0u - (uint32_t)v);
+    } else {
+        put_U(w, (uint32_t)v);
+    }
+}
+
+static void put_F1(writer_t *w, float v)
+{
+    if (!isfinite(v) || fabsf(v) >= 1e8f) {
+        put(w, "null", 4);
+        return;
+    }
+    int32_t tenths = (int32_t)lroundf(v * 10.0f);
+    if (tenths < 0) {
+        put(w, "-", 1);
+        tenths = -tenths;
+    }
+    char frac[2] = {'.', (char)('0' + tenths % 10)};
+    put_U(w, (uint32_t)tenths / 10);
+    put(w, frac, sizeof(frac));
+}
+
+size_t state_json_write(char *buf, size_t size, const sensor_data_t *s, uint32_t fields)
+{
+    if (buf == NULL || size < 3 || s == NULL) {
+        return 0;
+    }
+
+    writer_t w = {.p = buf, .end = buf + size - 1, .overflow = false};
+    put(&w, "{", 1);
+    char *first = w.p;
+
+    // 每个字段带前导逗号写入，首个字段跳过逗号
+#define WRITE_FIELD(name, fmt, bit)                                     \
+    if (fields & APP_FIELD_##bit) {                                     \
+        static const char key[] = ",\"" #name "\":";                    \
+        size_t skip = (w.p == first) ? 1 : 0;                           \
+        put(&w, key + skip, sizeof(key) - 1 - skip);                    \
+        put_##fmt(&w, s->name);                                         \
+    }
+    SENSOR_DATA_FIELDS(WRITE_FIELD)
+#undef WRITE_FIELD
+
+    put(&w, "}", 1);
+    if (w.overflow) {
+        buf[0] = '\0';
+        return 0;
+    }
+    *w.p = '\0';
+    return w.p - buf;
+}
@@ -0,0 +1,41 @@
+/**
+ * @file state_json.h
+ * @brief 状态快照 JSON 输出 (无动态分配)
+ *
+ * 字段由 app_types.h 的 SENSOR_DATA_FIELDS 展开，/api/data 与 /ws 推送共用。
+ * 数值直接逐位写入调用方缓冲区，不经过 printf 与堆分配；浮点保留一位小数，
+ * 非有限值 (或绝对值超过 1e8) 输出 null。
+ */
+
+#ifndef STATE_JSON_H
+#define STATE_JSON_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "app_types.h"
+
+// 各格式数值的最大字符数
+#define STATE_JSON_F1_MAX   11      // "-99999999.9"
+#define STATE_JSON_U_MAX    10      // "4294967295"
+#define STATE_JSON_I_MAX    11      // "-2147483648"
+
+#define STATE_JSON_FIELD_MAX(name, fmt, bit) \
+    + (sizeof(",\"" #name "\":") - 1 + STATE_JSON_##fmt##_MAX)
+
+/**
+ * @brief 全部字段输出的最大长度 (含花括号与结尾 '\0')，缓冲区按此分配即不会截断
+ */
+#define STATE_JSON_MAX_LEN  (2 SENSOR_DATA_FIELDS(STATE_JSON_FIELD_MAX) + 1)
+
+/**
+ * @brief 把快照中选中的字段写成 JSON 对象 {"temperature":25.6,...}
+ *
+ * @param buf 输出缓冲区 (结果以 '\0' 结尾)
+ * @param size 缓冲区大小
+ * @param s 状态快照
+ * @param fields 要输出的 APP_FIELD_* 位 (APP_FIELD_ALL 为完整快照)
+ * @return size_t 写入长度 (不含 '\0')，缓冲区不足返回 0
+ */
+size_t state_json_write(char *buf, size_t size, const sensor_data_t *s, uint32_t fields);
+
+#endif // STATE_JSON_H
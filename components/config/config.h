@@ -11,17 +11,20 @@
 #define WIFI_PASS "88888888"
 #endif
 #define WIFI_MAXIMUM_RETRY 5
+#define SNTP_SERVER "pool.ntp.org"  // 校时服务器 (归档时间戳)
 
 // ==================== GPIO 引脚配置 (ESP32-S3) ====================
 
 // 1. DHT11 温湿度传感器
 #define DHT11_GPIO 4
+// 1=RMT 接收解码 (无忙等)，0=esp-idf-lib 位翻转读取
+#define DHT11_USE_RMT 1
 
 // 2. LED 灯光控制 (PWM - 高电平有效)
 #define LED_GPIO 5
 #define LED_PWM_CHANNEL 0
 #define LED_PWM_FREQ 5000
-#define LED_PWM_RESOLUTION 8
+#define LED_PWM_RESOLUTION 13   // 5kHz 下的上限，亮度经 gamma 校正表映射
 
 // 3. 蜂鸣器 (低电平触发 Active Low)
 #define BUZZER_GPIO 6
@@ -29,6 +32,11 @@
 // 4. MQ-2 烟雾传感器 (ADC)
 // ESP32-S3: GPIO 7 对应 ADC_CHANNEL_6
 #define MQ2_ADC_CHANNEL ADC_CHANNEL_6  // GPIO 7
+// 采集模式: 1=DMA 连续采集 + 抽取滤波, 0=单次采样
+#define MQ2_ADC_CONTINUOUS 1
+// 连续采集采样率与抽取窗口：20kHz x 2000 点 = 100ms，恰为 50Hz 工频整周期
+#define MQ2_ADC_SAMPLE_RATE_HZ 20000
+#define MQ2_ADC_WINDOW_SAMPLES 2000
 
 // 5. 窗帘舵机控制 (PWM)
 #define SERVO_GPIO 8
@@ -50,7 +58,7 @@
 #define FAN_GPIO 18
 #define FAN_PWM_CHANNEL 1
 #define FAN_PWM_FREQ 25000
-#define FAN_PWM_RESOLUTION 8
+#define FAN_PWM_RESOLUTION 11   // 25kHz 下的上限 (80MHz / 25kHz = 3200 级)
 
 // 9. INMP441 麦克风 (I2S - 语音识别)
 #define INMP441_I2S_SCK  40  // I2S 时钟引脚
@@ -89,9 +97,9 @@
 
 // 烟雾阈值 (ADC原始值 0-4095)
 #define SMOKE_THRESHOLD 3500
+#define SMOKE_ALARM_HYSTERESIS 100   // 中断报警通路解除滞回 (ADC 值)
 
-// 蜂鸣器配置
-#define BUZZER_BEEP_DURATION_MS 200  // 蜂鸣器报警时长(毫秒)
+// 蜂鸣器配置：报警节奏 (SOS) 与提示音由 buzzer 组件的序列器播放，见 buzzer.h
 
 // 风扇速度档位
 #define FAN_SPEED_OFF 0
@@ -99,17 +107,86 @@
 #define FAN_SPEED_MEDIUM 200
 #define FAN_SPEED_HIGH 255
 
+// 风扇 PI 闭环调速 (自动模式下以连续转速替代三档风扇规则，可经 /api/fan/pid 在线调整)
+#define FAN_PI_ENABLE 0              // 1=PI 连续调速, 0=规则引擎分档
+#define FAN_PI_SETPOINT 28.0f        // 目标温度（℃）
+#define FAN_PI_KP 80.0f              // 比例增益 (占空/℃)
+#define FAN_PI_KI 0.3f               // 积分增益 (占空/(℃·s))
+#define FAN_PI_MIN_DUTY 80           // 最低起转占空 (低于此值风扇无法起转)
+
 // LED 亮度档位
 #define LED_BRIGHTNESS_OFF 0
 #define LED_BRIGHTNESS_MAX 255
 
+// LED / 风扇渐变时间（毫秒，0=立即生效），由 LEDC 硬件渐变完成，期间不占用 CPU
+// 经执行器服务下发的命令默认使用此时间，烟雾报警通路始终立即生效
+#define LED_FADE_MS 500
+#define FAN_FADE_MS 1000
+
 // ==================== 系统配置 ====================
-// 传感器读取间隔（毫秒）
+// 传感器读取间隔（毫秒）- 控制任务兜底周期的基准
 #define SENSOR_READ_INTERVAL 2000
 
+// 多速率采样配置（毫秒）：周期 / 截止时间
+// MQ2 关乎安全，高频采样；DHT11 物理上限约 1Hz
+#define MQ2_SAMPLE_PERIOD_MS      100
+#define MQ2_SAMPLE_DEADLINE_MS    50
+#define BH1750_SAMPLE_PERIOD_MS   250
+#define BH1750_SAMPLE_DEADLINE_MS 220   // 高分辨率单次转换最长 180ms
+#define BH1750_SAMPLE_POLL_MS     20
+#define BH1750_FAST_PERIOD_MS     60    // 光照快速变化时 (低分辨率 24ms)
+#define DHT11_SAMPLE_PERIOD_MS    2000
+#define DHT11_SAMPLE_DEADLINE_MS  1000
+#define DHT11_SAMPLE_POLL_MS      30    // RMT 后端：起始信号 20ms + 帧约 5ms
+#define CURTAIN_POSITION_PERIOD_MS 200  // 窗帘实际开度回读 (仅变化时发布)
+
+// 信号调理 (定点整数 = 物理量 × SCALE)
+// 中值窗口 / EMA 移位 (alpha=1/2^n) / 每次采样最大变化 / 离群阈值，0 表示关闭该级
+// MQ2/光照只做短中值，避免延迟烟雾报警和日光联动
+#define FILTER_TEMP_SCALE        10     // 0.1℃
+#define FILTER_TEMP_MEDIAN       3
+#define FILTER_TEMP_EMA_SHIFT    1
+#define FILTER_TEMP_SLEW         20     // 2.0℃
+#define FILTER_TEMP_OUTLIER      50     // 5.0℃
+#define FILTER_HUMI_SCALE        10     // 0.1%
+#define FILTER_HUMI_MEDIAN       3
+#define FILTER_HUMI_EMA_SHIFT    1
+#define FILTER_HUMI_SLEW         100    // 10%
+#define FILTER_HUMI_OUTLIER      150    // 15%
+#define FILTER_LIGHT_SCALE       1
+#define FILTER_LIGHT_MEDIAN      3
+#define FILTER_SMOKE_MEDIAN      3
+#define FILTER_OUTLIER_MAX_RUN   3      // 连续剔除超过此次数即视为真实阶跃
+
+// Flash 归档间隔（毫秒）：低优先级快照写入 sensorlog 分区
+#define SENSOR_LOG_INTERVAL_MS    10000
+
+// 控制回路轨迹 (PSRAM 环形缓冲，每条 10 字节)
+#define TRACE_CAPACITY            16384
+#define TRACE_KEYFRAME_INTERVAL_MS 60000  // 状态关键帧间隔，覆盖后回放从关键帧开始
+
 // HTTP 服务器端口
 #define HTTP_SERVER_PORT 80
 
+// HTTP 会话 (须不大于 CONFIG_LWIP_MAX_SOCKETS - 3，httpd 自身占用 3 个套接字)
+#define HTTP_MAX_OPEN_SOCKETS  10
+// 长连接 (/ws 客户端 + 挂起的长轮询) 共享预算，至少给页面与控制请求留 2 个会话
+#define HTTP_LONG_LIVED_MAX    6
+
+// WebSocket 状态推送 (/ws)
+#define WS_MAX_CLIENTS         4        // 同时推送的客户端数 (每个常驻占用一个 HTTP 会话，另受 HTTP_LONG_LIVED_MAX 限制)
+#define WS_MSG_MAX             384      // 单条消息上限 (完整快照最长 335 字节，编译期检查)
+#define WS_STALL_MS            5000     // 消息在途超过该时间视为客户端停滞并断开
+#define WS_PING_INTERVAL_MS    20000    // 空闲保活间隔
+
+// /api/data 长轮询 (?wait_version=N&timeout=ms)
+#define DATA_POLL_MAX_WAITERS      4        // 同时挂起的请求数 (每个占用一个 HTTP 会话，另受 HTTP_LONG_LIVED_MAX 限制)
+#define DATA_POLL_TIMEOUT_MS       20000    // 默认挂起时间，超时回 304
+#define DATA_POLL_MAX_TIMEOUT_MS   60000
+
+// 页面资源 (构建期 gzip，分块从 Flash 发送)
+#define WEB_ASSET_CHUNK_SIZE   4096     // 每次 httpd_resp_send_chunk 的字节数
+
 // 自动化功能开关 (1=开启, 0=关闭)
 #define AUTO_LIGHT_ENABLE 1      // 自动灯光
 #define AUTO_FAN_ENABLE 1        // 自动风扇
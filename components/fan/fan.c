@@ -2,10 +2,33 @@
 #include "driver/ledc.h"
 #include "esp_log.h"
 #include "driver/gpio.h"
+#include "esp_attr.h"
 
 static const char *TAG = "FAN_CTRL";
 static uint8_t g_fan_channel;
 
+// 80MHz / 25kHz = 3200 个时钟，11 位分辨率 (2048 级) 为该频率下的上限
+#define FAN_PWM_RESOLUTION LEDC_TIMER_11_BIT
+#define FAN_DUTY_MAX ((1 << 11) - 1)
+
+static bool s_fade_ready = false;
+static volatile bool s_fading = false;
+
+// 渐变结束中断：只清除状态，不唤醒任务
+static bool IRAM_ATTR fan_fade_end_cb(const ledc_cb_param_t *param, void *user_arg)
+{
+    if (param->event == LEDC_FADE_END_EVT) {
+        s_fading = false;
+    }
+    return false;
+}
+
+// 转速 (0-255) → 占空：保持原有反相逻辑，按 11 位满量程线性放大
+static uint32_t speed_to_duty(uint8_t speed)
+{
+    return FAN_DUTY_MAX - ((uint32_t)speed * FAN_DUTY_MAX + 127) / 255;
+}
+
 esp_err_t fan_init(uint8_t fan_gpio, uint8_t fan_channel)
 {
     g_fan_channel = fan_channel;
@@ -18,7 +41,7 @@ esp_err_t fan_init(uint8_t fan_gpio, uint8_t fan_channel)
     ledc_timer_config_t ledc_timer = {
         .speed_mode       = LEDC_LOW_SPEED_MODE,
         .timer_num        = LEDC_TIMER_2,
-        .duty_resolution  = LEDC_TIMER_8_BIT,
+        .duty_resolution  = FAN_PWM_RESOLUTION,
         .freq_hz          = 25000,  // 25kHz 通常适合4线PWM风扇
         .clk_cfg          = LEDC_AUTO_CLK
     };
@@ -34,7 +57,7 @@ esp_err_t fan_init(uint8_t fan_gpio, uint8_t fan_channel)
         .timer_sel      = LEDC_TIMER_2,
         .intr_type      = LEDC_INTR_DISABLE,
         .gpio_num       = fan_gpio,
-        .duty           = 255, // 初始关闭 (低电平触发: 0=全速, 255=停？待确认)
+        .duty           = FAN_DUTY_MAX, // 初始关闭 (低电平触发: 0=全速, 255=停？待确认)
                                // Config里说0=全速，255=停？
                                // 我们先按之前的逻辑：set_speed(0) -> duty=255(High) -> Fan Off
         .hpoint         = 0
@@ -44,11 +67,26 @@ esp_err_t fan_init(uint8_t fan_gpio, uint8_t fan_channel)
         return ESP_FAIL;
     }
 
+    // 硬件渐变 (与 LED 共用渐变服务，已安装时返回 ESP_ERR_INVALID_STATE)
+    esp_err_t ret = ledc_fade_func_install(0);
+    if (ret == ESP_OK || ret == ESP_ERR_INVALID_STATE) {
+        ledc_cbs_t cbs = { .fade_cb = fan_fade_end_cb };
+        s_fade_ready = (ledc_cb_register(LEDC_LOW_SPEED_MODE, fan_channel, &cbs, NULL) == ESP_OK);
+    }
+    if (!s_fade_ready) {
+        ESP_LOGW(TAG, "LEDC fade unavailable, speed changes will be immediate");
+    }
+
     ESP_LOGI(TAG, "Fan (PWM Ch%d) initialized", fan_channel);
     return ESP_OK;
 }
 
 esp_err_t fan_set_speed(uint8_t speed)
+{
+    return fan_fade_to(speed, 0);
+}
+
+esp_err_t fan_fade_to(uint8_t speed, uint32_t fade_ms)
 {
     // 假设风扇是低电平触发/控制 (PWM值越小转越快？或者根据MOS管电路)
     // 通常 PWM 风扇：High Duty = High Speed
@@ -59,12 +97,30 @@ esp_err_t fan_set_speed(uint8_t speed)
     // 那说明这是 PNP 控制或者 低电平有效的 PWM 输入？
     // 我们保持原有的反转逻辑，假设这适配您的硬件。
     
-    uint32_t duty = 255 - speed;
+    uint32_t duty = speed_to_duty(speed);
 
-    esp_err_t ret = ledc_set_duty(LEDC_LOW_SPEED_MODE, g_fan_channel, duty);
-    if (ret != ESP_OK) return ret;
-    
-    ret = ledc_update_duty(LEDC_LOW_SPEED_MODE, g_fan_channel);
+    if (!s_fade_ready) {
+        esp_err_t ret = ledc_set_duty(LEDC_LOW_SPEED_MODE, g_fan_channel, duty);
+        if (ret != ESP_OK) return ret;
+        return ledc_update_duty(LEDC_LOW_SPEED_MODE, g_fan_channel);
+    }
+
+    // 中止进行中的渐变，否则新的写入会阻塞到渐变结束
+    if (s_fading) {
+        ledc_fade_stop(LEDC_LOW_SPEED_MODE, g_fan_channel);
+        s_fading = false;
+    }
+
+    if (fade_ms == 0) {
+        return ledc_set_duty_and_update(LEDC_LOW_SPEED_MODE, g_fan_channel, duty, 0);
+    }
+
+    s_fading = true;
+    esp_err_t ret = ledc_set_fade_time_and_start(LEDC_LOW_SPEED_MODE, g_fan_channel, duty,
+                                                 fade_ms, LEDC_FADE_NO_WAIT);
+    if (ret != ESP_OK) {
+        s_fading = false;
+    }
     
     // ESP_LOGI(TAG, "Fan speed set to %d (Duty: %lu)", speed, duty);
     return ret;
@@ -72,7 +128,12 @@ esp_err_t fan_set_speed(uint8_t speed)
 
 esp_err_t fan_deinit(void)
 {
-    esp_err_t ret = ledc_stop(LEDC_LOW_SPEED_MODE, g_fan_channel, 255);
+    if (s_fade_ready && s_fading) {
+        ledc_fade_stop(LEDC_LOW_SPEED_MODE, g_fan_channel);
+        s_fading = false;
+    }
+
+    esp_err_t ret = ledc_stop(LEDC_LOW_SPEED_MODE, g_fan_channel, 1);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Fan LEDC stop failed");
         return ret;
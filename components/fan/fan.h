@@ -14,13 +14,22 @@
 esp_err_t fan_init(uint8_t fan_gpio, uint8_t fan_channel);
 
 /**
- * @brief 设置风扇速度
+ * @brief 设置风扇速度 (立即生效，中止进行中的渐变)
  *
- * @param speed 0-255
+ * @param speed 0-255 (按 11 位占空输出)
  * @return esp_err_t
  */
 esp_err_t fan_set_speed(uint8_t speed);
 
+/**
+ * @brief 由 LEDC 硬件渐变到目标转速 (立即返回，渐变期间不占用 CPU)
+ *
+ * @param speed 0-255
+ * @param fade_ms 渐变时间（毫秒），0 表示立即生效
+ * @return esp_err_t
+ */
+esp_err_t fan_fade_to(uint8_t speed, uint32_t fade_ms);
+
 /**
  * @brief 释放风扇 PWM 资源
  *
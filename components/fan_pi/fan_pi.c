@@ -0,0 +1,98 @@
+/**
+ * @file fan_pi.c
+ * @brief 定点 PI 风扇调速实现
+ */
+
+#include "fan_pi.h"
+#include <string.h>
+
+// 参数换算为 Q16：误差单位 0.1℃，时间单位毫秒
+static void load_gains(fan_pi_t *pi)
+{
+    pi->kp_q16 = ((int64_t)pi->cfg.kp_x10 << 16) / 100;
+    pi->ki_q16 = ((int64_t)pi->cfg.ki_x1000 << 16) / 10000;
+}
+
+static int64_t clamp_integral(const fan_pi_t *pi, int64_t integral)
+{
+    int64_t max_q16 = (int64_t)pi->cfg.max_duty << 16;
+    if (integral < 0) {
+        return 0;
+    }
+    return (integral > max_q16) ? max_q16 : integral;
+}
+
+void fan_pi_init(fan_pi_t *pi, const fan_pi_cfg_t *cfg)
+{
+    memset(pi, 0, sizeof(*pi));
+    pi->cfg = *cfg;
+    load_gains(pi);
+}
+
+void fan_pi_set_cfg(fan_pi_t *pi, const fan_pi_cfg_t *cfg)
+{
+    pi->cfg = *cfg;
+    load_gains(pi);
+    pi->integral = clamp_integral(pi, pi->integral);
+}
+
+void fan_pi_reset(fan_pi_t *pi, int32_t temp, uint8_t duty)
+{
+    if (duty > pi->cfg.max_duty) {
+        duty = pi->cfg.max_duty;
+    }
+    pi->error = temp - pi->cfg.setpoint;
+    pi->integral = clamp_integral(pi, ((int64_t)duty << 16) - pi->kp_q16 * pi->error);
+    pi->output = duty;
+    pi->running = (duty > 0);
+    pi->primed = true;
+}
+
+uint8_t fan_pi_update(fan_pi_t *pi, int32_t temp, uint32_t dt_ms)
+{
+    if (!pi->primed) {
+        fan_pi_reset(pi, temp, 0);
+    }
+    if (dt_ms > FAN_PI_MAX_DT_MS) {
+        dt_ms = FAN_PI_MAX_DT_MS;
+    }
+
+    int32_t e = temp - pi->cfg.setpoint;
+    int64_t max_q16 = (int64_t)pi->cfg.max_duty << 16;
+    int64_t p = pi->kp_q16 * e;
+    int64_t integral = clamp_integral(pi, pi->integral + pi->ki_q16 * e * (int64_t)dt_ms / 1000);
+    int64_t u = p + integral;
+
+    // 抗积分饱和：输出已饱和且误差继续推向饱和方向时保持原积分
+    if ((u > max_q16 && e > 0) || (u < 0 && e < 0)) {
+        if (integral != pi->integral) {
+            pi->windup_holds++;
+        }
+        u = p + pi->integral;
+    } else {
+        pi->integral = integral;
+    }
+    pi->error = e;
+
+    int64_t rounded = (u + (1 << 15)) >> 16;
+    uint32_t duty = (rounded < 0) ? 0 :
+                    (rounded > pi->cfg.max_duty) ? pi->cfg.max_duty : (uint32_t)rounded;
+
+    // 起转门限带回差：达到 min_duty 才启动，低于 min_duty/2 才停转
+    uint32_t min_duty = pi->cfg.min_duty;
+    if (pi->running) {
+        if (duty == 0 || duty < min_duty / 2) {
+            pi->running = false;
+        }
+    } else if (duty > 0 && duty >= min_duty) {
+        pi->running = true;
+    }
+
+    if (!pi->running) {
+        duty = 0;
+    } else if (duty < min_duty) {
+        duty = min_duty;
+    }
+    pi->output = (uint8_t)duty;
+    return pi->output;
+}
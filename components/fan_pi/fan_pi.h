@@ -0,0 +1,83 @@
+/**
+ * @file fan_pi.h
+ * @brief 定点 PI 风扇调速 (带抗积分饱和与最低起转占空)
+ *
+ * 输入为滤波后的温度 (0.1℃ 定点)，输出为连续的风扇占空 (0 ~ max_duty)。
+ * 温度高于设定点时加速：e = 温度 - 设定点，u = Kp·e + ∫Ki·e dt。
+ * - 抗积分饱和：输出已饱和且误差继续推向饱和方向时停止积分，积分项限制在 [0, max_duty]
+ * - 最低起转占空：PI 输出达到 min_duty 才启动，运行中不低于 min_duty，
+ *   输出降到 min_duty 的一半以下才停转，避免在起转门限附近反复启停
+ * - 内部全部为整数运算 (Q16)，每通道独立状态，无动态分配
+ */
+
+#ifndef FAN_PI_H
+#define FAN_PI_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 单次积分的最长时间步 (毫秒)，控制周期异常拉长时避免积分突变
+#define FAN_PI_MAX_DT_MS 10000
+
+/**
+ * @brief 控制器参数
+ */
+typedef struct {
+    int32_t setpoint;           // 设定温度 (0.1℃)
+    int32_t kp_x10;             // 比例增益 (0.1 占空/℃)
+    int32_t ki_x1000;           // 积分增益 (0.001 占空/(℃·s))
+    uint8_t min_duty;           // 最低起转占空
+    uint8_t max_duty;           // 最高占空
+} fan_pi_cfg_t;
+
+/**
+ * @brief 控制器状态
+ */
+typedef struct {
+    fan_pi_cfg_t cfg;
+    int64_t kp_q16;             // 每 0.1℃ 误差的占空 (Q16)
+    int64_t ki_q16;             // 每 0.1℃·s 的占空 (Q16)
+    int64_t integral;           // 积分项 (Q16 占空)
+    int32_t error;              // 最近一次误差 (0.1℃)
+    uint8_t output;             // 最近一次输出占空
+    bool running;               // 风扇处于转动状态
+    bool primed;                // 已用 fan_pi_reset() 建立初始状态
+    uint32_t windup_holds;      // 因饱和暂停积分的次数
+} fan_pi_t;
+
+/**
+ * @brief 初始化控制器 (未建立初始状态，首次更新前应调用 fan_pi_reset)
+ */
+void fan_pi_init(fan_pi_t *pi, const fan_pi_cfg_t *cfg);
+
+/**
+ * @brief 更新参数，保留积分项与运行状态
+ */
+void fan_pi_set_cfg(fan_pi_t *pi, const fan_pi_cfg_t *cfg);
+
+/**
+ * @brief 无扰切换：以当前温度与实际占空反推积分项
+ *
+ * 接管手动/报警/语音设定的转速时调用，使下一次输出从 duty 开始连续变化。
+ */
+void fan_pi_reset(fan_pi_t *pi, int32_t temp, uint8_t duty);
+
+/**
+ * @brief 输入一次温度并计算占空
+ *
+ * @param pi 控制器状态
+ * @param temp 滤波后温度 (0.1℃)
+ * @param dt_ms 距上次更新的时间 (超过 FAN_PI_MAX_DT_MS 时截断)
+ * @return uint8_t 风扇占空 (0 停转)
+ */
+uint8_t fan_pi_update(fan_pi_t *pi, int32_t temp, uint32_t dt_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FAN_PI_H
@@ -0,0 +1,124 @@
+/**
+ * @file sensor_filter.c
+ * @brief 定点流式信号调理实现
+ */
+
+#include "sensor_filter.h"
+#include <string.h>
+
+void sensor_filter_init(sensor_filter_t *f, const sensor_filter_cfg_t *cfg)
+{
+    memset(f, 0, sizeof(*f));
+    f->cfg = *cfg;
+    if (f->cfg.median_window > SENSOR_FILTER_MEDIAN_MAX) {
+        f->cfg.median_window = SENSOR_FILTER_MEDIAN_MAX;
+    }
+}
+
+void sensor_filter_reset(sensor_filter_t *f)
+{
+    f->win_count = 0;
+    f->win_head = 0;
+    f->reject_run = 0;
+    f->primed = false;
+    f->ema_acc = 0;
+    f->level = 0;
+    f->output = 0;
+}
+
+// 窗口内样本的中值 (插入排序，窗口不超过 7)
+static int32_t window_median(const sensor_filter_t *f)
+{
+    int32_t sorted[SENSOR_FILTER_MEDIAN_MAX];
+    uint8_t n = f->win_count;
+
+    for (uint8_t i = 0; i < n; i++) {
+        int32_t v = f->window[i];
+        uint8_t j = i;
+        while (j > 0 && sorted[j - 1] > v) {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = v;
+    }
+    return sorted[n / 2];
+}
+
+static void window_push(sensor_filter_t *f, int32_t v)
+{
+    f->window[f->win_head] = v;
+    f->win_head = (f->win_head + 1) % f->cfg.median_window;
+    if (f->win_count < f->cfg.median_window) {
+        f->win_count++;
+    }
+}
+
+bool sensor_filter_update(sensor_filter_t *f, int32_t in, int32_t *out)
+{
+    const sensor_filter_cfg_t *cfg = &f->cfg;
+    bool use_median = cfg->median_window > 1;
+
+    // 1. 离群剔除：参考值为窗口中值 (窗口未建立时为斜率限制前的电平)
+    if (f->primed && cfg->outlier_thresh > 0) {
+        int32_t ref = (use_median && f->win_count >= 3) ? window_median(f) : f->level;
+        int32_t dev = in - ref;
+        if (dev > cfg->outlier_thresh || dev < -cfg->outlier_thresh) {
+            if (f->reject_run < cfg->outlier_max_run) {
+                f->reject_run++;
+                f->rejected++;
+                if (out != NULL) {
+                    *out = f->output;
+                }
+                return false;
+            }
+            // 持续偏离视为真实阶跃：以新电平重建中值窗口与 EMA，输出仍受斜率限制
+            f->win_count = 0;
+            f->win_head = 0;
+            f->ema_acc = in * (1 << cfg->ema_shift);
+        }
+    }
+    f->reject_run = 0;
+
+    // 2. 滑动中值
+    int32_t y = in;
+    if (use_median) {
+        window_push(f, in);
+        y = window_median(f);
+    }
+
+    // 首个样本直接作为初值，避免从 0 爬升
+    if (!f->primed) {
+        f->primed = true;
+        f->ema_acc = y * (1 << cfg->ema_shift);
+        f->level = y;
+        f->output = y;
+        if (out != NULL) {
+            *out = y;
+        }
+        return true;
+    }
+
+    // 3. EMA：acc += x - acc / 2^k
+    if (cfg->ema_shift > 0) {
+        f->ema_acc += y - (f->ema_acc >> cfg->ema_shift);
+        y = f->ema_acc >> cfg->ema_shift;
+    }
+
+    f->level = y;
+
+    // 4. 斜率限制
+    if (cfg->max_slew > 0) {
+        int32_t delta = y - f->output;
+        if (delta > cfg->max_slew) {
+            y = f->output + cfg->max_slew;
+        } else if (delta < -cfg->max_slew) {
+            y = f->output - cfg->max_slew;
+        }
+    }
+
+    f->output = y;
+    if (out != NULL) {
+        *out = y;
+    }
+    return true;
+}
@@ -0,0 +1,77 @@
+/**
+ * @file sensor_filter.h
+ * @brief 定点流式信号调理 (每通道独立状态，无动态分配)
+ *
+ * 处理顺序：离群剔除 → 滑动中值 → EMA → 斜率限制。
+ * 各级可单独关闭 (对应配置为 0)。数值为调用方约定的定点整数，
+ * 例如温度以 0.1℃ 为单位传入 253 表示 25.3℃。
+ */
+
+#ifndef SENSOR_FILTER_H
+#define SENSOR_FILTER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 中值窗口最大长度
+#define SENSOR_FILTER_MEDIAN_MAX 7
+
+/**
+ * @brief 通道配置
+ */
+typedef struct {
+    uint8_t median_window;      // 中值窗口 (奇数，<=1 关闭)
+    uint8_t ema_shift;          // EMA 系数 alpha = 1/2^shift (0 关闭)
+    int32_t max_slew;           // 每次输出最大变化量 (0 关闭)
+    int32_t outlier_thresh;     // 偏离参考值超过此值视为离群 (0 关闭)
+    uint8_t outlier_max_run;    // 连续剔除次数上限，超过后接受 (真实阶跃不会被永久剔除)
+} sensor_filter_cfg_t;
+
+/**
+ * @brief 通道状态
+ */
+typedef struct {
+    sensor_filter_cfg_t cfg;
+    int32_t window[SENSOR_FILTER_MEDIAN_MAX];
+    uint8_t win_count;
+    uint8_t win_head;
+    uint8_t reject_run;
+    bool primed;
+    int32_t ema_acc;            // EMA 值 × 2^ema_shift
+    int32_t level;              // 斜率限制前的电平
+    int32_t output;
+    uint32_t rejected;          // 累计剔除次数
+} sensor_filter_t;
+
+/**
+ * @brief 初始化通道
+ *
+ * @param f 通道状态
+ * @param cfg 配置 (会被复制；中值窗口超出上限时截断)
+ */
+void sensor_filter_init(sensor_filter_t *f, const sensor_filter_cfg_t *cfg);
+
+/**
+ * @brief 清空历史 (保留配置与统计)
+ */
+void sensor_filter_reset(sensor_filter_t *f);
+
+/**
+ * @brief 输入一个样本
+ *
+ * @param f 通道状态
+ * @param in 输入样本
+ * @param out 输出滤波值 (样本被剔除时为上一次输出)
+ * @return true 样本被接受，false 样本被判为离群并剔除
+ */
+bool sensor_filter_update(sensor_filter_t *f, int32_t in, int32_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SENSOR_FILTER_H
@@ -0,0 +1,352 @@
+/**
+ * @file hal.c
+ * @brief 硬件抽象层分发
+ */
+
+#include "hal.h"
+#include "esp_log.h"
+#include "trace.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <string.h>
+
+static const char *TAG = "HAL";
+
+static const hal_ops_t *s_ops = NULL;
+
+// 影子寄存器：各输出通道最近一次成功写入的值
+// 比较与写入在同一把互斥锁内完成，防止并发写入使影子值与外设不一致
+typedef struct {
+    bool valid;
+    uint32_t value;
+} shadow_t;
+
+static shadow_t s_shadow[HAL_OUT_MAX];
+static hal_write_stats_t s_write_stats;
+static SemaphoreHandle_t s_out_lock = NULL;
+
+// RGB 通道编码：预设色带标志位，与任意 RGB 值区分
+#define RGB_SHADOW_PRESET (1u << 24)
+
+esp_err_t hal_register(const hal_ops_t *ops)
+{
+    if (ops == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_out_lock == NULL) {
+        s_out_lock = xSemaphoreCreateMutex();
+        if (s_out_lock == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    s_ops = ops;
+    hal_invalidate_outputs();
+    ESP_LOGI(TAG, "Backend: %s", ops->name ? ops->name : "unnamed");
+    return ESP_OK;
+}
+
+const hal_ops_t *hal_get(void)
+{
+    return s_ops;
+}
+
+esp_err_t hal_init(hal_status_t *status)
+{
+    if (status == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(status, 0, sizeof(*status));
+
+    if (s_ops == NULL || s_ops->init == NULL) {
+        ESP_LOGE(TAG, "No backend registered");
+        return ESP_ERR_INVALID_STATE;
+    }
+    hal_invalidate_outputs();
+    return s_ops->init(status);
+}
+
+// ==================== 传感器 ====================
+
+esp_err_t hal_climate_read(float *temperature, float *humidity)
+{
+    if (s_ops == NULL || s_ops->climate_read == NULL) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    return s_ops->climate_read(temperature, humidity);
+}
+
+esp_err_t hal_light_read(float *lux, bool *fast)
+{
+    if (s_ops == NULL || s_ops->light_read == NULL) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    return s_ops->light_read(lux, fast);
+}
+
+esp_err_t hal_smoke_read(uint32_t *value)
+{
+    if (s_ops == NULL || s_ops->smoke_read == NULL) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    return s_ops->smoke_read(value);
+}
+
+esp_err_t hal_smoke_window(hal_smoke_window_t *window)
+{
+    if (s_ops == NULL || s_ops->smoke_window == NULL) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    return s_ops->smoke_window(window);
+}
+
+// ==================== 烟雾阈值比较器 ====================
+
+bool hal_smoke_alarm_available(void)
+{
+    if (s_ops == NULL || s_ops->smoke_alarm_available == NULL) {
+        return false;
+    }
+    return s_ops->smoke_alarm_available();
+}
+
+esp_err_t hal_smoke_alarm_enable(uint32_t threshold, uint32_t hysteresis,
+                                 hal_smoke_alarm_cb_t cb, void *ctx)
+{
+    if (s_ops == NULL || s_ops->smoke_alarm_enable == NULL) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    return s_ops->smoke_alarm_enable(threshold, hysteresis, cb, ctx);
+}
+
+void hal_smoke_alarm_set_threshold(uint32_t threshold)
+{
+    if (s_ops != NULL && s_ops->smoke_alarm_set_threshold != NULL) {
+        s_ops->smoke_alarm_set_threshold(threshold);
+    }
+}
+
+bool hal_smoke_alarm_active(void)
+{
+    if (s_ops == NULL || s_ops->smoke_alarm_active == NULL) {
+        return false;
+    }
+    return s_ops->smoke_alarm_active();
+}
+
+// ==================== 执行器 ====================
+// 成功的写入同时记录到轨迹 (与上次相同的输出由 trace 去重)
+
+static esp_err_t traced(esp_err_t ret, trace_actuator_t act, int32_t value)
+{
+    if (ret == ESP_OK) {
+        trace_record(TRACE_EV_ACTUATOR, act, value);
+    }
+    return ret;
+}
+
+/**
+ * @brief 开始一次输出写入
+ *
+ * @return true 需要写入 (返回时持有锁，须调用 shadow_end)，false 与影子值相同已跳过
+ */
+static bool shadow_begin(hal_output_t out, uint32_t value)
+{
+    if (s_out_lock == NULL) {
+        return true;
+    }
+    xSemaphoreTake(s_out_lock, portMAX_DELAY);
+    if (s_shadow[out].valid && s_shadow[out].value == value) {
+        s_write_stats.suppressed[out]++;
+        xSemaphoreGive(s_out_lock);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 开始一次强制写入：不与影子值比较，返回时持有锁 (须调用 shadow_end)
+ */
+static void shadow_force_begin(void)
+{
+    if (s_out_lock != NULL) {
+        xSemaphoreTake(s_out_lock, portMAX_DELAY);
+    }
+}
+
+static void shadow_end(hal_output_t out, uint32_t value, esp_err_t ret)
+{
+    if (s_out_lock == NULL) {
+        return;
+    }
+    s_write_stats.issued[out]++;
+    s_shadow[out].valid = (ret == ESP_OK);
+    s_shadow[out].value = value;
+    xSemaphoreGive(s_out_lock);
+}
+
+void hal_invalidate_outputs(void)
+{
+    if (s_out_lock == NULL) {
+        return;
+    }
+    xSemaphoreTake(s_out_lock, portMAX_DELAY);
+    for (int i = 0; i < HAL_OUT_MAX; i++) {
+        s_shadow[i].valid = false;
+    }
+    xSemaphoreGive(s_out_lock);
+}
+
+void hal_get_write_stats(hal_write_stats_t *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    // 各计数独立读取，仅用于观测
+    memcpy(stats, &s_write_stats, sizeof(*stats));
+}
+
+esp_err_t hal_led_set(uint8_t brightness)
+{
+    if (s_ops == NULL || s_ops->led_set == NULL) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    if (!shadow_begin(HAL_OUT_LED, brightness)) {
+        return ESP_OK;
+    }
+    esp_err_t ret = s_ops->led_set(brightness);
+    shadow_end(HAL_OUT_LED, brightness, ret);
+    return traced(ret, TRACE_ACT_LED, brightness);
+}
+
+esp_err_t hal_fan_set(uint8_t speed)
+{
+    if (s_ops == NULL || s_ops->fan_set == NULL) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    if (!shadow_begin(HAL_OUT_FAN, speed)) {
+        return ESP_OK;
+    }
+    esp_err_t ret = s_ops->fan_set(speed);
+    shadow_end(HAL_OUT_FAN, speed, ret);
+    return traced(ret, TRACE_ACT_FAN, speed);
+}
+
+esp_err_t hal_fan_force(uint8_t speed)
+{
+    if (s_ops == NULL || s_ops->fan_set == NULL) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    // 影子值可能是进行中渐变的目标值，此时外设尚未到达，不能按相同值跳过
+    shadow_force_begin();
+    esp_err_t ret = s_ops->fan_set(speed);
+    shadow_end(HAL_OUT_FAN, speed, ret);
+    return traced(ret, TRACE_ACT_FAN, speed);
+}
+
+esp_err_t hal_led_fade(uint8_t brightness, uint32_t fade_ms)
+{
+    if (fade_ms == 0 || s_ops == NULL || s_ops->led_fade == NULL) {
+        return hal_led_set(brightness);
+    }
+    if (!shadow_begin(HAL_OUT_LED, brightness)) {
+        return ESP_OK;
+    }
+    esp_err_t ret = s_ops->led_fade(brightness, fade_ms);
+    shadow_end(HAL_OUT_LED, brightness, ret);
+    return traced(ret, TRACE_ACT_LED, brightness);
+}
+
+esp_err_t hal_fan_fade(uint8_t speed, uint32_t fade_ms)
+{
+    if (fade_ms == 0 || s_ops == NULL || s_ops->fan_fade == NULL) {
+        return hal_fan_set(speed);
+    }
+    if (!shadow_begin(HAL_OUT_FAN, speed)) {
+        return ESP_OK;
+    }
+    esp_err_t ret = s_ops->fan_fade(speed, fade_ms);
+    shadow_end(HAL_OUT_FAN, speed, ret);
+    return traced(ret, TRACE_ACT_FAN, speed);
+}
+
+esp_err_t hal_curtain_set(uint8_t percent)
+{
+    if (s_ops == NULL || s_ops->curtain_set == NULL) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    uint32_t value = (percent > 100) ? 100 : percent;
+    if (!shadow_begin(HAL_OUT_CURTAIN, value)) {
+        return ESP_OK;
+    }
+    esp_err_t ret = s_ops->curtain_set((uint8_t)value);
+    shadow_end(HAL_OUT_CURTAIN, value, ret);
+    return traced(ret, TRACE_ACT_CURTAIN, (int32_t)value);
+}
+
+esp_err_t hal_curtain_get_position(uint8_t *percent)
+{
+    if (percent == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_ops == NULL || s_ops->curtain_get_position == NULL) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    return s_ops->curtain_get_position(percent);
+}
+
+esp_err_t hal_buzzer_beep(uint32_t duration_ms)
+{
+    if (s_ops == NULL || s_ops->buzzer_beep == NULL) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    return traced(s_ops->buzzer_beep(duration_ms), TRACE_ACT_BUZZER, (int32_t)duration_ms);
+}
+
+esp_err_t hal_buzzer_alarm(void)
+{
+    if (s_ops == NULL || s_ops->buzzer_alarm == NULL) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    return traced(s_ops->buzzer_alarm(), TRACE_ACT_BUZZER, 0);
+}
+
+esp_err_t hal_rgb_set_color(rgb_color_t color)
+{
+    if (s_ops == NULL || s_ops->rgb_set_color == NULL) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    uint32_t value = RGB_SHADOW_PRESET | (uint32_t)color;
+    if (!shadow_begin(HAL_OUT_RGB, value)) {
+        return ESP_OK;
+    }
+    esp_err_t ret = s_ops->rgb_set_color(color);
+    shadow_end(HAL_OUT_RGB, value, ret);
+    return traced(ret, TRACE_ACT_RGB_COLOR, color);
+}
+
+esp_err_t hal_rgb_set_rgb(uint8_t red, uint8_t green, uint8_t blue)
+{
+    if (s_ops == NULL || s_ops->rgb_set_rgb == NULL) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    uint32_t value = ((uint32_t)red << 16) | ((uint32_t)green << 8) | blue;
+    if (!shadow_begin(HAL_OUT_RGB, value)) {
+        return ESP_OK;
+    }
+    esp_err_t ret = s_ops->rgb_set_rgb(red, green, blue);
+    shadow_end(HAL_OUT_RGB, value, ret);
+    return traced(ret, TRACE_ACT_RGB_RGB, (int32_t)value);
+}
+
+void hal_rgb_set_brightness(uint8_t brightness)
+{
+    if (s_ops == NULL || s_ops->rgb_set_brightness == NULL) {
+        return;
+    }
+    if (!shadow_begin(HAL_OUT_RGB_BRIGHTNESS, brightness)) {
+        return;
+    }
+    s_ops->rgb_set_brightness(brightness);
+    shadow_end(HAL_OUT_RGB_BRIGHTNESS, brightness, ESP_OK);
+    trace_record(TRACE_EV_ACTUATOR, TRACE_ACT_RGB_BRIGHTNESS, brightness);
+}
@@ -0,0 +1,186 @@
+/**
+ * @file hal.h
+ * @brief 硬件抽象层：传感器与执行器的驱动函数表
+ *
+ * 应用层 (application / app_control / web_ui) 只通过本接口访问硬件，
+ * 具体实现由注册的后端提供：
+ * - hal_esp32：封装现有 ESP-IDF 驱动 (目标板)
+ * - hal_sim：脚本/录制输入 + 执行器输出记录 (linux 目标或 FreeRTOS POSIX 移植)
+ */
+
+#ifndef HAL_H
+#define HAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "app_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 各设备初始化结果 (由后端 init 填写)
+ */
+typedef struct {
+    bool climate_ok;        // 温湿度 (DHT11)
+    bool light_ok;          // 光照 (BH1750)
+    bool smoke_ok;          // 烟雾 (MQ2)
+    bool smoke_comparator;  // 烟雾阈值比较器可用 (连续采集模式)
+    bool led_ok;
+    bool fan_ok;
+    bool buzzer_ok;
+    bool curtain_ok;
+    bool rgb_ok;
+} hal_status_t;
+
+/**
+ * @brief 带影子寄存器的输出通道
+ *
+ * RGB 颜色 (预设色与任意 RGB) 对应同一个物理灯，共用一个通道；
+ * 蜂鸣是动作而非状态，不做去重。
+ */
+typedef enum {
+    HAL_OUT_LED = 0,
+    HAL_OUT_FAN,
+    HAL_OUT_CURTAIN,
+    HAL_OUT_RGB,
+    HAL_OUT_RGB_BRIGHTNESS,
+    HAL_OUT_MAX,
+} hal_output_t;
+
+/**
+ * @brief 执行器写入统计 (按通道)
+ */
+typedef struct {
+    uint32_t issued[HAL_OUT_MAX];       // 实际写入外设的次数
+    uint32_t suppressed[HAL_OUT_MAX];   // 与影子值相同而跳过的次数
+} hal_write_stats_t;
+
+/**
+ * @brief 烟雾阈值越限回调 (可能在中断上下文中调用，只能做 FromISR 操作)
+ *
+ * @return true 需要在中断退出时进行任务切换
+ */
+typedef bool (*hal_smoke_alarm_cb_t)(uint32_t value, int64_t detect_us, void *ctx);
+
+/**
+ * @brief 烟雾传感器最近一个采集窗口的统计 (连续采集模式下由抽取窗口得到)
+ */
+typedef struct {
+    uint32_t avg_x16;   // 过采样平均值 (Q4 定点，avg_x16 / 16 即实际值)
+    uint32_t min;       // 窗口内最小原始值
+    uint32_t max;       // 窗口内最大原始值
+    uint32_t samples;   // 窗口内样本数
+    uint32_t seq;       // 窗口序号 (每产生一个窗口加 1)
+} hal_smoke_window_t;
+
+/**
+ * @brief 后端驱动函数表
+ *
+ * 传感器读取为非阻塞语义：转换进行中返回 ESP_ERR_NOT_FINISHED，
+ * 由调用方稍后重新轮询。未实现的函数指针可为 NULL。
+ */
+typedef struct {
+    const char *name;
+
+    esp_err_t (*init)(hal_status_t *status);
+
+    // ===== 传感器 =====
+    esp_err_t (*climate_read)(float *temperature, float *humidity);
+    esp_err_t (*light_read)(float *lux, bool *fast);
+    esp_err_t (*smoke_read)(uint32_t *value);
+    esp_err_t (*smoke_window)(hal_smoke_window_t *window);  // 尚无窗口时 ESP_ERR_INVALID_STATE
+
+    // ===== 烟雾阈值比较器 =====
+    bool (*smoke_alarm_available)(void);    // 比较器由采集路径驱动 (而非轮询)
+    esp_err_t (*smoke_alarm_enable)(uint32_t threshold, uint32_t hysteresis,
+                                    hal_smoke_alarm_cb_t cb, void *ctx);
+    void (*smoke_alarm_set_threshold)(uint32_t threshold);
+    bool (*smoke_alarm_active)(void);
+
+    // ===== 执行器 =====
+    esp_err_t (*led_set)(uint8_t brightness);       // 0 = 关闭
+    esp_err_t (*fan_set)(uint8_t speed);           // 立即生效，中止进行中的渐变
+    esp_err_t (*led_fade)(uint8_t brightness, uint32_t fade_ms);   // 硬件渐变，立即返回
+    esp_err_t (*fan_fade)(uint8_t speed, uint32_t fade_ms);
+    esp_err_t (*curtain_set)(uint8_t percent);      // 开度 0-100，运动规划后立即返回
+    esp_err_t (*curtain_get_position)(uint8_t *percent);    // 当前 (运动中插值) 开度
+    esp_err_t (*buzzer_beep)(uint32_t duration_ms);    // 非阻塞提示音
+    esp_err_t (*buzzer_alarm)(void);                   // 非阻塞报警节奏，打断提示音
+    esp_err_t (*rgb_set_color)(rgb_color_t color);
+    esp_err_t (*rgb_set_rgb)(uint8_t red, uint8_t green, uint8_t blue);
+    void (*rgb_set_brightness)(uint8_t brightness);
+} hal_ops_t;
+
+/**
+ * @brief 注册硬件后端 (须在 hal_init 之前调用)
+ *
+ * @param ops 函数表，须在整个运行期间有效
+ */
+esp_err_t hal_register(const hal_ops_t *ops);
+
+/**
+ * @brief 获取当前后端，未注册时返回 NULL
+ */
+const hal_ops_t *hal_get(void);
+
+/**
+ * @brief 初始化当前后端的全部设备 (容错模式，单个设备失败不影响其他设备)
+ *
+ * @param status 输出各设备初始化结果
+ */
+esp_err_t hal_init(hal_status_t *status);
+
+// ==================== 便捷接口 ====================
+// 后端未注册或未实现对应函数时返回 ESP_ERR_NOT_SUPPORTED
+
+esp_err_t hal_climate_read(float *temperature, float *humidity);
+esp_err_t hal_light_read(float *lux, bool *fast);
+esp_err_t hal_smoke_read(uint32_t *value);
+esp_err_t hal_smoke_window(hal_smoke_window_t *window);
+
+bool hal_smoke_alarm_available(void);
+esp_err_t hal_smoke_alarm_enable(uint32_t threshold, uint32_t hysteresis,
+                                 hal_smoke_alarm_cb_t cb, void *ctx);
+void hal_smoke_alarm_set_threshold(uint32_t threshold);
+bool hal_smoke_alarm_active(void);
+
+// 执行器写入经过影子寄存器：与上次成功写入的值相同则直接返回 ESP_OK，
+// 写入失败时影子值失效，下次必定重新写入
+esp_err_t hal_led_set(uint8_t brightness);
+esp_err_t hal_fan_set(uint8_t speed);
+// 渐变到目标值：影子值记录目标值；后端不支持渐变或 fade_ms 为 0 时立即写入
+esp_err_t hal_led_fade(uint8_t brightness, uint32_t fade_ms);
+esp_err_t hal_fan_fade(uint8_t speed, uint32_t fade_ms);
+// 立即写入风扇转速：不与影子值比较，并中止进行中的渐变 (安全通路使用)
+esp_err_t hal_fan_force(uint8_t speed);
+esp_err_t hal_curtain_set(uint8_t percent);        // 超过 100 按 100 处理
+esp_err_t hal_curtain_get_position(uint8_t *percent);
+esp_err_t hal_buzzer_beep(uint32_t duration_ms);
+esp_err_t hal_buzzer_alarm(void);   // 轨迹中记为时长 0 的蜂鸣
+esp_err_t hal_rgb_set_color(rgb_color_t color);
+esp_err_t hal_rgb_set_rgb(uint8_t red, uint8_t green, uint8_t blue);
+void hal_rgb_set_brightness(uint8_t brightness);   // 对当前颜色直接生效
+
+/**
+ * @brief 使全部影子值失效 (外设被绕过本层改写后调用，下一次写入必定下发)
+ */
+void hal_invalidate_outputs(void);
+
+/**
+ * @brief 获取执行器写入统计
+ */
+void hal_get_write_stats(hal_write_stats_t *stats);
+
+/**
+ * @brief ESP32 后端 (现有驱动，linux 目标下不编译)
+ */
+const hal_ops_t *hal_esp32_ops(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HAL_H
@@ -0,0 +1,217 @@
+/**
+ * @file hal_esp32.c
+ * @brief ESP32 硬件后端：封装现有 ESP-IDF 驱动
+ */
+
+#include "hal.h"
+#include "config.h"
+#include "esp_log.h"
+
+#include "dht_driver.h"      // esp-idf-lib/dht
+#include "bh1750_driver.h"   // esp-idf-lib/bh1750
+#include "servo_driver.h"    // espressif/servo
+#include "mq2.h"
+#include "led.h"
+#include "fan.h"
+#include "buzzer.h"
+#include "rgb_led.h"
+
+static const char *TAG = "HAL_ESP32";
+
+static esp_err_t esp32_init(hal_status_t *status)
+{
+    // ===== 传感器初始化 (容错模式) =====
+#if DHT11_USE_RMT
+    if (dht11_init_rmt(DHT11_GPIO) == ESP_OK) {
+        status->climate_ok = true;
+        ESP_LOGI(TAG, "  DHT11: OK (GPIO %d, RMT)", DHT11_GPIO);
+    } else {
+        ESP_LOGW(TAG, "  DHT11: RMT backend failed, falling back to bit-bang");
+    }
+#endif
+    if (!status->climate_ok) {
+        if (dht11_init(DHT11_GPIO) == ESP_OK) {
+            status->climate_ok = true;
+            ESP_LOGI(TAG, "  DHT11: OK (GPIO %d)", DHT11_GPIO);
+        } else {
+            ESP_LOGW(TAG, "  DHT11: FAILED");
+        }
+    }
+
+    if (bh1750_sensor_init(BH1750_SDA_GPIO, BH1750_SCL_GPIO) == ESP_OK) {
+        status->light_ok = true;
+        ESP_LOGI(TAG, "  BH1750: OK (SDA=%d, SCL=%d)", BH1750_SDA_GPIO, BH1750_SCL_GPIO);
+    } else {
+        ESP_LOGW(TAG, "  BH1750: FAILED");
+    }
+
+#if MQ2_ADC_CONTINUOUS
+    if (mq2_init_continuous(MQ2_ADC_CHANNEL, MQ2_ADC_SAMPLE_RATE_HZ,
+                            MQ2_ADC_WINDOW_SAMPLES) == ESP_OK) {
+        status->smoke_ok = true;
+        ESP_LOGI(TAG, "  MQ2: OK (ADC CH%d, continuous)", MQ2_ADC_CHANNEL);
+    } else {
+        ESP_LOGW(TAG, "  MQ2: continuous mode failed, falling back to oneshot");
+    }
+#endif
+    if (!status->smoke_ok) {
+        if (mq2_init(MQ2_ADC_CHANNEL) == ESP_OK) {
+            status->smoke_ok = true;
+            ESP_LOGI(TAG, "  MQ2: OK (ADC CH%d)", MQ2_ADC_CHANNEL);
+        } else {
+            ESP_LOGW(TAG, "  MQ2: FAILED");
+        }
+    }
+    status->smoke_comparator = status->smoke_ok && mq2_is_continuous();
+
+    // ===== 执行器初始化 (关键模块) =====
+    if (led_init(LED_GPIO, LED_PWM_CHANNEL) == ESP_OK) {
+        status->led_ok = true;
+    } else {
+        ESP_LOGE(TAG, "  LED: FAILED - Critical!");
+    }
+
+    if (fan_init(FAN_GPIO, FAN_PWM_CHANNEL) == ESP_OK) {
+        status->fan_ok = true;
+    } else {
+        ESP_LOGE(TAG, "  FAN: FAILED - Critical!");
+    }
+
+    if (buzzer_init(BUZZER_GPIO) == ESP_OK) {
+        status->buzzer_ok = true;
+    } else {
+        ESP_LOGW(TAG, "  BUZZER: FAILED");
+    }
+
+    if (motor_init(SERVO_GPIO) == ESP_OK) {
+        status->curtain_ok = true;
+    } else {
+        ESP_LOGW(TAG, "  MOTOR: FAILED");
+    }
+
+    // ===== RGB LED (可选) =====
+    if (rgb_led_init(RGB_LED_GPIO) == ESP_OK) {
+        status->rgb_ok = true;
+        rgb_led_set_brightness(30);
+        rgb_led_blink(RGB_COLOR_GREEN, 2, 100);  // 启动指示
+    } else {
+        ESP_LOGW(TAG, "  RGB LED: FAILED");
+    }
+
+    return ESP_OK;
+}
+
+// ==================== 传感器 ====================
+
+static esp_err_t esp32_climate_read(float *temperature, float *humidity)
+{
+    dht11_data_t dht_data;
+
+    // RMT 后端转换进行中时返回 ESP_ERR_NOT_FINISHED
+    esp_err_t ret = dht11_read_async(&dht_data);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (!dht_data.valid) {
+        return ESP_FAIL;
+    }
+
+    *temperature = dht_data.temperature;
+    *humidity = dht_data.humidity;
+    return ESP_OK;
+}
+
+static esp_err_t esp32_light_read(float *lux, bool *fast)
+{
+    esp_err_t ret = bh1750_sensor_read_async(lux);
+    if (ret == ESP_OK && fast != NULL) {
+        *fast = bh1750_sensor_is_fast();
+    }
+    return ret;
+}
+
+static esp_err_t esp32_smoke_read(uint32_t *value)
+{
+    return mq2_read(MQ2_ADC_CHANNEL, value);
+}
+
+static esp_err_t esp32_smoke_window(hal_smoke_window_t *window)
+{
+    mq2_window_t w;
+    esp_err_t ret = mq2_get_window(&w);
+    if (ret == ESP_OK) {
+        window->avg_x16 = w.avg_x16;
+        window->min = w.min;
+        window->max = w.max;
+        window->samples = w.samples;
+        window->seq = w.seq;
+    }
+    return ret;
+}
+
+static esp_err_t esp32_smoke_alarm_enable(uint32_t threshold, uint32_t hysteresis,
+                                          hal_smoke_alarm_cb_t cb, void *ctx)
+{
+    // 回调签名与 mq2_alarm_cb_t 一致
+    return mq2_alarm_enable(threshold, hysteresis, cb, ctx);
+}
+
+// ==================== 执行器 ====================
+
+static esp_err_t esp32_led_set(uint8_t brightness)
+{
+    if (brightness == 0) {
+        return led_off(LED_PWM_CHANNEL);
+    }
+    return led_set_brightness(LED_PWM_CHANNEL, brightness);
+}
+
+static esp_err_t esp32_led_fade(uint8_t brightness, uint32_t fade_ms)
+{
+    return led_fade_to(LED_PWM_CHANNEL, brightness, fade_ms);
+}
+
+static esp_err_t esp32_curtain_get_position(uint8_t *percent)
+{
+    *percent = curtain_get_position();
+    return ESP_OK;
+}
+
+static esp_err_t esp32_buzzer_beep(uint32_t duration_ms)
+{
+    return buzzer_beep(BUZZER_GPIO, duration_ms);
+}
+
+static esp_err_t esp32_buzzer_alarm(void)
+{
+    return buzzer_play(&BUZZER_PATTERN_SOS, BUZZER_PRIO_ALARM);
+}
+
+static const hal_ops_t s_esp32_ops = {
+    .name = "esp32",
+    .init = esp32_init,
+    .climate_read = esp32_climate_read,
+    .light_read = esp32_light_read,
+    .smoke_read = esp32_smoke_read,
+    .smoke_window = esp32_smoke_window,
+    .smoke_alarm_available = mq2_is_continuous,
+    .smoke_alarm_enable = esp32_smoke_alarm_enable,
+    .smoke_alarm_set_threshold = mq2_alarm_set_threshold,
+    .smoke_alarm_active = mq2_alarm_is_active,
+    .led_set = esp32_led_set,
+    .fan_set = fan_set_speed,
+    .led_fade = esp32_led_fade,
+    .fan_fade = fan_fade_to,
+    .curtain_set = curtain_set_position,
+    .curtain_get_position = esp32_curtain_get_position,
+    .buzzer_beep = esp32_buzzer_beep,
+    .buzzer_alarm = esp32_buzzer_alarm,
+    .rgb_set_color = rgb_led_set_color,
+    .rgb_set_rgb = rgb_led_set_rgb,
+    .rgb_set_brightness = rgb_led_set_brightness,
+};
+
+const hal_ops_t *hal_esp32_ops(void)
+{
+    return &s_esp32_ops;
+}
@@ -0,0 +1,428 @@
+/**
+ * @file hal_sim.c
+ * @brief 仿真硬件后端实现
+ */
+
+#include "hal_sim.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <string.h>
+
+static const char *TAG = "HAL_SIM";
+
+static SemaphoreHandle_t s_lock = NULL;
+static int64_t (*s_now_us)(void) = esp_timer_get_time;
+
+// 输入
+static const hal_sim_sample_t *s_script = NULL;
+static size_t s_script_len = 0;
+static size_t s_script_pos = 0;
+static int64_t s_script_start_us = 0;
+static hal_sim_sample_t s_inputs;
+static esp_err_t s_sensor_err[HAL_SIM_SENSOR_MAX];
+static hal_smoke_window_t s_smoke_window;   // 每次烟雾读取视为一个单样本窗口
+
+// 烟雾阈值比较器
+static bool s_comparator = true;
+static hal_smoke_alarm_cb_t s_alarm_cb = NULL;
+static void *s_alarm_ctx = NULL;
+static uint32_t s_alarm_threshold = 0;
+static uint32_t s_alarm_hysteresis = 0;
+static bool s_alarm_active = false;
+
+// 输出
+static hal_sim_event_t s_events[HAL_SIM_EVENT_CAPACITY];
+static size_t s_event_head = 0;
+static size_t s_event_count = 0;
+static hal_sim_outputs_t s_outputs;
+
+// 首次使用时创建锁 (注册/加载脚本均在任务启动前完成)
+static void sim_lock(void)
+{
+    if (s_lock == NULL) {
+        s_lock = xSemaphoreCreateMutex();
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+}
+
+static void sim_unlock(void)
+{
+    xSemaphoreGive(s_lock);
+}
+
+// 按脚本进度刷新当前输入 (调用方持有锁)
+static void advance_script_locked(void)
+{
+    if (s_script == NULL) {
+        return;
+    }
+    int64_t elapsed_ms = (s_now_us() - s_script_start_us) / 1000;
+    while (s_script_pos + 1 < s_script_len &&
+           (int64_t)s_script[s_script_pos + 1].at_ms <= elapsed_ms) {
+        s_script_pos++;
+    }
+    s_inputs = s_script[s_script_pos];
+}
+
+/**
+ * @brief 比较器求值 (带滞回，仅上穿时触发回调)
+ */
+static void evaluate_comparator(uint32_t value)
+{
+    hal_smoke_alarm_cb_t cb = NULL;
+    void *ctx = NULL;
+
+    sim_lock();
+    if (s_alarm_cb != NULL) {
+        if (!s_alarm_active && value > s_alarm_threshold) {
+            s_alarm_active = true;
+            cb = s_alarm_cb;
+            ctx = s_alarm_ctx;
+        } else if (s_alarm_active && value + s_alarm_hysteresis < s_alarm_threshold) {
+            s_alarm_active = false;
+        }
+    }
+    sim_unlock();
+
+    if (cb != NULL) {
+        cb(value, s_now_us(), ctx);
+    }
+}
+
+static void record_output(hal_sim_output_t output, uint32_t value)
+{
+    sim_lock();
+    size_t idx = (s_event_head + s_event_count) % HAL_SIM_EVENT_CAPACITY;
+    if (s_event_count == HAL_SIM_EVENT_CAPACITY) {
+        // 覆盖最旧事件
+        s_event_head = (s_event_head + 1) % HAL_SIM_EVENT_CAPACITY;
+        s_outputs.events_dropped++;
+    } else {
+        s_event_count++;
+    }
+    s_events[idx].ts_us = s_now_us();
+    s_events[idx].output = output;
+    s_events[idx].value = value;
+    s_outputs.events_total++;
+
+    switch (output) {
+        case HAL_SIM_OUT_LED:            s_outputs.led_brightness = (uint8_t)value; break;
+        case HAL_SIM_OUT_FAN:            s_outputs.fan_speed = (uint8_t)value; break;
+        case HAL_SIM_OUT_CURTAIN:        s_outputs.curtain_position = (uint8_t)value; break;
+        case HAL_SIM_OUT_BUZZER:         s_outputs.buzzer_beeps++; break;
+        case HAL_SIM_OUT_RGB_COLOR:      s_outputs.rgb_color = (rgb_color_t)value; break;
+        case HAL_SIM_OUT_RGB_RGB:        s_outputs.rgb_value = value; break;
+        case HAL_SIM_OUT_RGB_BRIGHTNESS: s_outputs.rgb_brightness = (uint8_t)value; break;
+    }
+    sim_unlock();
+}
+
+// ==================== 函数表实现 ====================
+
+static esp_err_t sim_init(hal_status_t *status)
+{
+    status->climate_ok = true;
+    status->light_ok = true;
+    status->smoke_ok = true;
+    status->smoke_comparator = s_comparator;
+    status->led_ok = true;
+    status->fan_ok = true;
+    status->buzzer_ok = true;
+    status->curtain_ok = true;
+    status->rgb_ok = true;
+
+    ESP_LOGI(TAG, "Simulated backend ready (script: %u samples)", (unsigned)s_script_len);
+    return ESP_OK;
+}
+
+static esp_err_t sim_climate_read(float *temperature, float *humidity)
+{
+    sim_lock();
+    advance_script_locked();
+    esp_err_t ret = s_sensor_err[HAL_SIM_SENSOR_CLIMATE];
+    if (ret == ESP_OK) {
+        *temperature = s_inputs.temperature;
+        *humidity = s_inputs.humidity;
+    }
+    sim_unlock();
+    return ret;
+}
+
+static esp_err_t sim_light_read(float *lux, bool *fast)
+{
+    sim_lock();
+    advance_script_locked();
+    esp_err_t ret = s_sensor_err[HAL_SIM_SENSOR_LIGHT];
+    if (ret == ESP_OK) {
+        *lux = s_inputs.light;
+        if (fast != NULL) {
+            *fast = false;
+        }
+    }
+    sim_unlock();
+    return ret;
+}
+
+static esp_err_t sim_smoke_read(uint32_t *value)
+{
+    sim_lock();
+    advance_script_locked();
+    esp_err_t ret = s_sensor_err[HAL_SIM_SENSOR_SMOKE];
+    uint32_t smoke = s_inputs.smoke;
+    if (ret == ESP_OK) {
+        s_smoke_window.avg_x16 = smoke * 16;
+        s_smoke_window.min = smoke;
+        s_smoke_window.max = smoke;
+        s_smoke_window.samples = 1;
+        s_smoke_window.seq++;
+    }
+    sim_unlock();
+
+    // 脚本模式下在采样时刻求值比较器
+    evaluate_comparator(smoke);
+
+    if (ret == ESP_OK) {
+        *value = smoke;
+    }
+    return ret;
+}
+
+static esp_err_t sim_smoke_window(hal_smoke_window_t *window)
+{
+    sim_lock();
+    *window = s_smoke_window;
+    sim_unlock();
+    return (window->seq == 0) ? ESP_ERR_INVALID_STATE : ESP_OK;
+}
+
+static bool sim_smoke_alarm_available(void)
+{
+    return s_comparator;
+}
+
+static esp_err_t sim_smoke_alarm_enable(uint32_t threshold, uint32_t hysteresis,
+                                        hal_smoke_alarm_cb_t cb, void *ctx)
+{
+    if (cb == NULL || hysteresis > threshold) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_comparator) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    sim_lock();
+    s_alarm_threshold = threshold;
+    s_alarm_hysteresis = hysteresis;
+    s_alarm_ctx = ctx;
+    s_alarm_cb = cb;
+    s_alarm_active = false;
+    sim_unlock();
+    return ESP_OK;
+}
+
+static void sim_smoke_alarm_set_threshold(uint32_t threshold)
+{
+    sim_lock();
+    s_alarm_threshold = threshold;
+    if (s_alarm_hysteresis > threshold) {
+        s_alarm_hysteresis = threshold;
+    }
+    sim_unlock();
+}
+
+static bool sim_smoke_alarm_active(void)
+{
+    sim_lock();
+    bool active = s_alarm_active;
+    sim_unlock();
+    return active;
+}
+
+static esp_err_t sim_led_set(uint8_t brightness)
+{
+    record_output(HAL_SIM_OUT_LED, brightness);
+    return ESP_OK;
+}
+
+// 仿真风扇瞬时到位，另记下本次写入的渐变时间
+static void record_fan(uint8_t speed, uint32_t fade_ms)
+{
+    record_output(HAL_SIM_OUT_FAN, speed);
+    sim_lock();
+    s_outputs.fan_fade_ms = fade_ms;
+    sim_unlock();
+}
+
+static esp_err_t sim_fan_set(uint8_t speed)
+{
+    record_fan(speed, 0);
+    return ESP_OK;
+}
+
+static esp_err_t sim_fan_fade(uint8_t speed, uint32_t fade_ms)
+{
+    record_fan(speed, fade_ms);
+    return ESP_OK;
+}
+
+static esp_err_t sim_curtain_set(uint8_t percent)
+{
+    record_output(HAL_SIM_OUT_CURTAIN, percent);
+    return ESP_OK;
+}
+
+static esp_err_t sim_curtain_get_position(uint8_t *percent)
+{
+    *percent = s_outputs.curtain_position;
+    return ESP_OK;
+}
+
+static esp_err_t sim_buzzer_beep(uint32_t duration_ms)
+{
+    record_output(HAL_SIM_OUT_BUZZER, duration_ms);
+    return ESP_OK;
+}
+
+static esp_err_t sim_buzzer_alarm(void)
+{
+    record_output(HAL_SIM_OUT_BUZZER, 0);
+    return ESP_OK;
+}
+
+static esp_err_t sim_rgb_set_color(rgb_color_t color)
+{
+    record_output(HAL_SIM_OUT_RGB_COLOR, (uint32_t)color);
+    return ESP_OK;
+}
+
+static esp_err_t sim_rgb_set_rgb(uint8_t red, uint8_t green, uint8_t blue)
+{
+    record_output(HAL_SIM_OUT_RGB_RGB,
+                  ((uint32_t)red << 16) | ((uint32_t)green << 8) | blue);
+    return ESP_OK;
+}
+
+static void sim_rgb_set_brightness(uint8_t brightness)
+{
+    record_output(HAL_SIM_OUT_RGB_BRIGHTNESS, brightness);
+}
+
+static const hal_ops_t s_sim_ops = {
+    .name = "sim",
+    .init = sim_init,
+    .climate_read = sim_climate_read,
+    .light_read = sim_light_read,
+    .smoke_read = sim_smoke_read,
+    .smoke_window = sim_smoke_window,
+    .smoke_alarm_available = sim_smoke_alarm_available,
+    .smoke_alarm_enable = sim_smoke_alarm_enable,
+    .smoke_alarm_set_threshold = sim_smoke_alarm_set_threshold,
+    .smoke_alarm_active = sim_smoke_alarm_active,
+    .led_set = sim_led_set,
+    .fan_set = sim_fan_set,
+    .fan_fade = sim_fan_fade,
+    .curtain_set = sim_curtain_set,
+    .curtain_get_position = sim_curtain_get_position,
+    .buzzer_beep = sim_buzzer_beep,
+    .buzzer_alarm = sim_buzzer_alarm,
+    .rgb_set_color = sim_rgb_set_color,
+    .rgb_set_rgb = sim_rgb_set_rgb,
+    .rgb_set_brightness = sim_rgb_set_brightness,
+};
+
+// ==================== 公共接口 ====================
+
+const hal_ops_t *hal_sim_ops(void)
+{
+    return &s_sim_ops;
+}
+
+void hal_sim_set_clock(int64_t (*now_us)(void))
+{
+    s_now_us = (now_us != NULL) ? now_us : esp_timer_get_time;
+}
+
+void hal_sim_load_script(const hal_sim_sample_t *samples, size_t count)
+{
+    sim_lock();
+    s_script = (count > 0) ? samples : NULL;
+    s_script_len = count;
+    s_script_pos = 0;
+    s_script_start_us = s_now_us();
+    advance_script_locked();
+    sim_unlock();
+}
+
+void hal_sim_set_inputs(const hal_sim_sample_t *sample)
+{
+    if (sample == NULL) {
+        return;
+    }
+    sim_lock();
+    s_script = NULL;
+    s_script_len = 0;
+    s_inputs = *sample;
+    sim_unlock();
+
+    evaluate_comparator(sample->smoke);
+}
+
+void hal_sim_set_comparator(bool available)
+{
+    sim_lock();
+    s_comparator = available;
+    if (!available) {
+        s_alarm_cb = NULL;
+        s_alarm_active = false;
+    }
+    sim_unlock();
+}
+
+void hal_sim_set_sensor_error(hal_sim_sensor_t sensor, esp_err_t err)
+{
+    if (sensor >= HAL_SIM_SENSOR_MAX) {
+        return;
+    }
+    sim_lock();
+    s_sensor_err[sensor] = err;
+    sim_unlock();
+}
+
+size_t hal_sim_take_events(hal_sim_event_t *out, size_t max)
+{
+    if (out == NULL) {
+        return 0;
+    }
+    sim_lock();
+    size_t n = (s_event_count < max) ? s_event_count : max;
+    for (size_t i = 0; i < n; i++) {
+        out[i] = s_events[(s_event_head + i) % HAL_SIM_EVENT_CAPACITY];
+    }
+    s_event_head = (s_event_head + n) % HAL_SIM_EVENT_CAPACITY;
+    s_event_count -= n;
+    sim_unlock();
+    return n;
+}
+
+void hal_sim_get_outputs(hal_sim_outputs_t *out)
+{
+    if (out == NULL) {
+        return;
+    }
+    sim_lock();
+    *out = s_outputs;
+    sim_unlock();
+}
+
+void hal_sim_reset(void)
+{
+    sim_lock();
+    s_event_head = 0;
+    s_event_count = 0;
+    memset(&s_outputs, 0, sizeof(s_outputs));
+    memset(s_sensor_err, 0, sizeof(s_sensor_err));
+    memset(&s_smoke_window, 0, sizeof(s_smoke_window));
+    s_alarm_active = false;
+    sim_unlock();
+}
@@ -0,0 +1,149 @@
+/**
+ * @file hal_sim.h
+ * @brief 仿真硬件后端
+ *
+ * 传感器输入来自脚本 (按时刻分段保持) 或由调用方逐条注入 (录制回放)；
+ * 执行器输出不驱动硬件，仅记录到带时间戳的事件缓冲区并保存当前值，
+ * 用于在 linux 目标 / FreeRTOS POSIX 移植上运行完整的采集→控制→执行回路。
+ */
+
+#ifndef HAL_SIM_H
+#define HAL_SIM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "hal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HAL_SIM_EVENT_CAPACITY 256
+
+/**
+ * @brief 一组传感器输入
+ */
+typedef struct {
+    uint32_t at_ms;         // 相对脚本起点的生效时刻 (注入时忽略)
+    float temperature;
+    float humidity;
+    float light;
+    uint32_t smoke;
+} hal_sim_sample_t;
+
+/**
+ * @brief 仿真传感器编号 (用于故障注入)
+ */
+typedef enum {
+    HAL_SIM_SENSOR_CLIMATE = 0,
+    HAL_SIM_SENSOR_LIGHT,
+    HAL_SIM_SENSOR_SMOKE,
+    HAL_SIM_SENSOR_MAX,
+} hal_sim_sensor_t;
+
+/**
+ * @brief 执行器输出类型
+ */
+typedef enum {
+    HAL_SIM_OUT_LED = 0,        // value = 亮度 (0 = 关闭)
+    HAL_SIM_OUT_FAN,            // value = 风速
+    HAL_SIM_OUT_CURTAIN,        // value = 开度 0-100
+    HAL_SIM_OUT_BUZZER,         // value = 蜂鸣时长 (ms)
+    HAL_SIM_OUT_RGB_COLOR,      // value = rgb_color_t
+    HAL_SIM_OUT_RGB_RGB,        // value = 0xRRGGBB
+    HAL_SIM_OUT_RGB_BRIGHTNESS, // value = 亮度 (0-100)
+} hal_sim_output_t;
+
+/**
+ * @brief 执行器输出事件
+ */
+typedef struct {
+    int64_t ts_us;
+    hal_sim_output_t output;
+    uint32_t value;
+} hal_sim_event_t;
+
+/**
+ * @brief 执行器当前输出
+ */
+typedef struct {
+    uint8_t led_brightness;
+    uint8_t fan_speed;
+    uint32_t fan_fade_ms;       // 最近一次风扇写入的渐变时间 (0 = 立即生效)
+    uint8_t curtain_position;   // 仿真舵机瞬时到位
+    rgb_color_t rgb_color;
+    uint32_t rgb_value;         // 最近一次 rgb_set_rgb (0xRRGGBB)
+    uint8_t rgb_brightness;
+    uint32_t buzzer_beeps;
+    uint32_t events_total;      // 记录过的事件总数
+    uint32_t events_dropped;    // 缓冲区满后覆盖的事件数
+} hal_sim_outputs_t;
+
+/**
+ * @brief 仿真后端函数表
+ */
+const hal_ops_t *hal_sim_ops(void);
+
+/**
+ * @brief 设置时间源 (默认 esp_timer_get_time)
+ *
+ * 回放/基准测试可注入虚拟时钟，使事件时间戳与脚本进度可复现。
+ */
+void hal_sim_set_clock(int64_t (*now_us)(void));
+
+/**
+ * @brief 加载输入脚本并以当前时刻为起点
+ *
+ * 读取时返回 at_ms 不晚于已流逝时间的最后一组输入；脚本结束后保持最后一组。
+ *
+ * @param samples 按 at_ms 升序排列，须在脚本运行期间有效
+ * @param count 条目数 (0 表示卸载脚本，改用注入值)
+ */
+void hal_sim_load_script(const hal_sim_sample_t *samples, size_t count);
+
+/**
+ * @brief 直接设置当前输入 (卸载脚本；用于逐条回放录制数据)
+ *
+ * 烟雾阈值比较器在此处求值，越限回调在调用方任务上下文中执行。
+ */
+void hal_sim_set_inputs(const hal_sim_sample_t *sample);
+
+/**
+ * @brief 设置烟雾阈值比较器是否可用 (默认可用)
+ *
+ * 不可用时模拟 MQ2 回退到单次采样：hal_init 报告 smoke_comparator = false，
+ * 已注册的越限回调失效，报警只能由周期控制通路发现。
+ */
+void hal_sim_set_comparator(bool available);
+
+/**
+ * @brief 注入传感器故障 (ESP_OK 清除)
+ */
+void hal_sim_set_sensor_error(hal_sim_sensor_t sensor, esp_err_t err);
+
+/**
+ * @brief 按时间顺序取出已记录的执行器事件
+ *
+ * @param out 输出缓冲区
+ * @param max 缓冲区容量
+ * @return size_t 取出的事件数 (取出后从记录中移除)
+ */
+size_t hal_sim_take_events(hal_sim_event_t *out, size_t max);
+
+/**
+ * @brief 获取执行器当前输出
+ */
+void hal_sim_get_outputs(hal_sim_outputs_t *out);
+
+/**
+ * @brief 清空事件记录与输出状态
+ */
+void hal_sim_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HAL_SIM_H
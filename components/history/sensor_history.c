@@ -0,0 +1,353 @@
+/**
+ * @file sensor_history.c
+ * @brief 传感器历史数据分层时序存储实现
+ *
+ * 每个通道包含三个环形缓冲区 (原始/分钟/小时) 和两个汇总累加器。
+ * 写入样本时：
+ * 1. 原始层按 1 秒粒度去重后写入
+ * 2. 样本累加到当前分钟累加器；跨分钟时提交上一分钟，并合并到小时累加器
+ * 3. 小时累加器跨小时时提交到小时层
+ */
+
+#include "sensor_history.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include <string.h>
+
+static const char *TAG = "HISTORY";
+
+// 原始层紧凑存储
+typedef struct {
+    uint32_t ts;
+    float value;
+} raw_sample_t;
+
+// 环形缓冲区 (元素首成员必须为 uint32_t 时间戳)
+typedef struct {
+    uint8_t *buf;
+    uint16_t elem_size;
+    uint16_t capacity;
+    uint16_t head;      // 下一个写入位置
+    uint16_t count;
+} ring_t;
+
+// 汇总累加器
+typedef struct {
+    bool active;
+    uint32_t start;
+    float min;
+    float max;
+    float sum;
+    uint32_t count;
+} rollup_acc_t;
+
+typedef struct {
+    ring_t raw;
+    ring_t minute;
+    ring_t hour;
+    rollup_acc_t minute_acc;
+    rollup_acc_t hour_acc;
+} channel_store_t;
+
+static channel_store_t s_channels[HISTORY_CH_MAX];
+static void *s_pool = NULL;
+static SemaphoreHandle_t s_mutex = NULL;
+
+static const char *s_channel_names[HISTORY_CH_MAX] = {
+    [HISTORY_CH_TEMPERATURE] = "temperature",
+    [HISTORY_CH_HUMIDITY]    = "humidity",
+    [HISTORY_CH_LIGHT]       = "light",
+    [HISTORY_CH_SMOKE]       = "smoke",
+};
+
+static const char *s_tier_names[HISTORY_TIER_MAX] = {
+    [HISTORY_TIER_RAW]    = "raw",
+    [HISTORY_TIER_MINUTE] = "minute",
+    [HISTORY_TIER_HOUR]   = "hour",
+};
+
+static const uint32_t s_tier_step[HISTORY_TIER_MAX] = {
+    [HISTORY_TIER_RAW]    = HISTORY_RAW_STEP_S,
+    [HISTORY_TIER_MINUTE] = HISTORY_MINUTE_STEP_S,
+    [HISTORY_TIER_HOUR]   = HISTORY_HOUR_STEP_S,
+};
+
+// ==================== 环形缓冲区 ====================
+
+static void ring_setup(ring_t *ring, uint8_t *buf, uint16_t elem_size, uint16_t capacity)
+{
+    ring->buf = buf;
+    ring->elem_size = elem_size;
+    ring->capacity = capacity;
+    ring->head = 0;
+    ring->count = 0;
+}
+
+static void ring_push(ring_t *ring, const void *elem)
+{
+    memcpy(ring->buf + (size_t)ring->head * ring->elem_size, elem, ring->elem_size);
+    ring->head = (ring->head + 1) % ring->capacity;
+    if (ring->count < ring->capacity) {
+        ring->count++;
+    }
+}
+
+// 按逻辑下标 (0 为最旧) 取元素
+static const void *ring_at(const ring_t *ring, uint16_t index)
+{
+    uint16_t pos = (ring->head + ring->capacity - ring->count + index) % ring->capacity;
+    return ring->buf + (size_t)pos * ring->elem_size;
+}
+
+static uint32_t ring_ts(const ring_t *ring, uint16_t index)
+{
+    uint32_t ts;
+    memcpy(&ts, ring_at(ring, index), sizeof(ts));
+    return ts;
+}
+
+// 第一个时间戳 >= ts 的逻辑下标
+static uint16_t ring_lower_bound(const ring_t *ring, uint32_t ts)
+{
+    uint16_t lo = 0;
+    uint16_t hi = ring->count;
+    while (lo < hi) {
+        uint16_t mid = lo + (hi - lo) / 2;
+        if (ring_ts(ring, mid) < ts) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+// ==================== 汇总 ====================
+
+static void acc_add(rollup_acc_t *acc, uint32_t start, float min, float max, float sum, uint32_t count)
+{
+    if (!acc->active) {
+        acc->active = true;
+        acc->start = start;
+        acc->min = min;
+        acc->max = max;
+        acc->sum = sum;
+        acc->count = count;
+        return;
+    }
+    if (min < acc->min) acc->min = min;
+    if (max > acc->max) acc->max = max;
+    acc->sum += sum;
+    acc->count += count;
+}
+
+static history_point_t acc_to_point(const rollup_acc_t *acc)
+{
+    history_point_t p = {
+        .ts = acc->start,
+        .min = acc->min,
+        .avg = acc->count ? acc->sum / (float)acc->count : 0.0f,
+        .max = acc->max,
+    };
+    return p;
+}
+
+static void commit_hour(channel_store_t *store)
+{
+    history_point_t p = acc_to_point(&store->hour_acc);
+    ring_push(&store->hour, &p);
+    store->hour_acc.active = false;
+}
+
+static void commit_minute(channel_store_t *store)
+{
+    rollup_acc_t *m = &store->minute_acc;
+    history_point_t p = acc_to_point(m);
+    ring_push(&store->minute, &p);
+
+    uint32_t hour_start = m->start - (m->start % HISTORY_HOUR_STEP_S);
+    if (store->hour_acc.active && store->hour_acc.start != hour_start) {
+        commit_hour(store);
+    }
+    acc_add(&store->hour_acc, hour_start, m->min, m->max, m->sum, m->count);
+
+    m->active = false;
+}
+
+// ==================== 公共接口 ====================
+
+esp_err_t history_init(void)
+{
+    if (s_pool != NULL) {
+        return ESP_OK;
+    }
+
+    const size_t raw_bytes = sizeof(raw_sample_t) * HISTORY_RAW_CAPACITY;
+    const size_t minute_bytes = sizeof(history_point_t) * HISTORY_MINUTE_CAPACITY;
+    const size_t hour_bytes = sizeof(history_point_t) * HISTORY_HOUR_CAPACITY;
+    const size_t per_channel = raw_bytes + minute_bytes + hour_bytes;
+    const size_t total = per_channel * HISTORY_CH_MAX;
+
+    s_pool = heap_caps_calloc(1, total, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (s_pool == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate %u bytes from PSRAM", (unsigned)total);
+        return ESP_ERR_NO_MEM;
+    }
+
+    s_mutex = xSemaphoreCreateMutex();
+    if (s_mutex == NULL) {
+        heap_caps_free(s_pool);
+        s_pool = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    uint8_t *p = (uint8_t *)s_pool;
+    for (int i = 0; i < HISTORY_CH_MAX; i++) {
+        channel_store_t *store = &s_channels[i];
+        memset(store, 0, sizeof(*store));
+        ring_setup(&store->raw, p, sizeof(raw_sample_t), HISTORY_RAW_CAPACITY);
+        p += raw_bytes;
+        ring_setup(&store->minute, p, sizeof(history_point_t), HISTORY_MINUTE_CAPACITY);
+        p += minute_bytes;
+        ring_setup(&store->hour, p, sizeof(history_point_t), HISTORY_HOUR_CAPACITY);
+        p += hour_bytes;
+    }
+
+    ESP_LOGI(TAG, "History store ready: %u bytes PSRAM (%d channels)",
+             (unsigned)total, HISTORY_CH_MAX);
+    return ESP_OK;
+}
+
+uint32_t history_now(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000000);
+}
+
+void history_record(history_channel_t ch, uint32_t ts_s, float value)
+{
+    if (s_pool == NULL || ch >= HISTORY_CH_MAX) {
+        return;
+    }
+
+    channel_store_t *store = &s_channels[ch];
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+
+    // 1. 原始层：每秒最多一个样本
+    if (store->raw.count == 0 ||
+        ts_s >= ring_ts(&store->raw, store->raw.count - 1) + HISTORY_RAW_STEP_S) {
+        raw_sample_t sample = { .ts = ts_s, .value = value };
+        ring_push(&store->raw, &sample);
+    }
+
+    // 2. 分钟累加器 (跨分钟时级联提交)
+    uint32_t minute_start = ts_s - (ts_s % HISTORY_MINUTE_STEP_S);
+    if (store->minute_acc.active && store->minute_acc.start != minute_start) {
+        commit_minute(store);
+    }
+    acc_add(&store->minute_acc, minute_start, value, value, value, 1);
+
+    xSemaphoreGive(s_mutex);
+}
+
+history_tier_t history_pick_tier(uint32_t step_s)
+{
+    if (step_s >= HISTORY_HOUR_STEP_S) {
+        return HISTORY_TIER_HOUR;
+    }
+    if (step_s >= HISTORY_MINUTE_STEP_S) {
+        return HISTORY_TIER_MINUTE;
+    }
+    return HISTORY_TIER_RAW;
+}
+
+size_t history_query(history_channel_t ch, history_tier_t tier, uint32_t *cursor_s,
+                     uint32_t to_s, uint32_t step_s, history_point_t *out, size_t max)
+{
+    if (s_pool == NULL || ch >= HISTORY_CH_MAX || tier >= HISTORY_TIER_MAX ||
+        cursor_s == NULL || out == NULL || max == 0) {
+        return 0;
+    }
+
+    if (step_s < s_tier_step[tier]) {
+        step_s = s_tier_step[tier];
+    }
+
+    channel_store_t *store = &s_channels[ch];
+    size_t n = 0;
+    uint32_t cursor = *cursor_s;
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+
+    if (tier == HISTORY_TIER_RAW) {
+        const ring_t *ring = &store->raw;
+        for (uint16_t i = ring_lower_bound(ring, cursor); i < ring->count && n < max; i++) {
+            const raw_sample_t *s = (const raw_sample_t *)ring_at(ring, i);
+            if (s->ts > to_s) {
+                break;
+            }
+            if (s->ts < cursor) {
+                continue;
+            }
+            out[n].ts = s->ts;
+            out[n].min = out[n].avg = out[n].max = s->value;
+            cursor = s->ts + step_s;
+            n++;
+        }
+    } else {
+        const ring_t *ring = (tier == HISTORY_TIER_MINUTE) ? &store->minute : &store->hour;
+        const rollup_acc_t *acc = (tier == HISTORY_TIER_MINUTE) ? &store->minute_acc : &store->hour_acc;
+
+        for (uint16_t i = ring_lower_bound(ring, cursor); i < ring->count && n < max; i++) {
+            const history_point_t *p = (const history_point_t *)ring_at(ring, i);
+            if (p->ts > to_s) {
+                break;
+            }
+            if (p->ts < cursor) {
+                continue;
+            }
+            out[n] = *p;
+            cursor = p->ts + step_s;
+            n++;
+        }
+
+        // 追加尚未结束的当前汇总区间，保证最新数据可见
+        if (n < max && acc->active && acc->start >= cursor && acc->start <= to_s) {
+            out[n] = acc_to_point(acc);
+            cursor = acc->start + step_s;
+            n++;
+        }
+    }
+
+    xSemaphoreGive(s_mutex);
+
+    *cursor_s = cursor;
+    return n;
+}
+
+const char *history_channel_name(history_channel_t ch)
+{
+    return (ch < HISTORY_CH_MAX) ? s_channel_names[ch] : "unknown";
+}
+
+bool history_channel_from_name(const char *name, history_channel_t *ch)
+{
+    if (name == NULL || ch == NULL) {
+        return false;
+    }
+    for (int i = 0; i < HISTORY_CH_MAX; i++) {
+        if (strcmp(name, s_channel_names[i]) == 0) {
+            *ch = (history_channel_t)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char *history_tier_name(history_tier_t tier)
+{
+    return (tier < HISTORY_TIER_MAX) ? s_tier_names[tier] : "unknown";
+}
@@ -0,0 +1,133 @@
+/**
+ * @file sensor_history.h
+ * @brief 传感器历史数据分层时序存储
+ *
+ * 固定内存占用 (PSRAM)，三级保留策略：
+ * - 原始层：每秒最多一个样本，保留最近 10 分钟
+ * - 分钟层：每分钟 min/avg/max，保留 24 小时
+ * - 小时层：每小时 min/avg/max，保留 30 天
+ *
+ * 汇总在写入时增量计算，查询不需要扫描下层数据。
+ * 时间戳为系统启动后的秒数。
+ */
+
+#ifndef SENSOR_HISTORY_H
+#define SENSOR_HISTORY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 各层分辨率 (秒) 与容量 (点)
+#define HISTORY_RAW_STEP_S      1
+#define HISTORY_RAW_CAPACITY    600     // 10 分钟
+#define HISTORY_MINUTE_STEP_S   60
+#define HISTORY_MINUTE_CAPACITY 1440    // 24 小时
+#define HISTORY_HOUR_STEP_S     3600
+#define HISTORY_HOUR_CAPACITY   720     // 30 天
+
+/**
+ * @brief 记录通道
+ */
+typedef enum {
+    HISTORY_CH_TEMPERATURE = 0,
+    HISTORY_CH_HUMIDITY,
+    HISTORY_CH_LIGHT,
+    HISTORY_CH_SMOKE,
+    HISTORY_CH_MAX
+} history_channel_t;
+
+/**
+ * @brief 存储层级
+ */
+typedef enum {
+    HISTORY_TIER_RAW = 0,
+    HISTORY_TIER_MINUTE,
+    HISTORY_TIER_HOUR,
+    HISTORY_TIER_MAX
+} history_tier_t;
+
+/**
+ * @brief 查询结果点 (原始层 min/avg/max 相同)
+ */
+typedef struct {
+    uint32_t ts;    // 区间起始时间 (秒)
+    float min;
+    float avg;
+    float max;
+} history_point_t;
+
+/**
+ * @brief 初始化历史存储 (从 PSRAM 分配全部缓冲区)
+ *
+ * @return esp_err_t ESP_OK 成功，ESP_ERR_NO_MEM 内存不足
+ */
+esp_err_t history_init(void);
+
+/**
+ * @brief 写入一个样本，并增量更新分钟/小时汇总
+ *
+ * @param ch 通道
+ * @param ts_s 时间戳 (秒)，需单调不减
+ * @param value 样本值
+ */
+void history_record(history_channel_t ch, uint32_t ts_s, float value);
+
+/**
+ * @brief 当前时间戳 (系统启动后的秒数)
+ */
+uint32_t history_now(void);
+
+/**
+ * @brief 按步长选择分辨率不超过步长的最粗层级
+ *
+ * @param step_s 期望步长 (秒)
+ * @return history_tier_t 层级
+ */
+history_tier_t history_pick_tier(uint32_t step_s);
+
+/**
+ * @brief 分批查询 [from_s, to_s] 内的点
+ *
+ * 每次最多返回 max 个点，相邻点间隔不小于 step_s。
+ * 调用方以 *cursor_s 作为游标反复调用直至返回 0，游标初值应为 from_s。
+ *
+ * @param ch 通道
+ * @param tier 层级
+ * @param cursor_s 游标 (输入起始时间，输出下一次起始时间)
+ * @param to_s 结束时间
+ * @param step_s 最小点间隔 (秒)
+ * @param out 输出数组
+ * @param max 数组容量
+ * @return size_t 本批点数
+ */
+size_t history_query(history_channel_t ch, history_tier_t tier, uint32_t *cursor_s,
+                     uint32_t to_s, uint32_t step_s, history_point_t *out, size_t max);
+
+/**
+ * @brief 通道名称 ("temperature"/"humidity"/"light"/"smoke")
+ */
+const char *history_channel_name(history_channel_t ch);
+
+/**
+ * @brief 按名称查找通道
+ *
+ * @return true 找到
+ */
+bool history_channel_from_name(const char *name, history_channel_t *ch);
+
+/**
+ * @brief 层级名称 ("raw"/"minute"/"hour")
+ */
+const char *history_tier_name(history_tier_t tier);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SENSOR_HISTORY_H
@@ -1,14 +1,67 @@
 #include "led.h"
 #include "driver/ledc.h"
+#include "esp_attr.h"
 #include "esp_log.h"
 
 static const char *TAG = "LED";
 
 #define LED_PWM_FREQ 5000
-#define LED_PWM_RESOLUTION LEDC_TIMER_8_BIT
+// 80MHz / 5kHz = 16000 个时钟，13 位分辨率 (8192 级) 为该频率下的上限
+#define LED_PWM_RESOLUTION LEDC_TIMER_13_BIT
+
+// 亮度 (0-255) → 13 位占空的感知校正表 (gamma 2.2，非零亮度至少为 1)
+static const uint16_t s_gamma_lut[256] = {
+       0,    1,    1,    1,    1,    1,    2,    3,    4,    5,    7,    8,
+      10,   12,   14,   16,   19,   21,   24,   27,   30,   34,   37,   41,
+      45,   49,   54,   59,   63,   69,   74,   79,   85,   91,   97,  104,
+     110,  117,  124,  132,  139,  147,  155,  163,  172,  180,  189,  198,
+     208,  217,  227,  237,  248,  258,  269,  280,  292,  303,  315,  327,
+     340,  352,  365,  378,  391,  405,  419,  433,  447,  462,  477,  492,
+     507,  523,  539,  555,  571,  588,  605,  622,  639,  657,  675,  693,
+     712,  731,  750,  769,  789,  808,  828,  849,  870,  890,  912,  933,
+     955,  977,  999, 1022, 1045, 1068, 1091, 1115, 1139, 1163, 1187, 1212,
+    1237, 1263, 1288, 1314, 1340, 1367, 1394, 1421, 1448, 1476, 1503, 1532,
+    1560, 1589, 1618, 1647, 1677, 1707, 1737, 1767, 1798, 1829, 1860, 1892,
+    1924, 1956, 1989, 2022, 2055, 2088, 2122, 2156, 2190, 2224, 2259, 2294,
+    2330, 2366, 2402, 2438, 2475, 2512, 2549, 2586, 2624, 2662, 2701, 2740,
+    2779, 2818, 2858, 2897, 2938, 2978, 3019, 3060, 3102, 3143, 3186, 3228,
+    3271, 3314, 3357, 3400, 3444, 3489, 3533, 3578, 3623, 3669, 3714, 3760,
+    3807, 3853, 3900, 3948, 3995, 4043, 4091, 4140, 4189, 4238, 4288, 4337,
+    4387, 4438, 4489, 4540, 4591, 4643, 4695, 4747, 4800, 4853, 4906, 4960,
+    5013, 5068, 5122, 5177, 5232, 5288, 5344, 5400, 5456, 5513, 5570, 5627,
+    5685, 5743, 5802, 5860, 5919, 5979, 6038, 6098, 6159, 6219, 6280, 6342,
+    6403, 6465, 6528, 6590, 6653, 6716, 6780, 6844, 6908, 6973, 7037, 7103,
+    7168, 7234, 7300, 7367, 7434, 7501, 7568, 7636, 7704, 7773, 7842, 7911,
+    7980, 8050, 8120, 8191,
+};
+
+static bool s_fade_ready = false;
+static volatile bool s_fading[LEDC_CHANNEL_MAX];
+
+// 渐变结束中断：只清除状态，不唤醒任务
+static bool IRAM_ATTR led_fade_end_cb(const ledc_cb_param_t *param, void *user_arg)
+{
+    if (param->event == LEDC_FADE_END_EVT && param->channel < LEDC_CHANNEL_MAX) {
+        s_fading[param->channel] = false;
+    }
+    return false;
+}
+
+// 新的写入前中止进行中的渐变，否则硬件渐变结束前会阻塞
+static void led_fade_cancel(uint8_t channel)
+{
+    if (s_fading[channel]) {
+        ledc_fade_stop(LEDC_LOW_SPEED_MODE, channel);
+        s_fading[channel] = false;
+    }
+}
 
 esp_err_t led_init(uint8_t gpio_num, uint8_t channel)
 {
+    if (channel >= LEDC_CHANNEL_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
     // 配置定时器
     ledc_timer_config_t ledc_timer = {
         .speed_mode = LEDC_LOW_SPEED_MODE,
@@ -40,6 +93,16 @@ esp_err_t led_init(uint8_t gpio_num, uint8_t channel)
         ESP_LOGE(TAG, "LEDC channel config failed");
         return ret;
     }
+
+    // 硬件渐变 (与风扇共用渐变服务，已安装时返回 ESP_ERR_INVALID_STATE)
+    ret = ledc_fade_func_install(0);
+    if (ret == ESP_OK || ret == ESP_ERR_INVALID_STATE) {
+        ledc_cbs_t cbs = { .fade_cb = led_fade_end_cb };
+        s_fade_ready = (ledc_cb_register(LEDC_LOW_SPEED_MODE, channel, &cbs, NULL) == ESP_OK);
+    }
+    if (!s_fade_ready) {
+        ESP_LOGW(TAG, "LEDC fade unavailable, brightness changes will be immediate");
+    }
     
     ESP_LOGI(TAG, "LED initialized on GPIO %d, channel %d", gpio_num, channel);
     return ESP_OK;
@@ -47,20 +110,46 @@ esp_err_t led_init(uint8_t gpio_num, uint8_t channel)
 
 esp_err_t led_set_brightness(uint8_t channel, uint8_t brightness)
 {
-    esp_err_t ret = ledc_set_duty(LEDC_LOW_SPEED_MODE, channel, brightness);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Set duty failed");
-        return ret;
+    return led_fade_to(channel, brightness, 0);
+}
+
+esp_err_t led_fade_to(uint8_t channel, uint8_t brightness, uint32_t fade_ms)
+{
+    if (channel >= LEDC_CHANNEL_MAX) {
+        return ESP_ERR_INVALID_ARG;
     }
-    
-    ret = ledc_update_duty(LEDC_LOW_SPEED_MODE, channel);
+
+    uint32_t duty = s_gamma_lut[brightness];
+    esp_err_t ret;
+
+    if (!s_fade_ready) {
+        ret = ledc_set_duty(LEDC_LOW_SPEED_MODE, channel, duty);
+        if (ret == ESP_OK) {
+            ret = ledc_update_duty(LEDC_LOW_SPEED_MODE, channel);
+        }
+    } else {
+        led_fade_cancel(channel);
+        if (fade_ms == 0) {
+            ret = ledc_set_duty_and_update(LEDC_LOW_SPEED_MODE, channel, duty, 0);
+        } else {
+            s_fading[channel] = true;
+            ret = ledc_set_fade_time_and_start(LEDC_LOW_SPEED_MODE, channel, duty, fade_ms,
+                                               LEDC_FADE_NO_WAIT);
+            if (ret != ESP_OK) {
+                s_fading[channel] = false;
+            }
+        }
+    }
+
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Update duty failed");
-        return ret;
+        ESP_LOGE(TAG, "Set duty failed");
     }
-    
-    // ESP_LOGI(TAG, "LED brightness set to %d", brightness);
-    return ESP_OK;
+    return ret;
+}
+
+bool led_is_fading(uint8_t channel)
+{
+    return (channel < LEDC_CHANNEL_MAX) && s_fading[channel];
 }
 
 esp_err_t led_on(uint8_t channel)
@@ -75,6 +164,11 @@ esp_err_t led_off(uint8_t channel)
 
 esp_err_t led_deinit(uint8_t channel)
 {
+    if (channel < LEDC_CHANNEL_MAX && s_fade_ready) {
+        led_fade_cancel(channel);
+        ledc_cb_register(LEDC_LOW_SPEED_MODE, channel, &(ledc_cbs_t){ .fade_cb = NULL }, NULL);
+    }
+
     esp_err_t ret = ledc_stop(LEDC_LOW_SPEED_MODE, channel, 0);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "LEDC stop failed");
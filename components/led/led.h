@@ -2,6 +2,7 @@
 #define LED_H
 
 #include <stdint.h>
+#include <stdbool.h>
 #include "esp_err.h"
 
 /**
@@ -15,6 +16,8 @@ esp_err_t led_init(uint8_t gpio_num, uint8_t channel);
 
 /**
  * @brief 设置 LED 亮度
+ *
+ * 亮度经 gamma 校正表映射为 13 位占空，立即生效 (中止进行中的渐变)。
  * 
  * @param channel PWM通道
  * @param brightness 亮度值（0-255）
@@ -22,6 +25,23 @@ esp_err_t led_init(uint8_t gpio_num, uint8_t channel);
  */
 esp_err_t led_set_brightness(uint8_t channel, uint8_t brightness);
 
+/**
+ * @brief 由 LEDC 硬件渐变到目标亮度 (立即返回，渐变期间不占用 CPU)
+ *
+ * 进行中的渐变会被中止，从当前占空开始新的渐变。
+ *
+ * @param channel PWM通道
+ * @param brightness 目标亮度（0-255）
+ * @param fade_ms 渐变时间（毫秒），0 表示立即生效
+ * @return esp_err_t ESP_OK 成功，其他值失败
+ */
+esp_err_t led_fade_to(uint8_t channel, uint8_t brightness, uint32_t fade_ms);
+
+/**
+ * @brief 通道是否正在渐变
+ */
+bool led_is_fading(uint8_t channel);
+
 /**
  * @brief 打开 LED
  * 
@@ -1,10 +1,16 @@
 /**
  * @file bh1750_driver.c
  * @brief BH1750 光照传感器驱动封装 (使用 esp-idf-lib/bh1750 组件)
+ *
+ * 单次测量模式，触发与取回分离：
+ * - trigger 只发送测量命令，collect 在转换时间到达后才读取
+ * - 光照变化剧烈时切换到低分辨率 (24ms)，连续稳定后恢复高分辨率 (180ms)
  */
 
 #include <string.h>
+#include <math.h>
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 
@@ -17,10 +23,26 @@
 
 static const char *TAG = "BH1750";
 
+// 转换时间 (数据手册最大值，微秒)
+#define BH1750_CONV_HIGH_US     180000
+#define BH1750_CONV_LOW_US      24000
+
+// 自适应分辨率：变化量超过 max(绝对阈值, 相对阈值 × 上次值) 即进入快速模式
+#define BH1750_FAST_ABS_LUX     20.0f
+#define BH1750_FAST_REL         0.15f
+#define BH1750_STABLE_SAMPLES   8       // 连续稳定次数后恢复高分辨率
+
 // esp-idf-lib 使用 i2cdev 库管理 I2C
 static i2c_dev_t s_dev = {0};
 static bool s_initialized = false;
 
+// 转换状态
+static bool s_pending = false;
+static bool s_fast = false;
+static int64_t s_ready_at_us = 0;
+static float s_last_lux = -1.0f;
+static uint8_t s_stable_count = 0;
+
 esp_err_t bh1750_sensor_init(uint8_t sda_gpio, uint8_t scl_gpio)
 {
     // 初始化 i2cdev 库 (全局只需调用一次)
@@ -48,30 +70,73 @@ esp_err_t bh1750_sensor_init(uint8_t sda_gpio, uint8_t scl_gpio)
         return ret;
     }
 
-    // 设置连续高分辨率测量模式
-    ret = bh1750_setup(&s_dev, BH1750_MODE_CONTINUOUS, BH1750_RES_HIGH);
+    s_pending = false;
+    s_fast = false;
+    s_last_lux = -1.0f;
+    s_stable_count = 0;
+    s_initialized = true;
+    ESP_LOGI(TAG, "BH1750 initialized (SDA:%d, SCL:%d) using esp-idf-lib/bh1750",
+             sda_gpio, scl_gpio);
+    return ESP_OK;
+}
+
+esp_err_t bh1750_sensor_trigger(void)
+{
+    if (!s_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // 单次测量结束后传感器自动掉电，需先上电再发送测量命令
+    esp_err_t ret = bh1750_power_on(&s_dev);
+    if (ret == ESP_OK) {
+        ret = bh1750_setup(&s_dev, BH1750_MODE_ONE_TIME,
+                           s_fast ? BH1750_RES_LOW : BH1750_RES_HIGH);
+    }
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "BH1750 setup failed: %s", esp_err_to_name(ret));
-        bh1750_free_desc(&s_dev);
+        ESP_LOGE(TAG, "Failed to start measurement: %s", esp_err_to_name(ret));
         return ret;
     }
 
-    s_initialized = true;
-    ESP_LOGI(TAG, "BH1750 initialized (SDA:%d, SCL:%d) using esp-idf-lib/bh1750",
-             sda_gpio, scl_gpio);
+    s_ready_at_us = esp_timer_get_time() + (s_fast ? BH1750_CONV_LOW_US : BH1750_CONV_HIGH_US);
+    s_pending = true;
     return ESP_OK;
 }
 
-esp_err_t bh1750_sensor_read(float *lux)
+// 根据变化速度选择下次转换的分辨率
+static void adapt_resolution(float lux)
+{
+    if (s_last_lux >= 0.0f) {
+        float threshold = fmaxf(BH1750_FAST_ABS_LUX, s_last_lux * BH1750_FAST_REL);
+        if (fabsf(lux - s_last_lux) > threshold) {
+            if (!s_fast) {
+                ESP_LOGD(TAG, "Fast mode (%.0f -> %.0f lux)", s_last_lux, lux);
+            }
+            s_fast = true;
+            s_stable_count = 0;
+        } else if (s_fast && ++s_stable_count >= BH1750_STABLE_SAMPLES) {
+            ESP_LOGD(TAG, "Back to high resolution");
+            s_fast = false;
+            s_stable_count = 0;
+        }
+    }
+    s_last_lux = lux;
+}
+
+esp_err_t bh1750_sensor_collect(float *lux)
 {
     if (lux == NULL) {
         return ESP_ERR_INVALID_ARG;
     }
 
-    if (!s_initialized) {
+    if (!s_initialized || !s_pending) {
         return ESP_ERR_INVALID_STATE;
     }
 
+    if (esp_timer_get_time() < s_ready_at_us) {
+        return ESP_ERR_NOT_FINISHED;
+    }
+    s_pending = false;
+
     uint16_t level = 0;
     // 调用 esp-idf-lib 的 bh1750_read 函数
     esp_err_t ret = bh1750_read(&s_dev, &level);
@@ -81,16 +146,52 @@ esp_err_t bh1750_sensor_read(float *lux)
     }
 
     *lux = (float)level;
-    ESP_LOGD(TAG, "Light intensity: %.1f lux", *lux);
+    adapt_resolution(*lux);
+    ESP_LOGD(TAG, "Light intensity: %.1f lux (%s)", *lux, s_fast ? "fast" : "high-res");
     return ESP_OK;
 }
 
+esp_err_t bh1750_sensor_read_async(float *lux)
+{
+    if (!s_pending) {
+        esp_err_t ret = bh1750_sensor_trigger();
+        return (ret == ESP_OK) ? ESP_ERR_NOT_FINISHED : ret;
+    }
+    return bh1750_sensor_collect(lux);
+}
+
+esp_err_t bh1750_sensor_read(float *lux)
+{
+    if (lux == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!s_pending) {
+        esp_err_t ret = bh1750_sensor_trigger();
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+
+    int64_t wait_us = s_ready_at_us - esp_timer_get_time();
+    if (wait_us > 0) {
+        vTaskDelay(pdMS_TO_TICKS((wait_us + 999) / 1000) + 1);
+    }
+    return bh1750_sensor_collect(lux);
+}
+
+bool bh1750_sensor_is_fast(void)
+{
+    return s_fast;
+}
+
 void bh1750_sensor_deinit(void)
 {
     if (s_initialized) {
         bh1750_power_down(&s_dev);
         bh1750_free_desc(&s_dev);
         s_initialized = false;
+        s_pending = false;
         ESP_LOGI(TAG, "BH1750 deinitialized");
     }
 }
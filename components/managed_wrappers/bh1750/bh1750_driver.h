@@ -2,11 +2,14 @@
 #define BH1750_DRIVER_H
 
 #include <stdint.h>
+#include <stdbool.h>
 #include "esp_err.h"
 
 /**
  * @brief 初始化 BH1750 光照传感器 (使用 esp-idf-lib/bh1750 组件)
  *
+ * 传感器工作在单次测量模式，由 bh1750_sensor_trigger() 启动每次转换。
+ *
  * @param sda_gpio SDA引脚
  * @param scl_gpio SCL引脚
  * @return esp_err_t ESP_OK 成功，其他值失败
@@ -14,13 +17,49 @@
 esp_err_t bh1750_sensor_init(uint8_t sda_gpio, uint8_t scl_gpio);
 
 /**
- * @brief 读取 BH1750 光照强度
+ * @brief 启动一次转换 (立即返回)
+ *
+ * 按当前分辨率发出单次测量命令：高分辨率最长 180ms，低分辨率最长 24ms。
+ *
+ * @return esp_err_t ESP_OK 成功，其他值失败
+ */
+esp_err_t bh1750_sensor_trigger(void);
+
+/**
+ * @brief 取回转换结果
+ *
+ * 转换时间未到时不访问 I2C，直接返回 ESP_ERR_NOT_FINISHED。
+ * 取回后根据光照变化速度自动切换下次转换的分辨率。
+ *
+ * @param lux 输出光照强度（lux）
+ * @return esp_err_t ESP_OK 成功，ESP_ERR_NOT_FINISHED 转换进行中，
+ *         ESP_ERR_INVALID_STATE 未触发转换，其他值失败
+ */
+esp_err_t bh1750_sensor_collect(float *lux);
+
+/**
+ * @brief 非阻塞读取：无转换进行时触发并返回 ESP_ERR_NOT_FINISHED，否则取回结果
+ *
+ * @param lux 输出光照强度（lux）
+ * @return esp_err_t ESP_OK 成功，ESP_ERR_NOT_FINISHED 转换进行中，其他值失败
+ */
+esp_err_t bh1750_sensor_read_async(float *lux);
+
+/**
+ * @brief 读取 BH1750 光照强度 (阻塞直到转换完成)
  *
  * @param lux 输出光照强度（lux）
  * @return esp_err_t ESP_OK 成功，其他值失败
  */
 esp_err_t bh1750_sensor_read(float *lux);
 
+/**
+ * @brief 当前是否处于快速 (低分辨率) 模式
+ *
+ * 光照快速变化时为 true，调用方可据此缩短采样周期。
+ */
+bool bh1750_sensor_is_fast(void);
+
 /**
  * @brief 反初始化 BH1750
  */
@@ -0,0 +1,78 @@
+/**
+ * @file dht_decode.c
+ * @brief DHT11 单总线波形解码实现
+ */
+
+#include "dht_decode.h"
+#include <stdbool.h>
+#include <string.h>
+
+// 脉宽容差 (微秒)，覆盖 DHT11 手册典型值及 RMT 量化误差
+#define RESPONSE_MIN_US   60
+#define RESPONSE_MAX_US   110
+#define BIT_LOW_MIN_US    30
+#define BIT_LOW_MAX_US    80
+#define BIT_HIGH_MIN_US   10
+#define BIT_HIGH_MAX_US   100
+#define BIT_ONE_THRESH_US 48
+
+static inline bool pulse_in(const dht_pulse_t *p, uint8_t level, uint16_t min_us, uint16_t max_us)
+{
+    return p->level == level && p->duration_us >= min_us && p->duration_us <= max_us;
+}
+
+esp_err_t dht_decode_pulses(const dht_pulse_t *pulses, size_t count,
+                            uint8_t frame[DHT_FRAME_BYTES])
+{
+    if (pulses == NULL || frame == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // 1. 定位应答：低 80us + 高 80us
+    size_t i = 0;
+    while (i + 1 < count &&
+           !(pulse_in(&pulses[i], 0, RESPONSE_MIN_US, RESPONSE_MAX_US) &&
+             pulse_in(&pulses[i + 1], 1, RESPONSE_MIN_US, RESPONSE_MAX_US))) {
+        i++;
+    }
+    if (i + 1 >= count) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    i += 2;
+
+    if (count - i < DHT_FRAME_BITS * 2) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    // 2. 逐位解码，高位在前
+    memset(frame, 0, DHT_FRAME_BYTES);
+    for (int bit = 0; bit < DHT_FRAME_BITS; bit++, i += 2) {
+        if (!pulse_in(&pulses[i], 0, BIT_LOW_MIN_US, BIT_LOW_MAX_US) ||
+            !pulse_in(&pulses[i + 1], 1, BIT_HIGH_MIN_US, BIT_HIGH_MAX_US)) {
+            return ESP_ERR_INVALID_RESPONSE;
+        }
+        if (pulses[i + 1].duration_us > BIT_ONE_THRESH_US) {
+            frame[bit / 8] |= (uint8_t)(0x80 >> (bit % 8));
+        }
+    }
+
+    // 3. 校验和
+    uint8_t sum = (uint8_t)(frame[0] + frame[1] + frame[2] + frame[3]);
+    if (sum != frame[4]) {
+        return ESP_ERR_INVALID_CRC;
+    }
+    return ESP_OK;
+}
+
+void dht11_frame_to_values(const uint8_t frame[DHT_FRAME_BYTES],
+                           float *temperature, float *humidity)
+{
+    // DHT11：整数 + 0.1 精度小数，温度小数字节最高位为负号
+    if (humidity != NULL) {
+        *humidity = frame[0] + frame[1] * 0.1f;
+    }
+    if (temperature != NULL) {
+        float t = frame[2] + (frame[3] & 0x0F) * 0.1f;
+        *temperature = (frame[3] & 0x80) ? -t : t;
+    }
+}
@@ -0,0 +1,61 @@
+/**
+ * @file dht_decode.h
+ * @brief DHT11 单总线波形解码 (与硬件无关)
+ *
+ * 输入为按时间顺序排列的电平脉冲 (电平 + 持续时间)，
+ * 由 RMT 接收结果转换而来，也可直接使用录制的波形离线验证。
+ */
+
+#ifndef DHT_DECODE_H
+#define DHT_DECODE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DHT_FRAME_BYTES 5
+#define DHT_FRAME_BITS  (DHT_FRAME_BYTES * 8)
+
+/**
+ * @brief 单个电平脉冲
+ */
+typedef struct {
+    uint8_t level;          // 0 低电平，1 高电平
+    uint16_t duration_us;   // 持续时间 (微秒)
+} dht_pulse_t;
+
+/**
+ * @brief 从脉冲序列解码 5 字节数据帧
+ *
+ * 先定位传感器应答 (约 80us 低 + 80us 高)，随后每位为约 50us 低电平
+ * 加高电平，高电平约 26us 为 0、约 70us 为 1。
+ *
+ * @param pulses 脉冲序列
+ * @param count 脉冲数量
+ * @param frame 输出数据帧
+ * @return esp_err_t ESP_OK 成功，ESP_ERR_NOT_FOUND 未找到应答，
+ *         ESP_ERR_INVALID_SIZE 数据位不足，ESP_ERR_INVALID_RESPONSE 脉宽异常，
+ *         ESP_ERR_INVALID_CRC 校验和错误
+ */
+esp_err_t dht_decode_pulses(const dht_pulse_t *pulses, size_t count,
+                            uint8_t frame[DHT_FRAME_BYTES]);
+
+/**
+ * @brief 将 DHT11 数据帧转换为温湿度
+ *
+ * @param frame 已通过校验的数据帧
+ * @param temperature 输出温度 (℃)
+ * @param humidity 输出湿度 (%)
+ */
+void dht11_frame_to_values(const uint8_t frame[DHT_FRAME_BYTES],
+                           float *temperature, float *humidity);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DHT_DECODE_H
@@ -1,19 +1,46 @@
 /**
  * @file dht_driver.c
- * @brief DHT11 温湿度传感器驱动封装 (使用 esp-idf-lib/dht 组件)
+ * @brief DHT11 温湿度传感器驱动封装
+ *
+ * 两种后端：
+ * - 位翻转：esp-idf-lib/dht 组件，读取期间忙等并进入临界区
+ * - RMT：起始信号由 esp_timer 释放，RMT RX 硬件捕获应答波形，
+ *   接收完成中断释放信号量，解码在调用方任务中完成
  */
 
 #include "dht_driver.h"
+#include "dht_decode.h"
 #include <dht.h>
+#include "driver/gpio.h"
+#include "driver/rmt_rx.h"
+#include "esp_timer.h"
 #include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
 
 static const char *TAG = "DHT11";
 
+#define DHT_RMT_RESOLUTION_HZ  1000000     // 1 tick = 1us
+#define DHT_RMT_MEM_SYMBOLS    64
+#define DHT_START_LOW_US       20000       // 起始信号低电平 (>= 18ms)
+#define DHT_RX_TIMEOUT_US      100000      // 单次转换超时
+
 static gpio_num_t s_dht_gpio = GPIO_NUM_NC;
 
+// RMT 后端状态
+static bool s_use_rmt = false;
+static rmt_channel_handle_t s_rx_chan = NULL;
+static esp_timer_handle_t s_start_timer = NULL;
+static SemaphoreHandle_t s_rx_done = NULL;
+static rmt_symbol_word_t s_rx_symbols[DHT_RMT_MEM_SYMBOLS];
+static volatile size_t s_rx_count = 0;
+static bool s_busy = false;
+static int64_t s_trigger_us = 0;
+
 esp_err_t dht11_init(uint8_t gpio_num)
 {
     s_dht_gpio = (gpio_num_t)gpio_num;
+    s_use_rmt = false;
 
     // esp-idf-lib/dht 组件不需要显式初始化
     // 只需记录 GPIO 引脚，读取时会自动配置
@@ -21,6 +48,192 @@ esp_err_t dht11_init(uint8_t gpio_num)
     return ESP_OK;
 }
 
+// ==================== RMT 后端 ====================
+
+static bool IRAM_ATTR dht_rx_done_cb(rmt_channel_handle_t chan,
+                                     const rmt_rx_done_event_data_t *edata, void *user_ctx)
+{
+    BaseType_t woken = pdFALSE;
+    s_rx_count = edata->num_symbols;
+    xSemaphoreGiveFromISR(s_rx_done, &woken);
+    return woken == pdTRUE;
+}
+
+// 起始信号低电平结束：先启动接收再释放总线，保证应答沿不丢失
+static void dht_start_timer_cb(void *arg)
+{
+    rmt_receive_config_t rx_cfg = {
+        .signal_range_min_ns = 1000,        // 滤除 <1us 毛刺
+        .signal_range_max_ns = 200 * 1000,  // 200us 无跳变视为帧结束
+    };
+
+    if (rmt_receive(s_rx_chan, s_rx_symbols, sizeof(s_rx_symbols), &rx_cfg) != ESP_OK) {
+        s_rx_count = 0;
+        xSemaphoreGive(s_rx_done);
+    }
+    gpio_set_level(s_dht_gpio, 1);
+}
+
+esp_err_t dht11_init_rmt(uint8_t gpio_num)
+{
+    if (s_rx_chan != NULL) {
+        return ESP_OK;
+    }
+
+    s_rx_done = xSemaphoreCreateBinary();
+    if (s_rx_done == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    rmt_rx_channel_config_t chan_cfg = {
+        .gpio_num = gpio_num,
+        .clk_src = RMT_CLK_SRC_DEFAULT,
+        .resolution_hz = DHT_RMT_RESOLUTION_HZ,
+        .mem_block_symbols = DHT_RMT_MEM_SYMBOLS,
+    };
+    esp_err_t ret = rmt_new_rx_channel(&chan_cfg, &s_rx_chan);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create RMT RX channel: %s", esp_err_to_name(ret));
+        goto fail;
+    }
+
+    rmt_rx_event_callbacks_t cbs = {
+        .on_recv_done = dht_rx_done_cb,
+    };
+    ret = rmt_rx_register_event_callbacks(s_rx_chan, &cbs, NULL);
+    if (ret == ESP_OK) {
+        ret = rmt_enable(s_rx_chan);
+    }
+    if (ret != ESP_OK) {
+        goto fail;
+    }
+
+    // RMT 已接管输入；同一引脚再配置为开漏输出用于发送起始信号
+    gpio_set_pull_mode(gpio_num, GPIO_PULLUP_ONLY);
+    gpio_set_direction(gpio_num, GPIO_MODE_INPUT_OUTPUT_OD);
+    gpio_set_level(gpio_num, 1);
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = dht_start_timer_cb,
+        .name = "dht_start",
+    };
+    ret = esp_timer_create(&timer_args, &s_start_timer);
+    if (ret != ESP_OK) {
+        goto fail;
+    }
+
+    s_dht_gpio = (gpio_num_t)gpio_num;
+    s_use_rmt = true;
+    s_busy = false;
+    ESP_LOGI(TAG, "DHT11 initialized on GPIO %d (RMT RX)", gpio_num);
+    return ESP_OK;
+
+fail:
+    if (s_rx_chan != NULL) {
+        rmt_disable(s_rx_chan);
+        rmt_del_channel(s_rx_chan);
+        s_rx_chan = NULL;
+    }
+    vSemaphoreDelete(s_rx_done);
+    s_rx_done = NULL;
+    return ret;
+}
+
+static esp_err_t rmt_trigger(void)
+{
+    xSemaphoreTake(s_rx_done, 0);   // 清除残留信号
+    s_rx_count = 0;
+
+    gpio_set_level(s_dht_gpio, 0);
+    esp_err_t ret = esp_timer_start_once(s_start_timer, DHT_START_LOW_US);
+    if (ret != ESP_OK) {
+        gpio_set_level(s_dht_gpio, 1);
+        return ret;
+    }
+
+    s_busy = true;
+    s_trigger_us = esp_timer_get_time();
+    return ESP_OK;
+}
+
+static esp_err_t rmt_collect(dht11_data_t *data)
+{
+    s_busy = false;
+
+    // 转换为与硬件无关的脉冲序列
+    dht_pulse_t pulses[DHT_RMT_MEM_SYMBOLS * 2];
+    size_t n = 0;
+    for (size_t i = 0; i < s_rx_count && i < DHT_RMT_MEM_SYMBOLS; i++) {
+        const rmt_symbol_word_t *sym = &s_rx_symbols[i];
+        if (sym->duration0 > 0) {
+            pulses[n++] = (dht_pulse_t){ .level = sym->level0, .duration_us = sym->duration0 };
+        }
+        if (sym->duration1 > 0) {
+            pulses[n++] = (dht_pulse_t){ .level = sym->level1, .duration_us = sym->duration1 };
+        }
+    }
+
+    uint8_t frame[DHT_FRAME_BYTES];
+    esp_err_t ret = dht_decode_pulses(pulses, n, frame);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to decode DHT11 (%u pulses): %s",
+                 (unsigned)n, esp_err_to_name(ret));
+        data->valid = 0;
+        return ret;
+    }
+
+    dht11_frame_to_values(frame, &data->temperature, &data->humidity);
+    data->valid = 1;
+
+    ESP_LOGD(TAG, "Temperature: %.1f C, Humidity: %.1f%%",
+             data->temperature, data->humidity);
+    return ESP_OK;
+}
+
+// 超时：中止本次接收，下次调用重新触发
+static void rmt_abort(void)
+{
+    esp_timer_stop(s_start_timer);
+    rmt_disable(s_rx_chan);
+    rmt_enable(s_rx_chan);
+    gpio_set_level(s_dht_gpio, 1);
+    s_busy = false;
+}
+
+// ==================== 公共接口 ====================
+
+esp_err_t dht11_read_async(dht11_data_t *data)
+{
+    if (data == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (s_dht_gpio == GPIO_NUM_NC) {
+        data->valid = 0;
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (!s_use_rmt) {
+        return dht11_read(data);
+    }
+
+    if (!s_busy) {
+        esp_err_t ret = rmt_trigger();
+        return (ret == ESP_OK) ? ESP_ERR_NOT_FINISHED : ret;
+    }
+
+    if (xSemaphoreTake(s_rx_done, 0) == pdTRUE) {
+        return rmt_collect(data);
+    }
+
+    if (esp_timer_get_time() - s_trigger_us > DHT_RX_TIMEOUT_US) {
+        rmt_abort();
+        data->valid = 0;
+        return ESP_ERR_TIMEOUT;
+    }
+    return ESP_ERR_NOT_FINISHED;
+}
+
 esp_err_t dht11_read(dht11_data_t *data)
 {
     if (data == NULL) {
@@ -32,6 +245,23 @@ esp_err_t dht11_read(dht11_data_t *data)
         return ESP_ERR_INVALID_STATE;
     }
 
+    if (s_use_rmt) {
+        // 阻塞于信号量而非忙等
+        if (!s_busy) {
+            esp_err_t ret = rmt_trigger();
+            if (ret != ESP_OK) {
+                data->valid = 0;
+                return ret;
+            }
+        }
+        if (xSemaphoreTake(s_rx_done, pdMS_TO_TICKS(DHT_RX_TIMEOUT_US / 1000)) != pdTRUE) {
+            rmt_abort();
+            data->valid = 0;
+            return ESP_ERR_TIMEOUT;
+        }
+        return rmt_collect(data);
+    }
+
     // 使用 esp-idf-lib 的 dht_read_float_data 函数直接获取浮点值
     float temperature = 0;
     float humidity = 0;
@@ -57,6 +287,18 @@ esp_err_t dht11_read(dht11_data_t *data)
 
 void dht11_deinit(void)
 {
+    if (s_rx_chan != NULL) {
+        esp_timer_stop(s_start_timer);
+        esp_timer_delete(s_start_timer);
+        s_start_timer = NULL;
+        rmt_disable(s_rx_chan);
+        rmt_del_channel(s_rx_chan);
+        s_rx_chan = NULL;
+        vSemaphoreDelete(s_rx_done);
+        s_rx_done = NULL;
+    }
+    s_use_rmt = false;
+    s_busy = false;
     s_dht_gpio = GPIO_NUM_NC;
     ESP_LOGI(TAG, "DHT11 deinitialized");
 }
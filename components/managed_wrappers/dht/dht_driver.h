@@ -20,13 +20,35 @@ typedef struct {
 esp_err_t dht11_init(uint8_t gpio_num);
 
 /**
- * @brief 读取 DHT11 传感器数据
+ * @brief 读取 DHT11 传感器数据 (阻塞直到完成)
  *
  * @param data 输出数据结构指针
  * @return esp_err_t ESP_OK 成功，其他值失败
  */
 esp_err_t dht11_read(dht11_data_t *data);
 
+/**
+ * @brief 初始化 DHT11 (RMT 接收后端)
+ *
+ * 起始信号由 esp_timer 定时释放，应答波形由 RMT RX 硬件捕获，
+ * 全过程无忙等、无临界区。
+ *
+ * @param gpio_num GPIO 引脚号
+ * @return esp_err_t ESP_OK 成功，其他值失败
+ */
+esp_err_t dht11_init_rmt(uint8_t gpio_num);
+
+/**
+ * @brief 非阻塞读取 DHT11
+ *
+ * RMT 后端：首次调用发出起始信号并返回 ESP_ERR_NOT_FINISHED，
+ * 接收完成后再次调用返回结果。位翻转后端：等同于 dht11_read()。
+ *
+ * @param data 输出数据结构指针
+ * @return esp_err_t ESP_OK 成功，ESP_ERR_NOT_FINISHED 转换进行中，其他值失败
+ */
+esp_err_t dht11_read_async(dht11_data_t *data);
+
 /**
  * @brief 反初始化 DHT11 (重置状态)
  */
@@ -2,19 +2,64 @@
  * @file rgb_led.c
  * @brief ESP32-S3 板载 RGB LED 驱动实现
  *
- * 使用 Espressif led_strip 组件驱动 WS2812 RGB LED
+ * 使用 Espressif led_strip 组件驱动 WS2812 RGB LED。
+ * 帧调度：esp_timer (RGB_LED_FRAME_MS) 渲染到后缓冲，与前缓冲相同则丢弃，
+ * 否则交换缓冲并通知渲染任务；渲染任务在锁外执行 RMT 发送，调用方从不等待刷新。
  */
 
 #include "rgb_led.h"
 #include "led_strip.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
+#include <string.h>
 
 static const char *TAG = "RGB_LED";
 
+#define RGB_LED_TASK_STACK      2048
+#define RGB_LED_TASK_PRIORITY   2       // 与 TASK_PRIORITY_LOW 一致
+#define RGB_LED_LEVEL_SCALE     256     // 亮度包络定点倍数
+#define RGB_LED_ATTACK_SHIFT    1       // 上升：每帧逼近剩余差值的 1/2
+#define RGB_LED_DECAY_SHIFT     3       // 下降：每帧逼近剩余差值的 1/8
+#define RGB_LED_BREATHE_FLOOR   16      // 呼吸最暗处 (0-255)
+
+typedef enum {
+    BASE_FADE = 0,      // 常亮 (渐变结束后即为静止画面)
+    BASE_BREATHE,
+} base_mode_t;
+
 static led_strip_handle_t s_led_strip = NULL;
-static uint8_t s_brightness = 50;  // 默认亮度 50%
+static SemaphoreHandle_t s_lock = NULL;
+static esp_timer_handle_t s_frame_timer = NULL;
+static TaskHandle_t s_render_task = NULL;
+static TaskHandle_t s_deinit_waiter = NULL;
+static volatile bool s_render_exit = false;
+static uint8_t s_brightness = 50;  // 默认亮度 50% (包络目标)
+
+// 以下状态由 s_lock 保护 (调用方任务、esp_timer 任务与渲染任务共享)
+static base_mode_t s_base_mode = BASE_FADE;
+static uint8_t s_fade_from[3];
+static uint8_t s_fade_to[3];
+static int64_t s_fade_start_us = 0;
+static int64_t s_fade_dur_us = 0;
+static uint8_t s_breathe_color[3];
+static int64_t s_breathe_start_us = 0;
+static int64_t s_breathe_period_us = 0;
+
+static uint8_t s_blink_color[3];
+static uint32_t s_blink_phases = 0;     // 剩余亮/灭相位数，0 = 无闪烁
+static int64_t s_blink_start_us = 0;
+static int64_t s_blink_interval_us = 0;
+
+static uint32_t s_level = 50 * RGB_LED_LEVEL_SCALE;   // 当前亮度包络 (0-100, 定点)
+
+static uint8_t s_frame[2][RGB_LED_MAX_PIXELS][3];
+static uint8_t s_front = 0;
+static bool s_push_pending = false;
+static bool s_timer_running = false;
+static rgb_led_stats_t s_stats;
 
 // 预定义颜色表 (R, G, B)
 static const uint8_t s_color_table[][3] = {
@@ -30,22 +75,192 @@ static const uint8_t s_color_table[][3] = {
     [RGB_COLOR_PURPLE]  = {128, 0, 255},
 };
 
+// ==================== 帧渲染 (调用方持有 s_lock) ====================
+
+static void set_rgb3(uint8_t out[3], uint8_t r, uint8_t g, uint8_t b)
+{
+    out[0] = r;
+    out[1] = g;
+    out[2] = b;
+}
+
+/**
+ * @brief 计算底色
+ * @return true 底色仍在变化 (需要继续出帧)
+ */
+static bool base_color(int64_t now, uint8_t out[3])
+{
+    if (s_base_mode == BASE_BREATHE) {
+        // 三角波 + 二次缓动，Q16 相位
+        uint32_t phase = (uint32_t)((((now - s_breathe_start_us) % s_breathe_period_us) << 16) /
+                                    s_breathe_period_us);
+        uint32_t tri = (phase < 0x8000) ? phase * 2 : (0x10000 - phase) * 2;
+        uint32_t ease = (uint32_t)(((uint64_t)tri * tri) >> 16);
+        uint32_t scale = RGB_LED_BREATHE_FLOOR + (((255 - RGB_LED_BREATHE_FLOOR) * ease) >> 16);
+        for (int i = 0; i < 3; i++) {
+            out[i] = (uint8_t)((s_breathe_color[i] * scale) / 255);
+        }
+        return true;
+    }
+
+    int64_t elapsed = now - s_fade_start_us;
+    if (s_fade_dur_us <= 0 || elapsed >= s_fade_dur_us) {
+        memcpy(out, s_fade_to, 3);
+        return false;
+    }
+    int32_t t = (int32_t)((elapsed << 8) / s_fade_dur_us);    // 0-255
+    for (int i = 0; i < 3; i++) {
+        out[i] = (uint8_t)(s_fade_from[i] + (((int32_t)s_fade_to[i] - s_fade_from[i]) * t) / 256);
+    }
+    return true;
+}
+
+/**
+ * @brief 亮度包络逐帧逼近目标：上升快、下降慢
+ * @return true 包络仍在变化
+ */
+static bool step_level(void)
+{
+    uint32_t target = (uint32_t)s_brightness * RGB_LED_LEVEL_SCALE;
+    if (s_level == target) {
+        return false;
+    }
+    if (target > s_level) {
+        uint32_t step = (target - s_level) >> RGB_LED_ATTACK_SHIFT;
+        s_level += (step > 0) ? step : 1;
+    } else {
+        uint32_t step = (s_level - target) >> RGB_LED_DECAY_SHIFT;
+        s_level -= (step > 0) ? step : 1;
+    }
+    return true;
+}
+
+/**
+ * @brief 渲染一帧到 out
+ * @return true 画面仍在变化 (帧定时器须继续运行)
+ */
+static bool render_frame(int64_t now, uint8_t out[RGB_LED_MAX_PIXELS][3])
+{
+    uint8_t color[3];
+    bool animating = base_color(now, color);
+    animating |= step_level();
+
+    if (s_blink_phases > 0) {
+        uint32_t phase = (uint32_t)((now - s_blink_start_us) / s_blink_interval_us);
+        if (phase >= s_blink_phases) {
+            s_blink_phases = 0;     // 闪烁结束，回到底色
+        } else {
+            if ((phase & 1) == 0) {
+                memcpy(color, s_blink_color, 3);
+            } else {
+                set_rgb3(color, 0, 0, 0);
+            }
+            animating = true;
+        }
+    }
+
+    for (int p = 0; p < RGB_LED_MAX_PIXELS; p++) {
+        for (int i = 0; i < 3; i++) {
+            out[p][i] = (uint8_t)((color[i] * s_level) / (100 * RGB_LED_LEVEL_SCALE));
+        }
+    }
+    return animating;
+}
+
+static void frame_timer_cb(void *arg)
+{
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    uint8_t back = s_front ^ 1;
+    bool animating = render_frame(esp_timer_get_time(), s_frame[back]);
+    s_stats.frames_rendered++;
+
+    if (memcmp(s_frame[back], s_frame[s_front], sizeof(s_frame[0])) == 0) {
+        s_stats.frames_coalesced++;
+    } else {
+        if (s_push_pending) {
+            s_stats.frames_coalesced++;     // 上一帧尚未发送即被覆盖
+        }
+        s_front = back;
+        s_push_pending = true;
+        xTaskNotifyGive(s_render_task);
+    }
+
+    // 画面静止：停止出帧，状态变化时由 kick() 重新启动
+    if (!animating) {
+        esp_timer_stop(s_frame_timer);
+        s_timer_running = false;
+    }
+    xSemaphoreGive(s_lock);
+}
+
+static void render_task(void *arg)
+{
+    uint8_t pixels[RGB_LED_MAX_PIXELS][3];
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (s_render_exit) {
+            break;
+        }
+
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        memcpy(pixels, s_frame[s_front], sizeof(pixels));
+        s_push_pending = false;
+        xSemaphoreGive(s_lock);
+
+        esp_err_t ret = ESP_OK;
+        for (int p = 0; p < RGB_LED_MAX_PIXELS && ret == ESP_OK; p++) {
+            ret = led_strip_set_pixel(s_led_strip, p, pixels[p][0], pixels[p][1], pixels[p][2]);
+        }
+        if (ret == ESP_OK) {
+            ret = led_strip_refresh(s_led_strip);
+        }
+
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        if (ret == ESP_OK) {
+            s_stats.frames_pushed++;
+        } else {
+            s_stats.push_errors++;
+        }
+        xSemaphoreGive(s_lock);
+    }
+
+    xTaskNotifyGive(s_deinit_waiter);
+    vTaskDelete(NULL);
+}
+
+// 动画状态已变化：确保帧定时器在运行 (调用方持有 s_lock)
+static void kick(void)
+{
+    if (!s_timer_running &&
+        esp_timer_start_periodic(s_frame_timer, RGB_LED_FRAME_MS * 1000) == ESP_OK) {
+        s_timer_running = true;
+    }
+}
+
+// ==================== 公共接口 ====================
+
 esp_err_t rgb_led_init(int gpio_num)
 {
+    if (s_led_strip != NULL) {
+        return ESP_OK;
+    }
+
     // 配置 LED Strip (RMT 后端，适合 WS2812)
     led_strip_config_t strip_config = {
         .strip_gpio_num = gpio_num,
-        .max_leds = 1,  // 单个 RGB LED
+        .max_leds = RGB_LED_MAX_PIXELS,
         .led_pixel_format = LED_PIXEL_FORMAT_GRB,
         .led_model = LED_MODEL_WS2812,
         .flags.invert_out = false,
     };
 
+    // DMA 发送：刷新期间不占用 CPU 填充 RMT 内存块
     led_strip_rmt_config_t rmt_config = {
         .clk_src = RMT_CLK_SRC_DEFAULT,
         .resolution_hz = 10 * 1000 * 1000,  // 10 MHz
         .mem_block_symbols = 64,
-        .flags.with_dma = false,
+        .flags.with_dma = true,
     };
 
     esp_err_t ret = led_strip_new_rmt_device(&strip_config, &rmt_config, &s_led_strip);
@@ -57,27 +272,91 @@ esp_err_t rgb_led_init(int gpio_num)
     // 初始化为关闭状态
     led_strip_clear(s_led_strip);
 
-    ESP_LOGI(TAG, "RGB LED initialized on GPIO%d", gpio_num);
+    s_lock = xSemaphoreCreateMutex();
+    if (s_lock == NULL) {
+        ret = ESP_ERR_NO_MEM;
+        goto fail;
+    }
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = frame_timer_cb,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "rgb_frame",
+    };
+    ret = esp_timer_create(&timer_args, &s_frame_timer);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Frame timer create failed");
+        goto fail;
+    }
+
+    if (xTaskCreate(render_task, "rgb_led", RGB_LED_TASK_STACK, NULL,
+                    RGB_LED_TASK_PRIORITY, &s_render_task) != pdPASS) {
+        ret = ESP_ERR_NO_MEM;
+        goto fail;
+    }
+
+    memset(s_frame, 0, sizeof(s_frame));
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_level = (uint32_t)s_brightness * RGB_LED_LEVEL_SCALE;
+
+    ESP_LOGI(TAG, "RGB LED initialized on GPIO%d (%d ms frames, RMT DMA)", gpio_num,
+             RGB_LED_FRAME_MS);
     return ESP_OK;
+
+fail:
+    if (s_frame_timer != NULL) {
+        esp_timer_delete(s_frame_timer);
+        s_frame_timer = NULL;
+    }
+    if (s_lock != NULL) {
+        vSemaphoreDelete(s_lock);
+        s_lock = NULL;
+    }
+    led_strip_del(s_led_strip);
+    s_led_strip = NULL;
+    return ret;
 }
 
-esp_err_t rgb_led_set_rgb(uint8_t red, uint8_t green, uint8_t blue)
+esp_err_t rgb_led_fade_to(uint8_t red, uint8_t green, uint8_t blue, uint32_t duration_ms)
 {
-    if (s_led_strip == NULL) {
+    if (s_lock == NULL) {
         return ESP_ERR_INVALID_STATE;
     }
 
-    // 应用亮度
-    uint8_t r = (uint8_t)((red * s_brightness) / 100);
-    uint8_t g = (uint8_t)((green * s_brightness) / 100);
-    uint8_t b = (uint8_t)((blue * s_brightness) / 100);
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    int64_t now = esp_timer_get_time();
+    base_color(now, s_fade_from);   // 从当前显示的底色出发，打断进行中的渐变/呼吸
+    set_rgb3(s_fade_to, red, green, blue);
+    s_fade_start_us = now;
+    s_fade_dur_us = (int64_t)duration_ms * 1000;
+    s_base_mode = BASE_FADE;
+    kick();
+    xSemaphoreGive(s_lock);
+    return ESP_OK;
+}
 
-    esp_err_t ret = led_strip_set_pixel(s_led_strip, 0, r, g, b);
-    if (ret != ESP_OK) {
-        return ret;
+esp_err_t rgb_led_breathe(uint8_t red, uint8_t green, uint8_t blue, uint32_t period_ms)
+{
+    if (period_ms < 2 * RGB_LED_FRAME_MS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_lock == NULL) {
+        return ESP_ERR_INVALID_STATE;
     }
 
-    return led_strip_refresh(s_led_strip);
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    set_rgb3(s_breathe_color, red, green, blue);
+    s_breathe_start_us = esp_timer_get_time();
+    s_breathe_period_us = (int64_t)period_ms * 1000;
+    s_base_mode = BASE_BREATHE;
+    kick();
+    xSemaphoreGive(s_lock);
+    return ESP_OK;
+}
+
+esp_err_t rgb_led_set_rgb(uint8_t red, uint8_t green, uint8_t blue)
+{
+    return rgb_led_fade_to(red, green, blue, RGB_LED_COLOR_FADE_MS);
 }
 
 esp_err_t rgb_led_set_color(rgb_color_t color)
@@ -98,39 +377,73 @@ void rgb_led_set_brightness(uint8_t brightness)
     if (brightness > 100) {
         brightness = 100;
     }
+    if (s_lock == NULL) {
+        s_brightness = brightness;
+        s_level = (uint32_t)brightness * RGB_LED_LEVEL_SCALE;
+        return;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
     s_brightness = brightness;
+    kick();
+    xSemaphoreGive(s_lock);
 }
 
 esp_err_t rgb_led_off(void)
 {
-    if (s_led_strip == NULL) {
-        return ESP_ERR_INVALID_STATE;
-    }
+    return rgb_led_fade_to(0, 0, 0, 0);
+}
 
-    esp_err_t ret = led_strip_clear(s_led_strip);
-    if (ret != ESP_OK) {
-        return ret;
+void rgb_led_blink(rgb_color_t color, int times, int interval_ms)
+{
+    if (s_lock == NULL || times <= 0 || interval_ms <= 0 ||
+        color >= sizeof(s_color_table) / sizeof(s_color_table[0])) {
+        return;
     }
 
-    return ESP_OK;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    memcpy(s_blink_color, s_color_table[color], 3);
+    s_blink_phases = (uint32_t)times * 2;
+    s_blink_start_us = esp_timer_get_time();
+    s_blink_interval_us = (int64_t)interval_ms * 1000;
+    kick();
+    xSemaphoreGive(s_lock);
 }
 
-void rgb_led_blink(rgb_color_t color, int times, int interval_ms)
+void rgb_led_get_stats(rgb_led_stats_t *stats)
 {
-    for (int i = 0; i < times; i++) {
-        rgb_led_set_color(color);
-        vTaskDelay(pdMS_TO_TICKS(interval_ms));
-        rgb_led_off();
-        vTaskDelay(pdMS_TO_TICKS(interval_ms));
+    if (stats == NULL || s_lock == NULL) {
+        return;
     }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    *stats = s_stats;
+    xSemaphoreGive(s_lock);
 }
 
 void rgb_led_deinit(void)
 {
-    if (s_led_strip != NULL) {
-        led_strip_clear(s_led_strip);
-        led_strip_del(s_led_strip);
-        s_led_strip = NULL;
-        ESP_LOGI(TAG, "RGB LED deinitialized");
+    if (s_led_strip == NULL) {
+        return;
     }
+
+    esp_timer_stop(s_frame_timer);
+    esp_timer_delete(s_frame_timer);
+    s_frame_timer = NULL;
+
+    // 等渲染任务发送完当前帧后自行退出，避免在 RMT 发送中途删除任务
+    s_deinit_waiter = xTaskGetCurrentTaskHandle();
+    s_render_exit = true;
+    xTaskNotifyGive(s_render_task);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    s_render_task = NULL;
+    s_render_exit = false;
+    s_timer_running = false;
+    s_push_pending = false;
+    vSemaphoreDelete(s_lock);
+    s_lock = NULL;
+
+    led_strip_clear(s_led_strip);
+    led_strip_del(s_led_strip);
+    s_led_strip = NULL;
+    ESP_LOGI(TAG, "RGB LED deinitialized");
 }
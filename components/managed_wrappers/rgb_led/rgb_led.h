@@ -1,6 +1,12 @@
 /**
  * @file rgb_led.h
  * @brief ESP32-S3 板载 RGB LED 驱动 (GPIO48, WS2812)
+ *
+ * 动画引擎：esp_timer 按固定帧间隔把当前动画渲染到双缓冲像素数组，
+ * 与上一帧相同的帧直接丢弃，变化的帧交给渲染任务经 RMT (DMA) 发送。
+ * 所有接口只修改动画状态后立即返回，不等待 LED 刷新；画面静止时定时器停止。
+ *
+ * 图层 (自下而上)：底色 (常亮 / 渐变 / 呼吸) → 亮度包络 (VAD 电平指示) → 闪烁覆盖层
  */
 
 #ifndef RGB_LED_H
@@ -9,26 +15,25 @@
 #include "esp_err.h"
 #include <stdint.h>
 #include <stdbool.h>
+#include "app_types.h"     // rgb_color_t
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+#define RGB_LED_MAX_PIXELS      1       // 像素数 (板载单颗)
+#define RGB_LED_FRAME_MS        20      // 帧间隔 (50 帧/秒)
+#define RGB_LED_COLOR_FADE_MS   200     // set_rgb / set_color 的颜色过渡时间
+
 /**
- * @brief 预定义颜色
+ * @brief 动画引擎统计
  */
-typedef enum {
-    RGB_COLOR_OFF = 0,
-    RGB_COLOR_RED,
-    RGB_COLOR_GREEN,
-    RGB_COLOR_BLUE,
-    RGB_COLOR_YELLOW,
-    RGB_COLOR_CYAN,
-    RGB_COLOR_MAGENTA,
-    RGB_COLOR_WHITE,
-    RGB_COLOR_ORANGE,
-    RGB_COLOR_PURPLE,
-} rgb_color_t;
+typedef struct {
+    uint32_t frames_rendered;   // 渲染的帧数
+    uint32_t frames_pushed;     // 经 RMT 发送的帧数
+    uint32_t frames_coalesced;  // 与上一帧相同或被更新帧覆盖而未发送的帧数
+    uint32_t push_errors;       // 发送失败次数
+} rgb_led_stats_t;
 
 /**
  * @brief 初始化 RGB LED
@@ -41,6 +46,8 @@ esp_err_t rgb_led_init(int gpio_num);
 /**
  * @brief 设置 RGB LED 颜色 (RGB 值)
  *
+ * 从当前颜色过渡 RGB_LED_COLOR_FADE_MS 到目标颜色并保持常亮。
+ *
  * @param red 红色分量 (0-255)
  * @param green 绿色分量 (0-255)
  * @param blue 蓝色分量 (0-255)
@@ -57,7 +64,24 @@ esp_err_t rgb_led_set_rgb(uint8_t red, uint8_t green, uint8_t blue);
 esp_err_t rgb_led_set_color(rgb_color_t color);
 
 /**
- * @brief 设置 RGB LED 亮度
+ * @brief 从当前颜色渐变到目标颜色
+ *
+ * @param duration_ms 渐变时间，0 表示下一帧直接切换
+ */
+esp_err_t rgb_led_fade_to(uint8_t red, uint8_t green, uint8_t blue, uint32_t duration_ms);
+
+/**
+ * @brief 呼吸效果 (亮度按周期起伏，直到设置新的颜色)
+ *
+ * @param period_ms 呼吸周期
+ */
+esp_err_t rgb_led_breathe(uint8_t red, uint8_t green, uint8_t blue, uint32_t period_ms);
+
+/**
+ * @brief 设置 RGB LED 亮度 (电平指示)
+ *
+ * 亮度按"上升快、下降慢"的包络逐帧逼近目标，VAD 状态切换时呈现电平表效果；
+ * 对当前画面立即生效，无需重新设置颜色。
  *
  * @param brightness 亮度 (0-100)
  */
@@ -71,7 +95,7 @@ void rgb_led_set_brightness(uint8_t brightness);
 esp_err_t rgb_led_off(void);
 
 /**
- * @brief 闪烁 RGB LED
+ * @brief 闪烁 RGB LED (覆盖层，结束后恢复底色；非阻塞)
  *
  * @param color 颜色
  * @param times 闪烁次数
@@ -79,6 +103,11 @@ esp_err_t rgb_led_off(void);
  */
 void rgb_led_blink(rgb_color_t color, int times, int interval_ms);
 
+/**
+ * @brief 获取动画引擎统计
+ */
+void rgb_led_get_stats(rgb_led_stats_t *stats);
+
 /**
  * @brief 反初始化 RGB LED
  */
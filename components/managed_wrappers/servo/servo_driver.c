@@ -2,13 +2,18 @@
  * @file servo_driver.c
  * @brief 舵机驱动封装 - 使用本地修改的 iot_servo 驱动
  *
- * 基于 espressif/servo 组件，已修改时钟配置 (LEDC_APB_CLK) 避免冲突
+ * 基于 espressif/servo 组件，已修改时钟配置 (LEDC_APB_CLK) 避免冲突。
+ * 运动规划在 esp_timer 任务中逐周期执行，调用方只设置目标。
  */
 
 #include "servo_driver.h"
 #include "iot_servo.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "driver/ledc.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <math.h>
 
 static const char *TAG = "SERVO";
 
@@ -17,11 +22,91 @@ static const char *TAG = "SERVO";
 #define SERVO_MAX_WIDTH_US  2500  // 180度脉宽
 #define SERVO_MAX_ANGLE     180
 #define SERVO_FREQ          50    // 50Hz
+#define SERVO_CHANNEL       LEDC_CHANNEL_2
+
+#define SERVO_ARRIVE_DEG    0.05f   // 到位判据
+#define SERVO_HOLD_TICKS    (SERVO_HOLD_MS / SERVO_TICK_MS)
 
 static bool s_initialized = false;
+static SemaphoreHandle_t s_lock = NULL;
+static esp_timer_handle_t s_timer = NULL;
+
+// 以下状态由 s_lock 保护 (调用方任务与 esp_timer 任务共享)
+static float s_pos = 0.0f;          // 当前指令角度
+static float s_vel = 0.0f;          // 当前角速度 (°/s，带方向)
+static float s_target = 0.0f;
+static bool s_running = false;      // 规划定时器运行中
+static uint32_t s_hold_ticks = 0;
+
+static void write_angle(float angle)
+{
+    // ledc_update_duty 会重新使能被 ledc_stop 关闭的输出
+    iot_servo_write_angle(LEDC_LOW_SPEED_MODE, SERVO_CHANNEL, angle);
+}
+
+static void detach(void)
+{
+    ledc_stop(LEDC_LOW_SPEED_MODE, SERVO_CHANNEL, 0);
+}
+
+/**
+ * @brief 推进一个周期：能在剩余距离内停下的最大速度与限速取小，
+ *        速度每周期最多变化 a·dt，得到梯形 (短距离为三角形) 速度曲线
+ * @return true 已到位
+ */
+static bool plan_step(float dt)
+{
+    float d = s_target - s_pos;
+    float dv = SERVO_ACCEL_DPS2 * dt;
+
+    if (fabsf(d) < SERVO_ARRIVE_DEG && fabsf(s_vel) <= dv) {
+        s_pos = s_target;
+        s_vel = 0.0f;
+        return true;
+    }
+
+    float v_stop = sqrtf(2.0f * SERVO_ACCEL_DPS2 * fabsf(d));
+    float v_max = (v_stop < SERVO_MAX_SPEED_DPS) ? v_stop : SERVO_MAX_SPEED_DPS;
+    float v_want = (d > 0) ? v_max : -v_max;
+
+    if (s_vel < v_want) {
+        s_vel = (s_vel + dv < v_want) ? s_vel + dv : v_want;
+    } else {
+        s_vel = (s_vel - dv > v_want) ? s_vel - dv : v_want;
+    }
+
+    float next = s_pos + s_vel * dt;
+    // 低速越过目标时直接落位，避免在目标两侧来回修正
+    if ((s_target - next) * d < 0 && fabsf(s_vel) <= 2.0f * dv) {
+        s_pos = s_target;
+        s_vel = 0.0f;
+        return true;
+    }
+    s_pos = next;
+    return false;
+}
+
+static void servo_timer_cb(void *arg)
+{
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    if (s_pos != s_target || s_vel != 0.0f) {
+        plan_step(SERVO_TICK_MS / 1000.0f);
+        write_angle(s_pos);
+        s_hold_ticks = 0;
+    } else if (++s_hold_ticks >= SERVO_HOLD_TICKS) {
+        detach();
+        esp_timer_stop(s_timer);
+        s_running = false;
+    }
+    xSemaphoreGive(s_lock);
+}
 
 esp_err_t motor_init(uint8_t servo_gpio)
 {
+    if (s_initialized) {
+        return ESP_OK;
+    }
+
     servo_config_t servo_cfg = {
         .max_angle = SERVO_MAX_ANGLE,
         .min_width_us = SERVO_MIN_WIDTH_US,
@@ -30,7 +115,7 @@ esp_err_t motor_init(uint8_t servo_gpio)
         .timer_number = LEDC_TIMER_3,  // 使用 Timer 3，避免与 LED(0)/Fan(2) 冲突
         .channels = {
             .servo_pin = {servo_gpio, -1, -1, -1, -1, -1, -1, -1},
-            .ch = {LEDC_CHANNEL_2, -1, -1, -1, -1, -1, -1, -1},
+            .ch = {SERVO_CHANNEL, -1, -1, -1, -1, -1, -1, -1},
         },
         .channel_number = 1,
     };
@@ -41,11 +126,39 @@ esp_err_t motor_init(uint8_t servo_gpio)
         return ret;
     }
 
-    // 初始位置设置为 0 度
-    iot_servo_write_angle(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_2, 0);
+    const esp_timer_create_args_t timer_args = {
+        .callback = servo_timer_cb,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "servo",
+    };
+    ret = esp_timer_create(&timer_args, &s_timer);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Planner timer create failed");
+        iot_servo_deinit(LEDC_LOW_SPEED_MODE);
+        return ret;
+    }
+
+    s_lock = xSemaphoreCreateMutex();
+    if (s_lock == NULL) {
+        esp_timer_delete(s_timer);
+        s_timer = NULL;
+        iot_servo_deinit(LEDC_LOW_SPEED_MODE);
+        return ESP_ERR_NO_MEM;
+    }
+
+    // 上电位置未知：直接写 0 度，保持 SERVO_HOLD_MS 后断开
+    s_pos = 0.0f;
+    s_vel = 0.0f;
+    s_target = 0.0f;
+    s_hold_ticks = 0;
+    write_angle(0.0f);
+    if (esp_timer_start_periodic(s_timer, SERVO_TICK_MS * 1000) == ESP_OK) {
+        s_running = true;
+    }
 
     s_initialized = true;
-    ESP_LOGI(TAG, "Servo initialized on GPIO %d (TIMER_3, APB_CLK)", servo_gpio);
+    ESP_LOGI(TAG, "Servo initialized on GPIO %d (TIMER_3, APB_CLK, %.0f deg/s)", servo_gpio,
+             SERVO_MAX_SPEED_DPS);
     return ESP_OK;
 }
 
@@ -58,26 +171,66 @@ esp_err_t servo_set_angle(float angle)
     if (angle < 0) angle = 0;
     if (angle > SERVO_MAX_ANGLE) angle = SERVO_MAX_ANGLE;
 
-    return iot_servo_write_angle(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_2, angle);
+    esp_err_t ret = ESP_OK;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    s_target = angle;
+    s_hold_ticks = 0;
+    if (!s_running) {
+        ret = esp_timer_start_periodic(s_timer, SERVO_TICK_MS * 1000);
+        s_running = (ret == ESP_OK);
+    }
+    xSemaphoreGive(s_lock);
+    return ret;
 }
 
-esp_err_t curtain_control(uint8_t open)
+float servo_get_angle(void)
 {
-    // open = 1 -> 打开窗帘 -> 舵机转到 180度
-    // open = 0 -> 关闭窗帘 -> 舵机转到 0度
-    float angle = open ? 180.0f : 0.0f;
+    if (!s_initialized) {
+        return 0.0f;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    float angle = s_pos;
+    xSemaphoreGive(s_lock);
+    return angle;
+}
+
+bool servo_is_moving(void)
+{
+    return s_running;
+}
 
-    esp_err_t ret = servo_set_angle(angle);
+esp_err_t curtain_set_position(uint8_t percent)
+{
+    if (percent > 100) {
+        percent = 100;
+    }
+    // 0% -> 关闭 (0度)，100% -> 全开 (180度)
+    esp_err_t ret = servo_set_angle(percent * (float)SERVO_MAX_ANGLE / 100.0f);
     if (ret == ESP_OK) {
-        ESP_LOGD(TAG, "Curtain set to %s (Angle: %.0f)",
-                 open ? "OPEN" : "CLOSED", angle);
+        ESP_LOGD(TAG, "Curtain target %u%%", percent);
     }
     return ret;
 }
 
+uint8_t curtain_get_position(void)
+{
+    return (uint8_t)lroundf(servo_get_angle() * 100.0f / SERVO_MAX_ANGLE);
+}
+
+esp_err_t curtain_control(uint8_t open)
+{
+    return curtain_set_position(open ? 100 : 0);
+}
+
 void motor_deinit(void)
 {
     if (s_initialized) {
+        esp_timer_stop(s_timer);
+        esp_timer_delete(s_timer);
+        s_timer = NULL;
+        vSemaphoreDelete(s_lock);
+        s_lock = NULL;
+        s_running = false;
         iot_servo_deinit(LEDC_LOW_SPEED_MODE);
         s_initialized = false;
         ESP_LOGI(TAG, "Servo deinitialized");
@@ -2,8 +2,20 @@
 #define SERVO_DRIVER_H
 
 #include <stdint.h>
+#include <stdbool.h>
 #include "esp_err.h"
 
+/**
+ * 运动规划：esp_timer 每 SERVO_TICK_MS (一个 PWM 周期) 按梯形速度曲线
+ * (加速度 SERVO_ACCEL_DPS2，限速 SERVO_MAX_SPEED_DPS) 推进指令角度并写入舵机。
+ * 新目标随时打断当前运动，从当前位置与速度继续规划，不会出现速度突变。
+ * 到位保持 SERVO_HOLD_MS 后停止 PWM 输出 (舵机不再抖动与耗电)，下次运动时自动恢复。
+ */
+#define SERVO_TICK_MS           20          // 规划周期 (与 50Hz PWM 周期一致)
+#define SERVO_MAX_SPEED_DPS     120.0f      // 最大角速度 (°/s)
+#define SERVO_ACCEL_DPS2        240.0f      // 加/减速度 (°/s²)
+#define SERVO_HOLD_MS           300         // 到位后保持 PWM 的时间，留给舵机机械到位
+
 /**
  * @brief 初始化舵机控制 (使用 espressif/servo 官方组件)
  *
@@ -21,13 +33,36 @@ esp_err_t motor_init(uint8_t servo_gpio);
 esp_err_t curtain_control(uint8_t open);
 
 /**
- * @brief 设置舵机角度
+ * @brief 设置窗帘开度 (规划运动，立即返回)
+ *
+ * @param percent 开度 0-100 (0 关闭，100 全开)，超出范围按 100 处理
+ * @return esp_err_t
+ */
+esp_err_t curtain_set_position(uint8_t percent);
+
+/**
+ * @brief 获取窗帘当前开度 (运动中为插值位置)
+ */
+uint8_t curtain_get_position(void);
+
+/**
+ * @brief 设置舵机目标角度 (规划运动，打断进行中的运动，立即返回)
  *
  * @param angle 角度 (0-180)
  * @return esp_err_t
  */
 esp_err_t servo_set_angle(float angle);
 
+/**
+ * @brief 获取当前指令角度 (运动中为插值位置)
+ */
+float servo_get_angle(void);
+
+/**
+ * @brief 是否正在运动 (含到位保持阶段)
+ */
+bool servo_is_moving(void);
+
 /**
  * @brief 反初始化舵机
  */
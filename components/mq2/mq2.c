@@ -1,10 +1,114 @@
 #include "mq2.h"
 #include "esp_log.h"
 #include "esp_adc/adc_oneshot.h"
+#include "esp_adc/adc_continuous.h"
+#include "freertos/FreeRTOS.h"
+#include "esp_timer.h"
+#include <string.h>
 
 static const char *TAG = "MQ2";
 static adc_oneshot_unit_handle_t adc1_handle = NULL;
 
+// ==================== 连续采集 (DMA) ====================
+// 每个 DMA 帧包含的转换结果数
+#define MQ2_CONT_FRAME_SAMPLES 256
+#define MQ2_CONT_FRAME_BYTES   (MQ2_CONT_FRAME_SAMPLES * SOC_ADC_DIGI_RESULT_BYTES)
+
+static adc_continuous_handle_t s_cont_handle = NULL;
+static adc_channel_t s_cont_channel;
+static uint32_t s_window_samples = 0;
+
+// 抽取器累加状态 (仅在 DMA 回调中访问)
+static struct {
+    uint32_t sum;
+    uint32_t min;
+    uint32_t max;
+    uint32_t count;
+} s_acc;
+
+// 最近一个已完成的窗口 (回调写，任务读)
+static mq2_window_t s_window;
+static uint32_t s_pool_overflows = 0;
+static portMUX_TYPE s_window_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// 帧级阈值比较器 (阈值由任务写、回调读，32 位读写为原子操作)
+static volatile uint32_t s_alarm_threshold = 0;
+static uint32_t s_alarm_hysteresis = 0;
+static mq2_alarm_cb_t s_alarm_cb = NULL;
+static void *s_alarm_ctx = NULL;
+static volatile bool s_alarm_active = false;
+
+static void acc_reset(void)
+{
+    s_acc.sum = 0;
+    s_acc.min = UINT32_MAX;
+    s_acc.max = 0;
+    s_acc.count = 0;
+}
+
+static bool mq2_conv_done_cb(adc_continuous_handle_t handle,
+                             const adc_continuous_evt_data_t *edata, void *user_data)
+{
+    const uint8_t *buf = edata->conv_frame_buffer;
+    uint32_t frame_sum = 0;
+    uint32_t frame_count = 0;
+
+    for (uint32_t i = 0; i + SOC_ADC_DIGI_RESULT_BYTES <= edata->size; i += SOC_ADC_DIGI_RESULT_BYTES) {
+        const adc_digi_output_data_t *p = (const adc_digi_output_data_t *)&buf[i];
+        if (p->type2.unit != 0 || p->type2.channel != s_cont_channel) {
+            continue;
+        }
+
+        uint32_t raw = p->type2.data;
+        frame_sum += raw;
+        frame_count++;
+        s_acc.sum += raw;
+        if (raw < s_acc.min) s_acc.min = raw;
+        if (raw > s_acc.max) s_acc.max = raw;
+
+        if (++s_acc.count >= s_window_samples) {
+            // 箱式抽取：Q4 定点平均，四舍五入
+            uint32_t avg_x16 = ((s_acc.sum << 4) + (s_acc.count >> 1)) / s_acc.count;
+
+            portENTER_CRITICAL_ISR(&s_window_lock);
+            s_window.avg_x16 = avg_x16;
+            s_window.avg = (avg_x16 + 8) >> 4;
+            s_window.min = s_acc.min;
+            s_window.max = s_acc.max;
+            s_window.samples = s_acc.count;
+            s_window.seq++;
+            portEXIT_CRITICAL_ISR(&s_window_lock);
+
+            acc_reset();
+        }
+    }
+
+    // 帧平均值过阈值比较：帧内平均抑制单点噪声，检测延迟不超过一帧
+    if (s_alarm_cb == NULL || frame_count == 0) {
+        return false;
+    }
+
+    uint32_t frame_avg = frame_sum / frame_count;
+    uint32_t threshold = s_alarm_threshold;
+    // 与周期通路 (smoke > smoke_threshold) 相同的判定：恰好等于阈值不报警
+    if (!s_alarm_active && mq2_is_smoke_detected(frame_avg, threshold)) {
+        s_alarm_active = true;
+        return s_alarm_cb(frame_avg, esp_timer_get_time(), s_alarm_ctx);
+    }
+    if (s_alarm_active && frame_avg + s_alarm_hysteresis < threshold) {
+        s_alarm_active = false;
+    }
+    return false;
+}
+
+static bool mq2_pool_ovf_cb(adc_continuous_handle_t handle,
+                            const adc_continuous_evt_data_t *edata, void *user_data)
+{
+    // 数据已在帧回调中消费，环形缓冲区溢出无害，仅计数
+    s_pool_overflows++;
+    return false;
+}
+
 esp_err_t mq2_init(adc_channel_t adc_channel)
 {
     // 配置ADC单元
@@ -34,9 +138,154 @@ esp_err_t mq2_init(adc_channel_t adc_channel)
     return ESP_OK;
 }
 
+esp_err_t mq2_init_continuous(adc_channel_t adc_channel, uint32_t sample_rate_hz,
+                              uint32_t window_samples)
+{
+    if (window_samples == 0 || window_samples > (UINT32_MAX >> 16) ||
+        sample_rate_hz < SOC_ADC_SAMPLE_FREQ_THRES_LOW ||
+        sample_rate_hz > SOC_ADC_SAMPLE_FREQ_THRES_HIGH) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (s_cont_handle != NULL || adc1_handle != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    adc_continuous_handle_cfg_t handle_cfg = {
+        .max_store_buf_size = MQ2_CONT_FRAME_BYTES * 2,
+        .conv_frame_size = MQ2_CONT_FRAME_BYTES,
+        .flags.flush_pool = 1,
+    };
+    esp_err_t ret = adc_continuous_new_handle(&handle_cfg, &s_cont_handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "ADC continuous handle create failed");
+        return ret;
+    }
+
+    adc_digi_pattern_config_t pattern = {
+        .atten = ADC_ATTEN_DB_12,
+        .channel = adc_channel,
+        .unit = ADC_UNIT_1,
+        .bit_width = ADC_BITWIDTH_12,
+    };
+    adc_continuous_config_t cont_cfg = {
+        .pattern_num = 1,
+        .adc_pattern = &pattern,
+        .sample_freq_hz = sample_rate_hz,
+        .conv_mode = ADC_CONV_SINGLE_UNIT_1,
+        .format = ADC_DIGI_OUTPUT_FORMAT_TYPE2,
+    };
+    ret = adc_continuous_config(s_cont_handle, &cont_cfg);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "ADC continuous config failed");
+        goto fail;
+    }
+
+    s_cont_channel = adc_channel;
+    s_window_samples = window_samples;
+    memset(&s_window, 0, sizeof(s_window));
+    s_pool_overflows = 0;
+    acc_reset();
+
+    adc_continuous_evt_cbs_t cbs = {
+        .on_conv_done = mq2_conv_done_cb,
+        .on_pool_ovf = mq2_pool_ovf_cb,
+    };
+    ret = adc_continuous_register_event_callbacks(s_cont_handle, &cbs, NULL);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "ADC continuous callback register failed");
+        goto fail;
+    }
+
+    ret = adc_continuous_start(s_cont_handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "ADC continuous start failed");
+        goto fail;
+    }
+
+    ESP_LOGI(TAG, "MQ-2 continuous on ADC1 channel %d: %lu Hz, window %lu samples",
+             adc_channel, (unsigned long)sample_rate_hz, (unsigned long)window_samples);
+    return ESP_OK;
+
+fail:
+    adc_continuous_deinit(s_cont_handle);
+    s_cont_handle = NULL;
+    return ret;
+}
+
+esp_err_t mq2_get_window(mq2_window_t *window)
+{
+    if (window == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (s_cont_handle == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    portENTER_CRITICAL(&s_window_lock);
+    *window = s_window;
+    portEXIT_CRITICAL(&s_window_lock);
+
+    return (window->seq == 0) ? ESP_ERR_INVALID_STATE : ESP_OK;
+}
+
+esp_err_t mq2_alarm_enable(uint32_t threshold, uint32_t hysteresis,
+                           mq2_alarm_cb_t cb, void *ctx)
+{
+    if (cb == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (s_cont_handle == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // 先写参数再发布回调指针，回调看到非空指针时参数已就绪
+    s_alarm_threshold = threshold;
+    s_alarm_hysteresis = hysteresis;
+    s_alarm_ctx = ctx;
+    s_alarm_active = false;
+    s_alarm_cb = cb;
+
+    ESP_LOGI(TAG, "Smoke alarm comparator enabled (threshold=%lu, hysteresis=%lu)",
+             (unsigned long)threshold, (unsigned long)hysteresis);
+    return ESP_OK;
+}
+
+void mq2_alarm_set_threshold(uint32_t threshold)
+{
+    s_alarm_threshold = threshold;
+}
+
+bool mq2_alarm_is_active(void)
+{
+    return s_alarm_cb != NULL && s_alarm_active;
+}
+
+bool mq2_is_continuous(void)
+{
+    return s_cont_handle != NULL;
+}
+
 esp_err_t mq2_read(adc_channel_t adc_channel, uint32_t *value)
 {
-    if (value == NULL || adc1_handle == NULL) {
+    if (value == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // 连续模式：直接返回最近窗口的去噪值
+    if (s_cont_handle != NULL) {
+        mq2_window_t window;
+        esp_err_t ret = mq2_get_window(&window);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        *value = window.avg;
+        return ESP_OK;
+    }
+
+    if (adc1_handle == NULL) {
         return ESP_ERR_INVALID_ARG;
     }
     
@@ -53,6 +302,24 @@ esp_err_t mq2_read(adc_channel_t adc_channel, uint32_t *value)
     return ESP_OK;
 }
 
+void mq2_deinit(void)
+{
+    if (s_cont_handle != NULL) {
+        adc_continuous_stop(s_cont_handle);
+        s_alarm_cb = NULL;
+        s_alarm_active = false;
+        adc_continuous_deinit(s_cont_handle);
+        s_cont_handle = NULL;
+        ESP_LOGI(TAG, "MQ-2 continuous stopped (pool overflows: %lu)",
+                 (unsigned long)s_pool_overflows);
+    }
+
+    if (adc1_handle != NULL) {
+        adc_oneshot_del_unit(adc1_handle);
+        adc1_handle = NULL;
+    }
+}
+
 uint8_t mq2_is_smoke_detected(uint32_t value, uint32_t threshold)
 {
     return (value > threshold) ? 1 : 0;
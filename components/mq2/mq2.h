@@ -2,9 +2,32 @@
 #define MQ2_H
 
 #include <stdint.h>
+#include <stdbool.h>
 #include "esp_err.h"
 #include "esp_adc/adc_oneshot.h"
 
+/**
+ * @brief 连续采集模式下一个抽取窗口的统计结果
+ */
+typedef struct {
+    uint32_t avg;       // 窗口平均值 (12 位，0-4095)
+    uint32_t avg_x16;   // 过采样平均值 (Q4 定点，avg_x16 / 16 即实际值)
+    uint32_t min;       // 窗口内最小原始值
+    uint32_t max;       // 窗口内最大原始值
+    uint32_t samples;   // 窗口内样本数
+    uint32_t seq;       // 窗口序号 (每产生一个窗口加 1)
+} mq2_window_t;
+
+/**
+ * @brief 烟雾阈值越限回调 (在 ADC 中断上下文中调用，只能做 FromISR 操作)
+ *
+ * @param value 触发时的 DMA 帧平均值
+ * @param detect_us 检测时刻 (esp_timer_get_time)
+ * @param ctx 注册时传入的上下文
+ * @return true 需要在中断退出时切换任务
+ */
+typedef bool (*mq2_alarm_cb_t)(uint32_t value, int64_t detect_us, void *ctx);
+
 /**
  * @brief 初始化 MQ-2 烟雾传感器
  * 
@@ -13,8 +36,25 @@
  */
 esp_err_t mq2_init(adc_channel_t adc_channel);
 
+/**
+ * @brief 以 DMA 连续采集模式初始化 MQ-2
+ *
+ * ADC 以 sample_rate_hz 持续采样，DMA 帧完成回调中按 window_samples
+ * 个样本做定点箱式 (一阶 CIC) 抽取，发布去噪后的平均值及窗口极值。
+ * 采样与滤波均不占用传感器任务。
+ *
+ * @param adc_channel ADC通道
+ * @param sample_rate_hz 采样率 (Hz)
+ * @param window_samples 每个抽取窗口的样本数
+ * @return esp_err_t ESP_OK 成功，其他值失败
+ */
+esp_err_t mq2_init_continuous(adc_channel_t adc_channel, uint32_t sample_rate_hz,
+                              uint32_t window_samples);
+
 /**
  * @brief 读取 MQ-2 传感器值
+ *
+ * 连续采集模式下返回最近一个抽取窗口的平均值，不触发 ADC 转换。
  * 
  * @param adc_channel ADC通道
  * @param value 输出ADC值（0-4095）
@@ -22,6 +62,51 @@ esp_err_t mq2_init(adc_channel_t adc_channel);
  */
 esp_err_t mq2_read(adc_channel_t adc_channel, uint32_t *value);
 
+/**
+ * @brief 获取最近一个抽取窗口的统计结果 (仅连续采集模式)
+ *
+ * @param window 输出窗口统计
+ * @return esp_err_t ESP_OK 成功，ESP_ERR_INVALID_STATE 未处于连续模式或尚无窗口
+ */
+esp_err_t mq2_get_window(mq2_window_t *window);
+
+/**
+ * @brief 启用阈值比较报警 (仅连续采集模式)
+ *
+ * 每个 DMA 帧 (约 13ms) 结束时比较帧平均值：上穿 threshold 时调用 cb，
+ * 回落到 threshold - hysteresis 以下后重新布防。
+ *
+ * @param threshold 报警阈值 (ADC 原始值)
+ * @param hysteresis 解除滞回量
+ * @param cb 越限回调
+ * @param ctx 回调上下文
+ * @return esp_err_t ESP_OK 成功，ESP_ERR_INVALID_STATE 未处于连续模式
+ */
+esp_err_t mq2_alarm_enable(uint32_t threshold, uint32_t hysteresis,
+                           mq2_alarm_cb_t cb, void *ctx);
+
+/**
+ * @brief 运行时修改报警阈值
+ *
+ * @param threshold 报警阈值 (ADC 原始值)
+ */
+void mq2_alarm_set_threshold(uint32_t threshold);
+
+/**
+ * @brief 阈值比较器当前是否处于越限状态 (未启用时恒为 false)
+ */
+bool mq2_alarm_is_active(void);
+
+/**
+ * @brief 是否处于 DMA 连续采集模式
+ */
+bool mq2_is_continuous(void);
+
+/**
+ * @brief 释放 MQ-2 ADC 资源
+ */
+void mq2_deinit(void);
+
 /**
  * @brief 判断是否检测到烟雾
  * 
@@ -0,0 +1,533 @@
+/**
+ * @file rules.c
+ * @brief 自动化规则引擎实现
+ */
+
+#include "rules.h"
+#include "config.h"
+#include "cJSON.h"
+#include "nvs.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "RULES";
+
+typedef enum {
+    RULE_OP_ABOVE = 0,
+    RULE_OP_BELOW,
+} rule_op_t;
+
+// 编译后的规则 (12 字节，阈值为 ×RULES_FIXED_SCALE 定点)
+typedef struct {
+    uint8_t field;      // rule_field_t
+    uint8_t op;         // rule_op_t
+    uint8_t target;     // rule_target_t
+    uint8_t value;
+    int32_t on;         // 激活阈值
+    int32_t off;        // 解除阈值 (等于 on 表示无滞回)
+} rule_t;
+
+typedef struct {
+    uint32_t count;
+    uint32_t target_mask;
+    rule_t rules[RULES_MAX];
+} rule_table_t;
+
+static const char *const s_field_names[RULE_FIELD_MAX] = {
+    "temperature", "humidity", "light", "smoke",
+};
+
+static const char *const s_target_names[RULE_TARGET_MAX] = {
+    "led", "fan", "curtain",
+};
+
+static rule_table_t s_table;
+static uint32_t s_latched = 0;                  // 各规则激活状态
+static bool s_target_on[RULE_TARGET_MAX];       // 各目标最近一次输出是否开启
+static uint8_t s_last_value[RULE_TARGET_MAX];   // 各目标上次求值结果
+static uint32_t s_last_valid = 0;               // s_last_value 有效的目标
+static rules_stats_t s_stats;
+static SemaphoreHandle_t s_lock = NULL;
+
+// ==================== 编译 ====================
+
+static int32_t to_fixed(double value)
+{
+    double scaled = value * RULES_FIXED_SCALE;
+    return (int32_t)(scaled >= 0 ? scaled + 0.5 : scaled - 0.5);
+}
+
+static void table_add(rule_table_t *t, rule_field_t field, rule_op_t op, float on, float off,
+                      rule_target_t target, uint8_t value)
+{
+    rule_t *r = &t->rules[t->count++];
+    r->field = (uint8_t)field;
+    r->op = (uint8_t)op;
+    r->target = (uint8_t)target;
+    r->value = value;
+    r->on = to_fixed(on);
+    r->off = to_fixed(off);
+    t->target_mask |= 1u << target;
+}
+
+// 内置默认规则：与原硬编码滞回逻辑一致 (同一目标按优先级从高到低)
+static void build_defaults(rule_table_t *t)
+{
+    memset(t, 0, sizeof(*t));
+    if (AUTO_FAN_ENABLE) {
+        table_add(t, RULE_FIELD_TEMPERATURE, RULE_OP_ABOVE, TEMP_CRITICAL_THRESHOLD,
+                  TEMP_CRITICAL_THRESHOLD, RULE_TARGET_FAN, FAN_SPEED_HIGH);
+        table_add(t, RULE_FIELD_TEMPERATURE, RULE_OP_ABOVE, TEMP_MEDIUM_THRESHOLD,
+                  TEMP_MEDIUM_THRESHOLD, RULE_TARGET_FAN, FAN_SPEED_MEDIUM);
+        table_add(t, RULE_FIELD_TEMPERATURE, RULE_OP_ABOVE, TEMP_HIGH_THRESHOLD,
+                  TEMP_HIGH_THRESHOLD - TEMP_HYSTERESIS, RULE_TARGET_FAN, FAN_SPEED_LOW);
+    }
+    if (AUTO_LIGHT_ENABLE) {
+        table_add(t, RULE_FIELD_LIGHT, RULE_OP_BELOW, LIGHT_LOW_THRESHOLD,
+                  LIGHT_LOW_THRESHOLD + LIGHT_HYSTERESIS, RULE_TARGET_LED, LED_BRIGHTNESS_MAX);
+    }
+}
+
+static int lookup(const char *const names[], int count, const cJSON *item)
+{
+    if (!cJSON_IsString(item)) {
+        return -1;
+    }
+    for (int i = 0; i < count; i++) {
+        if (strcmp(item->valuestring, names[i]) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static esp_err_t compile(const char *json, rule_table_t *t, const char **err)
+{
+    memset(t, 0, sizeof(*t));
+
+    cJSON *root = cJSON_Parse(json);
+    if (root == NULL) {
+        *err = "invalid json";
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t ret = ESP_ERR_INVALID_ARG;
+    cJSON *rules = cJSON_GetObjectItemCaseSensitive(root, "rules");
+    if (!cJSON_IsArray(rules)) {
+        *err = "rules must be an array";
+        goto out;
+    }
+    if (cJSON_GetArraySize(rules) > RULES_MAX) {
+        *err = "too many rules";
+        goto out;
+    }
+
+    cJSON *item = NULL;
+    cJSON_ArrayForEach(item, rules) {
+        int field = lookup(s_field_names, RULE_FIELD_MAX,
+                           cJSON_GetObjectItemCaseSensitive(item, "field"));
+        int target = lookup(s_target_names, RULE_TARGET_MAX,
+                            cJSON_GetObjectItemCaseSensitive(item, "target"));
+        if (field < 0 || target < 0) {
+            *err = "unknown field or target";
+            goto out;
+        }
+
+        cJSON *above = cJSON_GetObjectItemCaseSensitive(item, "above");
+        cJSON *below = cJSON_GetObjectItemCaseSensitive(item, "below");
+        if (cJSON_IsNumber(above) == cJSON_IsNumber(below)) {
+            *err = "exactly one of above/below is required";
+            goto out;
+        }
+        rule_op_t op = cJSON_IsNumber(above) ? RULE_OP_ABOVE : RULE_OP_BELOW;
+        double on = cJSON_IsNumber(above) ? above->valuedouble : below->valuedouble;
+
+        cJSON *release = cJSON_GetObjectItemCaseSensitive(item, "release");
+        double off = cJSON_IsNumber(release) ? release->valuedouble : on;
+        if ((op == RULE_OP_ABOVE && off > on) || (op == RULE_OP_BELOW && off < on)) {
+            *err = "release must lie on the inactive side of the threshold";
+            goto out;
+        }
+
+        cJSON *value = cJSON_GetObjectItemCaseSensitive(item, "value");
+        if (!cJSON_IsNumber(value) || value->valueint < 0 || value->valueint > 255) {
+            *err = "value must be 0-255";
+            goto out;
+        }
+
+        table_add(t, (rule_field_t)field, op, (float)on, (float)off,
+                  (rule_target_t)target, (uint8_t)value->valueint);
+    }
+    ret = ESP_OK;
+
+out:
+    cJSON_Delete(root);
+    return ret;
+}
+
+// ==================== 求值 ====================
+
+static void read_inputs(const sensor_data_t *data, int32_t in[RULE_FIELD_MAX])
+{
+    in[RULE_FIELD_TEMPERATURE] = to_fixed(data->temperature);
+    in[RULE_FIELD_HUMIDITY] = to_fixed(data->humidity);
+    in[RULE_FIELD_LIGHT] = to_fixed(data->light);
+    in[RULE_FIELD_SMOKE] = (int32_t)data->smoke * RULES_FIXED_SCALE;
+}
+
+// 单遍扫描：更新全部规则的激活状态，每个目标取第一条激活规则
+static void eval_table(const rule_table_t *t, const int32_t in[RULE_FIELD_MAX],
+                       uint32_t *latched, rule_outputs_t *out)
+{
+    uint32_t state = *latched;
+    uint32_t decided = 0;
+
+    out->mask = t->target_mask;
+    memset(out->value, 0, sizeof(out->value));
+
+    for (uint32_t i = 0; i < t->count; i++) {
+        const rule_t *r = &t->rules[i];
+        int32_t x = in[r->field];
+        uint32_t bit = 1u << i;
+        bool active;
+
+        if (r->op == RULE_OP_ABOVE) {
+            active = (x > r->on) || ((state & bit) && r->off < r->on && x >= r->off);
+        } else {
+            active = (x < r->on) || ((state & bit) && r->off > r->on && x <= r->off);
+        }
+
+        if (active) {
+            state |= bit;
+            uint32_t tbit = 1u << r->target;
+            if (!(decided & tbit)) {
+                decided |= tbit;
+                out->value[r->target] = r->value;
+            }
+        } else {
+            state &= ~bit;
+        }
+    }
+    *latched = state;
+}
+
+// 调用方持有 s_lock
+static void sync_locked(rule_target_t target, bool on)
+{
+    for (uint32_t i = 0; i < s_table.count; i++) {
+        const rule_t *r = &s_table.rules[i];
+        if (r->target == target && r->off != r->on) {
+            if (on) {
+                s_latched |= 1u << i;
+            } else {
+                s_latched &= ~(1u << i);
+            }
+        }
+    }
+    s_target_on[target] = on;
+    // 外部改变了设备状态：下次求值无论结果是否变化都重新下发
+    s_last_valid &= ~(1u << target);
+}
+
+// 调用方持有 s_lock
+static void install_locked(const rule_table_t *t, bool from_nvs)
+{
+    s_table = *t;
+    s_latched = 0;
+    s_last_valid = 0;
+    for (int i = 0; i < RULE_TARGET_MAX; i++) {
+        sync_locked((rule_target_t)i, s_target_on[i]);
+    }
+    s_stats.rule_count = t->count;
+    s_stats.from_nvs = from_nvs;
+}
+
+// ==================== NVS ====================
+
+static char *nvs_read_json(void)
+{
+    nvs_handle_t handle;
+    if (nvs_open(RULES_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+        return NULL;
+    }
+
+    char *json = NULL;
+    size_t len = 0;
+    if (nvs_get_str(handle, RULES_NVS_KEY, NULL, &len) == ESP_OK && len > 0 &&
+        len <= RULES_JSON_MAX) {
+        json = malloc(len);
+        if (json != NULL && nvs_get_str(handle, RULES_NVS_KEY, json, &len) != ESP_OK) {
+            free(json);
+            json = NULL;
+        }
+    }
+    nvs_close(handle);
+    return json;
+}
+
+static esp_err_t nvs_write_json(const char *json)
+{
+    nvs_handle_t handle;
+    esp_err_t ret = nvs_open(RULES_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    if (json != NULL) {
+        ret = nvs_set_str(handle, RULES_NVS_KEY, json);
+    } else {
+        ret = nvs_erase_key(handle, RULES_NVS_KEY);
+        if (ret == ESP_ERR_NVS_NOT_FOUND) {
+            ret = ESP_OK;
+        }
+    }
+    if (ret == ESP_OK) {
+        ret = nvs_commit(handle);
+    }
+    nvs_close(handle);
+    return ret;
+}
+
+// ==================== 公共接口 ====================
+
+esp_err_t rules_init(void)
+{
+    if (s_lock != NULL) {
+        return ESP_OK;
+    }
+
+    s_lock = xSemaphoreCreateMutex();
+    if (s_lock == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    memset(&s_stats, 0, sizeof(s_stats));
+    memset(s_target_on, 0, sizeof(s_target_on));
+
+    rule_table_t *t = malloc(sizeof(rule_table_t));
+    if (t == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    bool from_nvs = false;
+    char *json = nvs_read_json();
+    if (json != NULL) {
+        const char *err = NULL;
+        if (compile(json, t, &err) == ESP_OK) {
+            from_nvs = true;
+        } else {
+            ESP_LOGW(TAG, "Stored rules rejected (%s), using defaults", err);
+        }
+        free(json);
+    }
+    if (!from_nvs) {
+        build_defaults(t);
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    install_locked(t, from_nvs);
+    xSemaphoreGive(s_lock);
+    free(t);
+
+    ESP_LOGI(TAG, "Loaded %lu rules (%s)", (unsigned long)s_stats.rule_count,
+             from_nvs ? "nvs" : "defaults");
+    return ESP_OK;
+}
+
+esp_err_t rules_load(const char *json, bool persist, const char **err)
+{
+    const char *dummy = NULL;
+    if (err == NULL) {
+        err = &dummy;
+    }
+    if (s_lock == NULL) {
+        *err = "not initialized";
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (json != NULL && strlen(json) >= RULES_JSON_MAX) {
+        *err = "rules too large";
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    rule_table_t *t = malloc(sizeof(rule_table_t));
+    if (t == NULL) {
+        *err = "out of memory";
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_err_t ret = ESP_OK;
+    if (json != NULL) {
+        ret = compile(json, t, err);
+    } else {
+        build_defaults(t);
+    }
+
+    if (ret == ESP_OK) {
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        install_locked(t, json != NULL);
+        s_stats.reloads++;
+        xSemaphoreGive(s_lock);
+
+        ESP_LOGI(TAG, "Reloaded %lu rules", (unsigned long)t->count);
+        if (persist && nvs_write_json(json) != ESP_OK) {
+            ESP_LOGW(TAG, "Failed to persist rules");
+        }
+    }
+    free(t);
+    return ret;
+}
+
+void rules_evaluate(const sensor_data_t *data, rule_outputs_t *out)
+{
+    if (data == NULL || out == NULL) {
+        return;
+    }
+    if (s_lock == NULL) {
+        memset(out, 0, sizeof(*out));
+        return;
+    }
+
+    int32_t in[RULE_FIELD_MAX];
+    read_inputs(data, in);
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    int64_t start_us = esp_timer_get_time();
+    eval_table(&s_table, in, &s_latched, out);
+    uint32_t elapsed_us = (uint32_t)(esp_timer_get_time() - start_us);
+
+    // 只输出结果发生变化的目标，外部设定保持到下一次越过阈值
+    uint32_t changed = 0;
+    for (int i = 0; i < RULE_TARGET_MAX; i++) {
+        uint32_t bit = 1u << i;
+        if (!(out->mask & bit)) {
+            continue;
+        }
+        s_target_on[i] = (out->value[i] != 0);
+        if (!(s_last_valid & bit) || s_last_value[i] != out->value[i]) {
+            changed |= bit;
+            s_last_value[i] = out->value[i];
+            s_last_valid |= bit;
+        }
+    }
+    out->mask = changed;
+    s_stats.evaluations++;
+    if (elapsed_us > s_stats.eval_max_us) {
+        s_stats.eval_max_us = elapsed_us;
+    }
+    xSemaphoreGive(s_lock);
+}
+
+void rules_sync_target(rule_target_t target, bool on)
+{
+    if (s_lock == NULL || target >= RULE_TARGET_MAX) {
+        return;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    sync_locked(target, on);
+    xSemaphoreGive(s_lock);
+}
+
+char *rules_export_json(void)
+{
+    if (s_lock == NULL) {
+        return NULL;
+    }
+
+    rule_table_t *t = malloc(sizeof(rule_table_t));
+    if (t == NULL) {
+        return NULL;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    *t = s_table;
+    xSemaphoreGive(s_lock);
+
+    char *json = NULL;
+    cJSON *root = cJSON_CreateObject();
+    cJSON *rules = root ? cJSON_AddArrayToObject(root, "rules") : NULL;
+    if (rules != NULL) {
+        for (uint32_t i = 0; i < t->count; i++) {
+            const rule_t *r = &t->rules[i];
+            cJSON *item = cJSON_CreateObject();
+            if (item == NULL) {
+                break;
+            }
+            cJSON_AddStringToObject(item, "field", s_field_names[r->field]);
+            cJSON_AddNumberToObject(item, r->op == RULE_OP_ABOVE ? "above" : "below",
+                                    (double)r->on / RULES_FIXED_SCALE);
+            if (r->off != r->on) {
+                cJSON_AddNumberToObject(item, "release", (double)r->off / RULES_FIXED_SCALE);
+            }
+            cJSON_AddStringToObject(item, "target", s_target_names[r->target]);
+            cJSON_AddNumberToObject(item, "value", r->value);
+            cJSON_AddItemToArray(rules, item);
+        }
+        json = cJSON_PrintUnformatted(root);
+    }
+    cJSON_Delete(root);
+    free(t);
+    return json;
+}
+
+void rules_get_stats(rules_stats_t *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    if (s_lock == NULL) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    *stats = s_stats;
+    xSemaphoreGive(s_lock);
+}
+
+esp_err_t rules_benchmark(uint32_t iterations, rules_bench_t *result)
+{
+    if (result == NULL || iterations == 0 || s_lock == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    rule_table_t *t = malloc(sizeof(rule_table_t));
+    if (t == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    *t = s_table;
+    xSemaphoreGive(s_lock);
+
+    // 合成输入：温度 0-50℃、光照 0-500lux 往复扫描，覆盖激活与解除
+    uint32_t latched = 0;
+    uint32_t sink = 0;
+    rule_outputs_t out;
+    int32_t in[RULE_FIELD_MAX] = {0};
+
+    int64_t start_us = esp_timer_get_time();
+    for (uint32_t i = 0; i < iterations; i++) {
+        in[RULE_FIELD_TEMPERATURE] = (int32_t)(i % 500);
+        in[RULE_FIELD_HUMIDITY] = (int32_t)(i % 1000);
+        in[RULE_FIELD_LIGHT] = (int32_t)((i * 7) % 5000);
+        in[RULE_FIELD_SMOKE] = (int32_t)((i * 13) % 40960);
+        eval_table(t, in, &latched, &out);
+        sink += out.value[RULE_TARGET_FAN];
+    }
+    int64_t elapsed_us = esp_timer_get_time() - start_us;
+
+    result->iterations = iterations;
+    result->rule_count = t->count;
+    result->elapsed_us = elapsed_us > 0 ? elapsed_us : 1;
+    result->evals_per_sec = (uint32_t)((uint64_t)iterations * 1000000 / result->elapsed_us);
+    result->rules_per_sec = (uint32_t)((uint64_t)iterations * t->count * 1000000 /
+                                       result->elapsed_us);
+    free(t);
+
+    ESP_LOGI(TAG, "Benchmark: %lu evals of %lu rules in %lld us (%lu rules/s, sink=%lu)",
+             (unsigned long)iterations, (unsigned long)result->rule_count,
+             (long long)result->elapsed_us, (unsigned long)result->rules_per_sec,
+             (unsigned long)sink);
+    return ESP_OK;
+}
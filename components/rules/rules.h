@@ -0,0 +1,138 @@
+/**
+ * @file rules.h
+ * @brief 自动化规则引擎：传感器字段 + 滞回带 → 执行器目标值
+ *
+ * 规则以 JSON 描述并存放在 NVS，加载时编译为定长规则表 (每条 12 字节，
+ * 阈值为 ×10 定点整数)，每个控制周期顺序扫描一遍，耗时与规则数成正比且有上限。
+ *
+ * 语义：
+ * - above：值 > threshold 时激活，值 < release 时解除 (release 缺省等于 threshold，
+ *   此时不带记忆，值 ≤ threshold 即解除)
+ * - below：值 < threshold 时激活，值 > release 时解除
+ * - 同一目标的多条规则按书写顺序为优先级，取第一条处于激活状态的规则的值；
+ *   没有激活规则时目标值为 0 (关闭)；没有任何规则的目标不受引擎控制
+ * - 目标值只在变化时输出：HTTP 等外部设定保持到下一次越过阈值；
+ *   rules_sync_target() 之后的第一次求值总会输出
+ *
+ * JSON 格式：
+ * {"rules":[{"field":"temperature","above":30,"release":28,"target":"fan","value":150}, ...]}
+ */
+
+#ifndef RULES_H
+#define RULES_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "app_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RULES_MAX          32      // 规则表容量 (激活状态用 32 位掩码保存)
+#define RULES_JSON_MAX     2048    // JSON 源码上限 (NVS / HTTP 请求体)
+#define RULES_FIXED_SCALE  10      // 阈值定点倍数
+
+// NVS 存储位置
+#define RULES_NVS_NAMESPACE "rules"
+#define RULES_NVS_KEY       "json"
+
+typedef enum {
+    RULE_FIELD_TEMPERATURE = 0,
+    RULE_FIELD_HUMIDITY,
+    RULE_FIELD_LIGHT,
+    RULE_FIELD_SMOKE,
+    RULE_FIELD_MAX,
+} rule_field_t;
+
+typedef enum {
+    RULE_TARGET_LED = 0,
+    RULE_TARGET_FAN,
+    RULE_TARGET_CURTAIN,
+    RULE_TARGET_MAX,
+} rule_target_t;
+
+/**
+ * @brief 一次求值的输出
+ */
+typedef struct {
+    uint32_t mask;                      // 需要下发的目标 (1 << rule_target_t)
+    uint8_t value[RULE_TARGET_MAX];     // 目标值 (风扇转速 / LED 亮度 / 窗帘开度 0-100)
+} rule_outputs_t;
+
+/**
+ * @brief 引擎统计
+ */
+typedef struct {
+    uint32_t rule_count;        // 当前规则数
+    bool from_nvs;              // 当前规则来自 NVS (否则为内置默认规则)
+    uint32_t reloads;           // 热加载次数
+    uint32_t evaluations;       // 求值次数
+    uint32_t eval_max_us;       // 单次求值最长耗时
+} rules_stats_t;
+
+/**
+ * @brief 基准测试结果
+ */
+typedef struct {
+    uint32_t iterations;
+    uint32_t rule_count;
+    int64_t elapsed_us;
+    uint32_t evals_per_sec;     // 整表求值次数/秒
+    uint32_t rules_per_sec;     // 单条规则求值次数/秒
+} rules_bench_t;
+
+/**
+ * @brief 初始化：优先加载 NVS 中的规则，不存在或无效时使用内置默认规则
+ *
+ * 默认规则与 config.h 的 TEMP_* / LIGHT_* 阈值一致。重复调用直接返回。
+ */
+esp_err_t rules_init(void);
+
+/**
+ * @brief 编译并替换当前规则 (热加载)
+ *
+ * 编译失败时保持原规则不变。新规则沿用各目标当前的开关状态作为滞回记忆。
+ *
+ * @param json JSON 源码，NULL 表示恢复默认规则
+ * @param persist 成功后写入 NVS (恢复默认时删除 NVS 中的规则)
+ * @param err 编译失败时的原因，可为 NULL
+ * @return esp_err_t ESP_ERR_INVALID_ARG 格式错误
+ */
+esp_err_t rules_load(const char *json, bool persist, const char **err);
+
+/**
+ * @brief 对当前数据求值一次并更新各规则的激活状态
+ */
+void rules_evaluate(const sensor_data_t *data, rule_outputs_t *out);
+
+/**
+ * @brief 同步目标的开关状态 (语音/手动/报警改变设备后调用)
+ *
+ * 带滞回的规则激活状态设为 on，使后续求值沿用外部设定的状态直到越过解除阈值。
+ */
+void rules_sync_target(rule_target_t target, bool on);
+
+/**
+ * @brief 导出当前规则为 JSON (调用方 free)
+ */
+char *rules_export_json(void);
+
+/**
+ * @brief 获取引擎统计
+ */
+void rules_get_stats(rules_stats_t *stats);
+
+/**
+ * @brief 基准测试：用合成输入对当前规则表求值 iterations 次 (不影响运行中的激活状态)
+ *
+ * 持续占用 CPU 直到完成，不要在 httpd 等服务任务中调用；吞吐数字见主机测试 test_rules。
+ */
+esp_err_t rules_benchmark(uint32_t iterations, rules_bench_t *result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RULES_H
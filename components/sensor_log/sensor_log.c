@@ -0,0 +1,323 @@
+/**
+ * @file sensor_log.c
+ * @brief 掉电保持的传感器归档日志实现
+ *
+ * 双页缓冲：
+ * - active 页：sensor_log_append() 在其中增量编码
+ * - pending 页：已封装完成，等待写入任务擦除扇区并写入
+ * 写入任务积压时 (pending 未写完又有新页满) 丢弃新记录并计数，
+ * 不会阻塞调用方。
+ */
+
+#include "sensor_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_partition.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "SENSOR_LOG";
+
+#define PAGE_HDR_SIZE     sizeof(sensor_log_page_hdr_t)
+#define PAGE_PAYLOAD_SIZE (SENSOR_LOG_PAGE_SIZE - PAGE_HDR_SIZE)
+#define WRITER_STACK_SIZE (3 * 1024)
+
+// 未满页最长驻留时间 (秒)，限制掉电时 RAM 中可丢失的数据量
+#define SENSOR_LOG_MAX_PAGE_AGE_S 1800
+
+static const esp_partition_t *s_part = NULL;
+static uint32_t s_next_sector = 0;
+static uint32_t s_next_seq = 0;
+
+static uint8_t *s_pages[2] = {NULL, NULL};
+static int s_active = 0;
+static int s_pending = -1;
+static sensor_log_encoder_t s_enc;
+
+static SemaphoreHandle_t s_lock = NULL;
+static TaskHandle_t s_writer_task = NULL;
+static sensor_log_stats_t s_stats;
+
+static void encoder_reset(void)
+{
+    sensor_log_encoder_init(&s_enc, s_pages[s_active] + PAGE_HDR_SIZE, PAGE_PAYLOAD_SIZE);
+}
+
+// 封装当前页并交给写入任务 (调用方持有 s_lock)
+static bool submit_active_locked(void)
+{
+    if (s_enc.count == 0) {
+        return true;
+    }
+    if (s_pending >= 0) {
+        return false;
+    }
+
+    sensor_log_page_finalize(s_pages[s_active], s_next_seq++, &s_enc);
+    s_pending = s_active;
+    s_active ^= 1;
+    encoder_reset();
+
+    xTaskNotifyGive(s_writer_task);
+    return true;
+}
+
+static void writer_task(void *arg)
+{
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        int idx = s_pending;
+        uint32_t sector = s_next_sector;
+        xSemaphoreGive(s_lock);
+
+        if (idx < 0) {
+            continue;
+        }
+
+        const uint8_t *page = s_pages[idx];
+        sensor_log_page_hdr_t hdr;
+        memcpy(&hdr, page, sizeof(hdr));
+
+        // 页头与载荷一次写入；中途掉电时 CRC 校验失败，仅此页丢失
+        size_t offset = (size_t)sector * SENSOR_LOG_PAGE_SIZE;
+        esp_err_t ret = esp_partition_erase_range(s_part, offset, SENSOR_LOG_PAGE_SIZE);
+        if (ret == ESP_OK) {
+            ret = esp_partition_write(s_part, offset, page, PAGE_HDR_SIZE + hdr.payload_len);
+        }
+
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        if (ret == ESP_OK) {
+            s_stats.pages_written++;
+            s_stats.raw_bytes += hdr.count * sizeof(sensor_log_record_t);
+            s_stats.encoded_bytes += hdr.payload_len;
+        } else {
+            ESP_LOGE(TAG, "Page %lu write failed: %s",
+                     (unsigned long)hdr.seq, esp_err_to_name(ret));
+        }
+        // 写入失败也前进，避免反复磨损同一扇区
+        s_next_sector = (sector + 1) % s_stats.pages_total;
+        s_pending = -1;
+        xSemaphoreGive(s_lock);
+    }
+}
+
+// 扫描全部扇区，找到最新页以确定写入位置
+static void mount_scan(uint8_t *buf)
+{
+    bool found = false;
+    uint32_t max_seq = 0;
+    uint32_t max_sector = 0;
+
+    for (uint32_t i = 0; i < s_stats.pages_total; i++) {
+        size_t offset = (size_t)i * SENSOR_LOG_PAGE_SIZE;
+        if (esp_partition_read(s_part, offset, buf, SENSOR_LOG_PAGE_SIZE) != ESP_OK) {
+            continue;
+        }
+
+        uint32_t magic;
+        memcpy(&magic, buf, sizeof(magic));
+        if (magic != SENSOR_LOG_PAGE_MAGIC) {
+            continue;   // 空扇区
+        }
+
+        sensor_log_page_hdr_t hdr;
+        if (!sensor_log_page_verify(buf, SENSOR_LOG_PAGE_SIZE, &hdr)) {
+            s_stats.pages_corrupt++;
+            continue;
+        }
+
+        s_stats.pages_valid++;
+        if (!found || (int32_t)(hdr.seq - max_seq) > 0) {
+            found = true;
+            max_seq = hdr.seq;
+            max_sector = i;
+        }
+    }
+
+    if (found) {
+        s_next_sector = (max_sector + 1) % s_stats.pages_total;
+        s_next_seq = max_seq + 1;
+    } else {
+        s_next_sector = 0;
+        s_next_seq = 0;
+    }
+}
+
+static uint8_t *alloc_page(void)
+{
+    uint8_t *p = heap_caps_malloc(SENSOR_LOG_PAGE_SIZE, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (p == NULL) {
+        p = malloc(SENSOR_LOG_PAGE_SIZE);
+    }
+    return p;
+}
+
+esp_err_t sensor_log_init(uint32_t task_priority)
+{
+    if (s_part != NULL) {
+        return ESP_OK;
+    }
+
+    const esp_partition_t *part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                                           SENSOR_LOG_PARTITION_SUBTYPE,
+                                                           SENSOR_LOG_PARTITION_LABEL);
+    if (part == NULL) {
+        ESP_LOGW(TAG, "Partition '%s' not found", SENSOR_LOG_PARTITION_LABEL);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    s_pages[0] = alloc_page();
+    s_pages[1] = alloc_page();
+    s_lock = xSemaphoreCreateMutex();
+    if (s_pages[0] == NULL || s_pages[1] == NULL || s_lock == NULL) {
+        ESP_LOGE(TAG, "Out of memory");
+        goto fail;
+    }
+
+    s_part = part;
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_stats.pages_total = part->size / SENSOR_LOG_PAGE_SIZE;
+
+    mount_scan(s_pages[0]);
+    s_stats.next_seq = s_next_seq;
+
+    s_active = 0;
+    s_pending = -1;
+    encoder_reset();
+
+    if (xTaskCreate(writer_task, "slog_writer", WRITER_STACK_SIZE, NULL,
+                    task_priority, &s_writer_task) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create writer task");
+        s_part = NULL;
+        goto fail;
+    }
+
+    ESP_LOGI(TAG, "Mounted: %lu pages, %lu valid, %lu corrupt, next seq %lu at sector %lu",
+             (unsigned long)s_stats.pages_total, (unsigned long)s_stats.pages_valid,
+             (unsigned long)s_stats.pages_corrupt, (unsigned long)s_next_seq,
+             (unsigned long)s_next_sector);
+    return ESP_OK;
+
+fail:
+    free(s_pages[0]);
+    free(s_pages[1]);
+    s_pages[0] = s_pages[1] = NULL;
+    if (s_lock != NULL) {
+        vSemaphoreDelete(s_lock);
+        s_lock = NULL;
+    }
+    return ESP_ERR_NO_MEM;
+}
+
+esp_err_t sensor_log_append(const sensor_log_record_t *rec)
+{
+    if (rec == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_part == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_err_t ret = ESP_OK;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+
+    // 未满页驻留过久时提前提交；校时后时间戳跳变也在此换页，一页内只有一种时间基准
+    if (s_enc.count > 0 && rec->ts - s_enc.first_ts >= SENSOR_LOG_MAX_PAGE_AGE_S) {
+        submit_active_locked();
+    }
+
+    if (!sensor_log_encoder_append(&s_enc, rec)) {
+        // 当前页已满：提交后在新页重试
+        if (submit_active_locked() && sensor_log_encoder_append(&s_enc, rec)) {
+            s_stats.records_appended++;
+        } else {
+            s_stats.records_dropped++;
+            ret = ESP_ERR_NO_MEM;
+        }
+    } else {
+        s_stats.records_appended++;
+    }
+
+    s_stats.next_seq = s_next_seq;
+    xSemaphoreGive(s_lock);
+    return ret;
+}
+
+esp_err_t sensor_log_flush(void)
+{
+    if (s_part == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    bool ok = submit_active_locked();
+    s_stats.next_seq = s_next_seq;
+    xSemaphoreGive(s_lock);
+
+    return ok ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+esp_err_t sensor_log_foreach(sensor_log_cb_t cb, void *ctx)
+{
+    if (cb == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_part == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    uint8_t *buf = alloc_page();
+    if (buf == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    uint32_t start = s_next_sector;
+    xSemaphoreGive(s_lock);
+
+    // 扇区按页序号依次写入，从下一写入位置 (最旧页) 开始环形遍历即为页序号顺序
+    bool keep_going = true;
+    for (uint32_t i = 0; i < s_stats.pages_total && keep_going; i++) {
+        uint32_t sector = (start + i) % s_stats.pages_total;
+        if (esp_partition_read(s_part, (size_t)sector * SENSOR_LOG_PAGE_SIZE,
+                               buf, SENSOR_LOG_PAGE_SIZE) != ESP_OK) {
+            continue;
+        }
+
+        sensor_log_page_hdr_t hdr;
+        if (!sensor_log_page_verify(buf, SENSOR_LOG_PAGE_SIZE, &hdr)) {
+            continue;
+        }
+
+        sensor_log_decoder_t dec;
+        sensor_log_record_t rec;
+        sensor_log_decoder_init(&dec, buf + PAGE_HDR_SIZE, hdr.payload_len, hdr.count);
+        while (keep_going && sensor_log_decoder_next(&dec, &rec)) {
+            keep_going = cb(&rec, ctx);
+        }
+    }
+
+    free(buf);
+    return ESP_OK;
+}
+
+void sensor_log_get_stats(sensor_log_stats_t *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+
+    if (s_lock == NULL) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    *stats = s_stats;
+    xSemaphoreGive(s_lock);
+}
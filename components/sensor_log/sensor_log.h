@@ -0,0 +1,95 @@
+/**
+ * @file sensor_log.h
+ * @brief 掉电保持的传感器归档日志 (专用 Flash 分区)
+ *
+ * 追加写、日志结构：
+ * - 分区按扇区 (4KB) 划分为页，页在 RAM 中编码满后整页写入
+ * - 页按序号循环写入所有扇区，擦除次数均匀分布
+ * - 每页带序号与 CRC，掉电撕裂最多丢失正在写入的一页
+ * - Flash 写入在独立的低优先级任务中完成，调用方只做内存编码
+ */
+
+#ifndef SENSOR_LOG_H
+#define SENSOR_LOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "sensor_log_codec.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 分区标签与子类型 (见 partitions.csv)
+#define SENSOR_LOG_PARTITION_LABEL   "sensorlog"
+#define SENSOR_LOG_PARTITION_SUBTYPE 0x40
+#define SENSOR_LOG_PAGE_SIZE         4096
+
+/**
+ * @brief 归档统计
+ */
+typedef struct {
+    uint32_t pages_total;       // 分区页数
+    uint32_t pages_valid;       // 挂载时有效页数
+    uint32_t pages_corrupt;     // 挂载时 CRC 校验失败页数
+    uint32_t pages_written;     // 本次启动写入页数
+    uint32_t next_seq;          // 下一页序号
+    uint32_t records_appended;  // 本次启动追加记录数
+    uint32_t records_dropped;   // 写入任务忙导致丢弃的记录数
+    uint32_t raw_bytes;         // 已写入页的未压缩字节数
+    uint32_t encoded_bytes;     // 已写入页的压缩后字节数
+} sensor_log_stats_t;
+
+/**
+ * @brief 逐条读取回调
+ *
+ * @return true 继续，false 停止遍历
+ */
+typedef bool (*sensor_log_cb_t)(const sensor_log_record_t *rec, void *ctx);
+
+/**
+ * @brief 挂载归档分区并启动写入任务
+ *
+ * @param task_priority 写入任务优先级
+ * @return esp_err_t ESP_OK 成功，ESP_ERR_NOT_FOUND 分区不存在
+ */
+esp_err_t sensor_log_init(uint32_t task_priority);
+
+/**
+ * @brief 追加一条记录 (仅内存编码，不阻塞于 Flash)
+ *
+ * @param rec 记录
+ * @return esp_err_t ESP_OK 成功，ESP_ERR_NO_MEM 写入任务积压丢弃
+ */
+esp_err_t sensor_log_append(const sensor_log_record_t *rec);
+
+/**
+ * @brief 将当前未满页提交写入 (例如计划重启前调用)
+ *
+ * @return esp_err_t ESP_OK 成功
+ */
+esp_err_t sensor_log_flush(void);
+
+/**
+ * @brief 按写入顺序 (页序号递增) 遍历 Flash 中的全部有效记录
+ *
+ * 时钟未同步时写入的记录时间戳为上电以来秒数 (< SENSOR_LOG_TS_WALL_MIN)，
+ * 跨重启不单调，先后关系以遍历顺序为准。
+ *
+ * @param cb 回调
+ * @param ctx 回调上下文
+ * @return esp_err_t ESP_OK 成功
+ */
+esp_err_t sensor_log_foreach(sensor_log_cb_t cb, void *ctx);
+
+/**
+ * @brief 获取统计信息
+ */
+void sensor_log_get_stats(sensor_log_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SENSOR_LOG_H
@@ -0,0 +1,324 @@
+/**
+ * @file sensor_log_codec.c
+ * @brief 传感器归档日志编解码实现
+ */
+
+#include "sensor_log_codec.h"
+#include <string.h>
+
+// ==================== CRC32 ====================
+
+static const uint32_t s_crc_nibble[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+    0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+    0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+};
+
+uint32_t sensor_log_crc32(uint32_t crc, const void *data, size_t len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    crc = ~crc;
+    while (len--) {
+        crc ^= *p++;
+        crc = (crc >> 4) ^ s_crc_nibble[crc & 0x0F];
+        crc = (crc >> 4) ^ s_crc_nibble[crc & 0x0F];
+    }
+    return ~crc;
+}
+
+// ==================== 位流 ====================
+
+static void bits_write(sensor_log_bits_t *b, uint32_t value, uint8_t nbits)
+{
+    if (b->overflow || b->pos + nbits > b->cap_bits) {
+        b->overflow = true;
+        return;
+    }
+
+    // 高位在前
+    while (nbits > 0) {
+        nbits--;
+        uint8_t mask = (uint8_t)(0x80 >> (b->pos & 7));
+        if ((value >> nbits) & 1u) {
+            b->buf[b->pos >> 3] |= mask;
+        } else {
+            b->buf[b->pos >> 3] &= (uint8_t)~mask;
+        }
+        b->pos++;
+    }
+}
+
+static uint32_t bits_read(sensor_log_bits_t *b, uint8_t nbits)
+{
+    if (b->overflow || b->pos + nbits > b->cap_bits) {
+        b->overflow = true;
+        return 0;
+    }
+
+    uint32_t value = 0;
+    while (nbits--) {
+        value = (value << 1) | ((b->buf[b->pos >> 3] >> (7 - (b->pos & 7))) & 1u);
+        b->pos++;
+    }
+    return value;
+}
+
+static void bits_write_varint(sensor_log_bits_t *b, uint32_t value)
+{
+    while (value >= 0x80) {
+        bits_write(b, (value & 0x7F) | 0x80, 8);
+        value >>= 7;
+    }
+    bits_write(b, value, 8);
+}
+
+static uint32_t bits_read_varint(sensor_log_bits_t *b)
+{
+    uint32_t value = 0;
+    for (uint8_t shift = 0; shift < 35; shift += 7) {
+        uint32_t byte = bits_read(b, 8);
+        value |= (byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0 || b->overflow) {
+            break;
+        }
+    }
+    return value;
+}
+
+static inline uint32_t zigzag_encode(int32_t v)
+{
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static inline int32_t zigzag_decode(uint32_t v)
+{
+    return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+// ==================== Gorilla XOR 浮点 ====================
+
+static inline uint32_t float_bits(float f)
+{
+    uint32_t u;
+    memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+static inline float bits_float(uint32_t u)
+{
+    float f;
+    memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+static void xor_encode(sensor_log_bits_t *b, sensor_log_xor_state_t *st, float value)
+{
+    uint32_t cur = float_bits(value);
+    uint32_t x = cur ^ st->prev;
+    st->prev = cur;
+
+    if (x == 0) {
+        bits_write(b, 0, 1);
+        return;
+    }
+    bits_write(b, 1, 1);
+
+    uint8_t lead = (uint8_t)__builtin_clz(x);
+    uint8_t trail = (uint8_t)__builtin_ctz(x);
+
+    if (st->has_window && lead >= st->lead && trail >= st->trail) {
+        // 复用上一个有效位窗口
+        bits_write(b, 0, 1);
+        bits_write(b, x >> st->trail, (uint8_t)(32 - st->lead - st->trail));
+        return;
+    }
+
+    uint8_t len = (uint8_t)(32 - lead - trail);
+    bits_write(b, 1, 1);
+    bits_write(b, lead, 5);
+    bits_write(b, len - 1u, 5);
+    bits_write(b, x >> trail, len);
+    st->lead = lead;
+    st->trail = trail;
+    st->has_window = true;
+}
+
+static float xor_decode(sensor_log_bits_t *b, sensor_log_xor_state_t *st)
+{
+    if (bits_read(b, 1) == 0) {
+        return bits_float(st->prev);
+    }
+
+    uint32_t x;
+    if (bits_read(b, 1) == 0) {
+        if (!st->has_window) {
+            b->overflow = true;
+            return 0.0f;
+        }
+        x = bits_read(b, (uint8_t)(32 - st->lead - st->trail)) << st->trail;
+    } else {
+        uint8_t lead = (uint8_t)bits_read(b, 5);
+        uint8_t len = (uint8_t)(bits_read(b, 5) + 1);
+        if (lead + len > 32) {
+            b->overflow = true;
+            return 0.0f;
+        }
+        uint8_t trail = (uint8_t)(32 - lead - len);
+        uint32_t meaningful = bits_read(b, len);
+        x = meaningful << trail;
+        st->lead = lead;
+        st->trail = trail;
+        st->has_window = true;
+    }
+
+    st->prev ^= x;
+    return bits_float(st->prev);
+}
+
+// ==================== 编码 ====================
+
+void sensor_log_encoder_init(sensor_log_encoder_t *enc, uint8_t *payload, size_t capacity)
+{
+    memset(enc, 0, sizeof(*enc));
+    enc->bits.buf = payload;
+    enc->bits.cap_bits = capacity * 8;
+}
+
+bool sensor_log_encoder_append(sensor_log_encoder_t *enc, const sensor_log_record_t *rec)
+{
+    if (enc->count == UINT16_MAX) {
+        return false;
+    }
+
+    // 失败时整体回滚
+    sensor_log_encoder_t saved = *enc;
+    sensor_log_bits_t *b = &enc->bits;
+
+    if (enc->count == 0) {
+        bits_write(b, rec->ts, 32);
+        enc->first_ts = rec->ts;
+    } else {
+        int32_t delta = (int32_t)(rec->ts - enc->prev_ts);
+        int32_t dod = delta - enc->prev_delta;
+        if (dod == 0) {
+            bits_write(b, 0, 1);
+        } else {
+            bits_write(b, 1, 1);
+            bits_write_varint(b, zigzag_encode(dod));
+        }
+        enc->prev_delta = delta;
+    }
+    enc->prev_ts = rec->ts;
+
+    xor_encode(b, &enc->xor_state[0], rec->temperature);
+    xor_encode(b, &enc->xor_state[1], rec->humidity);
+    xor_encode(b, &enc->xor_state[2], rec->light);
+
+    bits_write_varint(b, zigzag_encode((int32_t)(rec->smoke - enc->prev_smoke)));
+    enc->prev_smoke = rec->smoke;
+
+    if (b->overflow) {
+        *enc = saved;
+        return false;
+    }
+
+    enc->count++;
+    return true;
+}
+
+size_t sensor_log_encoder_bytes(const sensor_log_encoder_t *enc)
+{
+    return (enc->bits.pos + 7) / 8;
+}
+
+void sensor_log_page_finalize(uint8_t *page, uint32_t seq, const sensor_log_encoder_t *enc)
+{
+    sensor_log_page_hdr_t hdr = {
+        .magic = SENSOR_LOG_PAGE_MAGIC,
+        .seq = seq,
+        .first_ts = enc->first_ts,
+        .count = enc->count,
+        .payload_len = (uint16_t)sensor_log_encoder_bytes(enc),
+        .crc = 0,
+    };
+
+    // 最后一个字节中未使用的低位清零，保证 CRC 可复现
+    size_t pos = enc->bits.pos;
+    if (pos & 7) {
+        page[sizeof(hdr) + (pos >> 3)] &= (uint8_t)(0xFF << (8 - (pos & 7)));
+    }
+
+    uint32_t crc = sensor_log_crc32(0, &hdr, offsetof(sensor_log_page_hdr_t, crc));
+    hdr.crc = sensor_log_crc32(crc, page + sizeof(hdr), hdr.payload_len);
+    memcpy(page, &hdr, sizeof(hdr));
+}
+
+bool sensor_log_page_verify(const uint8_t *page, size_t page_size, sensor_log_page_hdr_t *hdr)
+{
+    sensor_log_page_hdr_t h;
+    memcpy(&h, page, sizeof(h));
+
+    if (h.magic != SENSOR_LOG_PAGE_MAGIC || h.count == 0 ||
+        h.payload_len > page_size - sizeof(h)) {
+        return false;
+    }
+
+    uint32_t crc = sensor_log_crc32(0, &h, offsetof(sensor_log_page_hdr_t, crc));
+    crc = sensor_log_crc32(crc, page + sizeof(h), h.payload_len);
+    if (crc != h.crc) {
+        return false;
+    }
+
+    if (hdr != NULL) {
+        *hdr = h;
+    }
+    return true;
+}
+
+// ==================== 解码 ====================
+
+void sensor_log_decoder_init(sensor_log_decoder_t *dec, const uint8_t *payload, size_t len,
+                             uint16_t count)
+{
+    memset(dec, 0, sizeof(*dec));
+    dec->bits.buf = (uint8_t *)payload;     // 解码只读
+    dec->bits.cap_bits = len * 8;
+    dec->remaining = count;
+}
+
+bool sensor_log_decoder_next(sensor_log_decoder_t *dec, sensor_log_record_t *rec)
+{
+    if (dec->remaining == 0 || dec->bits.overflow) {
+        return false;
+    }
+
+    sensor_log_bits_t *b = &dec->bits;
+
+    if (dec->index == 0) {
+        rec->ts = bits_read(b, 32);
+    } else {
+        int32_t dod = 0;
+        if (bits_read(b, 1)) {
+            dod = zigzag_decode(bits_read_varint(b));
+        }
+        dec->prev_delta += dod;
+        rec->ts = dec->prev_ts + (uint32_t)dec->prev_delta;
+    }
+    dec->prev_ts = rec->ts;
+
+    rec->temperature = xor_decode(b, &dec->xor_state[0]);
+    rec->humidity = xor_decode(b, &dec->xor_state[1]);
+    rec->light = xor_decode(b, &dec->xor_state[2]);
+
+    dec->prev_smoke += (uint32_t)zigzag_decode(bits_read_varint(b));
+    rec->smoke = dec->prev_smoke;
+
+    if (b->overflow) {
+        return false;
+    }
+
+    dec->index++;
+    dec->remaining--;
+    return true;
+}
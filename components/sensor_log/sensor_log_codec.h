@@ -0,0 +1,164 @@
+/**
+ * @file sensor_log_codec.h
+ * @brief 传感器归档日志编解码 (与平台无关，可在主机上编译)
+ *
+ * 页内记录按位流压缩：
+ * - 时间戳：首条 32 位原值，之后为二阶差分 (0 时仅 1 位)
+ * - 温度/湿度/光照：Gorilla 风格 XOR 浮点压缩
+ * - MQ2 ADC 值：差分 + zigzag + varint
+ *
+ * 每页独立编码 (首条记录不依赖上一页)，页头带序号和 CRC32，
+ * 撕裂写入只会损坏当页。
+ */
+
+#ifndef SENSOR_LOG_CODEC_H
+#define SENSOR_LOG_CODEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SENSOR_LOG_PAGE_MAGIC 0x474F4C53u   // "SLOG"
+
+// 不小于此值的时间戳为墙钟 (Unix 秒)，小于此值为时钟未同步时的上电以来秒数
+#define SENSOR_LOG_TS_WALL_MIN 1704067200u  // 2024-01-01
+
+/**
+ * @brief 一条归档记录
+ */
+typedef struct {
+    uint32_t ts;            // 时间戳 (秒，见 SENSOR_LOG_TS_WALL_MIN)
+    float temperature;
+    float humidity;
+    float light;
+    uint32_t smoke;         // MQ2 ADC 原始值
+} sensor_log_record_t;
+
+/**
+ * @brief 页头 (位于每页起始处)
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint32_t seq;           // 页序号，单调递增
+    uint32_t first_ts;      // 首条记录时间戳
+    uint16_t count;         // 记录条数
+    uint16_t payload_len;   // 载荷字节数
+    uint32_t crc;           // 页头 (不含 crc) + 载荷的 CRC32
+} sensor_log_page_hdr_t;
+
+// 浮点 XOR 压缩状态
+typedef struct {
+    uint32_t prev;
+    uint8_t lead;
+    uint8_t trail;
+    bool has_window;
+} sensor_log_xor_state_t;
+
+// 位流
+typedef struct {
+    uint8_t *buf;
+    size_t cap_bits;
+    size_t pos;
+    bool overflow;
+} sensor_log_bits_t;
+
+/**
+ * @brief 页编码器
+ */
+typedef struct {
+    sensor_log_bits_t bits;
+    uint16_t count;
+    uint32_t first_ts;
+    uint32_t prev_ts;
+    int32_t prev_delta;
+    sensor_log_xor_state_t xor_state[3];
+    uint32_t prev_smoke;
+} sensor_log_encoder_t;
+
+/**
+ * @brief 页解码器
+ */
+typedef struct {
+    sensor_log_bits_t bits;
+    uint16_t remaining;
+    uint16_t index;
+    uint32_t prev_ts;
+    int32_t prev_delta;
+    sensor_log_xor_state_t xor_state[3];
+    uint32_t prev_smoke;
+} sensor_log_decoder_t;
+
+/**
+ * @brief CRC32 (IEEE 802.3, 反射多项式 0xEDB88320)
+ *
+ * @param crc 上一段的结果 (首段传 0)
+ */
+uint32_t sensor_log_crc32(uint32_t crc, const void *data, size_t len);
+
+/**
+ * @brief 初始化编码器
+ *
+ * @param enc 编码器
+ * @param payload 载荷缓冲区
+ * @param capacity 载荷缓冲区字节数
+ */
+void sensor_log_encoder_init(sensor_log_encoder_t *enc, uint8_t *payload, size_t capacity);
+
+/**
+ * @brief 追加一条记录
+ *
+ * @return true 成功；false 空间不足 (编码器状态保持不变)
+ */
+bool sensor_log_encoder_append(sensor_log_encoder_t *enc, const sensor_log_record_t *rec);
+
+/**
+ * @brief 当前载荷字节数
+ */
+size_t sensor_log_encoder_bytes(const sensor_log_encoder_t *enc);
+
+/**
+ * @brief 填写页头 (载荷需紧跟在页头之后)
+ *
+ * @param page 页起始地址
+ * @param seq 页序号
+ * @param enc 已编码的编码器 (载荷缓冲区为 page + sizeof(hdr))
+ */
+void sensor_log_page_finalize(uint8_t *page, uint32_t seq, const sensor_log_encoder_t *enc);
+
+/**
+ * @brief 校验页并取出页头
+ *
+ * @param page 页起始地址
+ * @param page_size 页大小
+ * @param hdr 输出页头 (可为 NULL)
+ * @return true 魔数、长度和 CRC 均有效
+ */
+bool sensor_log_page_verify(const uint8_t *page, size_t page_size, sensor_log_page_hdr_t *hdr);
+
+/**
+ * @brief 初始化解码器
+ *
+ * @param dec 解码器
+ * @param payload 载荷
+ * @param len 载荷字节数
+ * @param count 记录条数
+ */
+void sensor_log_decoder_init(sensor_log_decoder_t *dec, const uint8_t *payload, size_t len,
+                             uint16_t count);
+
+/**
+ * @brief 解码下一条记录
+ *
+ * @return true 成功；false 已结束或数据损坏
+ */
+bool sensor_log_decoder_next(sensor_log_decoder_t *dec, sensor_log_record_t *rec);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SENSOR_LOG_CODEC_H
@@ -0,0 +1,264 @@
+/**
+ * @file sensor_sched.c
+ * @brief 多速率传感器采样调度器实现
+ *
+ * 调度策略：
+ * - 每个采样项维护下一次计划时刻 (微秒)
+ * - 循环中选出所有已到期项里优先级最高者执行，同优先级取计划时刻最早者
+ * - 无到期项时休眠到最近的计划时刻
+ * - 严重滞后 (超过一个周期) 时跳过错过的周期，避免突发补采
+ * - 回调返回 ESP_ERR_NOT_FINISHED 时在 poll_ms 后重新轮询，
+ *   统计在最终完成时按原计划时刻结算
+ */
+
+#include "sensor_sched.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include <stdbool.h>
+#include <string.h>
+
+static const char *TAG = "SENSOR_SCHED";
+
+#define SCHED_MAX_SLEEP_US  1000000     // 单次休眠上限
+
+typedef struct {
+    sensor_sched_entry_t cfg;
+    int64_t next_due_us;
+
+    // 分阶段采样进行中
+    bool in_progress;
+    int64_t phase_due_us;       // 本次采样的原计划时刻
+    int64_t first_start_us;     // 首次回调开始时刻
+    uint32_t exec_acc_us;       // 已累计的回调耗时
+
+    // 统计 (受 s_stats_lock 保护)
+    uint32_t runs;
+    uint32_t errors;
+    uint32_t deadline_misses;
+    uint32_t skipped;
+    uint64_t jitter_sum_us;
+    uint32_t jitter_max_us;
+    uint64_t exec_sum_us;
+    uint32_t exec_max_us;
+} sched_slot_t;
+
+static sched_slot_t s_slots[SENSOR_SCHED_MAX_ENTRIES];
+static size_t s_slot_count = 0;
+static portMUX_TYPE s_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+esp_err_t sensor_sched_init(void)
+{
+    memset(s_slots, 0, sizeof(s_slots));
+    s_slot_count = 0;
+    return ESP_OK;
+}
+
+esp_err_t sensor_sched_add(const sensor_sched_entry_t *entry)
+{
+    if (entry == NULL || entry->read == NULL || entry->period_ms == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (s_slot_count >= SENSOR_SCHED_MAX_ENTRIES) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    sched_slot_t *slot = &s_slots[s_slot_count];
+    memset(slot, 0, sizeof(*slot));
+    slot->cfg = *entry;
+    if (slot->cfg.deadline_ms == 0) {
+        slot->cfg.deadline_ms = slot->cfg.period_ms;
+    }
+    if (slot->cfg.poll_ms == 0) {
+        slot->cfg.poll_ms = SENSOR_SCHED_DEFAULT_POLL_MS;
+    }
+    s_slot_count++;
+
+    ESP_LOGI(TAG, "Added %s: period=%lums deadline=%lums prio=%d",
+             entry->name ? entry->name : "?",
+             (unsigned long)slot->cfg.period_ms,
+             (unsigned long)slot->cfg.deadline_ms,
+             slot->cfg.priority);
+    return ESP_OK;
+}
+
+static sched_slot_t *pick_due_slot(int64_t now_us)
+{
+    sched_slot_t *best = NULL;
+
+    for (size_t i = 0; i < s_slot_count; i++) {
+        sched_slot_t *slot = &s_slots[i];
+        if (slot->next_due_us > now_us) {
+            continue;
+        }
+        if (best == NULL ||
+            slot->cfg.priority > best->cfg.priority ||
+            (slot->cfg.priority == best->cfg.priority &&
+             slot->next_due_us < best->next_due_us)) {
+            best = slot;
+        }
+    }
+    return best;
+}
+
+static int64_t earliest_due_us(void)
+{
+    int64_t earliest = INT64_MAX;
+    for (size_t i = 0; i < s_slot_count; i++) {
+        if (s_slots[i].next_due_us < earliest) {
+            earliest = s_slots[i].next_due_us;
+        }
+    }
+    return earliest;
+}
+
+static void run_slot(sched_slot_t *slot, int64_t start_us)
+{
+    if (!slot->in_progress) {
+        slot->phase_due_us = slot->next_due_us;
+        slot->first_start_us = start_us;
+        slot->exec_acc_us = 0;
+    }
+
+    int64_t due_us = slot->phase_due_us;
+    esp_err_t ret = slot->cfg.read(slot->cfg.ctx);
+    int64_t end_us = esp_timer_get_time();
+    slot->exec_acc_us += (uint32_t)(end_us - start_us);
+
+    // 转换未完成：稍后重新轮询，不结算统计
+    if (ret == ESP_ERR_NOT_FINISHED) {
+        slot->in_progress = true;
+        slot->next_due_us = end_us + (int64_t)slot->cfg.poll_ms * 1000;
+        return;
+    }
+    slot->in_progress = false;
+
+    uint32_t jitter_us = (uint32_t)(slot->first_start_us - due_us);
+    uint32_t exec_us = slot->exec_acc_us;
+    bool missed = (end_us - due_us) > (int64_t)slot->cfg.deadline_ms * 1000;
+
+    // 计算下一次计划时刻，保持相位；滞后超过一个周期则跳过
+    int64_t period_us = (int64_t)slot->cfg.period_ms * 1000;
+    uint32_t skipped = 0;
+    slot->next_due_us = due_us + period_us;
+    while (slot->next_due_us <= end_us) {
+        slot->next_due_us += period_us;
+        skipped++;
+    }
+
+    portENTER_CRITICAL(&s_stats_lock);
+    slot->runs++;
+    if (ret != ESP_OK) {
+        slot->errors++;
+    }
+    if (missed) {
+        slot->deadline_misses++;
+    }
+    slot->skipped += skipped;
+    slot->jitter_sum_us += jitter_us;
+    if (jitter_us > slot->jitter_max_us) {
+        slot->jitter_max_us = jitter_us;
+    }
+    slot->exec_sum_us += exec_us;
+    if (exec_us > slot->exec_max_us) {
+        slot->exec_max_us = exec_us;
+    }
+    portEXIT_CRITICAL(&s_stats_lock);
+}
+
+void sensor_sched_run(void)
+{
+    int64_t now_us = esp_timer_get_time();
+    for (size_t i = 0; i < s_slot_count; i++) {
+        s_slots[i].next_due_us = now_us;
+        s_slots[i].in_progress = false;
+    }
+
+    ESP_LOGI(TAG, "Scheduler running with %d entries", (int)s_slot_count);
+
+    while (1) {
+        now_us = esp_timer_get_time();
+        sched_slot_t *slot = pick_due_slot(now_us);
+        if (slot != NULL) {
+            run_slot(slot, now_us);
+            continue;
+        }
+
+        // 无启用条目时 earliest_due_us() 为 INT64_MAX：先限幅再换算，避免溢出
+        int64_t wait_us = earliest_due_us() - now_us;
+        if (wait_us > SCHED_MAX_SLEEP_US) {
+            wait_us = SCHED_MAX_SLEEP_US;
+        }
+        TickType_t ticks = pdMS_TO_TICKS((wait_us + 999) / 1000);
+        vTaskDelay(ticks > 0 ? ticks : 1);
+    }
+}
+
+size_t sensor_sched_get_stats(sensor_sched_stats_t *out, size_t max)
+{
+    if (out == NULL) {
+        return 0;
+    }
+
+    size_t count = (s_slot_count < max) ? s_slot_count : max;
+
+    portENTER_CRITICAL(&s_stats_lock);
+    for (size_t i = 0; i < count; i++) {
+        const sched_slot_t *slot = &s_slots[i];
+        sensor_sched_stats_t *st = &out[i];
+        st->name = slot->cfg.name;
+        st->period_ms = slot->cfg.period_ms;
+        st->runs = slot->runs;
+        st->errors = slot->errors;
+        st->deadline_misses = slot->deadline_misses;
+        st->skipped = slot->skipped;
+        st->jitter_avg_us = slot->runs ? (uint32_t)(slot->jitter_sum_us / slot->runs) : 0;
+        st->jitter_max_us = slot->jitter_max_us;
+        st->exec_avg_us = slot->runs ? (uint32_t)(slot->exec_sum_us / slot->runs) : 0;
+        st->exec_max_us = slot->exec_max_us;
+    }
+    portEXIT_CRITICAL(&s_stats_lock);
+
+    return count;
+}
+
+esp_err_t sensor_sched_set_period(const char *name, uint32_t period_ms)
+{
+    if (name == NULL || period_ms == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    for (size_t i = 0; i < s_slot_count; i++) {
+        sched_slot_t *slot = &s_slots[i];
+        if (slot->cfg.name == NULL || strcmp(slot->cfg.name, name) != 0) {
+            continue;
+        }
+        if (slot->cfg.period_ms != period_ms) {
+            portENTER_CRITICAL(&s_stats_lock);
+            slot->cfg.period_ms = period_ms;
+            portEXIT_CRITICAL(&s_stats_lock);
+            ESP_LOGD(TAG, "%s period -> %lums", name, (unsigned long)period_ms);
+        }
+        return ESP_OK;
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+void sensor_sched_reset_stats(void)
+{
+    portENTER_CRITICAL(&s_stats_lock);
+    for (size_t i = 0; i < s_slot_count; i++) {
+        sched_slot_t *slot = &s_slots[i];
+        slot->runs = 0;
+        slot->errors = 0;
+        slot->deadline_misses = 0;
+        slot->skipped = 0;
+        slot->jitter_sum_us = 0;
+        slot->jitter_max_us = 0;
+        slot->exec_sum_us = 0;
+        slot->exec_max_us = 0;
+    }
+    portEXIT_CRITICAL(&s_stats_lock);
+}
@@ -0,0 +1,118 @@
+/**
+ * @file sensor_sched.h
+ * @brief 多速率传感器采样调度器
+ *
+ * 每个传感器拥有独立的采样周期、截止时间和优先级，
+ * 同一时刻多个传感器到期时按优先级先后执行。
+ * 采样回调把结果写入 app_state，控制路径经 app_state 订阅得知数据变化。
+ */
+
+#ifndef SENSOR_SCHED_H
+#define SENSOR_SCHED_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 最多可注册的采样项数量
+#define SENSOR_SCHED_MAX_ENTRIES 8
+
+// 默认重新轮询间隔 (毫秒)
+#define SENSOR_SCHED_DEFAULT_POLL_MS 10
+
+/**
+ * @brief 采样回调
+ *
+ * 分阶段采样 (先触发转换、稍后取结果) 的回调在转换未完成时返回
+ * ESP_ERR_NOT_FINISHED，调度器在 poll_ms 后再次调用，期间任务休眠。
+ *
+ * @param ctx 注册时传入的上下文
+ * @return esp_err_t ESP_OK 表示本次采样完成；
+ *         ESP_ERR_NOT_FINISHED 表示稍后重新轮询
+ */
+typedef esp_err_t (*sensor_sched_read_fn_t)(void *ctx);
+
+/**
+ * @brief 采样项配置
+ */
+typedef struct {
+    const char *name;               // 名称 (用于日志和统计)
+    uint32_t period_ms;             // 采样周期
+    uint32_t deadline_ms;           // 截止时间 (相对计划时刻，0 表示等于周期)
+    uint8_t priority;               // 优先级 (数值越大越优先)
+    uint32_t poll_ms;               // 未完成时的重新轮询间隔 (0 表示默认值)
+    sensor_sched_read_fn_t read;    // 采样回调
+    void *ctx;                      // 回调上下文
+} sensor_sched_entry_t;
+
+/**
+ * @brief 单个采样项的运行统计
+ *
+ * 抖动定义为实际开始时刻相对计划时刻的滞后。
+ * 分阶段采样的执行耗时为各次回调耗时之和 (不含等待转换的时间)。
+ */
+typedef struct {
+    const char *name;
+    uint32_t period_ms;
+    uint32_t runs;              // 执行次数
+    uint32_t errors;            // 回调返回失败次数
+    uint32_t deadline_misses;   // 超过截止时间完成的次数
+    uint32_t skipped;           // 因严重滞后被跳过的周期数
+    uint32_t jitter_avg_us;     // 平均开始抖动
+    uint32_t jitter_max_us;     // 最大开始抖动
+    uint32_t exec_avg_us;       // 平均执行耗时
+    uint32_t exec_max_us;       // 最大执行耗时
+} sensor_sched_stats_t;
+
+/**
+ * @brief 初始化调度器 (清空已注册的采样项)
+ *
+ * @return esp_err_t ESP_OK 成功
+ */
+esp_err_t sensor_sched_init(void);
+
+/**
+ * @brief 注册采样项 (需在 sensor_sched_run 之前调用)
+ *
+ * @param entry 采样项配置 (内容会被复制)
+ * @return esp_err_t ESP_OK 成功，ESP_ERR_NO_MEM 已满
+ */
+esp_err_t sensor_sched_add(const sensor_sched_entry_t *entry);
+
+/**
+ * @brief 在当前任务中运行调度循环 (不返回)
+ */
+void sensor_sched_run(void);
+
+/**
+ * @brief 获取各采样项统计
+ *
+ * @param out 输出数组
+ * @param max 数组容量
+ * @return size_t 实际写入数量
+ */
+size_t sensor_sched_get_stats(sensor_sched_stats_t *out, size_t max);
+
+/**
+ * @brief 运行时修改采样周期 (可在采样回调中调用，完成本次采样后即生效)
+ *
+ * @param name 采样项名称
+ * @param period_ms 新周期
+ * @return esp_err_t ESP_OK 成功，ESP_ERR_NOT_FOUND 名称不存在
+ */
+esp_err_t sensor_sched_set_period(const char *name, uint32_t period_ms);
+
+/**
+ * @brief 清零统计数据
+ */
+void sensor_sched_reset_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SENSOR_SCHED_H
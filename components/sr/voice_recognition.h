@@ -2,39 +2,12 @@
 #define VOICE_RECOGNITION_H
 
 #include "esp_err.h"
+#include "app_types.h"    // vr_command_t / vr_vad_state_t
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-/**
- * @brief 语音命令枚举
- */
-typedef enum {
-    VR_CMD_WAKE_UP = 0,     // 唤醒
-    VR_CMD_LIGHT_ON,        // 打开灯光
-    VR_CMD_LIGHT_OFF,       // 关闭灯光
-    VR_CMD_FAN_ON,          // 打开风扇
-    VR_CMD_FAN_OFF,         // 关闭风扇
-    VR_CMD_CURTAIN_OPEN,    // 打开窗帘
-    VR_CMD_CURTAIN_CLOSE,   // 关闭窗帘
-    VR_CMD_RGB_RED,         // RGB 红色
-    VR_CMD_RGB_GREEN,       // RGB 绿色
-    VR_CMD_RGB_BLUE,        // RGB 蓝色
-    VR_CMD_MODE_AUTO,       // 自动模式
-    VR_CMD_MODE_MANUAL,     // 手动模式
-    VR_CMD_TIMEOUT,         // 语音超时 (退出唤醒)
-    VR_CMD_UNKNOWN          // 未知命令
-} vr_command_t;
-
-/**
- * @brief VAD 状态枚举
- */
-typedef enum {
-    VR_VAD_SILENCE = 0,     // 静音
-    VR_VAD_SPEECH           // 检测到语音
-} vr_vad_state_t;
-
 /**
  * @brief 语音命令回调函数类型
  *
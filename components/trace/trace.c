@@ -0,0 +1,175 @@
+/**
+ * @file trace.c
+ * @brief 控制回路二进制轨迹记录实现
+ */
+
+#include "trace.h"
+#include "freertos/FreeRTOS.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "TRACE";
+
+// 去重表覆盖的 id 范围 (传感器与执行器 id 均小于此值)
+#define TRACE_DEDUP_IDS 8
+
+static trace_record_t *s_buf = NULL;
+static size_t s_capacity = 0;
+static size_t s_head = 0;       // 最旧记录位置
+static size_t s_count = 0;
+static bool s_paused = false;
+static trace_stats_t s_stats;
+
+// 传感器/执行器最近一次记录的值
+static int32_t s_last_value[2][TRACE_DEDUP_IDS];
+static uint8_t s_last_valid[2];
+
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+esp_err_t trace_init(size_t capacity)
+{
+    if (s_buf != NULL) {
+        return ESP_OK;
+    }
+    if (capacity == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    size_t bytes = capacity * sizeof(trace_record_t);
+    s_buf = heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (s_buf == NULL) {
+        s_buf = malloc(bytes);
+    }
+    if (s_buf == NULL) {
+        ESP_LOGE(TAG, "Out of memory (%u records)", (unsigned)capacity);
+        return ESP_ERR_NO_MEM;
+    }
+
+    s_capacity = capacity;
+    trace_clear();
+    ESP_LOGI(TAG, "Trace buffer: %u records (%u KB)",
+             (unsigned)capacity, (unsigned)(bytes / 1024));
+    return ESP_OK;
+}
+
+// 传感器与执行器输出只记录变化 (调用方持有锁)
+static bool is_duplicate_locked(trace_event_t event, uint8_t id, int32_t value)
+{
+    int slot;
+    if (event == TRACE_EV_SENSOR) {
+        slot = 0;
+    } else if (event == TRACE_EV_ACTUATOR && id != TRACE_ACT_BUZZER) {
+        slot = 1;
+    } else {
+        return false;
+    }
+    if (id >= TRACE_DEDUP_IDS) {
+        return false;
+    }
+
+    uint8_t bit = (uint8_t)(1u << id);
+    if ((s_last_valid[slot] & bit) && s_last_value[slot][id] == value) {
+        return true;
+    }
+    s_last_valid[slot] |= bit;
+    s_last_value[slot][id] = value;
+    return false;
+}
+
+void trace_record(trace_event_t event, uint8_t id, int32_t value)
+{
+    if (s_buf == NULL) {
+        return;
+    }
+
+    uint32_t ts_ms = (uint32_t)(esp_timer_get_time() / 1000);
+
+    portENTER_CRITICAL(&s_lock);
+    if (s_paused) {
+        s_stats.lost++;
+    } else if (is_duplicate_locked(event, id, value)) {
+        s_stats.suppressed++;
+    } else {
+        size_t idx = (s_head + s_count) % s_capacity;
+        if (s_count == s_capacity) {
+            s_head = (s_head + 1) % s_capacity;
+            s_stats.overwritten++;
+        } else {
+            s_count++;
+        }
+        s_buf[idx].ts_ms = ts_ms;
+        s_buf[idx].event = (uint8_t)event;
+        s_buf[idx].id = id;
+        s_buf[idx].value = value;
+        s_stats.recorded++;
+    }
+    portEXIT_CRITICAL(&s_lock);
+}
+
+esp_err_t trace_export_begin(trace_file_hdr_t *hdr)
+{
+    if (hdr == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_buf == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    portENTER_CRITICAL(&s_lock);
+    s_paused = true;
+    hdr->magic = TRACE_FILE_MAGIC;
+    hdr->version = TRACE_FILE_VERSION;
+    hdr->record_size = sizeof(trace_record_t);
+    hdr->count = (uint32_t)s_count;
+    hdr->overwritten = s_stats.overwritten;
+    portEXIT_CRITICAL(&s_lock);
+    return ESP_OK;
+}
+
+size_t trace_export_read(size_t index, trace_record_t *out, size_t max)
+{
+    if (s_buf == NULL || out == NULL) {
+        return 0;
+    }
+
+    portENTER_CRITICAL(&s_lock);
+    size_t n = 0;
+    while (n < max && index + n < s_count) {
+        out[n] = s_buf[(s_head + index + n) % s_capacity];
+        n++;
+    }
+    portEXIT_CRITICAL(&s_lock);
+    return n;
+}
+
+void trace_export_end(void)
+{
+    portENTER_CRITICAL(&s_lock);
+    s_paused = false;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+void trace_clear(void)
+{
+    portENTER_CRITICAL(&s_lock);
+    s_head = 0;
+    s_count = 0;
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_stats.capacity = (uint32_t)s_capacity;
+    memset(s_last_valid, 0, sizeof(s_last_valid));
+    portEXIT_CRITICAL(&s_lock);
+}
+
+void trace_get_stats(trace_stats_t *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    portENTER_CRITICAL(&s_lock);
+    *stats = s_stats;
+    stats->count = (uint32_t)s_count;
+    portEXIT_CRITICAL(&s_lock);
+}
@@ -0,0 +1,162 @@
+/**
+ * @file trace.h
+ * @brief 控制回路二进制轨迹记录
+ *
+ * 记录控制逻辑的全部输入与输出，用于复现现场问题 (风扇振荡、漏报警等)：
+ * - 输入：滤波后的传感器读数、HTTP/语音命令、中断报警、周期状态关键帧
+ * - 输出：经 HAL 的执行器写入
+ * 记录为 10 字节定长结构，存放在 PSRAM 环形缓冲区中，满后覆盖最旧记录。
+ * 与上次记录相同的传感器读数/执行器输出不重复记录。
+ *
+ * 导出格式：trace_file_hdr_t + count 条 trace_record_t (小端，由旧到新)。
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TRACE_FILE_MAGIC    0x31435254  // "TRC1"
+#define TRACE_FILE_VERSION  2
+
+// 温湿度以 0.1 为单位记录
+#define TRACE_CLIMATE_SCALE 10
+
+/**
+ * @brief 记录类型
+ */
+typedef enum {
+    TRACE_EV_SENSOR = 1,    // id = trace_sensor_t，value = 定点读数
+    TRACE_EV_VOICE,         // id = vr_command_t
+    TRACE_EV_VAD,           // id = vr_vad_state_t
+    TRACE_EV_HTTP,          // id = trace_http_cmd_t，value = 命令生效后的值
+    TRACE_EV_ALARM,         // 中断报警通路触发，value = 烟雾值
+    TRACE_EV_STATE,         // 周期关键帧，id = trace_state_t
+    TRACE_EV_ACTUATOR,      // id = trace_actuator_t，value = 输出值
+    TRACE_EV_MAX,
+} trace_event_t;
+
+typedef enum {
+    TRACE_SENSOR_TEMPERATURE = 0,   // ×TRACE_CLIMATE_SCALE
+    TRACE_SENSOR_HUMIDITY,          // ×TRACE_CLIMATE_SCALE
+    TRACE_SENSOR_LIGHT,             // lux
+    TRACE_SENSOR_SMOKE,             // ADC 原始值
+} trace_sensor_t;
+
+/**
+ * @brief HTTP 命令 (LED/风扇的 value 为 (state << 8) | 亮度/风速)
+ */
+typedef enum {
+    TRACE_HTTP_LED = 0,
+    TRACE_HTTP_FAN,
+    TRACE_HTTP_CURTAIN,             // 目标开度 0-100
+    TRACE_HTTP_MODE,
+    TRACE_HTTP_SMOKE_THRESHOLD,
+    TRACE_HTTP_RGB_RGB,             // 0xRRGGBB
+    TRACE_HTTP_RGB_COLOR,           // rgb_color_t
+} trace_http_cmd_t;
+
+/**
+ * @brief 状态关键帧字段 (LED/风扇编码同 HTTP 命令)
+ */
+typedef enum {
+    TRACE_STATE_MODE = 0,
+    TRACE_STATE_SMOKE_THRESHOLD,
+    TRACE_STATE_LED,
+    TRACE_STATE_FAN,
+    TRACE_STATE_CURTAIN,
+} trace_state_t;
+
+typedef enum {
+    TRACE_ACT_LED = 0,              // 亮度 (0 = 关闭)
+    TRACE_ACT_FAN,                  // 风速
+    TRACE_ACT_CURTAIN,              // 开度 0-100
+    TRACE_ACT_BUZZER,               // 蜂鸣时长 (ms)，不去重
+    TRACE_ACT_RGB_COLOR,            // rgb_color_t
+    TRACE_ACT_RGB_RGB,              // 0xRRGGBB
+    TRACE_ACT_RGB_BRIGHTNESS,       // 0-100
+    TRACE_ACT_MAX,
+} trace_actuator_t;
+
+/**
+ * @brief 单条记录
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t ts_ms;         // 启动后毫秒数
+    uint8_t event;          // trace_event_t
+    uint8_t id;
+    int32_t value;
+} trace_record_t;
+
+/**
+ * @brief 导出文件头
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t record_size;
+    uint32_t count;
+    uint32_t overwritten;   // 被覆盖的记录数，>0 表示轨迹不是从启动开始
+} trace_file_hdr_t;
+
+/**
+ * @brief 记录统计
+ */
+typedef struct {
+    uint32_t capacity;
+    uint32_t count;
+    uint32_t recorded;      // 累计写入
+    uint32_t overwritten;   // 环形覆盖
+    uint32_t suppressed;    // 与上次相同而跳过
+    uint32_t lost;          // 导出期间暂停而丢弃
+} trace_stats_t;
+
+/**
+ * @brief 初始化轨迹缓冲区 (优先 PSRAM)
+ *
+ * @param capacity 记录条数
+ */
+esp_err_t trace_init(size_t capacity);
+
+/**
+ * @brief 追加一条记录 (任务上下文，未初始化时直接返回)
+ */
+void trace_record(trace_event_t event, uint8_t id, int32_t value);
+
+/**
+ * @brief 开始导出：暂停记录并填写文件头
+ */
+esp_err_t trace_export_begin(trace_file_hdr_t *hdr);
+
+/**
+ * @brief 按由旧到新的顺序读取记录 (须在 begin/end 之间调用)
+ *
+ * @param index 起始序号 (0 为最旧)
+ * @return size_t 实际读取条数
+ */
+size_t trace_export_read(size_t index, trace_record_t *out, size_t max);
+
+/**
+ * @brief 结束导出并恢复记录
+ */
+void trace_export_end(void);
+
+/**
+ * @brief 清空记录
+ */
+void trace_clear(void);
+
+void trace_get_stats(trace_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TRACE_H
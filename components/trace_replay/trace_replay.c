@@ -0,0 +1,302 @@
+/**
+ * @file trace_replay.c
+ * @brief 轨迹回放实现
+ *
+ * 按记录顺序把输入 (传感器/命令/报警/关键帧) 重新施加到 app_state 与 app_control，
+ * 执行器输出由仿真后端接收；每处理一条输入前，比较仿真输出与轨迹中最近一次
+ * 执行器记录，不一致时计数 (同一执行器持续不一致只计一次)。
+ *
+ * 回放会删除并重建 app_state 的互斥锁，实时任务运行时调用会让任务持有已释放的锁，
+ * 因此只在 linux 目标 (主机) 上编译。
+ */
+
+#include "sdkconfig.h"
+#if !CONFIG_IDF_TARGET_LINUX
+#error "trace_replay rebuilds app_state and must not be linked into the device firmware"
+#endif
+
+#include "trace_replay.h"
+#include "app_state.h"
+#include "app_control.h"
+#include "config.h"
+#include "hal.h"
+#include "hal_sim.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include <string.h>
+
+static const char *TAG = "TRACE_REPLAY";
+
+static int64_t s_virtual_us = 0;
+
+typedef struct {
+    int32_t expected[TRACE_ACT_MAX];
+    uint32_t known;         // 已有记录的执行器
+    uint32_t diverged;      // 当前不一致的执行器
+    trace_replay_result_t *result;
+} replay_ctx_t;
+
+static int64_t virtual_now(void)
+{
+    return s_virtual_us;
+}
+
+// 比较器仅用于复现 hal_smoke_alarm_active()，报警动作由 TRACE_EV_ALARM 记录驱动
+static bool on_sim_threshold(uint32_t value, int64_t detect_us, void *ctx)
+{
+    return false;
+}
+
+static int32_t sim_output(const hal_sim_outputs_t *out, trace_actuator_t act)
+{
+    switch (act) {
+        case TRACE_ACT_LED:            return out->led_brightness;
+        case TRACE_ACT_FAN:            return out->fan_speed;
+        case TRACE_ACT_CURTAIN:        return out->curtain_position;
+        case TRACE_ACT_RGB_COLOR:      return out->rgb_color;
+        case TRACE_ACT_RGB_RGB:        return (int32_t)out->rgb_value;
+        case TRACE_ACT_RGB_BRIGHTNESS: return out->rgb_brightness;
+        default:                       return 0;
+    }
+}
+
+static void check_outputs(replay_ctx_t *rc, uint32_t ts_ms)
+{
+    hal_sim_outputs_t out;
+    hal_sim_get_outputs(&out);
+
+    for (int act = 0; act < TRACE_ACT_MAX; act++) {
+        uint32_t bit = 1u << act;
+        if (act == TRACE_ACT_BUZZER || !(rc->known & bit)) {
+            continue;
+        }
+        if (sim_output(&out, (trace_actuator_t)act) == rc->expected[act]) {
+            rc->diverged &= ~bit;
+        } else if (!(rc->diverged & bit)) {
+            rc->diverged |= bit;
+            if (rc->result->mismatches++ == 0) {
+                rc->result->first_mismatch_ms = ts_ms;
+                rc->result->first_mismatch_actuator = (trace_actuator_t)act;
+            }
+        }
+    }
+}
+
+// 与 control_task 一致：读取共享状态执行一次控制逻辑
+static void run_control(sensor_data_t *data, trace_replay_result_t *result)
+{
+    if (app_state_lock() != ESP_OK) {
+        return;
+    }
+    app_control_process(data);
+    app_state_unlock();
+    result->control_runs++;
+}
+
+static void apply_sensor(sensor_data_t *data, hal_sim_sample_t *inputs,
+                         const trace_record_t *rec)
+{
+    if (app_state_lock() != ESP_OK) {
+        return;
+    }
+    switch (rec->id) {
+        case TRACE_SENSOR_TEMPERATURE:
+            data->temperature = (float)rec->value / TRACE_CLIMATE_SCALE;
+            break;
+        case TRACE_SENSOR_HUMIDITY:
+            data->humidity = (float)rec->value / TRACE_CLIMATE_SCALE;
+            break;
+        case TRACE_SENSOR_LIGHT:
+            data->light = (float)rec->value;
+            break;
+        case TRACE_SENSOR_SMOKE:
+            data->smoke = (uint32_t)rec->value;
+            break;
+    }
+    app_state_unlock();
+
+    if (rec->id == TRACE_SENSOR_SMOKE) {
+        inputs->smoke = (uint32_t)rec->value;
+        hal_sim_set_inputs(inputs);
+    }
+}
+
+// HTTP 命令与关键帧中的 LED/风扇编码均为 (state << 8) | 值
+static void apply_command(sensor_data_t *data, trace_http_cmd_t cmd, int32_t value)
+{
+    if (cmd == TRACE_HTTP_RGB_RGB) {
+        hal_rgb_set_rgb((uint8_t)(value >> 16), (uint8_t)(value >> 8), (uint8_t)value);
+        return;
+    }
+    if (cmd == TRACE_HTTP_RGB_COLOR) {
+        hal_rgb_set_color((rgb_color_t)value);
+        return;
+    }
+
+    if (app_state_lock() != ESP_OK) {
+        return;
+    }
+    switch (cmd) {
+        case TRACE_HTTP_LED:
+            data->led_state = (value >> 8) & 1;
+            data->led_brightness = (uint8_t)value;
+            break;
+        case TRACE_HTTP_FAN:
+            data->fan_state = (value >> 8) & 1;
+            data->fan_speed = (uint8_t)value;
+            break;
+        case TRACE_HTTP_CURTAIN:
+            data->curtain_state = (uint8_t)value;
+            break;
+        case TRACE_HTTP_MODE:
+            app_control_set_mode(data, (control_mode_t)value);
+            break;
+        case TRACE_HTTP_SMOKE_THRESHOLD:
+            data->smoke_threshold = (uint32_t)value;
+            break;
+        default:
+            break;
+    }
+    app_state_unlock();
+
+    if (cmd == TRACE_HTTP_SMOKE_THRESHOLD) {
+        hal_smoke_alarm_set_threshold((uint32_t)value);
+    }
+}
+
+static const trace_http_cmd_t s_state_to_cmd[] = {
+    [TRACE_STATE_MODE] = TRACE_HTTP_MODE,
+    [TRACE_STATE_SMOKE_THRESHOLD] = TRACE_HTTP_SMOKE_THRESHOLD,
+    [TRACE_STATE_LED] = TRACE_HTTP_LED,
+    [TRACE_STATE_FAN] = TRACE_HTTP_FAN,
+    [TRACE_STATE_CURTAIN] = TRACE_HTTP_CURTAIN,
+};
+
+esp_err_t trace_replay_run(const uint8_t *data, size_t len, trace_replay_result_t *result)
+{
+    if (data == NULL || result == NULL || len < sizeof(trace_file_hdr_t)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    trace_file_hdr_t hdr;
+    memcpy(&hdr, data, sizeof(hdr));
+    if (hdr.magic != TRACE_FILE_MAGIC || hdr.version != TRACE_FILE_VERSION ||
+        hdr.record_size != sizeof(trace_record_t) ||
+        (len - sizeof(hdr)) / sizeof(trace_record_t) < hdr.count) {
+        ESP_LOGE(TAG, "Invalid trace header");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(result, 0, sizeof(*result));
+    replay_ctx_t rc = { .result = result };
+
+    // 切换到仿真后端与虚拟时钟，重建共享状态
+    const hal_ops_t *prev_ops = hal_get();
+    s_virtual_us = 0;
+    hal_sim_set_clock(virtual_now);
+    app_control_set_clock(virtual_now);
+    hal_register(hal_sim_ops());
+    hal_sim_reset();
+
+    hal_sim_sample_t inputs = {0};
+    hal_sim_set_inputs(&inputs);
+
+    app_state_deinit();
+    app_state_init();
+    sensor_data_t *state = app_state_get();
+    hal_smoke_alarm_enable(state->smoke_threshold, SMOKE_ALARM_HYSTERESIS,
+                           on_sim_threshold, NULL);
+    app_control_init();
+
+    // 被覆盖过的轨迹起点状态未知，从第一个关键帧开始比对
+    bool comparing = (hdr.overwritten == 0);
+    const uint8_t *p = data + sizeof(hdr);
+    uint32_t first_ts = 0;
+    uint32_t last_ts = 0;
+    int64_t start_us = esp_timer_get_time();
+
+    for (uint32_t i = 0; i < hdr.count; i++) {
+        trace_record_t rec;
+        memcpy(&rec, p + (size_t)i * sizeof(rec), sizeof(rec));
+
+        if (i == 0) {
+            first_ts = rec.ts_ms;
+        }
+        last_ts = rec.ts_ms;
+        s_virtual_us = (int64_t)rec.ts_ms * 1000;
+        result->records++;
+
+        bool is_input = (rec.event != TRACE_EV_ACTUATOR && rec.event != TRACE_EV_STATE);
+        if (is_input) {
+            result->inputs++;
+            if (comparing) {
+                check_outputs(&rc, rec.ts_ms);
+            }
+        }
+
+        switch (rec.event) {
+            case TRACE_EV_SENSOR:
+                apply_sensor(state, &inputs, &rec);
+                run_control(state, result);
+                break;
+
+            case TRACE_EV_VOICE:
+                app_control_handle_voice_command((vr_command_t)rec.id);
+                break;
+
+            case TRACE_EV_VAD:
+                app_control_handle_vad_state((vr_vad_state_t)rec.id);
+                break;
+
+            case TRACE_EV_HTTP:
+                apply_command(state, (trace_http_cmd_t)rec.id, rec.value);
+                run_control(state, result);
+                break;
+
+            case TRACE_EV_ALARM:
+                app_control_smoke_alarm((uint32_t)rec.value, virtual_now());
+                break;
+
+            case TRACE_EV_STATE:
+                if (rec.id < sizeof(s_state_to_cmd) / sizeof(s_state_to_cmd[0])) {
+                    apply_command(state, s_state_to_cmd[rec.id], rec.value);
+                }
+                comparing = true;
+                break;
+
+            case TRACE_EV_ACTUATOR:
+                result->actuator_expected++;
+                if (rec.id == TRACE_ACT_BUZZER) {
+                    result->beeps_expected++;
+                } else if (rec.id < TRACE_ACT_MAX) {
+                    rc.expected[rec.id] = rec.value;
+                    rc.known |= 1u << rec.id;
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    if (comparing) {
+        check_outputs(&rc, last_ts);
+    }
+
+    hal_sim_outputs_t out;
+    hal_sim_get_outputs(&out);
+    result->beeps_replayed = out.buzzer_beeps;
+    result->span_ms = last_ts - first_ts;
+    result->elapsed_us = esp_timer_get_time() - start_us;
+
+    hal_sim_set_clock(NULL);
+    app_control_set_clock(NULL);
+    if (prev_ops != NULL) {
+        hal_register(prev_ops);
+    }
+
+    ESP_LOGI(TAG, "Replayed %lu records (%lu s of data) in %lld us: %lu mismatches",
+             (unsigned long)result->records, (unsigned long)(result->span_ms / 1000),
+             (long long)result->elapsed_us, (unsigned long)result->mismatches);
+    return ESP_OK;
+}
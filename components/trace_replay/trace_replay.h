@@ -0,0 +1,55 @@
+/**
+ * @file trace_replay.h
+ * @brief 轨迹回放：以仿真 HAL 驱动控制逻辑并与记录的执行器输出比对
+ *
+ * 面向主机 (ESP-IDF linux 目标 / FreeRTOS POSIX 移植)：回放不等待真实时间，
+ * 虚拟时钟取记录时间戳，一周的数据可在数秒内跑完。
+ * 回放会重建 app_state 并临时切换到仿真后端，不可与实时控制回路同时运行。
+ */
+
+#ifndef TRACE_REPLAY_H
+#define TRACE_REPLAY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "trace.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 回放结果
+ */
+typedef struct {
+    uint32_t records;           // 处理的记录数
+    uint32_t inputs;            // 传感器/命令/报警记录数
+    uint32_t control_runs;      // 控制逻辑执行次数
+    uint32_t actuator_expected; // 轨迹中的执行器记录数
+    uint32_t mismatches;        // 回放输出与记录不一致的次数
+    uint32_t first_mismatch_ms; // 首次不一致时的轨迹时间戳
+    trace_actuator_t first_mismatch_actuator;
+    uint32_t beeps_expected;    // 蜂鸣次数 (依赖系统节拍节流，仅统计不比对)
+    uint32_t beeps_replayed;
+    uint32_t span_ms;           // 轨迹覆盖的时长
+    int64_t elapsed_us;         // 回放耗时 (墙钟)
+} trace_replay_result_t;
+
+/**
+ * @brief 回放一段导出的轨迹 (trace_file_hdr_t + 记录)
+ *
+ * 轨迹被环形覆盖过时，从第一个状态关键帧开始比对。
+ *
+ * @param data 导出数据
+ * @param len 数据长度
+ * @param result 输出回放结果
+ * @return esp_err_t ESP_ERR_INVALID_ARG 格式错误
+ */
+esp_err_t trace_replay_run(const uint8_t *data, size_t len, trace_replay_result_t *result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TRACE_REPLAY_H
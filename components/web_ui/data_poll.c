@@ -0,0 +1,302 @@
+/**
+ * @file data_poll.c
+ * @brief /api/data 条件请求与长轮询实现
+ */
+
+#include "data_poll.h"
+#include "app_state.h"
+#include "config.h"
+#include "session_budget.h"
+#include "esp_log.h"
+#include "esp_random.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "state_json.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char *TAG = "DATA_POLL";
+
+#define POLL_TASK_STACK     3072
+#define POLL_TASK_PRIORITY  2       // 与 APP_TASK_PRIORITY_LOW 一致
+#define POLL_TICK_MS        200     // 检查超时的周期 (也是新登记请求最长的首次检查延迟)
+#define POLL_ETAG_MAX       24      // "xxxxxxxx-4294967295"
+#define POLL_VERSION_MAX    11
+
+typedef struct {
+    httpd_req_t *req;           // 异步请求副本，NULL = 空闲槽位
+    uint32_t version;           // 客户端已有的版本
+    int64_t deadline_us;
+} waiter_t;
+
+static SemaphoreHandle_t s_lock = NULL;
+static TaskHandle_t s_task = NULL;
+static app_state_sub_t s_sub = -1;
+static volatile bool s_running = false;
+static uint32_t s_boot_id = 0;
+
+// 以下状态由 s_lock 保护 (长轮询任务与 httpd 任务共享)
+static waiter_t s_waiters[DATA_POLL_MAX_WAITERS];
+static data_poll_stats_t s_stats;
+
+#define STAT_INC(field)                             \
+    do {                                            \
+        if (s_lock != NULL) {                       \
+            xSemaphoreTake(s_lock, portMAX_DELAY);  \
+            s_stats.field++;                        \
+            xSemaphoreGive(s_lock);                 \
+        }                                           \
+    } while (0)
+
+// ==================== 响应 ====================
+
+static void format_etag(char *buf, size_t size, uint32_t version)
+{
+    snprintf(buf, size, "\"%08lx-%lu\"", (unsigned long)s_boot_id, (unsigned long)version);
+}
+
+static void set_version_headers(httpd_req_t *req, const char *etag, const char *version)
+{
+    httpd_resp_set_hdr(req, "ETag", etag);
+    httpd_resp_set_hdr(req, "X-State-Version", version);
+    httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+}
+
+static esp_err_t send_not_modified(httpd_req_t *req, uint32_t version)
+{
+    char etag[POLL_ETAG_MAX];
+    char ver[POLL_VERSION_MAX];
+    format_etag(etag, sizeof(etag), version);
+    snprintf(ver, sizeof(ver), "%lu", (unsigned long)version);
+
+    httpd_resp_set_status(req, "304 Not Modified");
+    set_version_headers(req, etag, ver);
+    return httpd_resp_send(req, NULL, 0);
+}
+
+static esp_err_t send_full(httpd_req_t *req)
+{
+    // 无锁快照，不与写者竞争；ETag 取快照自身的版本
+    sensor_data_t snapshot;
+    uint32_t version = app_state_read_snapshot(&snapshot);
+
+    char json[STATE_JSON_MAX_LEN];
+    size_t len = state_json_write(json, sizeof(json), &snapshot, APP_FIELD_ALL);
+    if (len == 0) {
+        httpd_resp_send_500(req);
+        return ESP_FAIL;
+    }
+
+    char etag[POLL_ETAG_MAX];
+    char ver[POLL_VERSION_MAX];
+    format_etag(etag, sizeof(etag), version);
+    snprintf(ver, sizeof(ver), "%lu", (unsigned long)version);
+
+    httpd_resp_set_type(req, "application/json");
+    set_version_headers(req, etag, ver);
+    return httpd_resp_send(req, json, len);
+}
+
+// ==================== 长轮询任务 ====================
+
+static void finish_waiter(httpd_req_t *req, bool changed, uint32_t version)
+{
+    if (changed) {
+        send_full(req);
+    } else {
+        send_not_modified(req, version);
+    }
+    httpd_req_async_handler_complete(req);
+}
+
+static void data_poll_task(void *arg)
+{
+    while (s_running) {
+        // 状态变化时立即唤醒，否则按周期检查超时
+        app_state_wait(s_sub, pdMS_TO_TICKS(POLL_TICK_MS));
+
+        // 以版本号判断而非变化位：登记前后发生的变化都不会遗漏
+        uint32_t version = app_state_version();
+        int64_t now = esp_timer_get_time();
+        waiter_t done[DATA_POLL_MAX_WAITERS];
+        bool changed[DATA_POLL_MAX_WAITERS];
+        int count = 0;
+
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        for (int i = 0; i < DATA_POLL_MAX_WAITERS; i++) {
+            waiter_t *w = &s_waiters[i];
+            if (w->req == NULL) {
+                continue;
+            }
+            bool is_changed = (w->version != version);
+            if (!is_changed && now < w->deadline_us) {
+                continue;
+            }
+            if (is_changed) {
+                s_stats.wait_changed++;
+            } else {
+                s_stats.wait_timeouts++;
+            }
+            s_stats.waiting--;
+            changed[count] = is_changed;
+            done[count++] = *w;
+            w->req = NULL;
+        }
+        xSemaphoreGive(s_lock);
+
+        // 发送在锁外进行，慢客户端不阻塞新的登记
+        for (int i = 0; i < count; i++) {
+            finish_waiter(done[i].req, changed[i], done[i].version);
+            session_budget_release();
+        }
+    }
+
+    s_task = NULL;
+    vTaskDelete(NULL);
+}
+
+// ==================== 公共接口 ====================
+
+esp_err_t data_poll_respond(httpd_req_t *req)
+{
+    uint32_t version = app_state_version();
+    char etag[POLL_ETAG_MAX];
+    format_etag(etag, sizeof(etag), version);
+
+    char inm[64];
+    if (httpd_req_get_hdr_value_str(req, "If-None-Match", inm, sizeof(inm)) == ESP_OK &&
+        strstr(inm, etag) != NULL) {
+        STAT_INC(not_modified);
+        return send_not_modified(req, version);
+    }
+
+    STAT_INC(full);
+    return send_full(req);
+}
+
+esp_err_t data_poll_wait(httpd_req_t *req, uint32_t wait_version, uint32_t timeout_ms)
+{
+    if (s_lock == NULL || wait_version != app_state_version()) {
+        return data_poll_respond(req);
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    if (!s_running) {
+        xSemaphoreGive(s_lock);
+        return data_poll_respond(req);
+    }
+    waiter_t *w = NULL;
+    for (int i = 0; i < DATA_POLL_MAX_WAITERS && w == NULL; i++) {
+        if (s_waiters[i].req == NULL) {
+            w = &s_waiters[i];
+        }
+    }
+    // 挂起数与长连接共享预算 (与 /ws 共用) 都要满足
+    if (w == NULL || !session_budget_acquire()) {
+        s_stats.rejected++;
+        xSemaphoreGive(s_lock);
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        httpd_resp_set_hdr(req, "Retry-After", "2");
+        return httpd_resp_send(req, NULL, 0);
+    }
+
+    // 交给长轮询任务应答，httpd 任务立即返回处理其他连接
+    httpd_req_t *async_req = NULL;
+    esp_err_t ret = httpd_req_async_handler_begin(req, &async_req);
+    if (ret != ESP_OK) {
+        xSemaphoreGive(s_lock);
+        session_budget_release();
+        ESP_LOGW(TAG, "Async begin failed (%d)", ret);
+        return data_poll_respond(req);
+    }
+    w->req = async_req;
+    w->version = wait_version;
+    w->deadline_us = esp_timer_get_time() + (int64_t)timeout_ms * 1000;
+    s_stats.waits++;
+    s_stats.waiting++;
+    xSemaphoreGive(s_lock);
+    return ESP_OK;
+}
+
+esp_err_t data_poll_start(void)
+{
+    if (s_running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (s_lock == NULL) {
+        s_lock = xSemaphoreCreateMutex();
+        if (s_lock == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    memset(s_waiters, 0, sizeof(s_waiters));
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_boot_id = esp_random();
+
+    esp_err_t ret = app_state_subscribe(APP_FIELD_ALL, &s_sub);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    s_running = true;
+    if (xTaskCreate(data_poll_task, "data_poll", POLL_TASK_STACK, NULL, POLL_TASK_PRIORITY,
+                    &s_task) != pdPASS) {
+        s_running = false;
+        app_state_unsubscribe(s_sub);
+        s_sub = -1;
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "Long-poll ready (max %d waiters)", DATA_POLL_MAX_WAITERS);
+    return ESP_OK;
+}
+
+void data_poll_stop(void)
+{
+    if (!s_running) {
+        return;
+    }
+
+    // 任务最多在一个 POLL_TICK_MS 内退出
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    s_running = false;
+    xSemaphoreGive(s_lock);
+    while (s_task != NULL) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    app_state_unsubscribe(s_sub);
+    s_sub = -1;
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    for (int i = 0; i < DATA_POLL_MAX_WAITERS; i++) {
+        httpd_req_t *req = s_waiters[i].req;
+        if (req != NULL) {
+            httpd_resp_set_status(req, "503 Service Unavailable");
+            httpd_resp_send(req, NULL, 0);
+            httpd_req_async_handler_complete(req);
+            s_waiters[i].req = NULL;
+            session_budget_release();
+        }
+    }
+    s_stats.waiting = 0;
+    xSemaphoreGive(s_lock);
+}
+
+esp_err_t data_poll_send_state(httpd_req_t *req)
+{
+    return send_full(req);
+}
+
+void data_poll_get_stats(data_poll_stats_t *stats)
+{
+    if (stats == NULL || s_lock == NULL) {
+        return;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    *stats = s_stats;
+    xSemaphoreGive(s_lock);
+}
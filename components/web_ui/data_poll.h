@@ -0,0 +1,67 @@
+/**
+ * @file data_poll.h
+ * @brief /api/data 条件请求与长轮询
+ *
+ * 响应带 ETag "<启动标识>-<状态版本>"，版本即 app_state 的单调版本号，任一字段变化加 1：
+ * - If-None-Match 命中当前版本时直接回 304，不读取快照也不序列化
+ * - 长轮询 (?wait_version=N) 在版本仍为 N 时挂起请求 (异步处理，不占用 httpd 任务)，
+ *   版本变化后返回完整快照，超时回 304
+ * 启动标识在每次启动时随机生成，重启后旧 ETag 不会误命中。
+ */
+
+#ifndef DATA_POLL_H
+#define DATA_POLL_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+/**
+ * @brief 条件请求与长轮询统计
+ */
+typedef struct {
+    uint32_t full;              // 返回完整快照
+    uint32_t not_modified;      // If-None-Match 命中 (304，跳过序列化)
+    uint32_t waits;             // 进入挂起的长轮询
+    uint32_t wait_changed;      // 长轮询因版本变化返回
+    uint32_t wait_timeouts;     // 长轮询超时 (304)
+    uint32_t rejected;          // 挂起数已满 (503)
+    uint32_t waiting;           // 当前挂起数
+} data_poll_stats_t;
+
+/**
+ * @brief 启动长轮询任务 (httpd_start 之后调用)
+ */
+esp_err_t data_poll_start(void);
+
+/**
+ * @brief 停止长轮询任务，挂起的请求回 503 (httpd_stop 之前调用)
+ */
+void data_poll_stop(void);
+
+/**
+ * @brief 处理普通 /api/data：If-None-Match 命中当前版本回 304，否则返回完整快照
+ */
+esp_err_t data_poll_respond(httpd_req_t *req);
+
+/**
+ * @brief 处理长轮询：当前版本与 wait_version 不同时立即返回完整快照，
+ *        否则挂起直到版本变化或超时
+ *
+ * @param req 请求
+ * @param wait_version 客户端已有的版本
+ * @param timeout_ms 最长挂起时间
+ */
+esp_err_t data_poll_wait(httpd_req_t *req, uint32_t wait_version, uint32_t timeout_ms);
+
+/**
+ * @brief 返回当前完整快照 (带 ETag 与版本头，不计入统计)，供写操作回复应用后的状态
+ */
+esp_err_t data_poll_send_state(httpd_req_t *req);
+
+/**
+ * @brief 获取统计
+ */
+void data_poll_get_stats(data_poll_stats_t *stats);
+
+#endif // DATA_POLL_H
@@ -1,21 +1,36 @@
 #include "http_server.h"
 
+#include "actuator.h"
 #include "app_control.h"
 #include "app_state.h"
 #include "cJSON.h"
 #include "config.h"
+#include "data_poll.h"
 #include "esp_log.h"
-#include "rgb_led.h"
-
+#include "esp_timer.h"
+#include "hal.h"
+#include "sensor_sched.h"
+#include "rules.h"
+#include "sensor_history.h"
+#include "sensor_log.h"
+#include "session_budget.h"
+#include "trace.h"
+#include "ws_push.h"
+#include "index_html_asset.h"
+#include "sdkconfig.h"
+
+#include <math.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
 static const char *TAG = "HTTP_SERVER";
 static sensor_data_t *g_sensor_data = NULL;
 
-// 引用嵌入的HTML文件
-extern const uint8_t index_html_start[] asm("_binary_index_html_start");
-extern const uint8_t index_html_end[] asm("_binary_index_html_end");
+// 引用嵌入的页面 (构建期已压缩并 gzip，见 tools/pack_asset.py)
+extern const uint8_t index_html_gz_start[] asm("_binary_index_html_gz_start");
+extern const uint8_t index_html_gz_end[] asm("_binary_index_html_gz_end");
 
 static esp_err_t send_json_status(httpd_req_t *req, const char *status, const char *message)
 {
@@ -90,15 +105,20 @@ static esp_err_t lock_state_or_503(httpd_req_t *req)
     return ESP_OK;
 }
 
-static bool query_get_int(httpd_req_t *req, const char *key, int *out)
+static bool query_get_str(httpd_req_t *req, const char *key, char *out, size_t out_size)
 {
-    char query[64];
+    char query[128];
     if (httpd_req_get_url_query_str(req, query, sizeof(query)) != ESP_OK) {
         return false;
     }
 
+    return httpd_query_key_value(query, key, out, out_size) == ESP_OK;
+}
+
+static bool query_get_int(httpd_req_t *req, const char *key, int *out)
+{
     char param[32];
-    if (httpd_query_key_value(query, key, param, sizeof(param)) != ESP_OK) {
+    if (!query_get_str(req, key, param, sizeof(param))) {
         return false;
     }
 
@@ -106,6 +126,16 @@ static bool query_get_int(httpd_req_t *req, const char *key, int *out)
     return true;
 }
 
+// 设置了 close_fn 后由其负责关闭套接字
+static void on_session_close(httpd_handle_t hd, int sockfd)
+{
+    ws_push_on_close(sockfd);
+    close(sockfd);
+}
+
+_Static_assert(HTTP_MAX_OPEN_SOCKETS + 3 <= CONFIG_LWIP_MAX_SOCKETS,
+               "HTTP_MAX_OPEN_SOCKETS exceeds CONFIG_LWIP_MAX_SOCKETS - 3");
+
 static esp_err_t register_uri_handler_checked(httpd_handle_t server, const httpd_uri_t *uri)
 {
     esp_err_t ret = httpd_register_uri_handler(server, uri);
@@ -115,27 +145,78 @@ static esp_err_t register_uri_handler_checked(httpd_handle_t server, const httpd
     return ret;
 }
 
+/**
+ * @brief If-None-Match 是否命中 (支持 * 与逗号分隔的列表，弱比较)
+ */
+static bool etag_matches(httpd_req_t *req, const char *etag)
+{
+    char inm[96];
+    if (httpd_req_get_hdr_value_str(req, "If-None-Match", inm, sizeof(inm)) != ESP_OK) {
+        return false;
+    }
+    return strcmp(inm, "*") == 0 || strstr(inm, etag) != NULL;
+}
+
 // 主页处理
+// 页面地址 "/" 不带内容哈希，不能长期缓存 (OTA 后浏览器会一直用旧页面)：
+// 使用 no-cache + 强 ETag，浏览器每次重新验证，内容未变时只回 304 空响应
 static esp_err_t root_handler(httpd_req_t *req)
 {
-    httpd_resp_set_type(req, "text/html");
-    size_t html_len = index_html_end - index_html_start;
-    return httpd_resp_send(req, (const char *)index_html_start, html_len);
+    httpd_resp_set_hdr(req, "ETag", INDEX_HTML_ETAG);
+    httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+    if (etag_matches(req, INDEX_HTML_ETAG)) {
+        httpd_resp_set_status(req, "304 Not Modified");
+        return httpd_resp_send(req, NULL, 0);
+    }
+
+    httpd_resp_set_type(req, "text/html; charset=utf-8");
+    httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+    httpd_resp_set_hdr(req, "Vary", "Accept-Encoding");
+
+    // 直接从 Flash 映射区分块发送，不复制到 RAM
+    const char *p = (const char *)index_html_gz_start;
+    size_t left = index_html_gz_end - index_html_gz_start;
+    while (left > 0) {
+        size_t n = left < WEB_ASSET_CHUNK_SIZE ? left : WEB_ASSET_CHUNK_SIZE;
+        esp_err_t ret = httpd_resp_send_chunk(req, p, n);
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "Index send aborted (%d)", ret);
+            return ret;
+        }
+        p += n;
+        left -= n;
+    }
+    return httpd_resp_send_chunk(req, NULL, 0);
 }
 
-// API数据处理
+// API数据处理：ETag 条件请求、?wait_version=N 长轮询 (见 data_poll.c)
 static esp_err_t api_data_handler(httpd_req_t *req)
 {
     if (require_sensor_data(req) != ESP_OK) {
         return ESP_FAIL;
     }
 
-    if (lock_state_or_503(req) != ESP_OK) {
-        return ESP_FAIL;
+    char param[16];
+    if (query_get_str(req, "wait_version", param, sizeof(param))) {
+        char *end = NULL;
+        unsigned long wait_version = strtoul(param, &end, 10);
+        int timeout_ms = DATA_POLL_TIMEOUT_MS;
+        query_get_int(req, "timeout", &timeout_ms);
+        if (end == param || *end != '\0' || timeout_ms <= 0 ||
+            timeout_ms > DATA_POLL_MAX_TIMEOUT_MS) {
+            return send_json_status(req, "400 Bad Request", "invalid wait_version or timeout");
+        }
+        return data_poll_wait(req, (uint32_t)wait_version, (uint32_t)timeout_ms);
     }
 
-    sensor_data_t snapshot = *g_sensor_data;
-    app_state_unlock();
+    return data_poll_respond(req);
+}
+
+// 运行指标 (采样抖动等)
+static esp_err_t api_metrics_handler(httpd_req_t *req)
+{
+    sensor_sched_stats_t stats[SENSOR_SCHED_MAX_ENTRIES];
+    size_t count = sensor_sched_get_stats(stats, SENSOR_SCHED_MAX_ENTRIES);
 
     cJSON *root = cJSON_CreateObject();
     if (root == NULL) {
@@ -143,17 +224,183 @@ static esp_err_t api_data_handler(httpd_req_t *req)
         return ESP_FAIL;
     }
 
-    cJSON_AddNumberToObject(root, "temperature", snapshot.temperature);
-    cJSON_AddNumberToObject(root, "humidity", snapshot.humidity);
-    cJSON_AddNumberToObject(root, "light", snapshot.light);
-    cJSON_AddNumberToObject(root, "smoke", snapshot.smoke);
-    cJSON_AddNumberToObject(root, "smoke_threshold", snapshot.smoke_threshold);
-    cJSON_AddNumberToObject(root, "led_state", snapshot.led_state);
-    cJSON_AddNumberToObject(root, "led_brightness", snapshot.led_brightness);
-    cJSON_AddNumberToObject(root, "fan_state", snapshot.fan_state);
-    cJSON_AddNumberToObject(root, "fan_speed", snapshot.fan_speed);
-    cJSON_AddNumberToObject(root, "curtain_state", snapshot.curtain_state);
-    cJSON_AddNumberToObject(root, "control_mode", snapshot.control_mode);
+    cJSON *sampling = cJSON_AddArrayToObject(root, "sampling");
+    for (size_t i = 0; sampling != NULL && i < count; i++) {
+        cJSON *item = cJSON_CreateObject();
+        if (item == NULL) {
+            break;
+        }
+        cJSON_AddStringToObject(item, "name", stats[i].name ? stats[i].name : "");
+        cJSON_AddNumberToObject(item, "period_ms", stats[i].period_ms);
+        cJSON_AddNumberToObject(item, "runs", stats[i].runs);
+        cJSON_AddNumberToObject(item, "errors", stats[i].errors);
+        cJSON_AddNumberToObject(item, "deadline_misses", stats[i].deadline_misses);
+        cJSON_AddNumberToObject(item, "skipped", stats[i].skipped);
+        cJSON_AddNumberToObject(item, "jitter_avg_us", stats[i].jitter_avg_us);
+        cJSON_AddNumberToObject(item, "jitter_max_us", stats[i].jitter_max_us);
+        cJSON_AddNumberToObject(item, "exec_avg_us", stats[i].exec_avg_us);
+        cJSON_AddNumberToObject(item, "exec_max_us", stats[i].exec_max_us);
+        cJSON_AddItemToArray(sampling, item);
+    }
+
+    hal_smoke_window_t window;
+    if (hal_smoke_window(&window) == ESP_OK) {
+        cJSON *mq2 = cJSON_AddObjectToObject(root, "mq2_window");
+        if (mq2 != NULL) {
+            cJSON_AddNumberToObject(mq2, "avg", window.avg_x16 / 16.0);
+            cJSON_AddNumberToObject(mq2, "min", window.min);
+            cJSON_AddNumberToObject(mq2, "max", window.max);
+            cJSON_AddNumberToObject(mq2, "samples", window.samples);
+            cJSON_AddNumberToObject(mq2, "seq", window.seq);
+        }
+    }
+
+    app_alarm_stats_t alarm_stats;
+    app_control_get_alarm_stats(&alarm_stats);
+    cJSON *alarm = cJSON_AddObjectToObject(root, "smoke_alarm");
+    if (alarm != NULL) {
+        cJSON_AddBoolToObject(alarm, "interrupt_path", hal_smoke_alarm_available());
+        cJSON_AddBoolToObject(alarm, "comparator_active", hal_smoke_alarm_active());
+        cJSON_AddNumberToObject(alarm, "triggers", alarm_stats.triggers);
+        cJSON_AddNumberToObject(alarm, "latency_last_us", alarm_stats.latency_last_us);
+        cJSON_AddNumberToObject(alarm, "latency_avg_us", alarm_stats.latency_avg_us);
+        cJSON_AddNumberToObject(alarm, "latency_max_us", alarm_stats.latency_max_us);
+    }
+
+    app_state_stats_t state_stats;
+    app_state_get_stats(&state_stats);
+    cJSON *state = cJSON_AddObjectToObject(root, "app_state");
+    if (state != NULL) {
+        cJSON_AddNumberToObject(state, "lock_acquired", state_stats.lock_acquired);
+        cJSON_AddNumberToObject(state, "lock_contended", state_stats.lock_contended);
+        cJSON_AddNumberToObject(state, "lock_timeouts", state_stats.lock_timeouts);
+        cJSON_AddNumberToObject(state, "lock_wait_max_us", state_stats.lock_wait_max_us);
+        cJSON_AddNumberToObject(state, "publishes", state_stats.publishes);
+        cJSON_AddNumberToObject(state, "snapshot_reads", state_stats.snapshot_reads);
+        cJSON_AddNumberToObject(state, "snapshot_retries", state_stats.snapshot_retries);
+        cJSON_AddNumberToObject(state, "unchanged_unlocks", state_stats.unchanged_unlocks);
+        cJSON_AddNumberToObject(state, "notifications", state_stats.notifications);
+        cJSON_AddNumberToObject(state, "version", app_state_version());
+    }
+
+    static const char *const source_names[ACTUATOR_SRC_MAX] = {"http", "voice", "auto"};
+    actuator_stats_t act_stats;
+    actuator_get_stats(&act_stats);
+    cJSON *act = cJSON_AddObjectToObject(root, "actuator");
+    if (act != NULL) {
+        cJSON_AddNumberToObject(act, "posted", act_stats.posted);
+        cJSON_AddNumberToObject(act, "executed", act_stats.executed);
+        cJSON_AddNumberToObject(act, "failed", act_stats.failed);
+        cJSON_AddNumberToObject(act, "dropped", act_stats.dropped);
+        cJSON_AddNumberToObject(act, "coalesced", act_stats.coalesced);
+        cJSON_AddNumberToObject(act, "queue_peak", act_stats.queue_peak);
+        for (int i = 0; i < ACTUATOR_SRC_MAX; i++) {
+            cJSON *src = cJSON_AddObjectToObject(act, source_names[i]);
+            if (src == NULL) {
+                break;
+            }
+            cJSON_AddNumberToObject(src, "count", act_stats.source[i].count);
+            cJSON_AddNumberToObject(src, "latency_last_us", act_stats.source[i].latency_last_us);
+            cJSON_AddNumberToObject(src, "latency_avg_us", act_stats.source[i].latency_avg_us);
+            cJSON_AddNumberToObject(src, "latency_max_us", act_stats.source[i].latency_max_us);
+        }
+    }
+
+    rules_stats_t rules_stats;
+    rules_get_stats(&rules_stats);
+    cJSON *rules = cJSON_AddObjectToObject(root, "rules");
+    if (rules != NULL) {
+        cJSON_AddNumberToObject(rules, "count", rules_stats.rule_count);
+        cJSON_AddStringToObject(rules, "source", rules_stats.from_nvs ? "nvs" : "default");
+        cJSON_AddNumberToObject(rules, "reloads", rules_stats.reloads);
+        cJSON_AddNumberToObject(rules, "evaluations", rules_stats.evaluations);
+        cJSON_AddNumberToObject(rules, "eval_max_us", rules_stats.eval_max_us);
+    }
+
+    ws_push_stats_t ws_stats;
+    memset(&ws_stats, 0, sizeof(ws_stats));
+    ws_push_get_stats(&ws_stats);
+    cJSON *ws = cJSON_AddObjectToObject(root, "ws_push");
+    if (ws != NULL) {
+        cJSON_AddNumberToObject(ws, "clients", ws_stats.clients);
+        cJSON_AddNumberToObject(ws, "connects", ws_stats.connects);
+        cJSON_AddNumberToObject(ws, "rejected", ws_stats.rejected);
+        cJSON_AddNumberToObject(ws, "messages", ws_stats.messages);
+        cJSON_AddNumberToObject(ws, "bytes", ws_stats.bytes);
+        cJSON_AddNumberToObject(ws, "coalesced", ws_stats.coalesced);
+        cJSON_AddNumberToObject(ws, "stalled", ws_stats.stalled);
+        cJSON_AddNumberToObject(ws, "send_errors", ws_stats.send_errors);
+    }
+
+    cJSON *sessions = cJSON_AddObjectToObject(root, "http_sessions");
+    if (sessions != NULL) {
+        cJSON_AddNumberToObject(sessions, "max_open", HTTP_MAX_OPEN_SOCKETS);
+        cJSON_AddNumberToObject(sessions, "long_lived", session_budget_in_use());
+        cJSON_AddNumberToObject(sessions, "long_lived_max", HTTP_LONG_LIVED_MAX);
+    }
+
+    data_poll_stats_t poll_stats;
+    memset(&poll_stats, 0, sizeof(poll_stats));
+    data_poll_get_stats(&poll_stats);
+    cJSON *poll = cJSON_AddObjectToObject(root, "data_poll");
+    if (poll != NULL) {
+        cJSON_AddNumberToObject(poll, "full", poll_stats.full);
+        cJSON_AddNumberToObject(poll, "not_modified", poll_stats.not_modified);
+        cJSON_AddNumberToObject(poll, "waits", poll_stats.waits);
+        cJSON_AddNumberToObject(poll, "wait_changed", poll_stats.wait_changed);
+        cJSON_AddNumberToObject(poll, "wait_timeouts", poll_stats.wait_timeouts);
+        cJSON_AddNumberToObject(poll, "rejected", poll_stats.rejected);
+        cJSON_AddNumberToObject(poll, "waiting", poll_stats.waiting);
+    }
+
+    static const char *const output_names[HAL_OUT_MAX] = {
+        "led", "fan", "curtain", "rgb", "rgb_brightness",
+    };
+    hal_write_stats_t write_stats;
+    hal_get_write_stats(&write_stats);
+    cJSON *writes = cJSON_AddObjectToObject(root, "hal_writes");
+    if (writes != NULL) {
+        for (int i = 0; i < HAL_OUT_MAX; i++) {
+            cJSON *out = cJSON_AddObjectToObject(writes, output_names[i]);
+            if (out == NULL) {
+                break;
+            }
+            cJSON_AddNumberToObject(out, "issued", write_stats.issued[i]);
+            cJSON_AddNumberToObject(out, "suppressed", write_stats.suppressed[i]);
+        }
+    }
+
+    sensor_log_stats_t log_stats;
+    sensor_log_get_stats(&log_stats);
+    if (log_stats.pages_total > 0) {
+        cJSON *slog = cJSON_AddObjectToObject(root, "sensor_log");
+        if (slog != NULL) {
+            cJSON_AddNumberToObject(slog, "pages_total", log_stats.pages_total);
+            cJSON_AddNumberToObject(slog, "pages_valid", log_stats.pages_valid);
+            cJSON_AddNumberToObject(slog, "pages_corrupt", log_stats.pages_corrupt);
+            cJSON_AddNumberToObject(slog, "pages_written", log_stats.pages_written);
+            cJSON_AddNumberToObject(slog, "next_seq", log_stats.next_seq);
+            cJSON_AddNumberToObject(slog, "records_appended", log_stats.records_appended);
+            cJSON_AddNumberToObject(slog, "records_dropped", log_stats.records_dropped);
+            cJSON_AddNumberToObject(slog, "compression_ratio",
+                                    log_stats.encoded_bytes ?
+                                    (double)log_stats.raw_bytes / log_stats.encoded_bytes : 0);
+        }
+    }
+
+    trace_stats_t trace_stats;
+    trace_get_stats(&trace_stats);
+    if (trace_stats.capacity > 0) {
+        cJSON *trace = cJSON_AddObjectToObject(root, "trace");
+        if (trace != NULL) {
+            cJSON_AddNumberToObject(trace, "capacity", trace_stats.capacity);
+            cJSON_AddNumberToObject(trace, "count", trace_stats.count);
+            cJSON_AddNumberToObject(trace, "recorded", trace_stats.recorded);
+            cJSON_AddNumberToObject(trace, "overwritten", trace_stats.overwritten);
+            cJSON_AddNumberToObject(trace, "suppressed", trace_stats.suppressed);
+            cJSON_AddNumberToObject(trace, "lost", trace_stats.lost);
+        }
+    }
 
     char *json_str = cJSON_PrintUnformatted(root);
     cJSON_Delete(root);
@@ -168,138 +415,447 @@ static esp_err_t api_data_handler(httpd_req_t *req)
     return ret;
 }
 
-static esp_err_t api_led_toggle_handler(httpd_req_t *req)
+// 控制回路轨迹 (二进制，导出期间暂停记录)
+#define TRACE_CHUNK_RECORDS 64
+
+static esp_err_t api_trace_handler(httpd_req_t *req)
 {
-    if (require_sensor_data(req) != ESP_OK) {
-        return ESP_FAIL;
+    trace_file_hdr_t hdr;
+    if (trace_export_begin(&hdr) != ESP_OK) {
+        return send_json_status(req, "503 Service Unavailable", "trace unavailable");
     }
 
-    if (lock_state_or_503(req) != ESP_OK) {
+    httpd_resp_set_type(req, "application/octet-stream");
+    httpd_resp_set_hdr(req, "Content-Disposition", "attachment; filename=\"trace.bin\"");
+
+    esp_err_t ret = httpd_resp_send_chunk(req, (const char *)&hdr, sizeof(hdr));
+    trace_record_t records[TRACE_CHUNK_RECORDS];
+    size_t index = 0;
+    while (ret == ESP_OK && index < hdr.count) {
+        size_t n = trace_export_read(index, records, TRACE_CHUNK_RECORDS);
+        if (n == 0) {
+            break;
+        }
+        ret = httpd_resp_send_chunk(req, (const char *)records, n * sizeof(trace_record_t));
+        index += n;
+    }
+    trace_export_end();
+
+    if (ret != ESP_OK) {
         return ESP_FAIL;
     }
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+
+// 历史数据 (分块流式输出，不在内存中拼装完整响应)
+#define HISTORY_CHUNK_SIZE  512
+#define HISTORY_QUERY_BATCH 16
+
+static esp_err_t api_history_handler(httpd_req_t *req)
+{
+    char sensor[16];
+    history_channel_t ch;
+    if (!query_get_str(req, "sensor", sensor, sizeof(sensor)) ||
+        !history_channel_from_name(sensor, &ch)) {
+        return send_json_status(req, "400 Bad Request", "unknown sensor");
+    }
+
+    int step = 0;
+    int from = -1;
+    int to = -1;
+    query_get_int(req, "step", &step);
+    query_get_int(req, "from", &from);
+    query_get_int(req, "to", &to);
+
+    if (step < 0) step = 0;
+    history_tier_t tier = history_pick_tier((uint32_t)step);
+
+    // 缺省区间：该层级的完整保留期
+    uint32_t now = history_now();
+    uint32_t span = (tier == HISTORY_TIER_HOUR) ? HISTORY_HOUR_STEP_S * HISTORY_HOUR_CAPACITY :
+                    (tier == HISTORY_TIER_MINUTE) ? HISTORY_MINUTE_STEP_S * HISTORY_MINUTE_CAPACITY :
+                    HISTORY_RAW_STEP_S * HISTORY_RAW_CAPACITY;
+    uint32_t to_s = (to < 0) ? now : (uint32_t)to;
+    uint32_t from_s = (from < 0) ? ((to_s > span) ? to_s - span : 0) : (uint32_t)from;
+    if (from_s > to_s) {
+        return send_json_status(req, "400 Bad Request", "from must not exceed to");
+    }
+
+    httpd_resp_set_type(req, "application/json");
+
+    char buf[HISTORY_CHUNK_SIZE];
+    int len = snprintf(buf, sizeof(buf),
+                       "{\"sensor\":\"%s\",\"tier\":\"%s\",\"now\":%lu,\"from\":%lu,"
+                       "\"to\":%lu,\"step\":%d,\"points\":[",
+                       history_channel_name(ch), history_tier_name(tier),
+                       (unsigned long)now, (unsigned long)from_s, (unsigned long)to_s, step);
+
+    history_point_t points[HISTORY_QUERY_BATCH];
+    uint32_t cursor = from_s;
+    bool first = true;
+    size_t n;
+
+    while ((n = history_query(ch, tier, &cursor, to_s, (uint32_t)step,
+                              points, HISTORY_QUERY_BATCH)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            // 预留单个点的最大长度，不足时先发出当前分块
+            if (len > (int)sizeof(buf) - 96) {
+                if (httpd_resp_send_chunk(req, buf, len) != ESP_OK) {
+                    return ESP_FAIL;
+                }
+                len = 0;
+            }
 
-    if (g_sensor_data->led_state == 0) {
-        g_sensor_data->led_state = 1;
-        if (g_sensor_data->led_brightness == 0) {
-            g_sensor_data->led_brightness = 255;
+            if (tier == HISTORY_TIER_RAW) {
+                len += snprintf(buf + len, sizeof(buf) - len, "%s[%lu,%.2f]",
+                                first ? "" : ",", (unsigned long)points[i].ts, points[i].avg);
+            } else {
+                len += snprintf(buf + len, sizeof(buf) - len, "%s[%lu,%.2f,%.2f,%.2f]",
+                                first ? "" : ",", (unsigned long)points[i].ts,
+                                points[i].min, points[i].avg, points[i].max);
+            }
+            first = false;
         }
-    } else {
-        g_sensor_data->led_state = 0;
-        g_sensor_data->led_brightness = 0;
     }
-    app_state_unlock();
 
-    return send_ok(req);
+    len += snprintf(buf + len, sizeof(buf) - len, "]}");
+    if (httpd_resp_send_chunk(req, buf, len) != ESP_OK) {
+        return ESP_FAIL;
+    }
+    return httpd_resp_send_chunk(req, NULL, 0);
 }
 
-static esp_err_t api_fan_toggle_handler(httpd_req_t *req)
+// ==================== 执行器控制 ====================
+// 单项接口与 POST /api/control 共用同一条路径：一次加锁写入全部字段 (一次发布)，解锁后逐项下发
+
+#define CONTROL_LED             (1u << 0)
+#define CONTROL_FAN             (1u << 1)
+#define CONTROL_CURTAIN         (1u << 2)
+#define CONTROL_MODE            (1u << 3)
+#define CONTROL_SMOKE_THRESHOLD (1u << 4)
+#define CONTROL_RGB             (1u << 5)   // 自定义颜色 0xRRGGBB
+#define CONTROL_RGB_PRESET      (1u << 6)
+#define CONTROL_STATE_MASK      (CONTROL_LED | CONTROL_FAN | CONTROL_CURTAIN | CONTROL_MODE | \
+                                 CONTROL_SMOKE_THRESHOLD)
+
+#define CONTROL_BODY_MAX        256
+
+typedef struct {
+    uint32_t set;               // 要写入的 CONTROL_* 位
+    uint32_t toggle;            // 在锁内按当前状态取反的 CONTROL_* 位 (LED/风扇/窗帘/模式)
+    uint8_t led_brightness;
+    uint8_t fan_speed;
+    uint8_t curtain;            // 目标开度 0-100
+    control_mode_t mode;
+    uint32_t smoke_threshold;
+    uint32_t rgb;
+    rgb_color_t rgb_preset;
+} control_req_t;
+
+static const struct {
+    const char *name;
+    rgb_color_t color;
+} k_rgb_presets[] = {
+    {"red", RGB_COLOR_RED},       {"green", RGB_COLOR_GREEN},     {"blue", RGB_COLOR_BLUE},
+    {"yellow", RGB_COLOR_YELLOW}, {"cyan", RGB_COLOR_CYAN},       {"magenta", RGB_COLOR_MAGENTA},
+    {"white", RGB_COLOR_WHITE},   {"orange", RGB_COLOR_ORANGE},   {"purple", RGB_COLOR_PURPLE},
+    {"off", RGB_COLOR_OFF},
+};
+
+static bool rgb_preset_from_name(const char *name, rgb_color_t *color)
 {
-    if (require_sensor_data(req) != ESP_OK) {
-        return ESP_FAIL;
+    for (size_t i = 0; i < sizeof(k_rgb_presets) / sizeof(k_rgb_presets[0]); i++) {
+        if (strcmp(name, k_rgb_presets[i].name) == 0) {
+            *color = k_rgb_presets[i].color;
+            return true;
+        }
     }
+    return false;
+}
 
-    if (lock_state_or_503(req) != ESP_OK) {
-        return ESP_FAIL;
+/**
+ * @brief 把切换请求换算为目标值 (调用方持有状态锁)
+ */
+static void resolve_toggles_locked(control_req_t *c)
+{
+    if (c->toggle & CONTROL_LED) {
+        // 打开时沿用当前亮度，亮度为 0 则全亮
+        c->led_brightness = g_sensor_data->led_state ? 0 :
+                            (g_sensor_data->led_brightness ? g_sensor_data->led_brightness : 255);
+    }
+    if (c->toggle & CONTROL_FAN) {
+        c->fan_speed = g_sensor_data->fan_state ? 0 :
+                       (g_sensor_data->fan_speed ? g_sensor_data->fan_speed : 255);
+    }
+    if (c->toggle & CONTROL_CURTAIN) {
+        // 部分打开时切换为关闭
+        c->curtain = g_sensor_data->curtain_state ? 0 : 100;
     }
+    if (c->toggle & CONTROL_MODE) {
+        c->mode = (g_sensor_data->control_mode == CONTROL_MODE_AUTO) ? CONTROL_MODE_MANUAL
+                                                                     : CONTROL_MODE_AUTO;
+    }
+    c->set |= c->toggle;
+}
+
+/**
+ * @brief 应用控制请求：状态字段在一次加锁内写入，解锁后记录轨迹并投递执行器命令
+ * @return ESP_OK，加锁超时时已回复 503 并返回 ESP_FAIL
+ */
+static esp_err_t apply_control(httpd_req_t *req, control_req_t *c, int64_t t0_us)
+{
+    if ((c->set | c->toggle) & CONTROL_STATE_MASK) {
+        if (lock_state_or_503(req) != ESP_OK) {
+            return ESP_FAIL;
+        }
+        resolve_toggles_locked(c);
 
-    if (g_sensor_data->fan_state == 0) {
-        g_sensor_data->fan_state = 1;
-        if (g_sensor_data->fan_speed == 0) {
-            g_sensor_data->fan_speed = 255;
+        if (c->set & CONTROL_LED) {
+            g_sensor_data->led_brightness = c->led_brightness;
+            g_sensor_data->led_state = (c->led_brightness > 0) ? 1 : 0;
+        }
+        if (c->set & CONTROL_FAN) {
+            g_sensor_data->fan_speed = c->fan_speed;
+            g_sensor_data->fan_state = (c->fan_speed > 0) ? 1 : 0;
+        }
+        if (c->set & CONTROL_CURTAIN) {
+            g_sensor_data->curtain_state = c->curtain;
+        }
+        if (c->set & CONTROL_SMOKE_THRESHOLD) {
+            g_sensor_data->smoke_threshold = c->smoke_threshold;
+        }
+        // 模式最后切换：切回自动时规则滞回状态与上面写入的设备状态同步
+        if (c->set & CONTROL_MODE) {
+            app_control_set_mode(g_sensor_data, c->mode);
         }
-    } else {
-        g_sensor_data->fan_state = 0;
-        g_sensor_data->fan_speed = 0;
+        app_state_unlock();
     }
-    app_state_unlock();
 
-    return send_ok(req);
+    if (c->set & CONTROL_LED) {
+        trace_record(TRACE_EV_HTTP, TRACE_HTTP_LED,
+                     ((c->led_brightness > 0) << 8) | c->led_brightness);
+        actuator_post(ACTUATOR_LED, c->led_brightness, ACTUATOR_SRC_HTTP, t0_us);
+    }
+    if (c->set & CONTROL_FAN) {
+        trace_record(TRACE_EV_HTTP, TRACE_HTTP_FAN, ((c->fan_speed > 0) << 8) | c->fan_speed);
+        actuator_post(ACTUATOR_FAN, c->fan_speed, ACTUATOR_SRC_HTTP, t0_us);
+    }
+    if (c->set & CONTROL_CURTAIN) {
+        trace_record(TRACE_EV_HTTP, TRACE_HTTP_CURTAIN, c->curtain);
+        actuator_post(ACTUATOR_CURTAIN, c->curtain, ACTUATOR_SRC_HTTP, t0_us);
+    }
+    if (c->set & CONTROL_SMOKE_THRESHOLD) {
+        // 同步中断报警通路的比较阈值
+        hal_smoke_alarm_set_threshold(c->smoke_threshold);
+        trace_record(TRACE_EV_HTTP, TRACE_HTTP_SMOKE_THRESHOLD, (int32_t)c->smoke_threshold);
+        ESP_LOGI(TAG, "Smoke threshold updated to %lu", (unsigned long)c->smoke_threshold);
+    }
+    if (c->set & CONTROL_MODE) {
+        trace_record(TRACE_EV_HTTP, TRACE_HTTP_MODE, c->mode);
+    }
+    if (c->set & CONTROL_RGB) {
+        trace_record(TRACE_EV_HTTP, TRACE_HTTP_RGB_RGB, (int32_t)c->rgb);
+        actuator_post(ACTUATOR_RGB_RGB, c->rgb, ACTUATOR_SRC_HTTP, t0_us);
+    }
+    if (c->set & CONTROL_RGB_PRESET) {
+        trace_record(TRACE_EV_HTTP, TRACE_HTTP_RGB_COLOR, c->rgb_preset);
+        actuator_post(ACTUATOR_RGB_COLOR, c->rgb_preset, ACTUATOR_SRC_HTTP, t0_us);
+    }
+    return ESP_OK;
 }
 
-static esp_err_t api_curtain_toggle_handler(httpd_req_t *req)
+/**
+ * @brief 单项接口：应用后回复 {"ok":true}
+ */
+static esp_err_t control_and_reply_ok(httpd_req_t *req, control_req_t *c, int64_t t0_us)
 {
     if (require_sensor_data(req) != ESP_OK) {
         return ESP_FAIL;
     }
-
-    if (lock_state_or_503(req) != ESP_OK) {
+    if (apply_control(req, c, t0_us) != ESP_OK) {
         return ESP_FAIL;
     }
+    return send_ok(req);
+}
+
+static bool json_get_int(const cJSON *item, int min, int max, int *out)
+{
+    if (!cJSON_IsNumber(item)) {
+        return false;
+    }
+    double v = item->valuedouble;
+    if (v < min || v > max || v != (double)(int)v) {
+        return false;
+    }
+    *out = (int)v;
+    return true;
+}
 
-    g_sensor_data->curtain_state = !g_sensor_data->curtain_state;
-    app_state_unlock();
+/**
+ * @brief 解析 /api/control 请求体，任何字段非法时整个请求不生效
+ * @return NULL 成功，否则为错误描述
+ */
+static const char *parse_control(const cJSON *root, control_req_t *c)
+{
+    if (!cJSON_IsObject(root)) {
+        return "body must be a json object";
+    }
 
-    return send_ok(req);
+    const cJSON *item = NULL;
+    cJSON_ArrayForEach(item, root) {
+        const char *key = item->string;
+        int v = 0;
+        if (strcmp(key, "led_brightness") == 0) {
+            if (!json_get_int(item, 0, 255, &v)) return "led_brightness must be 0-255";
+            c->set |= CONTROL_LED;
+            c->led_brightness = (uint8_t)v;
+        } else if (strcmp(key, "fan_speed") == 0) {
+            if (!json_get_int(item, 0, 255, &v)) return "fan_speed must be 0-255";
+            c->set |= CONTROL_FAN;
+            c->fan_speed = (uint8_t)v;
+        } else if (strcmp(key, "curtain_state") == 0) {
+            if (!json_get_int(item, 0, 100, &v)) return "curtain_state must be 0-100";
+            c->set |= CONTROL_CURTAIN;
+            c->curtain = (uint8_t)v;
+        } else if (strcmp(key, "control_mode") == 0) {
+            if (!json_get_int(item, CONTROL_MODE_AUTO, CONTROL_MODE_MANUAL, &v)) {
+                return "control_mode must be 0 or 1";
+            }
+            c->set |= CONTROL_MODE;
+            c->mode = (control_mode_t)v;
+        } else if (strcmp(key, "smoke_threshold") == 0) {
+            if (!json_get_int(item, 100, 4095, &v)) return "smoke_threshold must be 100-4095";
+            c->set |= CONTROL_SMOKE_THRESHOLD;
+            c->smoke_threshold = (uint32_t)v;
+        } else if (strcmp(key, "rgb") == 0) {
+            // 预设名称或 [r, g, b]
+            if (cJSON_IsString(item)) {
+                if (!rgb_preset_from_name(item->valuestring, &c->rgb_preset)) {
+                    return "unknown rgb preset";
+                }
+                c->set = (c->set & ~CONTROL_RGB) | CONTROL_RGB_PRESET;
+            } else {
+                if (!cJSON_IsArray(item) || cJSON_GetArraySize(item) != 3) {
+                    return "rgb must be a preset name or [r,g,b]";
+                }
+                uint32_t rgb = 0;
+                for (int i = 0; i < 3; i++) {
+                    if (!json_get_int(cJSON_GetArrayItem(item, i), 0, 255, &v)) {
+                        return "rgb components must be 0-255";
+                    }
+                    rgb = (rgb << 8) | (uint32_t)v;
+                }
+                c->set = (c->set & ~CONTROL_RGB_PRESET) | CONTROL_RGB;
+                c->rgb = rgb;
+            }
+        } else {
+            return "unknown field";
+        }
+    }
+
+    if (c->set == 0) {
+        return "no fields";
+    }
+    return NULL;
 }
 
-static esp_err_t api_led_brightness_handler(httpd_req_t *req)
+// 批量控制：一次请求、一次加锁设置多个执行器 (场景切换)，返回应用后的完整状态
+static esp_err_t api_control_handler(httpd_req_t *req)
 {
+    int64_t t0_us = esp_timer_get_time();
     if (require_sensor_data(req) != ESP_OK) {
         return ESP_FAIL;
     }
 
-    int value = 0;
-    if (!query_get_int(req, "value", &value)) {
-        return send_json_status(req, "400 Bad Request", "missing value");
+    char body[CONTROL_BODY_MAX];
+    if (recv_request_body(req, body, sizeof(body)) != ESP_OK) {
+        return ESP_FAIL;
     }
 
-    if (value < 0) value = 0;
-    if (value > 255) value = 255;
+    cJSON *root = cJSON_Parse(body);
+    if (root == NULL) {
+        return send_json_status(req, "400 Bad Request", "invalid json");
+    }
+    control_req_t c = {0};
+    const char *err = parse_control(root, &c);
+    cJSON_Delete(root);
+    if (err != NULL) {
+        return send_json_status(req, "400 Bad Request", err);
+    }
 
-    if (lock_state_or_503(req) != ESP_OK) {
+    if (apply_control(req, &c, t0_us) != ESP_OK) {
         return ESP_FAIL;
     }
+    return data_poll_send_state(req);
+}
 
-    g_sensor_data->led_brightness = (uint8_t)value;
-    g_sensor_data->led_state = (value > 0) ? 1 : 0;
-    app_state_unlock();
+static esp_err_t api_led_toggle_handler(httpd_req_t *req)
+{
+    control_req_t c = {.toggle = CONTROL_LED};
+    return control_and_reply_ok(req, &c, esp_timer_get_time());
+}
 
-    return send_ok(req);
+static esp_err_t api_fan_toggle_handler(httpd_req_t *req)
+{
+    control_req_t c = {.toggle = CONTROL_FAN};
+    return control_and_reply_ok(req, &c, esp_timer_get_time());
 }
 
-static esp_err_t api_fan_speed_handler(httpd_req_t *req)
+static esp_err_t api_curtain_toggle_handler(httpd_req_t *req)
 {
-    if (require_sensor_data(req) != ESP_OK) {
-        return ESP_FAIL;
-    }
+    control_req_t c = {.toggle = CONTROL_CURTAIN};
+    return control_and_reply_ok(req, &c, esp_timer_get_time());
+}
 
+static esp_err_t api_mode_toggle_handler(httpd_req_t *req)
+{
+    control_req_t c = {.toggle = CONTROL_MODE};
+    return control_and_reply_ok(req, &c, esp_timer_get_time());
+}
+
+static esp_err_t api_curtain_position_handler(httpd_req_t *req)
+{
+    int64_t t0_us = esp_timer_get_time();
     int value = 0;
     if (!query_get_int(req, "value", &value)) {
         return send_json_status(req, "400 Bad Request", "missing value");
     }
 
     if (value < 0) value = 0;
-    if (value > 255) value = 255;
+    if (value > 100) value = 100;
 
-    if (lock_state_or_503(req) != ESP_OK) {
-        return ESP_FAIL;
+    control_req_t c = {.set = CONTROL_CURTAIN, .curtain = (uint8_t)value};
+    return control_and_reply_ok(req, &c, t0_us);
+}
+
+static esp_err_t api_led_brightness_handler(httpd_req_t *req)
+{
+    int64_t t0_us = esp_timer_get_time();
+    int value = 0;
+    if (!query_get_int(req, "value", &value)) {
+        return send_json_status(req, "400 Bad Request", "missing value");
     }
 
-    g_sensor_data->fan_speed = (uint8_t)value;
-    g_sensor_data->fan_state = (g_sensor_data->fan_speed > 0) ? 1 : 0;
-    app_state_unlock();
+    if (value < 0) value = 0;
+    if (value > 255) value = 255;
 
-    return send_ok(req);
+    control_req_t c = {.set = CONTROL_LED, .led_brightness = (uint8_t)value};
+    return control_and_reply_ok(req, &c, t0_us);
 }
 
-static esp_err_t api_mode_toggle_handler(httpd_req_t *req)
+static esp_err_t api_fan_speed_handler(httpd_req_t *req)
 {
-    if (require_sensor_data(req) != ESP_OK) {
-        return ESP_FAIL;
-    }
-
-    if (lock_state_or_503(req) != ESP_OK) {
-        return ESP_FAIL;
+    int64_t t0_us = esp_timer_get_time();
+    int value = 0;
+    if (!query_get_int(req, "value", &value)) {
+        return send_json_status(req, "400 Bad Request", "missing value");
     }
 
-    if (g_sensor_data->control_mode == CONTROL_MODE_AUTO) {
-        app_control_set_mode(g_sensor_data, CONTROL_MODE_MANUAL);
-    } else {
-        app_control_set_mode(g_sensor_data, CONTROL_MODE_AUTO);
-    }
-    app_state_unlock();
+    if (value < 0) value = 0;
+    if (value > 255) value = 255;
 
-    return send_ok(req);
+    control_req_t c = {.set = CONTROL_FAN, .fan_speed = (uint8_t)value};
+    return control_and_reply_ok(req, &c, t0_us);
 }
 
 static esp_err_t api_smoke_threshold_handler(httpd_req_t *req)
@@ -331,19 +887,13 @@ static esp_err_t api_smoke_threshold_handler(httpd_req_t *req)
         return send_json_status(req, "400 Bad Request", "threshold out of range");
     }
 
-    if (lock_state_or_503(req) != ESP_OK) {
-        return ESP_FAIL;
-    }
-
-    g_sensor_data->smoke_threshold = (uint32_t)value;
-    app_state_unlock();
-
-    ESP_LOGI(TAG, "Smoke threshold updated to %d", value);
-    return send_ok(req);
+    control_req_t c = {.set = CONTROL_SMOKE_THRESHOLD, .smoke_threshold = (uint32_t)value};
+    return control_and_reply_ok(req, &c, esp_timer_get_time());
 }
 
 static esp_err_t api_rgb_color_handler(httpd_req_t *req)
 {
+    int64_t t0_us = esp_timer_get_time();
     int r = 0;
     int g = 255;
     int b = 0;
@@ -359,34 +909,155 @@ static esp_err_t api_rgb_color_handler(httpd_req_t *req)
     if (b < 0) b = 0;
     if (b > 255) b = 255;
 
-    rgb_led_set_rgb((uint8_t)r, (uint8_t)g, (uint8_t)b);
     ESP_LOGI(TAG, "RGB set to: R=%d G=%d B=%d", r, g, b);
-
-    return send_ok(req);
+    control_req_t c = {
+        .set = CONTROL_RGB,
+        .rgb = ((uint32_t)r << 16) | ((uint32_t)g << 8) | (uint32_t)b,
+    };
+    return control_and_reply_ok(req, &c, t0_us);
 }
 
 static esp_err_t api_rgb_preset_handler(httpd_req_t *req)
 {
+    int64_t t0_us = esp_timer_get_time();
     char query[32];
     if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
         char color_str[16];
         if (httpd_query_key_value(query, "c", color_str, sizeof(color_str)) == ESP_OK) {
-            rgb_color_t color = RGB_COLOR_GREEN;
-            if (strcmp(color_str, "red") == 0) color = RGB_COLOR_RED;
-            else if (strcmp(color_str, "green") == 0) color = RGB_COLOR_GREEN;
-            else if (strcmp(color_str, "blue") == 0) color = RGB_COLOR_BLUE;
-            else if (strcmp(color_str, "yellow") == 0) color = RGB_COLOR_YELLOW;
-            else if (strcmp(color_str, "cyan") == 0) color = RGB_COLOR_CYAN;
-            else if (strcmp(color_str, "magenta") == 0) color = RGB_COLOR_MAGENTA;
-            else if (strcmp(color_str, "white") == 0) color = RGB_COLOR_WHITE;
-            else if (strcmp(color_str, "orange") == 0) color = RGB_COLOR_ORANGE;
-            else if (strcmp(color_str, "purple") == 0) color = RGB_COLOR_PURPLE;
-
-            rgb_led_set_color(color);
+            // 未知名称按绿色处理
+            control_req_t c = {.set = CONTROL_RGB_PRESET, .rgb_preset = RGB_COLOR_GREEN};
+            rgb_preset_from_name(color_str, &c.rgb_preset);
             ESP_LOGI(TAG, "RGB preset: %s", color_str);
+            return control_and_reply_ok(req, &c, t0_us);
+        }
+    }
+
+    return send_ok(req);
+}
+
+// 自动化规则：GET 导出当前规则，POST 热加载并写入 NVS
+static esp_err_t api_rules_get_handler(httpd_req_t *req)
+{
+    char *json = rules_export_json();
+    if (json == NULL) {
+        return send_json_status(req, "503 Service Unavailable", "rules unavailable");
+    }
+    httpd_resp_set_type(req, "application/json");
+    esp_err_t ret = httpd_resp_send(req, json, strlen(json));
+    free(json);
+    return ret;
+}
+
+static esp_err_t api_rules_post_handler(httpd_req_t *req)
+{
+    char *body = malloc(RULES_JSON_MAX);
+    if (body == NULL) {
+        return send_json_status(req, "500 Internal Server Error", "out of memory");
+    }
+    if (recv_request_body(req, body, RULES_JSON_MAX) != ESP_OK) {
+        free(body);
+        return ESP_FAIL;
+    }
+
+    // {"rules": null} 或 {} 恢复内置默认规则
+    cJSON *root = cJSON_Parse(body);
+    bool reset = (root != NULL) &&
+                 !cJSON_IsArray(cJSON_GetObjectItemCaseSensitive(root, "rules"));
+    cJSON_Delete(root);
+
+    const char *err = NULL;
+    esp_err_t ret = rules_load(reset ? NULL : body, true, &err);
+    free(body);
+    if (ret != ESP_OK) {
+        return send_json_status(req, "400 Bad Request", err ? err : "invalid rules");
+    }
+
+    rules_stats_t stats;
+    rules_get_stats(&stats);
+    ESP_LOGI(TAG, "Rules reloaded: %lu rules (%s)", (unsigned long)stats.rule_count,
+             stats.from_nvs ? "custom" : "defaults");
+    return send_ok(req);
+}
+
+static esp_err_t api_fan_pid_get_handler(httpd_req_t *req)
+{
+    app_fan_pi_status_t status;
+    app_control_get_fan_pi(&status);
+
+    cJSON *root = cJSON_CreateObject();
+    if (root == NULL) {
+        return send_json_status(req, "500 Internal Server Error", "out of memory");
+    }
+
+    cJSON_AddBoolToObject(root, "enabled", status.enabled);
+    cJSON_AddNumberToObject(root, "setpoint", status.cfg.setpoint / 10.0);
+    cJSON_AddNumberToObject(root, "kp", status.cfg.kp_x10 / 10.0);
+    cJSON_AddNumberToObject(root, "ki", status.cfg.ki_x1000 / 1000.0);
+    cJSON_AddNumberToObject(root, "min_duty", status.cfg.min_duty);
+    cJSON_AddNumberToObject(root, "output", status.output);
+    cJSON_AddNumberToObject(root, "error", status.error / 10.0);
+    cJSON_AddNumberToObject(root, "integral", status.integral);
+    cJSON_AddNumberToObject(root, "windup_holds", status.windup_holds);
+    cJSON_AddNumberToObject(root, "resyncs", status.resyncs);
+
+    char *json_str = cJSON_PrintUnformatted(root);
+    cJSON_Delete(root);
+    if (json_str == NULL) {
+        return send_json_status(req, "500 Internal Server Error", "out of memory");
+    }
+    httpd_resp_set_type(req, "application/json");
+    esp_err_t ret = httpd_resp_send(req, json_str, strlen(json_str));
+    free(json_str);
+    return ret;
+}
+
+static esp_err_t api_fan_pid_post_handler(httpd_req_t *req)
+{
+    char body[192];
+    if (recv_request_body(req, body, sizeof(body)) != ESP_OK) {
+        return ESP_FAIL;
+    }
+
+    cJSON *root = cJSON_Parse(body);
+    if (root == NULL) {
+        return send_json_status(req, "400 Bad Request", "invalid json");
+    }
+
+    // 未给出的字段保持当前值
+    app_fan_pi_status_t status;
+    app_control_get_fan_pi(&status);
+    bool enabled = status.enabled;
+    fan_pi_cfg_t cfg = status.cfg;
+
+    cJSON *item = cJSON_GetObjectItemCaseSensitive(root, "enabled");
+    if (cJSON_IsBool(item)) {
+        enabled = cJSON_IsTrue(item);
+    }
+    item = cJSON_GetObjectItemCaseSensitive(root, "setpoint");
+    if (cJSON_IsNumber(item)) {
+        cfg.setpoint = (int32_t)lround(item->valuedouble * 10.0);
+    }
+    item = cJSON_GetObjectItemCaseSensitive(root, "kp");
+    if (cJSON_IsNumber(item)) {
+        cfg.kp_x10 = (int32_t)lround(item->valuedouble * 10.0);
+    }
+    item = cJSON_GetObjectItemCaseSensitive(root, "ki");
+    if (cJSON_IsNumber(item)) {
+        cfg.ki_x1000 = (int32_t)lround(item->valuedouble * 1000.0);
+    }
+    item = cJSON_GetObjectItemCaseSensitive(root, "min_duty");
+    if (cJSON_IsNumber(item)) {
+        if (item->valueint < 0 || item->valueint > FAN_SPEED_HIGH) {
+            cJSON_Delete(root);
+            return send_json_status(req, "400 Bad Request", "min_duty out of range");
         }
+        cfg.min_duty = (uint8_t)item->valueint;
     }
+    cJSON_Delete(root);
 
+    if (app_control_set_fan_pi(enabled, &cfg) != ESP_OK) {
+        return send_json_status(req, "400 Bad Request", "parameter out of range");
+    }
     return send_ok(req);
 }
 
@@ -396,7 +1067,11 @@ httpd_handle_t http_server_start(sensor_data_t *sensor_data)
 
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
     config.server_port = HTTP_SERVER_PORT;
-    config.max_uri_handlers = 16;
+    config.max_uri_handlers = 24;
+    config.max_open_sockets = HTTP_MAX_OPEN_SOCKETS;
+    // 会话占满时关闭最久未活动的会话，而不是拒绝新连接
+    config.lru_purge_enable = true;
+    config.close_fn = on_session_close;
 
     httpd_handle_t server = NULL;
     if (httpd_start(&server, &config) != ESP_OK) {
@@ -416,6 +1091,24 @@ httpd_handle_t http_server_start(sensor_data_t *sensor_data)
         .handler = api_data_handler,
         .user_ctx = NULL,
     };
+    httpd_uri_t api_metrics_uri = {
+        .uri = "/api/metrics",
+        .method = HTTP_GET,
+        .handler = api_metrics_handler,
+        .user_ctx = NULL,
+    };
+    httpd_uri_t api_history_uri = {
+        .uri = "/api/history",
+        .method = HTTP_GET,
+        .handler = api_history_handler,
+        .user_ctx = NULL,
+    };
+    httpd_uri_t api_trace_uri = {
+        .uri = "/api/trace",
+        .method = HTTP_GET,
+        .handler = api_trace_handler,
+        .user_ctx = NULL,
+    };
     httpd_uri_t api_led_toggle_uri = {
         .uri = "/api/led/toggle",
         .method = HTTP_POST,
@@ -440,6 +1133,12 @@ httpd_handle_t http_server_start(sensor_data_t *sensor_data)
         .handler = api_curtain_toggle_handler,
         .user_ctx = NULL,
     };
+    httpd_uri_t api_curtain_position_uri = {
+        .uri = "/api/curtain/position",
+        .method = HTTP_POST,
+        .handler = api_curtain_position_handler,
+        .user_ctx = NULL,
+    };
     httpd_uri_t api_led_brightness_uri = {
         .uri = "/api/led/brightness",
         .method = HTTP_POST,
@@ -470,19 +1169,58 @@ httpd_handle_t http_server_start(sensor_data_t *sensor_data)
         .handler = api_rgb_preset_handler,
         .user_ctx = NULL,
     };
+    httpd_uri_t api_control_uri = {
+        .uri = "/api/control",
+        .method = HTTP_POST,
+        .handler = api_control_handler,
+        .user_ctx = NULL,
+    };
+    httpd_uri_t api_fan_pid_get_uri = {
+        .uri = "/api/fan/pid",
+        .method = HTTP_GET,
+        .handler = api_fan_pid_get_handler,
+        .user_ctx = NULL,
+    };
+    httpd_uri_t api_fan_pid_post_uri = {
+        .uri = "/api/fan/pid",
+        .method = HTTP_POST,
+        .handler = api_fan_pid_post_handler,
+        .user_ctx = NULL,
+    };
+    httpd_uri_t api_rules_get_uri = {
+        .uri = "/api/rules",
+        .method = HTTP_GET,
+        .handler = api_rules_get_handler,
+        .user_ctx = NULL,
+    };
+    httpd_uri_t api_rules_post_uri = {
+        .uri = "/api/rules",
+        .method = HTTP_POST,
+        .handler = api_rules_post_handler,
+        .user_ctx = NULL,
+    };
 
     const httpd_uri_t *uris[] = {
         &root_uri,
         &api_data_uri,
+        &api_metrics_uri,
+        &api_history_uri,
+        &api_trace_uri,
         &api_led_toggle_uri,
         &api_fan_toggle_uri,
         &api_fan_speed_uri,
         &api_curtain_toggle_uri,
+        &api_curtain_position_uri,
         &api_led_brightness_uri,
         &api_mode_toggle_uri,
         &api_smoke_threshold_uri,
         &api_rgb_color_uri,
         &api_rgb_preset_uri,
+        &api_control_uri,
+        &api_rules_get_uri,
+        &api_rules_post_uri,
+        &api_fan_pid_get_uri,
+        &api_fan_pid_post_uri,
     };
 
     for (size_t i = 0; i < sizeof(uris) / sizeof(uris[0]); i++) {
@@ -493,6 +1231,15 @@ httpd_handle_t http_server_start(sensor_data_t *sensor_data)
         }
     }
 
+    // 推送通道失败不影响 HTTP 接口，页面退回轮询
+    if (ws_push_start(server) != ESP_OK) {
+        ESP_LOGW(TAG, "WebSocket push unavailable, dashboard falls back to polling");
+    }
+    // 长轮询不可用时 wait_version 请求立即返回当前快照
+    if (data_poll_start() != ESP_OK) {
+        ESP_LOGW(TAG, "Long-poll unavailable, wait_version requests return immediately");
+    }
+
     ESP_LOGI(TAG, "HTTP server started on port %d", config.server_port);
     return server;
 }
@@ -502,5 +1249,7 @@ esp_err_t http_server_stop(httpd_handle_t server)
     if (server == NULL) {
         return ESP_OK;
     }
+    data_poll_stop();
+    ws_push_stop();
     return httpd_stop(server);
 }
@@ -0,0 +1,40 @@
+/**
+ * @file session_budget.c
+ * @brief 长连接会话预算实现
+ */
+
+#include "session_budget.h"
+#include "config.h"
+
+_Static_assert(HTTP_LONG_LIVED_MAX + 2 <= HTTP_MAX_OPEN_SOCKETS,
+               "long-lived sessions must leave room for page and API requests");
+
+static uint32_t s_in_use = 0;
+
+bool session_budget_acquire(void)
+{
+    uint32_t cur = __atomic_load_n(&s_in_use, __ATOMIC_RELAXED);
+    do {
+        if (cur >= HTTP_LONG_LIVED_MAX) {
+            return false;
+        }
+    } while (!__atomic_compare_exchange_n(&s_in_use, &cur, cur + 1, true,
+                                          __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+    return true;
+}
+
+void session_budget_release(void)
+{
+    uint32_t cur = __atomic_load_n(&s_in_use, __ATOMIC_RELAXED);
+    do {
+        if (cur == 0) {
+            return;
+        }
+    } while (!__atomic_compare_exchange_n(&s_in_use, &cur, cur - 1, true,
+                                          __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+}
+
+uint32_t session_budget_in_use(void)
+{
+    return __atomic_load_n(&s_in_use, __ATOMIC_RELAXED);
+}
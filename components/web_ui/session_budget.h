@@ -0,0 +1,31 @@
+/**
+ * @file session_budget.h
+ * @brief 长连接会话预算 (/ws 客户端与挂起的长轮询共享)
+ *
+ * 长连接会一直占用 httpd 会话，预算 HTTP_LONG_LIVED_MAX 比 HTTP_MAX_OPEN_SOCKETS 少若干个，
+ * 保证长连接占满时页面 (/) 与控制接口仍能建立新连接。
+ */
+
+#ifndef SESSION_BUDGET_H
+#define SESSION_BUDGET_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief 占用一个长连接名额
+ * @return false 预算已满
+ */
+bool session_budget_acquire(void);
+
+/**
+ * @brief 归还一个长连接名额
+ */
+void session_budget_release(void);
+
+/**
+ * @brief 当前占用的长连接数
+ */
+uint32_t session_budget_in_use(void);
+
+#endif // SESSION_BUDGET_H
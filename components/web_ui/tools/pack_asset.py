@@ -0,0 +1,74 @@
+#!/usr/bin/env python3
+"""
+构建期打包网页资源：保守压缩 -> gzip -> 生成 ETag 头文件
+
+用法: pack_asset.py <输入.html> <输出.gz> <输出头文件> <宏前缀>
+
+压缩只做不改变语义的处理 (保留换行，JS 自动分号插入不受影响):
+- 去掉每行首尾空白与空行
+- 去掉 HTML 注释、<script> 中的整行 // 注释、<style> 中的 /* */ 注释
+gzip 固定 mtime=0，同一输入得到逐字节相同的输出，ETag 取 gzip 内容的 SHA-256 前 16 位。
+"""
+
+import gzip
+import hashlib
+import re
+import sys
+
+
+def minify(html):
+    html = re.sub(r'<!--.*?-->', '', html, flags=re.S)
+    html = re.sub(r'(<style[^>]*>)(.*?)(</style>)',
+                  lambda m: m.group(1) + re.sub(r'/\*.*?\*/', '', m.group(2), flags=re.S) + m.group(3),
+                  html, flags=re.S)
+    out = []
+    in_script = False
+    for line in html.splitlines():
+        s = line.strip()
+        if '<script' in s:
+            in_script = True
+        if '</script>' in s:
+            in_script = False
+        if not s or (in_script and s.startswith('//')):
+            continue
+        out.append(s)
+    return '\n'.join(out) + '\n'
+
+
+def main():
+    if len(sys.argv) != 5:
+        sys.stderr.write(__doc__)
+        return 1
+    src, gz_path, hdr_path, prefix = sys.argv[1:]
+
+    with open(src, 'r', encoding='utf-8') as f:
+        raw = f.read().encode('utf-8')
+    mini = minify(raw.decode('utf-8')).encode('utf-8')
+    packed = gzip.compress(mini, compresslevel=9, mtime=0)
+    etag = hashlib.sha256(packed).hexdigest()[:16]
+
+    with open(gz_path, 'wb') as f:
+        f.write(packed)
+
+    hdr = (
+        '// 由 tools/pack_asset.py 生成，请勿手动修改\n'
+        '#pragma once\n'
+        f'#define {prefix}_ETAG        "\\"{etag}\\""\n'
+        f'#define {prefix}_RAW_SIZE    {len(raw)}\n'
+        f'#define {prefix}_MIN_SIZE    {len(mini)}\n'
+        f'#define {prefix}_GZ_SIZE     {len(packed)}\n'
+    )
+    # 内容未变时不改写头文件，避免无谓的重新编译
+    try:
+        with open(hdr_path, 'r', encoding='utf-8') as f:
+            if f.read() == hdr:
+                return 0
+    except OSError:
+        pass
+    with open(hdr_path, 'w', encoding='utf-8') as f:
+        f.write(hdr)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
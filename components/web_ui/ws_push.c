@@ -0,0 +1,342 @@
+/**
+ * @file ws_push.c
+ * @brief 状态推送通道实现
+ */
+
+#include "ws_push.h"
+#include "app_state.h"
+#include "config.h"
+#include "session_budget.h"
+#include "state_json.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char *TAG = "WS_PUSH";
+
+#define WS_TASK_STACK       3072
+#define WS_TASK_PRIORITY    2       // 与 APP_TASK_PRIORITY_LOW 一致
+#define WS_TICK_MS          1000    // 无变化时检查停滞与保活的周期
+#define WS_RX_MAX           32      // 客户端消息仅作保活，超长视为异常
+
+typedef struct {
+    int fd;                     // -1 = 空闲槽位
+    uint32_t gen;               // 发送序号，识别过期的完成回调
+    uint32_t dirty;             // 待发送字段 (APP_FIELD_*)
+    bool full;                  // 下一条为完整快照
+    bool in_flight;
+    int64_t sent_us;            // 在途消息开始时刻
+    int64_t last_tx_us;         // 最近一次发送完成时刻
+    char buf[WS_MSG_MAX];       // 在途消息，完成回调前保持有效
+} ws_client_t;
+
+static httpd_handle_t s_server = NULL;
+static SemaphoreHandle_t s_lock = NULL;
+static TaskHandle_t s_task = NULL;
+static app_state_sub_t s_sub = -1;
+static volatile bool s_running = false;
+
+// 以下状态由 s_lock 保护 (推送任务与 httpd 任务共享)
+static ws_client_t s_clients[WS_MAX_CLIENTS];
+static ws_push_stats_t s_stats;
+
+// ==================== 消息格式 ====================
+
+// 消息头 {"v":<版本>,"full":false,"d": 的最大长度
+#define WS_MSG_HEAD_MAX     (sizeof("{\"v\":4294967295,\"full\":false,\"d\":") - 1)
+_Static_assert(WS_MSG_MAX >= WS_MSG_HEAD_MAX + STATE_JSON_MAX_LEN + 1,
+               "WS_MSG_MAX too small for a full snapshot");
+
+static size_t format_message(char *buf, size_t size, const sensor_data_t *s,
+                             uint32_t fields, uint32_t version, bool full)
+{
+    int head = snprintf(buf, size, "{\"v\":%lu,\"full\":%s,\"d\":", (unsigned long)version,
+                        full ? "true" : "false");
+    if (head <= 0 || (size_t)head >= size) {
+        return 0;
+    }
+    size_t body = state_json_write(buf + head, size - head - 1, s, fields);
+    if (body == 0) {
+        return 0;
+    }
+    size_t len = head + body;
+    buf[len++] = '}';
+    buf[len] = '\0';
+    return len;
+}
+
+// ==================== 客户端 (调用方持有 s_lock) ====================
+
+static void on_send_done(esp_err_t err, int socket, void *arg);
+
+static void close_client_locked(ws_client_t *c)
+{
+    httpd_sess_trigger_close(s_server, c->fd);
+    c->fd = -1;
+    c->in_flight = false;
+    s_stats.clients--;
+    session_budget_release();
+}
+
+static void send_frame_locked(ws_client_t *c, httpd_ws_type_t type, size_t len)
+{
+    int slot = (int)(c - s_clients);
+    httpd_ws_frame_t frame = {
+        .final = true,
+        .type = type,
+        .payload = (uint8_t *)c->buf,
+        .len = len,
+    };
+
+    c->gen++;
+    c->in_flight = true;
+    c->sent_us = esp_timer_get_time();
+    void *arg = (void *)(uintptr_t)((c->gen << 8) | (uint32_t)slot);
+    if (httpd_ws_send_data_async(s_server, c->fd, &frame, on_send_done, arg) != ESP_OK) {
+        s_stats.send_errors++;
+        close_client_locked(c);
+    }
+}
+
+static void send_state_locked(ws_client_t *c)
+{
+    sensor_data_t snapshot;
+    uint32_t version = app_state_read_snapshot(&snapshot);
+    size_t len = format_message(c->buf, sizeof(c->buf), &snapshot, c->dirty, version, c->full);
+    c->dirty = 0;
+    c->full = false;
+    if (len == 0) {
+        return;
+    }
+
+    s_stats.messages++;
+    s_stats.bytes += len;
+    send_frame_locked(c, HTTPD_WS_TYPE_TEXT, len);
+}
+
+static void on_send_done(esp_err_t err, int socket, void *arg)
+{
+    uint32_t slot = (uint32_t)(uintptr_t)arg & 0xFF;
+    uint32_t gen = (uint32_t)(uintptr_t)arg >> 8;
+    if (slot >= WS_MAX_CLIENTS) {
+        return;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    ws_client_t *c = &s_clients[slot];
+    if (c->fd == socket && c->in_flight && (c->gen & 0xFFFFFF) == (gen & 0xFFFFFF)) {
+        c->in_flight = false;
+        if (err != ESP_OK) {
+            s_stats.send_errors++;
+            close_client_locked(c);
+        } else {
+            c->last_tx_us = esp_timer_get_time();
+            // 在途期间累积的变化立即以最新快照补发
+            if (c->dirty != 0) {
+                send_state_locked(c);
+            }
+        }
+    }
+    xSemaphoreGive(s_lock);
+}
+
+// ==================== 推送任务 ====================
+
+static void ws_push_task(void *arg)
+{
+    while (s_running) {
+        uint32_t changed = app_state_wait(s_sub, pdMS_TO_TICKS(WS_TICK_MS));
+        int64_t now = esp_timer_get_time();
+
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+            ws_client_t *c = &s_clients[i];
+            if (c->fd < 0) {
+                continue;
+            }
+            if (changed != 0) {
+                if (c->in_flight) {
+                    s_stats.coalesced++;
+                }
+                c->dirty |= changed;
+            }
+
+            if (c->in_flight) {
+                if (now - c->sent_us > (int64_t)WS_STALL_MS * 1000) {
+                    ESP_LOGW(TAG, "Client fd %d stalled, closing", c->fd);
+                    s_stats.stalled++;
+                    close_client_locked(c);
+                }
+            } else if (c->dirty != 0) {
+                send_state_locked(c);
+            } else if (now - c->last_tx_us > (int64_t)WS_PING_INTERVAL_MS * 1000) {
+                send_frame_locked(c, HTTPD_WS_TYPE_PING, 0);
+            }
+        }
+        xSemaphoreGive(s_lock);
+    }
+
+    s_task = NULL;
+    vTaskDelete(NULL);
+}
+
+// ==================== /ws 处理 ====================
+
+static esp_err_t ws_handler(httpd_req_t *req)
+{
+    if (req->method == HTTP_GET) {
+        // 握手已完成：登记客户端并推送完整快照
+        int fd = httpd_req_to_sockfd(req);
+        ws_client_t *c = NULL;
+
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        for (int i = 0; i < WS_MAX_CLIENTS && c == NULL; i++) {
+            if (s_clients[i].fd < 0) {
+                c = &s_clients[i];
+            }
+        }
+        // 客户端数与长连接共享预算都要满足，预算满时拒绝，给页面和控制请求留出会话
+        if (c == NULL || !session_budget_acquire()) {
+            s_stats.rejected++;
+            xSemaphoreGive(s_lock);
+            ESP_LOGW(TAG, "Client limit reached, rejecting fd %d", fd);
+            httpd_sess_trigger_close(req->handle, fd);
+            return ESP_OK;
+        }
+
+        c->fd = fd;
+        c->dirty = APP_FIELD_ALL;
+        c->full = true;
+        c->in_flight = false;
+        c->last_tx_us = esp_timer_get_time();
+        s_stats.clients++;
+        s_stats.connects++;
+        send_state_locked(c);
+        xSemaphoreGive(s_lock);
+        return ESP_OK;
+    }
+
+    httpd_ws_frame_t frame = {0};
+    esp_err_t ret = httpd_ws_recv_frame(req, &frame, 0);
+    if (ret != ESP_OK || frame.len == 0) {
+        return ret;
+    }
+    if (frame.len > WS_RX_MAX) {
+        return ESP_FAIL;
+    }
+    uint8_t rx[WS_RX_MAX];
+    frame.payload = rx;
+    return httpd_ws_recv_frame(req, &frame, frame.len);
+}
+
+// ==================== 公共接口 ====================
+
+esp_err_t ws_push_start(httpd_handle_t server)
+{
+    if (s_running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (s_lock == NULL) {
+        s_lock = xSemaphoreCreateMutex();
+        if (s_lock == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    memset(s_clients, 0, sizeof(s_clients));
+    for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+        s_clients[i].fd = -1;
+    }
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_server = server;
+
+    httpd_uri_t ws_uri = {
+        .uri = "/ws",
+        .method = HTTP_GET,
+        .handler = ws_handler,
+        .user_ctx = NULL,
+        .is_websocket = true,
+    };
+    esp_err_t ret = httpd_register_uri_handler(server, &ws_uri);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to register /ws (%d)", ret);
+        return ret;
+    }
+
+    ret = app_state_subscribe(APP_FIELD_ALL, &s_sub);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    s_running = true;
+    if (xTaskCreate(ws_push_task, "ws_push", WS_TASK_STACK, NULL, WS_TASK_PRIORITY,
+                    &s_task) != pdPASS) {
+        s_running = false;
+        app_state_unsubscribe(s_sub);
+        s_sub = -1;
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "Push channel ready on /ws (max %d clients)", WS_MAX_CLIENTS);
+    return ESP_OK;
+}
+
+void ws_push_stop(void)
+{
+    if (!s_running) {
+        return;
+    }
+
+    // 推送任务最多在一个 WS_TICK_MS 内退出
+    s_running = false;
+    while (s_task != NULL) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    app_state_unsubscribe(s_sub);
+    s_sub = -1;
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+        if (s_clients[i].fd >= 0) {
+            session_budget_release();
+        }
+        s_clients[i].fd = -1;
+        s_clients[i].in_flight = false;
+    }
+    s_stats.clients = 0;
+    xSemaphoreGive(s_lock);
+    s_server = NULL;
+}
+
+void ws_push_on_close(int sockfd)
+{
+    if (s_lock == NULL) {
+        return;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+        if (s_clients[i].fd == sockfd) {
+            s_clients[i].fd = -1;
+            s_clients[i].in_flight = false;
+            s_stats.clients--;
+            session_budget_release();
+        }
+    }
+    xSemaphoreGive(s_lock);
+}
+
+void ws_push_get_stats(ws_push_stats_t *stats)
+{
+    if (stats == NULL || s_lock == NULL) {
+        return;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    *stats = s_stats;
+    xSemaphoreGive(s_lock);
+}
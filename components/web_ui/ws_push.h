@@ -0,0 +1,54 @@
+/**
+ * @file ws_push.h
+ * @brief 状态推送通道 (WebSocket /ws)
+ *
+ * 连接建立后先推送完整快照，之后只推送变化的字段：
+ * {"v":<状态版本>,"full":true|false,"d":{<字段>...}}
+ * - 推送任务订阅 app_state，变化位按客户端累积到各自的待发送掩码
+ * - 每个客户端同一时刻最多一条在途消息；在途期间的变化只合并掩码，
+ *   发送完成后再以最新快照发出一条，慢客户端不会积压旧数据
+ * - 在途超过 WS_STALL_MS 的客户端被断开，空闲时按 WS_PING_INTERVAL_MS 发送 PING
+ */
+
+#ifndef WS_PUSH_H
+#define WS_PUSH_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+/**
+ * @brief 推送统计
+ */
+typedef struct {
+    uint32_t clients;           // 当前连接数
+    uint32_t connects;          // 累计接入
+    uint32_t rejected;          // 连接数已满被拒绝
+    uint32_t messages;          // 发出的状态消息
+    uint32_t bytes;             // 发出的状态消息字节数
+    uint32_t coalesced;         // 在途期间被合并的变化次数
+    uint32_t stalled;           // 因发送停滞被断开
+    uint32_t send_errors;       // 发送失败 (连接随之关闭)
+} ws_push_stats_t;
+
+/**
+ * @brief 注册 /ws 并启动推送任务 (httpd_start 之后调用)
+ */
+esp_err_t ws_push_start(httpd_handle_t server);
+
+/**
+ * @brief 停止推送任务 (httpd_stop 之前调用)
+ */
+void ws_push_stop(void);
+
+/**
+ * @brief 会话关闭通知 (由 httpd close_fn 调用)
+ */
+void ws_push_on_close(int sockfd);
+
+/**
+ * @brief 获取推送统计
+ */
+void ws_push_get_stats(ws_push_stats_t *stats);
+
+#endif // WS_PUSH_H
@@ -0,0 +1,197 @@
+/**
+ * @file bench_state_json.c
+ * @brief state_json 输出校验与基准：对照原 cJSON 实现 (cJSON 树 + PrintUnformatted)
+ *
+ * 用法: bench_state_json [迭代次数]
+ * 校验：固定快照的输出逐字节比对；随机快照的输出可被 cJSON 解析，
+ * 各字段与快照一致 (浮点误差不超过 0.05)，长度不超过 STATE_JSON_MAX_LEN。
+ * 基准：单次生成耗时与堆操作次数 (cJSON 经 InitHooks 计数，主机单线程无并发用户)。
+ */
+
+#include "host_test.h"
+#include "state_json.h"
+#include "app_state.h"
+#include "cJSON.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+HOST_TEST_DEFINE_GLOBALS();
+
+#define DEFAULT_ITERATIONS 200000
+
+// 原 /api/data 实现
+static char *data_json_cjson(const sensor_data_t *s)
+{
+    cJSON *root = cJSON_CreateObject();
+    if (root == NULL) {
+        return NULL;
+    }
+    cJSON_AddNumberToObject(root, "temperature", s->temperature);
+    cJSON_AddNumberToObject(root, "humidity", s->humidity);
+    cJSON_AddNumberToObject(root, "light", s->light);
+    cJSON_AddNumberToObject(root, "smoke", s->smoke);
+    cJSON_AddNumberToObject(root, "smoke_threshold", s->smoke_threshold);
+    cJSON_AddNumberToObject(root, "led_state", s->led_state);
+    cJSON_AddNumberToObject(root, "led_brightness", s->led_brightness);
+    cJSON_AddNumberToObject(root, "fan_state", s->fan_state);
+    cJSON_AddNumberToObject(root, "fan_speed", s->fan_speed);
+    cJSON_AddNumberToObject(root, "curtain_state", s->curtain_state);
+    cJSON_AddNumberToObject(root, "curtain_position", s->curtain_position);
+    cJSON_AddNumberToObject(root, "control_mode", s->control_mode);
+    char *json = cJSON_PrintUnformatted(root);
+    cJSON_Delete(root);
+    return json;
+}
+
+static uint32_t s_heap_ops;
+
+static void *counting_malloc(size_t size)
+{
+    s_heap_ops++;
+    return malloc(size);
+}
+
+static void counting_free(void *ptr)
+{
+    s_heap_ops++;
+    free(ptr);
+}
+
+static void test_golden(void)
+{
+    sensor_data_t s = {
+        .temperature = 25.64f, .humidity = 48.04f, .light = 0.0f,
+        .smoke = 812, .smoke_threshold = 3500,
+        .led_state = 1, .led_brightness = 255, .fan_state = 0, .fan_speed = 0,
+        .curtain_state = 100, .curtain_position = 37, .control_mode = CONTROL_MODE_MANUAL,
+    };
+    char buf[STATE_JSON_MAX_LEN];
+    size_t n = state_json_write(buf, sizeof(buf), &s, APP_FIELD_ALL);
+    const char *expected =
+        "{\"temperature\":25.6,\"humidity\":48.0,\"light\":0.0,\"smoke\":812,"
+        "\"smoke_threshold\":3500,\"led_state\":1,\"led_brightness\":255,\"fan_state\":0,"
+        "\"fan_speed\":0,\"curtain_state\":100,\"curtain_position\":37,\"control_mode\":1}";
+    CHECK_EQ(n, strlen(expected));
+    CHECK(strcmp(buf, expected) == 0);
+
+    n = state_json_write(buf, sizeof(buf), &s, APP_FIELD_FAN | APP_FIELD_CURTAIN_POSITION);
+    CHECK(strcmp(buf, "{\"fan_state\":0,\"fan_speed\":0,\"curtain_position\":37}") == 0);
+
+    s.temperature = NAN;
+    s.humidity = -INFINITY;
+    s.light = -12.35f;
+    n = state_json_write(buf, sizeof(buf), &s,
+                         APP_FIELD_TEMPERATURE | APP_FIELD_HUMIDITY | APP_FIELD_LIGHT);
+    CHECK(strcmp(buf, "{\"temperature\":null,\"humidity\":null,\"light\":-12.4}") == 0);
+
+    // 缓冲区不足时返回 0，不越界
+    CHECK_EQ(state_json_write(buf, 8, &s, APP_FIELD_ALL), 0);
+}
+
+static sensor_data_t random_snapshot(void)
+{
+    sensor_data_t s = {
+        .temperature = (float)(rand() % 200001 - 100000) / 100.0f,
+        .humidity = (float)(rand() % 10001) / 100.0f,
+        .light = (float)(rand() % 6553500) / 100.0f,
+        .smoke = (uint32_t)rand() * 2u + (uint32_t)(rand() & 1),
+        .smoke_threshold = (uint32_t)(rand() % 4096),
+        .led_state = (uint8_t)(rand() & 1),
+        .led_brightness = (uint8_t)rand(),
+        .fan_state = (uint8_t)(rand() & 1),
+        .fan_speed = (uint8_t)rand(),
+        .curtain_state = (uint8_t)(rand() % 101),
+        .curtain_position = (uint8_t)(rand() % 101),
+        .control_mode = (control_mode_t)(rand() & 1),
+    };
+    return s;
+}
+
+static double field_number(const cJSON *root, const char *name)
+{
+    const cJSON *item = cJSON_GetObjectItemCaseSensitive(root, name);
+    CHECK(cJSON_IsNumber(item));
+    return cJSON_IsNumber(item) ? item->valuedouble : NAN;
+}
+
+static void test_roundtrip(int count)
+{
+    char buf[STATE_JSON_MAX_LEN];
+    for (int i = 0; i < count; i++) {
+        sensor_data_t s = random_snapshot();
+        size_t n = state_json_write(buf, sizeof(buf), &s, APP_FIELD_ALL);
+        CHECK(n > 0 && n < STATE_JSON_MAX_LEN);
+
+        cJSON *root = cJSON_Parse(buf);
+        CHECK(root != NULL);
+        if (root == NULL) {
+            fprintf(stderr, "unparsable: %s\n", buf);
+            continue;
+        }
+#define CHECK_FIELD(name, fmt, bit) \
+        CHECK(fabs(field_number(root, #name) - (double)s.name) <= 0.05 + fabs((double)s.name) * 1e-7);
+        SENSOR_DATA_FIELDS(CHECK_FIELD)
+#undef CHECK_FIELD
+        cJSON_Delete(root);
+    }
+}
+
+static void bench(int iterations)
+{
+    sensor_data_t s = {
+        .temperature = 26.3f, .humidity = 51.2f, .light = 342.0f,
+        .smoke = 804, .smoke_threshold = 3500,
+        .led_state = 0, .led_brightness = 0, .fan_state = 1, .fan_speed = 150,
+        .curtain_state = 60, .curtain_position = 60, .control_mode = CONTROL_MODE_AUTO,
+    };
+    char buf[STATE_JSON_MAX_LEN];
+    size_t writer_bytes = 0;
+    size_t cjson_bytes = 0;
+
+    int64_t start = host_now_ns();
+    for (int i = 0; i < iterations; i++) {
+        // 每次改动温度，防止编译器把循环体提出循环
+        s.temperature = 26.3f + (float)(i & 7) * 0.1f;
+        writer_bytes = state_json_write(buf, sizeof(buf), &s, APP_FIELD_ALL);
+    }
+    int64_t writer_ns = host_now_ns() - start;
+
+    cJSON_Hooks hooks = {.malloc_fn = counting_malloc, .free_fn = counting_free};
+    cJSON_InitHooks(&hooks);
+    s_heap_ops = 0;
+    start = host_now_ns();
+    for (int i = 0; i < iterations; i++) {
+        s.temperature = 26.3f + (float)(i & 7) * 0.1f;
+        char *out = data_json_cjson(&s);
+        CHECK(out != NULL);
+        if (out == NULL) {
+            break;
+        }
+        cjson_bytes = strlen(out);
+        cJSON_free(out);
+    }
+    int64_t cjson_ns = host_now_ns() - start;
+    cJSON_InitHooks(NULL);
+
+    printf("iterations: %d\n", iterations);
+    printf("  writer: %6.1f ns/response, 0 heap ops, %zu bytes\n",
+           (double)writer_ns / iterations, writer_bytes);
+    printf("  cjson:  %6.1f ns/response, %.1f heap ops, %zu bytes\n",
+           (double)cjson_ns / iterations, (double)s_heap_ops / iterations, cjson_bytes);
+    printf("  speedup: %.1fx\n", (double)cjson_ns / (double)(writer_ns ? writer_ns : 1));
+}
+
+int main(int argc, char **argv)
+{
+    int iterations = (argc > 1) ? atoi(argv[1]) : DEFAULT_ITERATIONS;
+    if (iterations <= 0) {
+        iterations = DEFAULT_ITERATIONS;
+    }
+
+    srand(1);
+    test_golden();
+    test_roundtrip(10000);
+    bench(iterations);
+    return HOST_TEST_RESULT("state_json");
+}
@@ -0,0 +1,51 @@
+/**
+ * @file host_test.h
+ * @brief 主机测试公共断言与计时
+ *
+ * 失败时打印位置并计数，main() 以 HOST_TEST_RESULT() 返回，ctest 据退出码判定。
+ */
+
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+
+extern int g_host_test_failures;
+
+#define HOST_TEST_DEFINE_GLOBALS() int g_host_test_failures = 0
+
+#define CHECK(cond) do {                                                    \
+        if (!(cond)) {                                                      \
+            fprintf(stderr, "%s:%d: CHECK failed: %s\n",                    \
+                    __FILE__, __LINE__, #cond);                             \
+            g_host_test_failures++;                                         \
+        }                                                                   \
+    } while (0)
+
+#define CHECK_EQ(a, b) do {                                                 \
+        long long a_ = (long long)(a), b_ = (long long)(b);                 \
+        if (a_ != b_) {                                                     \
+            fprintf(stderr, "%s:%d: CHECK_EQ failed: %s (%lld) != %s (%lld)\n", \
+                    __FILE__, __LINE__, #a, a_, #b, b_);                    \
+            g_host_test_failures++;                                         \
+        }                                                                   \
+    } while (0)
+
+#define HOST_TEST_RESULT(name) (                                            \
+        printf("%s: %s (%d failures)\n", (name),                            \
+               g_host_test_failures ? "FAIL" : "PASS", g_host_test_failures), \
+        g_host_test_failures ? 1 : 0)
+
+/**
+ * @brief 单调时钟 (纳秒)，用于基准测试
+ */
+static inline int64_t host_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+#endif // HOST_TEST_H
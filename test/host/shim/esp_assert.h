@@ -0,0 +1,8 @@
+/**
+ * @file esp_assert.h
+ * @brief 主机测试垫片
+ */
+
+#pragma once
+
+#include <assert.h>
@@ -0,0 +1,18 @@
+/**
+ * @file esp_timer.h
+ * @brief 主机测试垫片：单调时钟 (微秒，自进程启动起)
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int64_t esp_timer_get_time(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,455 @@
+/**
+ * @file host_shim.c
+ * @brief 主机测试垫片实现：FreeRTOS/ESP-IDF 基础接口映射到 pthread 与 CLOCK_MONOTONIC
+ *
+ * 只覆盖被测组件用到的接口，语义以 FreeRTOS 文档为准：
+ * 超时单位为节拍，portMAX_DELAY 永久等待，0 立即返回。
+ */
+
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "nvs.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// ==================== 时钟 ====================
+
+static int64_t monotonic_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static int64_t s_boot_us = 0;
+
+__attribute__((constructor))
+static void shim_boot(void)
+{
+    s_boot_us = monotonic_us();
+}
+
+int64_t esp_timer_get_time(void)
+{
+    return monotonic_us() - s_boot_us;
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return (TickType_t)(esp_timer_get_time() / (1000000 / configTICK_RATE_HZ));
+}
+
+// 计算绝对超时时刻 (CLOCK_MONOTONIC)
+static struct timespec deadline_after(TickType_t ticks)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    int64_t ns = (int64_t)ticks * (1000000000LL / configTICK_RATE_HZ);
+    ts.tv_sec += ns / 1000000000LL;
+    ts.tv_nsec += ns % 1000000000LL;
+    if (ts.tv_nsec >= 1000000000L) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+    return ts;
+}
+
+static void cond_init_monotonic(pthread_cond_t *cond)
+{
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+// 在 mutex 已持有时等待 cond，直到 ready() 为真或超时
+#define WAIT_UNTIL(mutex, cond, ticks, ready_expr)                          \
+    ({                                                                      \
+        bool ok_ = true;                                                    \
+        if (!(ready_expr)) {                                                \
+            if ((ticks) == 0) {                                             \
+                ok_ = false;                                                \
+            } else if ((ticks) == portMAX_DELAY) {                          \
+                while (!(ready_expr)) {                                     \
+                    pthread_cond_wait(cond, mutex);                         \
+                }                                                           \
+            } else {                                                        \
+                struct timespec dl_ = deadline_after(ticks);                \
+                while (!(ready_expr)) {                                     \
+                    if (pthread_cond_timedwait(cond, mutex, &dl_) == ETIMEDOUT) { \
+                        ok_ = (ready_expr);                                 \
+                        break;                                              \
+                    }                                                       \
+                }                                                           \
+            }                                                               \
+        }                                                                   \
+        ok_;                                                                \
+    })
+
+// ==================== 信号量 ====================
+
+struct host_sem {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    unsigned count;
+};
+
+static SemaphoreHandle_t sem_create(unsigned initial)
+{
+    SemaphoreHandle_t sem = calloc(1, sizeof(*sem));
+    if (sem == NULL) {
+        return NULL;
+    }
+    pthread_mutex_init(&sem->mutex, NULL);
+    cond_init_monotonic(&sem->cond);
+    sem->count = initial;
+    return sem;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    return sem_create(1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    return sem_create(0);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks_to_wait)
+{
+    pthread_mutex_lock(&sem->mutex);
+    bool ok = WAIT_UNTIL(&sem->mutex, &sem->cond, ticks_to_wait, sem->count > 0);
+    if (ok) {
+        sem->count--;
+    }
+    pthread_mutex_unlock(&sem->mutex);
+    return ok ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+    pthread_mutex_lock(&sem->mutex);
+    bool ok = (sem->count == 0);
+    if (ok) {
+        sem->count = 1;
+        pthread_cond_signal(&sem->cond);
+    }
+    pthread_mutex_unlock(&sem->mutex);
+    return ok ? pdTRUE : pdFALSE;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem)
+{
+    if (sem == NULL) {
+        return;
+    }
+    pthread_cond_destroy(&sem->cond);
+    pthread_mutex_destroy(&sem->mutex);
+    free(sem);
+}
+
+// ==================== 队列 ====================
+
+struct host_queue {
+    pthread_mutex_t mutex;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    size_t item_size;
+    size_t length;
+    size_t head;
+    size_t count;
+    uint8_t *items;
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+    QueueHandle_t q = calloc(1, sizeof(*q));
+    if (q == NULL) {
+        return NULL;
+    }
+    q->items = calloc(length, item_size);
+    if (q->items == NULL) {
+        free(q);
+        return NULL;
+    }
+    pthread_mutex_init(&q->mutex, NULL);
+    cond_init_monotonic(&q->not_empty);
+    cond_init_monotonic(&q->not_full);
+    q->item_size = item_size;
+    q->length = length;
+    return q;
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void *item, TickType_t ticks_to_wait)
+{
+    pthread_mutex_lock(&q->mutex);
+    bool ok = WAIT_UNTIL(&q->mutex, &q->not_full, ticks_to_wait, q->count < q->length);
+    if (ok) {
+        size_t tail = (q->head + q->count) % q->length;
+        memcpy(q->items + tail * q->item_size, item, q->item_size);
+        q->count++;
+        pthread_cond_signal(&q->not_empty);
+    }
+    pthread_mutex_unlock(&q->mutex);
+    return ok ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void *item, TickType_t ticks_to_wait)
+{
+    pthread_mutex_lock(&q->mutex);
+    bool ok = WAIT_UNTIL(&q->mutex, &q->not_empty, ticks_to_wait, q->count > 0);
+    if (ok) {
+        memcpy(item, q->items + q->head * q->item_size, q->item_size);
+        q->head = (q->head + 1) % q->length;
+        q->count--;
+        pthread_cond_signal(&q->not_full);
+    }
+    pthread_mutex_unlock(&q->mutex);
+    return ok ? pdTRUE : pdFALSE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q)
+{
+    pthread_mutex_lock(&q->mutex);
+    size_t count = q->count;
+    pthread_mutex_unlock(&q->mutex);
+    return (UBaseType_t)count;
+}
+
+void vQueueDelete(QueueHandle_t q)
+{
+    if (q == NULL) {
+        return;
+    }
+    pthread_cond_destroy(&q->not_empty);
+    pthread_cond_destroy(&q->not_full);
+    pthread_mutex_destroy(&q->mutex);
+    free(q->items);
+    free(q);
+}
+
+// ==================== 任务 ====================
+
+struct host_task {
+    pthread_t thread;
+    TaskFunction_t fn;
+    void *arg;
+};
+
+static void *task_entry(void *p)
+{
+    struct host_task *task = p;
+    task->fn(task->arg);
+    return NULL;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack_depth,
+                       void *arg, UBaseType_t priority, TaskHandle_t *out_handle)
+{
+    (void)name;
+    (void)stack_depth;
+    (void)priority;
+
+    struct host_task *task = calloc(1, sizeof(*task));
+    if (task == NULL) {
+        return pdFAIL;
+    }
+    task->fn = fn;
+    task->arg = arg;
+    if (pthread_create(&task->thread, NULL, task_entry, task) != 0) {
+        free(task);
+        return pdFAIL;
+    }
+    pthread_detach(task->thread);
+    if (out_handle != NULL) {
+        *out_handle = task;
+    }
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    // 仅支持任务自删除 (NULL)：线程退出，句柄随进程释放
+    if (task == NULL) {
+        pthread_exit(NULL);
+    }
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    struct timespec dl = deadline_after(ticks);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &dl, NULL) == EINTR) {
+    }
+}
+
+// ==================== 日志 ====================
+
+static esp_log_level_t s_log_level = ESP_LOG_WARN;
+
+void esp_log_level_set(const char *tag, esp_log_level_t level)
+{
+    (void)tag;
+    s_log_level = level;
+}
+
+void esp_log_write(esp_log_level_t level, const char *tag, const char *format, ...)
+{
+    static const char letters[] = "NEWIDV";
+    if (level > s_log_level) {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    fprintf(stderr, "%c (%lld) %s: ", letters[level],
+            (long long)(esp_timer_get_time() / 1000), tag);
+    vfprintf(stderr, format, args);
+    fputc('\n', stderr);
+    va_end(args);
+}
+
+const char *esp_err_to_name(esp_err_t code)
+{
+    switch (code) {
+        case ESP_OK:                    return "ESP_OK";
+        case ESP_FAIL:                  return "ESP_FAIL";
+        case ESP_ERR_NO_MEM:            return "ESP_ERR_NO_MEM";
+        case ESP_ERR_INVALID_ARG:       return "ESP_ERR_INVALID_ARG";
+        case ESP_ERR_INVALID_STATE:     return "ESP_ERR_INVALID_STATE";
+        case ESP_ERR_INVALID_SIZE:      return "ESP_ERR_INVALID_SIZE";
+        case ESP_ERR_NOT_FOUND:         return "ESP_ERR_NOT_FOUND";
+        case ESP_ERR_NOT_SUPPORTED:     return "ESP_ERR_NOT_SUPPORTED";
+        case ESP_ERR_TIMEOUT:           return "ESP_ERR_TIMEOUT";
+        case ESP_ERR_INVALID_RESPONSE:  return "ESP_ERR_INVALID_RESPONSE";
+        case ESP_ERR_INVALID_CRC:       return "ESP_ERR_INVALID_CRC";
+        case ESP_ERR_NOT_FINISHED:      return "ESP_ERR_NOT_FINISHED";
+        case ESP_ERR_NVS_NOT_FOUND:     return "ESP_ERR_NVS_NOT_FOUND";
+        default:                        return "UNKNOWN ERROR";
+    }
+}
+
+// ==================== NVS (内存) ====================
+
+#define NVS_SHIM_MAX_ENTRIES 16
+
+typedef struct {
+    char ns[16];
+    char key[16];
+    char *value;
+} nvs_entry_t;
+
+static nvs_entry_t s_nvs[NVS_SHIM_MAX_ENTRIES];
+static char s_nvs_handles[NVS_SHIM_MAX_ENTRIES + 1][16];
+static pthread_mutex_t s_nvs_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static nvs_entry_t *nvs_find(nvs_handle_t handle, const char *key, bool create)
+{
+    const char *ns = s_nvs_handles[handle];
+    nvs_entry_t *free_slot = NULL;
+    for (int i = 0; i < NVS_SHIM_MAX_ENTRIES; i++) {
+        if (s_nvs[i].value == NULL) {
+            if (free_slot == NULL) {
+                free_slot = &s_nvs[i];
+            }
+        } else if (strcmp(s_nvs[i].ns, ns) == 0 && strcmp(s_nvs[i].key, key) == 0) {
+            return &s_nvs[i];
+        }
+    }
+    if (create && free_slot != NULL) {
+        snprintf(free_slot->ns, sizeof(free_slot->ns), "%s", ns);
+        snprintf(free_slot->key, sizeof(free_slot->key), "%s", key);
+        return free_slot;
+    }
+    return NULL;
+}
+
+esp_err_t nvs_open(const char *namespace_name, nvs_open_mode_t open_mode, nvs_handle_t *out_handle)
+{
+    (void)open_mode;
+    pthread_mutex_lock(&s_nvs_lock);
+    for (nvs_handle_t h = 1; h <= NVS_SHIM_MAX_ENTRIES; h++) {
+        if (s_nvs_handles[h][0] == '\0' || strcmp(s_nvs_handles[h], namespace_name) == 0) {
+            snprintf(s_nvs_handles[h], sizeof(s_nvs_handles[h]), "%s", namespace_name);
+            pthread_mutex_unlock(&s_nvs_lock);
+            *out_handle = h;
+            return ESP_OK;
+        }
+    }
+    pthread_mutex_unlock(&s_nvs_lock);
+    return ESP_ERR_NO_MEM;
+}
+
+void nvs_close(nvs_handle_t handle)
+{
+    (void)handle;
+}
+
+esp_err_t nvs_get_str(nvs_handle_t handle, const char *key, char *out_value, size_t *length)
+{
+    pthread_mutex_lock(&s_nvs_lock);
+    nvs_entry_t *e = nvs_find(handle, key, false);
+    if (e == NULL) {
+        pthread_mutex_unlock(&s_nvs_lock);
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    size_t need = strlen(e->value) + 1;
+    esp_err_t ret = ESP_OK;
+    if (out_value == NULL) {
+        *length = need;
+    } else if (*length < need) {
+        ret = ESP_ERR_NVS_INVALID_LENGTH;
+    } else {
+        memcpy(out_value, e->value, need);
+        *length = need;
+    }
+    pthread_mutex_unlock(&s_nvs_lock);
+    return ret;
+}
+
+esp_err_t nvs_set_str(nvs_handle_t handle, const char *key, const char *value)
+{
+    char *copy = strdup(value);
+    if (copy == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    pthread_mutex_lock(&s_nvs_lock);
+    nvs_entry_t *e = nvs_find(handle, key, true);
+    if (e == NULL) {
+        pthread_mutex_unlock(&s_nvs_lock);
+        free(copy);
+        return ESP_ERR_NO_MEM;
+    }
+    free(e->value);
+    e->value = copy;
+    pthread_mutex_unlock(&s_nvs_lock);
+    return ESP_OK;
+}
+
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char *key)
+{
+    pthread_mutex_lock(&s_nvs_lock);
+    nvs_entry_t *e = nvs_find(handle, key, false);
+    if (e != NULL) {
+        free(e->value);
+        memset(e, 0, sizeof(*e));
+    }
+    pthread_mutex_unlock(&s_nvs_lock);
+    return (e != NULL) ? ESP_OK : ESP_ERR_NVS_NOT_FOUND;
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle)
+{
+    (void)handle;
+    return ESP_OK;
+}
@@ -0,0 +1,9 @@
+/**
+ * @file sdkconfig.h
+ * @brief 主机测试配置：按 ESP-IDF linux 目标编译
+ */
+
+#pragma once
+
+#define CONFIG_IDF_TARGET_LINUX 1
+#define CONFIG_IDF_TARGET "linux"
@@ -0,0 +1,214 @@
+/**
+ * @file test_app_state_stress.c
+ * @brief app_state 多读者并发压力测试
+ *
+ * 用法: test_app_state_stress [读者线程数] [每轮毫秒数]
+ * 两个写者线程不停加锁改写全部字段 (均由同一计数值 k 推出) 后解锁发布，
+ * 读者线程同时读取：
+ *   - 快照轮：app_state_read_snapshot() 无锁读取
+ *   - 加锁轮：app_state_lock() + 复制 + app_state_unlock() (改为双缓冲之前的读法)
+ * 校验每份读到的数据各字段属于同一个 k (没有撕裂)，版本号与 k 对应且每个读者单调不减。
+ * 打印两轮的读取吞吐、快照重试率与加锁竞争 (lock_contended / lock_timeouts / lock_wait_max_us)；
+ * 加锁轮的超时是要展示的竞争本身，只在快照轮断言无超时。
+ */
+
+#include "host_test.h"
+#include "app_state.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+HOST_TEST_DEFINE_GLOBALS();
+
+#define DEFAULT_READERS   8
+#define DEFAULT_PHASE_MS  300
+#define MAX_READERS       64
+#define WRITERS           2
+
+typedef struct {
+    bool use_lock;
+    uint64_t reads;
+    uint64_t torn;
+    uint64_t backwards;
+} reader_ctx_t;
+
+static bool s_stop;
+static uint32_t s_counter;          // 写者在锁内递增
+static uint32_t s_version_base;     // 版本号 = s_version_base + k
+static uint64_t s_writes[WRITERS];
+
+static void fill(sensor_data_t *d, uint32_t k)
+{
+    d->temperature = (float)(k & 0xFFFF);
+    d->humidity = (float)(k % 1000);
+    d->light = (float)(k & 0xFFFFF) * 0.5f;
+    d->smoke = k;
+    d->smoke_threshold = ~k;
+    d->led_state = (uint8_t)(k & 1);
+    d->led_brightness = (uint8_t)k;
+    d->fan_state = (uint8_t)((k >> 1) & 1);
+    d->fan_speed = (uint8_t)(k >> 8);
+    d->curtain_state = (uint8_t)(k % 101);
+    d->curtain_position = (uint8_t)((k / 7) % 101);
+    d->control_mode = (control_mode_t)((k >> 2) & 1);
+}
+
+static bool consistent(const sensor_data_t *d, uint32_t version)
+{
+    sensor_data_t expect;
+    memset(&expect, 0, sizeof(expect));
+    fill(&expect, d->smoke);
+#define SAME_FIELD(name, fmt, bit) \
+    if (d->name != expect.name) return false;
+    SENSOR_DATA_FIELDS(SAME_FIELD)
+#undef SAME_FIELD
+    return version == s_version_base + d->smoke;
+}
+
+static void *writer_main(void *arg)
+{
+    uint64_t *writes = arg;
+    while (!__atomic_load_n(&s_stop, __ATOMIC_RELAXED)) {
+        if (app_state_lock() != ESP_OK) {
+            continue;
+        }
+        fill(app_state_get(), ++s_counter);
+        app_state_unlock();
+        (*writes)++;
+        // 真实写者每次更新后都会阻塞；shim 的信号量不保证公平，紧循环会饿死等待者
+        sched_yield();
+    }
+    return NULL;
+}
+
+static void *reader_main(void *arg)
+{
+    reader_ctx_t *ctx = arg;
+    uint32_t last = 0;
+    while (!__atomic_load_n(&s_stop, __ATOMIC_RELAXED)) {
+        sensor_data_t d;
+        uint32_t version;
+        if (ctx->use_lock) {
+            if (app_state_lock() != ESP_OK) {
+                continue;
+            }
+            d = *app_state_get();
+            version = app_state_version();
+            app_state_unlock();
+        } else {
+            version = app_state_read_snapshot(&d);
+        }
+        if (!consistent(&d, version)) {
+            ctx->torn++;
+        }
+        if (version < last) {
+            ctx->backwards++;
+        }
+        last = version;
+        ctx->reads++;
+    }
+    return NULL;
+}
+
+static void run_phase(bool use_lock, int readers, int phase_ms)
+{
+    // 每轮重新初始化，统计从零开始
+    app_state_deinit();
+    app_state_init();
+    s_counter = 0;
+    if (app_state_lock() == ESP_OK) {
+        fill(app_state_get(), 0);
+        app_state_unlock();
+    }
+    s_version_base = app_state_version();
+    __atomic_store_n(&s_stop, false, __ATOMIC_RELAXED);
+
+    static reader_ctx_t ctx[MAX_READERS];
+    pthread_t reader_threads[MAX_READERS];
+    pthread_t writer_threads[WRITERS];
+    memset(ctx, 0, sizeof(ctx));
+    memset(s_writes, 0, sizeof(s_writes));
+
+    int64_t start = host_now_ns();
+    for (int i = 0; i < readers; i++) {
+        ctx[i].use_lock = use_lock;
+        CHECK_EQ(pthread_create(&reader_threads[i], NULL, reader_main, &ctx[i]), 0);
+    }
+    for (int i = 0; i < WRITERS; i++) {
+        CHECK_EQ(pthread_create(&writer_threads[i], NULL, writer_main, &s_writes[i]), 0);
+    }
+
+    struct timespec ts = {.tv_sec = phase_ms / 1000, .tv_nsec = (phase_ms % 1000) * 1000000L};
+    nanosleep(&ts, NULL);
+    __atomic_store_n(&s_stop, true, __ATOMIC_RELAXED);
+
+    for (int i = 0; i < WRITERS; i++) {
+        pthread_join(writer_threads[i], NULL);
+    }
+    for (int i = 0; i < readers; i++) {
+        pthread_join(reader_threads[i], NULL);
+    }
+    double seconds = (double)(host_now_ns() - start) / 1e9;
+
+    uint64_t reads = 0;
+    uint64_t torn = 0;
+    uint64_t backwards = 0;
+    for (int i = 0; i < readers; i++) {
+        reads += ctx[i].reads;
+        torn += ctx[i].torn;
+        backwards += ctx[i].backwards;
+    }
+    uint64_t writes = 0;
+    for (int i = 0; i < WRITERS; i++) {
+        writes += s_writes[i];
+    }
+
+    app_state_stats_t stats;
+    app_state_get_stats(&stats);
+
+    CHECK(reads > 0);
+    CHECK(writes > 0);
+    CHECK_EQ(torn, 0);
+    CHECK_EQ(backwards, 0);
+    // 每次写入都改变 smoke，必然发布 (另有 init 与基准写入各一次)
+    CHECK_EQ(stats.publishes, writes + 2);
+    CHECK_EQ(app_state_version(), s_version_base + s_counter);
+    if (!use_lock) {
+        // 读者不加锁，写者之间的竞争不应超时
+        CHECK_EQ(stats.snapshot_reads, reads);
+        CHECK_EQ(stats.lock_timeouts, 0);
+    }
+
+    printf("%s: %d readers + %d writers, %.2f s\n",
+           use_lock ? "locked reads" : "snapshot reads", readers, WRITERS, seconds);
+    printf("  reads %llu (%.0f/s), writes %llu (%.0f/s), torn %llu\n",
+           (unsigned long long)reads, reads / seconds,
+           (unsigned long long)writes, writes / seconds, (unsigned long long)torn);
+    printf("  snapshot_reads %lu, snapshot_retries %lu (%.4f%%)\n",
+           (unsigned long)stats.snapshot_reads, (unsigned long)stats.snapshot_retries,
+           stats.snapshot_reads ? 100.0 * stats.snapshot_retries / stats.snapshot_reads : 0.0);
+    printf("  lock_acquired %lu, lock_contended %lu (%.1f%%), lock_timeouts %lu, lock_wait_max_us %lu\n",
+           (unsigned long)stats.lock_acquired, (unsigned long)stats.lock_contended,
+           stats.lock_acquired ? 100.0 * stats.lock_contended / stats.lock_acquired : 0.0,
+           (unsigned long)stats.lock_timeouts, (unsigned long)stats.lock_wait_max_us);
+}
+
+int main(int argc, char **argv)
+{
+    int readers = (argc > 1) ? atoi(argv[1]) : DEFAULT_READERS;
+    int phase_ms = (argc > 2) ? atoi(argv[2]) : DEFAULT_PHASE_MS;
+    if (readers <= 0 || readers > MAX_READERS) {
+        readers = DEFAULT_READERS;
+    }
+    if (phase_ms <= 0) {
+        phase_ms = DEFAULT_PHASE_MS;
+    }
+
+    app_state_init();
+    run_phase(false, readers, phase_ms);
+    run_phase(true, readers, phase_ms);
+    app_state_deinit();
+    return HOST_TEST_RESULT("app_state_stress");
+}
@@ -0,0 +1,262 @@
+/**
+ * @file test_control_loop.c
+ * @brief 控制回路主机测试：hal_sim 输入 → app_state → app_control → hal_sim 输出
+ *
+ * 与 application.c 的 sensor_task / control_task / smoke_alarm_task 相同的调用顺序，
+ * 执行器服务未启动，命令在调用方上下文同步执行。
+ */
+
+#include "host_test.h"
+#include "app_state.h"
+#include "app_control.h"
+#include "config.h"
+#include "hal.h"
+#include "hal_sim.h"
+#include <string.h>
+
+HOST_TEST_DEFINE_GLOBALS();
+
+// 比较器越限回调：设备上经报警任务转发，这里直接进入报警快速通路
+static bool on_smoke_threshold(uint32_t value, int64_t detect_us, void *ctx)
+{
+    app_control_smoke_alarm(value, detect_us);
+    return false;
+}
+
+// sensor_task：读取 HAL 写入共享状态
+static void sample_all(void)
+{
+    float temperature = 0;
+    float humidity = 0;
+    float lux = 0;
+    uint32_t smoke = 0;
+
+    CHECK_EQ(hal_climate_read(&temperature, &humidity), ESP_OK);
+    CHECK_EQ(hal_light_read(&lux, NULL), ESP_OK);
+    CHECK_EQ(hal_smoke_read(&smoke), ESP_OK);
+
+    sensor_data_t *data = app_state_get();
+    if (app_state_lock() == ESP_OK) {
+        data->temperature = temperature;
+        data->humidity = humidity;
+        data->light = lux;
+        data->smoke = smoke;
+        app_state_unlock();
+    }
+}
+
+// control_task：持锁执行一次控制逻辑
+static void control_once(void)
+{
+    if (app_state_lock() == ESP_OK) {
+        app_control_process(app_state_get());
+        app_state_unlock();
+    }
+}
+
+static void step(float temperature, float light, uint32_t smoke)
+{
+    hal_sim_sample_t in = {
+        .temperature = temperature,
+        .humidity = 50.0f,
+        .light = light,
+        .smoke = smoke,
+    };
+    hal_sim_set_inputs(&in);
+    sample_all();
+    control_once();
+}
+
+static void outputs(hal_sim_outputs_t *out)
+{
+    hal_sim_get_outputs(out);
+}
+
+// MQ2 回退到单次采样 (无比较器)：周期通路是唯一的报警通路，报警时风扇须立即全速
+static void test_periodic_alarm(void)
+{
+    hal_sim_outputs_t out;
+    app_alarm_stats_t alarm;
+    app_control_get_alarm_stats(&alarm);
+    uint32_t triggers_before = alarm.triggers;
+
+    hal_sim_set_comparator(false);
+    CHECK(!hal_smoke_alarm_available());
+    if (app_state_lock() == ESP_OK) {
+        app_control_set_mode(app_state_get(), CONTROL_MODE_AUTO);
+        app_state_unlock();
+    }
+
+    // 正常自动控制保留默认渐变；升到全速档时渐变仍在进行 (影子值已是全速)
+    step(31.0f, 130.0f, 800);
+    outputs(&out);
+    CHECK_EQ(out.fan_speed, FAN_SPEED_LOW);
+    CHECK_EQ(out.fan_fade_ms, FAN_FADE_MS);
+    step(36.0f, 130.0f, 800);
+    outputs(&out);
+    CHECK_EQ(out.fan_speed, FAN_SPEED_HIGH);
+    CHECK_EQ(out.fan_fade_ms, FAN_FADE_MS);
+
+    // 烟雾越限：周期通路强制全速写入，不按影子值跳过，也不渐变
+    uint32_t events_before = out.events_total;
+    uint32_t beeps_before = out.buzzer_beeps;
+    step(36.0f, 130.0f, SMOKE_THRESHOLD + 200);
+    outputs(&out);
+    CHECK_EQ(out.fan_speed, FAN_SPEED_HIGH);
+    CHECK_EQ(out.fan_fade_ms, 0);
+    CHECK(out.events_total > events_before);
+    CHECK(out.buzzer_beeps > beeps_before);
+    CHECK(!hal_smoke_alarm_active());
+
+    // 从低速档进入报警同样立即全速
+    step(25.0f, 130.0f, 800);
+    step(31.0f, 130.0f, 800);
+    outputs(&out);
+    CHECK_EQ(out.fan_speed, FAN_SPEED_LOW);
+    step(31.0f, 130.0f, SMOKE_THRESHOLD + 200);
+    outputs(&out);
+    CHECK_EQ(out.fan_speed, FAN_SPEED_HIGH);
+    CHECK_EQ(out.fan_fade_ms, 0);
+
+    // 报警保持期间仍无渐变
+    step(31.0f, 130.0f, SMOKE_THRESHOLD + 100);
+    outputs(&out);
+    CHECK_EQ(out.fan_speed, FAN_SPEED_HIGH);
+    CHECK_EQ(out.fan_fade_ms, 0);
+
+    // 快速通路未参与
+    app_control_get_alarm_stats(&alarm);
+    CHECK_EQ(alarm.triggers, triggers_before);
+
+    // 解除后恢复默认渐变
+    step(31.0f, 130.0f, 800);
+    outputs(&out);
+    CHECK_EQ(out.fan_speed, FAN_SPEED_LOW);
+    CHECK_EQ(out.fan_fade_ms, FAN_FADE_MS);
+}
+
+int main(void)
+{
+    hal_status_t status = {0};
+    CHECK_EQ(hal_register(hal_sim_ops()), ESP_OK);
+    CHECK_EQ(hal_init(&status), ESP_OK);
+    CHECK(status.smoke_comparator);
+
+    app_state_init();
+    CHECK_EQ(hal_smoke_alarm_enable(app_state_get()->smoke_threshold, SMOKE_ALARM_HYSTERESIS,
+                                    on_smoke_threshold, NULL), ESP_OK);
+    CHECK_EQ(app_control_init(), ESP_OK);
+
+    hal_sim_outputs_t out;
+    outputs(&out);
+    CHECK_EQ(out.rgb_color, RGB_COLOR_GREEN);
+
+    // 烟雾窗口与比较器状态经 HAL 读取 (/api/metrics 同一路径)
+    hal_smoke_window_t window;
+    CHECK_EQ(hal_smoke_window(&window), ESP_ERR_INVALID_STATE);
+    CHECK(hal_smoke_alarm_available());
+
+    // 常温、暗光：灯亮，风扇不转
+    step(25.0f, 50.0f, 800);
+    outputs(&out);
+    CHECK_EQ(out.led_brightness, LED_BRIGHTNESS_MAX);
+    CHECK_EQ(out.fan_speed, 0);
+    CHECK_EQ(hal_smoke_window(&window), ESP_OK);
+    CHECK_EQ(window.avg_x16, 800 * 16);
+    CHECK(window.seq > 0);
+
+    // 亮光：灯在滞回带外才熄灭
+    step(25.0f, 110.0f, 800);
+    outputs(&out);
+    CHECK_EQ(out.led_brightness, LED_BRIGHTNESS_MAX);
+    step(25.0f, 130.0f, 800);
+    outputs(&out);
+    CHECK_EQ(out.led_brightness, 0);
+
+    // 升温分档
+    step(31.0f, 130.0f, 800);
+    outputs(&out);
+    CHECK_EQ(out.fan_speed, FAN_SPEED_LOW);
+    step(33.0f, 130.0f, 800);
+    outputs(&out);
+    CHECK_EQ(out.fan_speed, FAN_SPEED_MEDIUM);
+    step(36.0f, 130.0f, 800);
+    outputs(&out);
+    CHECK_EQ(out.fan_speed, FAN_SPEED_HIGH);
+    step(29.0f, 130.0f, 800);
+    outputs(&out);
+    CHECK_EQ(out.fan_speed, FAN_SPEED_LOW);
+
+    // 恰好等于阈值：快速通路与周期通路都不报警
+    uint32_t beeps_before = out.buzzer_beeps;
+    step(29.0f, 130.0f, SMOKE_THRESHOLD);
+    outputs(&out);
+    CHECK(!hal_smoke_alarm_active());
+    CHECK_EQ(out.fan_speed, FAN_SPEED_LOW);
+    CHECK_EQ(out.buzzer_beeps, beeps_before);
+
+    app_alarm_stats_t alarm;
+    app_control_get_alarm_stats(&alarm);
+    CHECK_EQ(alarm.triggers, 0);
+
+    // 超过阈值 1：两条通路同时判定越限
+    step(29.0f, 130.0f, SMOKE_THRESHOLD + 1);
+    outputs(&out);
+    CHECK(hal_smoke_alarm_active());
+    CHECK_EQ(out.fan_speed, FAN_SPEED_HIGH);
+    CHECK(out.buzzer_beeps > beeps_before);
+    app_control_get_alarm_stats(&alarm);
+    CHECK_EQ(alarm.triggers, 1);
+
+    // 回落到滞回带以下解除
+    step(29.0f, 130.0f, 800);
+    outputs(&out);
+    CHECK(!hal_smoke_alarm_active());
+    CHECK_EQ(out.fan_speed, FAN_SPEED_LOW);
+
+    // 烟雾越限：比较器回调走快速通路，风扇全速并蜂鸣
+    beeps_before = out.buzzer_beeps;
+    step(29.0f, 130.0f, SMOKE_THRESHOLD + 200);
+    outputs(&out);
+    CHECK_EQ(out.fan_speed, FAN_SPEED_HIGH);
+    CHECK(out.buzzer_beeps > beeps_before);
+    CHECK(hal_smoke_alarm_active());
+
+    app_control_get_alarm_stats(&alarm);
+    CHECK_EQ(alarm.triggers, 2);
+
+    sensor_data_t snap;
+    app_state_read_snapshot(&snap);
+    CHECK_EQ(snap.fan_speed, FAN_SPEED_HIGH);
+    CHECK_EQ(snap.fan_state, 1);
+
+    // 报警保持期间的周期控制不降速
+    step(29.0f, 130.0f, SMOKE_THRESHOLD + 150);
+    outputs(&out);
+    CHECK_EQ(out.fan_speed, FAN_SPEED_HIGH);
+
+    // 烟雾回落到滞回带以下：报警解除，风扇交还规则
+    step(29.0f, 130.0f, 800);
+    outputs(&out);
+    CHECK(!hal_smoke_alarm_active());
+    CHECK_EQ(out.fan_speed, FAN_SPEED_LOW);
+
+    // 手动模式：自动规则不再改变灯
+    if (app_state_lock() == ESP_OK) {
+        app_control_set_mode(app_state_get(), CONTROL_MODE_MANUAL);
+        app_state_unlock();
+    }
+    step(29.0f, 20.0f, 800);
+    outputs(&out);
+    CHECK_EQ(out.led_brightness, 0);
+
+    // 语音命令经 app_control 同步下发
+    app_control_handle_voice_command(VR_CMD_WAKE_UP);
+    app_control_handle_voice_command(VR_CMD_LIGHT_ON);
+    control_once();
+    outputs(&out);
+    CHECK(out.led_brightness > 0);
+
+    test_periodic_alarm();
+    return HOST_TEST_RESULT("control_loop");
+}
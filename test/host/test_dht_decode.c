@@ -0,0 +1,229 @@
+/**
+ * @file test_dht_decode.c
+ * @brief DHT11 波形解码主机测试
+ *
+ * 用法: test_dht_decode <dht11_captures.txt>
+ * 逐个读取 RMT 接收波形，按 dht_driver.c 的 rmt_collect() 相同方式转换为脉冲序列后解码，
+ * 与期望的返回值和温湿度比对；另对截断的波形和整体时间缩放做鲁棒性检查，
+ * 打印解码器能接受的时基偏差范围。
+ */
+
+#include "host_test.h"
+#include "dht_decode.h"
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+HOST_TEST_DEFINE_GLOBALS();
+
+#define MAX_SYMBOLS 64      // 与 DHT_RMT_MEM_SYMBOLS 相同
+
+typedef struct {
+    uint8_t level0;
+    uint16_t duration0;
+    uint8_t level1;
+    uint16_t duration1;
+} symbol_t;
+
+typedef struct {
+    char name[32];
+    char expect[32];
+    float humidity;
+    float temperature;
+    symbol_t symbols[MAX_SYMBOLS];
+    size_t count;
+} capture_t;
+
+// 同 rmt_collect()：时长为 0 的一半是结束标记，不计入脉冲
+static size_t to_pulses(const symbol_t *symbols, size_t count, dht_pulse_t *pulses)
+{
+    size_t n = 0;
+    for (size_t i = 0; i < count && i < MAX_SYMBOLS; i++) {
+        if (symbols[i].duration0 > 0) {
+            pulses[n++] = (dht_pulse_t){ .level = symbols[i].level0,
+                                         .duration_us = symbols[i].duration0 };
+        }
+        if (symbols[i].duration1 > 0) {
+            pulses[n++] = (dht_pulse_t){ .level = symbols[i].level1,
+                                         .duration_us = symbols[i].duration1 };
+        }
+    }
+    return n;
+}
+
+static esp_err_t decode(const capture_t *c, uint8_t frame[DHT_FRAME_BYTES])
+{
+    dht_pulse_t pulses[MAX_SYMBOLS * 2];
+    size_t n = to_pulses(c->symbols, c->count, pulses);
+    return dht_decode_pulses(pulses, n, frame);
+}
+
+static void check_capture(const capture_t *c)
+{
+    uint8_t frame[DHT_FRAME_BYTES];
+    esp_err_t ret = decode(c, frame);
+    const char *got = esp_err_to_name(ret);
+    if (strcmp(got, c->expect) != 0) {
+        fprintf(stderr, "%s: expected %s, got %s\n", c->name, c->expect, got);
+        g_host_test_failures++;
+        return;
+    }
+    if (ret == ESP_OK) {
+        float t = 0;
+        float h = 0;
+        dht11_frame_to_values(frame, &t, &h);
+        if (fabsf(t - c->temperature) > 0.01f || fabsf(h - c->humidity) > 0.01f) {
+            fprintf(stderr, "%s: expected %.1f%% %.1fC, got %.1f%% %.1fC\n",
+                    c->name, c->humidity, c->temperature, h, t);
+            g_host_test_failures++;
+        }
+    }
+    printf("  %-14s %2zu symbols  %s\n", c->name, c->count, got);
+}
+
+// 有效波形的任意前缀都不能解码成功，也不能越界读取
+static void check_truncation(const capture_t *c)
+{
+    dht_pulse_t pulses[MAX_SYMBOLS * 2];
+    size_t n = to_pulses(c->symbols, c->count, pulses);
+    uint8_t frame[DHT_FRAME_BYTES];
+    for (size_t len = 0; len + 1 < n; len++) {
+        dht_pulse_t *copy = malloc((len ? len : 1) * sizeof(dht_pulse_t));
+        CHECK(copy != NULL);
+        if (copy == NULL) {
+            return;
+        }
+        memcpy(copy, pulses, len * sizeof(dht_pulse_t));
+        CHECK(dht_decode_pulses(copy, len, frame) != ESP_OK);
+        free(copy);
+    }
+}
+
+// 全部时长按 percent% 缩放 (时基偏差)，返回是否仍解码出同样的数据
+static bool decodes_scaled(const capture_t *c, int percent, const uint8_t expect[DHT_FRAME_BYTES])
+{
+    capture_t scaled = *c;
+    for (size_t i = 0; i < scaled.count; i++) {
+        scaled.symbols[i].duration0 = (uint16_t)((c->symbols[i].duration0 * percent + 50) / 100);
+        scaled.symbols[i].duration1 = (uint16_t)((c->symbols[i].duration1 * percent + 50) / 100);
+    }
+    uint8_t frame[DHT_FRAME_BYTES];
+    return decode(&scaled, frame) == ESP_OK && memcmp(frame, expect, DHT_FRAME_BYTES) == 0;
+}
+
+static void check_tolerance(const capture_t *c)
+{
+    uint8_t expect[DHT_FRAME_BYTES];
+    if (decode(c, expect) != ESP_OK) {
+        return;
+    }
+    int lo = 100;
+    int hi = 100;
+    while (lo > 50 && decodes_scaled(c, lo - 1, expect)) {
+        lo--;
+    }
+    while (hi < 200 && decodes_scaled(c, hi + 1, expect)) {
+        hi++;
+    }
+    // 至少容忍 ±10% 的整体时序偏差 (传感器个体差异 + 温漂)
+    CHECK(lo <= 90);
+    CHECK(hi >= 110);
+    printf("  %-14s timing scale accepted: %d%% .. %d%%\n", c->name, lo, hi);
+}
+
+static void test_values(void)
+{
+    uint8_t frame[DHT_FRAME_BYTES] = {0};
+    CHECK_EQ(dht_decode_pulses(NULL, 0, frame), ESP_ERR_INVALID_ARG);
+
+    const uint8_t f1[DHT_FRAME_BYTES] = {90, 5, 50, 9, 154};
+    float t = 0;
+    float h = 0;
+    dht11_frame_to_values(f1, &t, &h);
+    CHECK(fabsf(h - 90.5f) < 0.01f);
+    CHECK(fabsf(t - 50.9f) < 0.01f);
+
+    const uint8_t f2[DHT_FRAME_BYTES] = {20, 0, 0, 0x81, 0xA1};
+    dht11_frame_to_values(f2, &t, NULL);
+    CHECK(fabsf(t + 0.1f) < 0.01f);
+}
+
+static int load_captures(const char *path, capture_t **out)
+{
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        perror(path);
+        return -1;
+    }
+
+    capture_t *caps = NULL;
+    int count = 0;
+    capture_t *cur = NULL;
+    char line[256];
+    int lineno = 0;
+    while (fgets(line, sizeof(line), f) != NULL) {
+        lineno++;
+        if (line[0] == '#' || line[0] == '\n') {
+            continue;
+        }
+        if (strncmp(line, "capture ", 8) == 0) {
+            capture_t *grown = realloc(caps, (size_t)(count + 1) * sizeof(capture_t));
+            if (grown == NULL) {
+                break;
+            }
+            caps = grown;
+            cur = &caps[count++];
+            memset(cur, 0, sizeof(*cur));
+            sscanf(line + 8, "%31s %31s %f %f", cur->name, cur->expect,
+                   &cur->humidity, &cur->temperature);
+            continue;
+        }
+        if (strncmp(line, "end", 3) == 0) {
+            cur = NULL;
+            continue;
+        }
+
+        unsigned l0, d0, l1, d1;
+        if (cur == NULL || sscanf(line, "%u %u %u %u", &l0, &d0, &l1, &d1) != 4 ||
+            cur->count >= MAX_SYMBOLS) {
+            fprintf(stderr, "%s:%d: malformed line\n", path, lineno);
+            fclose(f);
+            free(caps);
+            return -1;
+        }
+        cur->symbols[cur->count++] = (symbol_t){
+            .level0 = (uint8_t)l0, .duration0 = (uint16_t)d0,
+            .level1 = (uint8_t)l1, .duration1 = (uint16_t)d1,
+        };
+    }
+    fclose(f);
+    *out = caps;
+    return count;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s <dht11_captures.txt>\n", argv[0]);
+        return 2;
+    }
+
+    capture_t *caps = NULL;
+    int count = load_captures(argv[1], &caps);
+    CHECK(count > 0);
+
+    test_values();
+    printf("captures: %d\n", count);
+    for (int i = 0; i < count; i++) {
+        check_capture(&caps[i]);
+    }
+    for (int i = 0; i < count; i++) {
+        if (strcmp(caps[i].expect, "ESP_OK") == 0) {
+            check_truncation(&caps[i]);
+            check_tolerance(&caps[i]);
+        }
+    }
+    free(caps);
+    return HOST_TEST_RESULT("dht_decode");
+}
@@ -0,0 +1,309 @@
+/**
+ * @file test_fan_pi.c
+ * @brief 风扇 PI 控制器主机测试与房间热模型仿真
+ *
+ * 单元测试：比例/积分方向、抗积分饱和、起转门限回差、无扰切换、时间步截断、参数更新。
+ * 仿真：dT/dt = (T_load - T - cooling × duty / 255) / tau，按 1 秒步长积分；
+ * 控制器按 DHT11 采样周期读取量化到 0.1℃ 的温度，输出保持到下一次采样。
+ * 以 config.h 默认参数对比 PI 与三档滞回控制 (默认风扇规则)，打印两者的结果。
+ */
+
+#include "host_test.h"
+#include "fan_pi.h"
+#include "config.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+HOST_TEST_DEFINE_GLOBALS();
+
+#define SIM_START_TEMP      25.0f   // 初始室温 (℃)
+#define SIM_LOAD_TEMP       38.0f   // 无风扇时的平衡温度 (℃)
+#define SIM_TAU_S           600.0f  // 房间热时间常数 (秒)
+#define SIM_FAN_COOLING     12.0f   // 风扇全速时平衡温度下降量 (℃)
+#define SIM_DURATION_S      7200    // 仿真时长 (秒)
+#define SIM_FINAL_WINDOW_S  1200    // 末段统计窗口 (秒)
+#define SIM_SETTLE_BAND     5       // 稳定判据 ±0.5℃ (0.1℃)
+#define SIM_SAMPLE_S        (DHT11_SAMPLE_PERIOD_MS / 1000)
+
+typedef enum {
+    SIM_CTRL_PI = 0,
+    SIM_CTRL_STEPPED,
+} sim_ctrl_t;
+
+/**
+ * @brief 仿真结果 (单个控制器)
+ */
+typedef struct {
+    int32_t peak;               // 最高温度 (0.1℃)
+    int32_t overshoot;          // 最高温度超出设定点的量 (0.1℃)
+    int32_t final_temp;         // 末段平均温度 (0.1℃)
+    int32_t final_error;        // 末段平均温度 - 设定点 (0.1℃)
+    uint32_t settle_s;          // 进入并保持在末段温度 ±0.5℃ 内的时刻 (秒)
+    uint32_t speed_changes;     // 输出变化次数
+    uint32_t max_step;          // 单次输出最大跳变
+    uint32_t mean_duty;         // 平均占空
+} sim_result_t;
+
+static int32_t to_fixed(float celsius)
+{
+    return (int32_t)lroundf(celsius * 10.0f);
+}
+
+static fan_pi_cfg_t default_cfg(void)
+{
+    fan_pi_cfg_t cfg = {
+        .setpoint = to_fixed(FAN_PI_SETPOINT),
+        .kp_x10 = (int32_t)lroundf(FAN_PI_KP * 10.0f),
+        .ki_x1000 = (int32_t)lroundf(FAN_PI_KI * 1000.0f),
+        .min_duty = FAN_PI_MIN_DUTY,
+        .max_duty = FAN_SPEED_HIGH,
+    };
+    return cfg;
+}
+
+// ==================== 单元测试 ====================
+
+static void test_proportional(void)
+{
+    fan_pi_cfg_t cfg = default_cfg();
+    cfg.ki_x1000 = 0;
+    fan_pi_t pi;
+    fan_pi_init(&pi, &cfg);
+    CHECK(!pi.primed);
+
+    // 低于设定点不转；首次更新自动建立初始状态
+    CHECK_EQ(fan_pi_update(&pi, cfg.setpoint - 10, 2000), 0);
+    CHECK(pi.primed);
+
+    // Kp = 80 占空/℃：+1.0℃ → 80 (恰好达到起转门限)
+    fan_pi_reset(&pi, cfg.setpoint, 0);
+    CHECK_EQ(fan_pi_update(&pi, cfg.setpoint + 10, 2000), 80);
+    CHECK(pi.running);
+    CHECK_EQ(fan_pi_update(&pi, cfg.setpoint + 15, 2000), 120);
+    CHECK_EQ(pi.error, 15);
+
+    // 饱和到 max_duty
+    CHECK_EQ(fan_pi_update(&pi, cfg.setpoint + 100, 2000), FAN_SPEED_HIGH);
+}
+
+static void test_min_duty(void)
+{
+    fan_pi_cfg_t cfg = default_cfg();
+    cfg.ki_x1000 = 0;
+    fan_pi_t pi;
+    fan_pi_init(&pi, &cfg);
+
+    // 未达门限不起转
+    CHECK_EQ(fan_pi_update(&pi, cfg.setpoint + 9, 2000), 0);
+    CHECK(!pi.running);
+    CHECK_EQ(fan_pi_update(&pi, cfg.setpoint + 10, 2000), 80);
+
+    // 运行中低于门限按门限输出，降到一半 (40) 以下才停转
+    CHECK_EQ(fan_pi_update(&pi, cfg.setpoint + 6, 2000), 80);
+    CHECK_EQ(fan_pi_update(&pi, cfg.setpoint + 5, 2000), 80);
+    CHECK_EQ(fan_pi_update(&pi, cfg.setpoint + 4, 2000), 0);
+    CHECK(!pi.running);
+    CHECK_EQ(fan_pi_update(&pi, cfg.setpoint + 6, 2000), 0);
+}
+
+static void test_integral(void)
+{
+    fan_pi_cfg_t cfg = default_cfg();
+    cfg.kp_x10 = 0;
+    cfg.min_duty = 0;
+    fan_pi_t pi;
+    fan_pi_init(&pi, &cfg);
+    fan_pi_reset(&pi, cfg.setpoint, 0);
+
+    // Ki = 0.3 占空/(℃·s)：+1.0℃ 持续 10 s → 3
+    CHECK_EQ(fan_pi_update(&pi, cfg.setpoint + 10, 10000), 3);
+    CHECK_EQ(fan_pi_update(&pi, cfg.setpoint + 10, 10000), 6);
+
+    // 时间步超过 FAN_PI_MAX_DT_MS 时截断
+    CHECK_EQ(fan_pi_update(&pi, cfg.setpoint + 10, 60000), 9);
+
+    // 负误差回积，积分项不低于 0
+    for (int i = 0; i < 10; i++) {
+        fan_pi_update(&pi, cfg.setpoint - 50, 10000);
+    }
+    CHECK_EQ(pi.integral, 0);
+    CHECK_EQ(fan_pi_update(&pi, cfg.setpoint, 10000), 0);
+}
+
+static void test_anti_windup(void)
+{
+    fan_pi_cfg_t cfg = default_cfg();
+    fan_pi_t pi;
+    fan_pi_init(&pi, &cfg);
+    fan_pi_reset(&pi, cfg.setpoint + 20, 200);
+    int64_t integral = pi.integral;
+    CHECK_EQ(integral, 40 << 16);
+
+    // 长时间饱和：积分保持不变，误差回落后立即退出饱和
+    for (int i = 0; i < 100; i++) {
+        CHECK_EQ(fan_pi_update(&pi, cfg.setpoint + 40, 2000), FAN_SPEED_HIGH);
+    }
+    CHECK_EQ(pi.integral, integral);
+    CHECK_EQ(pi.windup_holds, 100);
+
+    // P = 80，I ≈ 40：没有抗饱和时积分会累积到 255，输出仍为全速
+    uint8_t duty = fan_pi_update(&pi, cfg.setpoint + 10, 2000);
+    CHECK(duty >= 115 && duty <= 125);
+}
+
+static void test_reset(void)
+{
+    fan_pi_cfg_t cfg = default_cfg();
+    fan_pi_t pi;
+    fan_pi_init(&pi, &cfg);
+
+    // 从手动设定的 200 无扰接管：下一次同温度更新输出仍在 200 附近
+    fan_pi_reset(&pi, cfg.setpoint + 5, 200);
+    CHECK(pi.running);
+    CHECK_EQ(pi.output, 200);
+    uint8_t duty = fan_pi_update(&pi, cfg.setpoint + 5, 2000);
+    CHECK(abs((int)duty - 200) <= 2);
+
+    // 超过 max_duty 的接管值按 max_duty
+    cfg.max_duty = 180;
+    fan_pi_set_cfg(&pi, &cfg);
+    CHECK(pi.integral <= ((int64_t)180 << 16));
+    fan_pi_reset(&pi, cfg.setpoint, 255);
+    CHECK_EQ(pi.output, 180);
+    CHECK(fan_pi_update(&pi, cfg.setpoint + 50, 2000) <= 180);
+
+    // 接管停转状态
+    fan_pi_reset(&pi, cfg.setpoint - 20, 0);
+    CHECK(!pi.running);
+    CHECK_EQ(fan_pi_update(&pi, cfg.setpoint - 20, 2000), 0);
+}
+
+// ==================== 仿真 ====================
+
+// 与默认风扇规则等价的三档滞回控制
+static uint8_t stepped_update(int32_t temp, uint8_t prev)
+{
+    if (temp > to_fixed(TEMP_CRITICAL_THRESHOLD)) {
+        return FAN_SPEED_HIGH;
+    }
+    if (temp > to_fixed(TEMP_MEDIUM_THRESHOLD)) {
+        return FAN_SPEED_MEDIUM;
+    }
+    if (temp > to_fixed(TEMP_HIGH_THRESHOLD) ||
+        (prev > 0 && temp >= to_fixed(TEMP_HIGH_THRESHOLD - TEMP_HYSTERESIS))) {
+        return FAN_SPEED_LOW;
+    }
+    return FAN_SPEED_OFF;
+}
+
+/**
+ * @brief 运行一次仿真
+ *
+ * @param final_ref 稳定判据的参考温度 (首轮传入 INT32_MIN 时不统计 settle_s)
+ */
+static void sim_run(const fan_pi_cfg_t *cfg, sim_ctrl_t kind, int32_t final_ref,
+                    sim_result_t *r)
+{
+    fan_pi_t pi;
+    fan_pi_init(&pi, cfg);
+
+    memset(r, 0, sizeof(*r));
+    float temp = SIM_START_TEMP;
+    uint8_t duty = 0;
+    int64_t duty_sum = 0;
+    int64_t final_sum = 0;
+    r->peak = to_fixed(temp);
+
+    for (uint32_t t = 0; t < SIM_DURATION_S; t++) {
+        int32_t temp_fixed = to_fixed(temp);
+
+        if (t % SIM_SAMPLE_S == 0) {
+            uint8_t next = (kind == SIM_CTRL_PI) ?
+                           fan_pi_update(&pi, temp_fixed, SIM_SAMPLE_S * 1000) :
+                           stepped_update(temp_fixed, duty);
+            if (next != duty) {
+                uint32_t step = (next > duty) ? next - duty : duty - next;
+                if (step > r->max_step) {
+                    r->max_step = step;
+                }
+                r->speed_changes++;
+                duty = next;
+            }
+        }
+
+        if (temp_fixed > r->peak) {
+            r->peak = temp_fixed;
+        }
+        if (t >= SIM_DURATION_S - SIM_FINAL_WINDOW_S) {
+            final_sum += temp_fixed;
+        }
+        if (final_ref != INT32_MIN && abs(temp_fixed - final_ref) > SIM_SETTLE_BAND) {
+            r->settle_s = t + 1;
+        }
+        duty_sum += duty;
+
+        temp += (SIM_LOAD_TEMP - temp - SIM_FAN_COOLING * duty / 255.0f) / SIM_TAU_S;
+    }
+
+    r->overshoot = r->peak - cfg->setpoint;
+    if (r->overshoot < 0) {
+        r->overshoot = 0;
+    }
+    r->final_temp = (int32_t)(final_sum / SIM_FINAL_WINDOW_S);
+    r->final_error = r->final_temp - cfg->setpoint;
+    r->mean_duty = (uint32_t)(duty_sum / SIM_DURATION_S);
+}
+
+// 仿真确定可复现：首轮求末段温度，次轮以其为参考统计稳定时间
+static void simulate(const fan_pi_cfg_t *cfg, sim_ctrl_t kind, sim_result_t *r)
+{
+    sim_run(cfg, kind, INT32_MIN, r);
+    sim_run(cfg, kind, r->final_temp, r);
+}
+
+static void print_result(const char *name, const sim_result_t *r)
+{
+    printf("  %-8s peak %.1f  overshoot %.1f  final %.1f (%+.1f)  settle %4lu s  "
+           "changes %4lu  max_step %3lu  mean_duty %3lu\n",
+           name, r->peak / 10.0, r->overshoot / 10.0, r->final_temp / 10.0,
+           r->final_error / 10.0, (unsigned long)r->settle_s,
+           (unsigned long)r->speed_changes, (unsigned long)r->max_step,
+           (unsigned long)r->mean_duty);
+}
+
+static void test_simulation(void)
+{
+    fan_pi_cfg_t cfg = default_cfg();
+    sim_result_t pi;
+    sim_result_t stepped;
+    simulate(&cfg, SIM_CTRL_PI, &pi);
+    simulate(&cfg, SIM_CTRL_STEPPED, &stepped);
+
+    printf("room model: load %.0f C, tau %.0f s, cooling %.0f C, %d s from %.0f C\n",
+           SIM_LOAD_TEMP, SIM_TAU_S, SIM_FAN_COOLING, SIM_DURATION_S, SIM_START_TEMP);
+    print_result("pi", &pi);
+    print_result("stepped", &stepped);
+
+    // PI 回到设定点且超调小；三档停在低速档的平衡点，无法回到设定温度
+    CHECK(abs(pi.final_error) <= 1);
+    CHECK(pi.overshoot <= 10);
+    CHECK(pi.overshoot < stepped.overshoot);
+    CHECK(pi.settle_s < stepped.settle_s);
+    CHECK(stepped.final_error >= 20);
+
+    // 连续调速：最大跳变只出现在起转，不超过三档的单次跳变
+    CHECK(pi.max_step <= stepped.max_step);
+    CHECK(pi.mean_duty > 0 && pi.mean_duty < FAN_SPEED_HIGH);
+}
+
+int main(void)
+{
+    test_proportional();
+    test_min_duty();
+    test_integral();
+    test_anti_windup();
+    test_reset();
+    test_simulation();
+    return HOST_TEST_RESULT("fan_pi");
+}
@@ -0,0 +1,216 @@
+/**
+ * @file test_rules.c
+ * @brief 规则引擎主机测试与基准
+ *
+ * 用法: test_rules [迭代次数]
+ * 校验：默认规则分档与滞回、优先级、只输出变化、外部同步、编译错误与导出往返、NVS 持久化。
+ * 基准：rules_benchmark() 在当前规则表副本上求值 N 次 (原 GET /api/rules?bench，
+ * 在 httpd 任务中运行会阻塞其他请求，改在主机上给出)。
+ */
+
+#include "host_test.h"
+#include "rules.h"
+#include "config.h"
+#include <stdlib.h>
+#include <string.h>
+
+HOST_TEST_DEFINE_GLOBALS();
+
+#define DEFAULT_ITERATIONS 1000000
+
+static sensor_data_t s_data;
+
+static rule_outputs_t eval(float temperature, float light)
+{
+    rule_outputs_t out;
+    s_data.temperature = temperature;
+    s_data.light = light;
+    rules_evaluate(&s_data, &out);
+    return out;
+}
+
+#define BIT(t) (1u << (t))
+
+static void test_defaults(void)
+{
+    CHECK_EQ(rules_load(NULL, false, NULL), ESP_OK);
+    rules_stats_t stats;
+    rules_get_stats(&stats);
+    CHECK_EQ(stats.rule_count, 4);
+    CHECK(!stats.from_nvs);
+
+    // 首次求值输出全部受控目标
+    rule_outputs_t out = eval(25.0f, 50.0f);
+    CHECK_EQ(out.mask, BIT(RULE_TARGET_FAN) | BIT(RULE_TARGET_LED));
+    CHECK_EQ(out.value[RULE_TARGET_FAN], FAN_SPEED_OFF);
+    CHECK_EQ(out.value[RULE_TARGET_LED], LED_BRIGHTNESS_MAX);
+
+    // 未变化不输出
+    out = eval(25.0f, 50.0f);
+    CHECK_EQ(out.mask, 0);
+
+    // 升温分档，优先级取第一条激活规则
+    out = eval(30.5f, 50.0f);
+    CHECK_EQ(out.mask, BIT(RULE_TARGET_FAN));
+    CHECK_EQ(out.value[RULE_TARGET_FAN], FAN_SPEED_LOW);
+    out = eval(32.5f, 50.0f);
+    CHECK_EQ(out.value[RULE_TARGET_FAN], FAN_SPEED_MEDIUM);
+    out = eval(35.5f, 50.0f);
+    CHECK_EQ(out.value[RULE_TARGET_FAN], FAN_SPEED_HIGH);
+
+    // 低速档带滞回：28℃ 以上保持，低于 28℃ 才关闭
+    out = eval(29.0f, 50.0f);
+    CHECK_EQ(out.value[RULE_TARGET_FAN], FAN_SPEED_LOW);
+    out = eval(28.0f, 50.0f);
+    CHECK_EQ(out.mask, 0);
+    out = eval(27.9f, 50.0f);
+    CHECK_EQ(out.mask, BIT(RULE_TARGET_FAN));
+    CHECK_EQ(out.value[RULE_TARGET_FAN], FAN_SPEED_OFF);
+
+    // 光照滞回：100-120 lux 之间保持
+    out = eval(25.0f, 110.0f);
+    CHECK_EQ(out.mask, 0);
+    out = eval(25.0f, 121.0f);
+    CHECK_EQ(out.value[RULE_TARGET_LED], 0);
+    out = eval(25.0f, 110.0f);
+    CHECK_EQ(out.mask, 0);
+}
+
+static void test_sync(void)
+{
+    CHECK_EQ(rules_load(NULL, false, NULL), ESP_OK);
+    rule_outputs_t out = eval(25.0f, 200.0f);
+    CHECK_EQ(out.value[RULE_TARGET_FAN], FAN_SPEED_OFF);
+
+    // 外部打开风扇：滞回带内沿用开启状态，且同步后的首次求值总会输出
+    rules_sync_target(RULE_TARGET_FAN, true);
+    out = eval(29.0f, 200.0f);
+    CHECK(out.mask & BIT(RULE_TARGET_FAN));
+    CHECK_EQ(out.value[RULE_TARGET_FAN], FAN_SPEED_LOW);
+
+    // 外部关闭后同样保持到越过激活阈值
+    rules_sync_target(RULE_TARGET_FAN, false);
+    out = eval(29.0f, 200.0f);
+    CHECK_EQ(out.value[RULE_TARGET_FAN], FAN_SPEED_OFF);
+    out = eval(30.5f, 200.0f);
+    CHECK_EQ(out.value[RULE_TARGET_FAN], FAN_SPEED_LOW);
+}
+
+static void test_compile(void)
+{
+    static const struct {
+        const char *json;
+        const char *err;
+    } bad[] = {
+        {"{", "invalid json"},
+        {"{\"rules\":{}}", "rules must be an array"},
+        {"{\"rules\":[{\"field\":\"pressure\",\"above\":1,\"target\":\"fan\",\"value\":1}]}",
+         "unknown field or target"},
+        {"{\"rules\":[{\"field\":\"light\",\"target\":\"led\",\"value\":1}]}",
+         "exactly one of above/below is required"},
+        {"{\"rules\":[{\"field\":\"light\",\"above\":10,\"below\":5,\"target\":\"led\",\"value\":1}]}",
+         "exactly one of above/below is required"},
+        {"{\"rules\":[{\"field\":\"light\",\"above\":10,\"release\":12,\"target\":\"led\",\"value\":1}]}",
+         "release must lie on the inactive side of the threshold"},
+        {"{\"rules\":[{\"field\":\"light\",\"below\":10,\"target\":\"led\",\"value\":256}]}",
+         "value must be 0-255"},
+    };
+
+    CHECK_EQ(rules_load(NULL, false, NULL), ESP_OK);
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        const char *err = NULL;
+        CHECK_EQ(rules_load(bad[i].json, false, &err), ESP_ERR_INVALID_ARG);
+        CHECK(err != NULL && strcmp(err, bad[i].err) == 0);
+    }
+
+    // 失败时保持原规则
+    rules_stats_t stats;
+    rules_get_stats(&stats);
+    CHECK_EQ(stats.rule_count, 4);
+
+    char *big = malloc(RULES_JSON_MAX + 1);
+    CHECK(big != NULL);
+    if (big != NULL) {
+        memset(big, ' ', RULES_JSON_MAX);
+        big[RULES_JSON_MAX] = '\0';
+        CHECK_EQ(rules_load(big, false, NULL), ESP_ERR_INVALID_SIZE);
+        free(big);
+    }
+
+    // 导出后重新加载得到相同的规则
+    const char *src =
+        "{\"rules\":[{\"field\":\"humidity\",\"above\":70,\"release\":65,\"target\":\"fan\",\"value\":120},"
+        "{\"field\":\"smoke\",\"above\":2000,\"target\":\"curtain\",\"value\":100}]}";
+    CHECK_EQ(rules_load(src, false, NULL), ESP_OK);
+    char *exported = rules_export_json();
+    CHECK(exported != NULL);
+    if (exported != NULL) {
+        CHECK_EQ(rules_load(exported, false, NULL), ESP_OK);
+        char *again = rules_export_json();
+        CHECK(again != NULL && strcmp(exported, again) == 0);
+        free(again);
+        free(exported);
+    }
+
+    // 无规则的目标 (led) 不受控制
+    rule_outputs_t out;
+    s_data.humidity = 72.0f;
+    s_data.smoke = 2500;
+    rules_evaluate(&s_data, &out);
+    CHECK_EQ(out.mask, BIT(RULE_TARGET_FAN) | BIT(RULE_TARGET_CURTAIN));
+    CHECK_EQ(out.value[RULE_TARGET_FAN], 120);
+    CHECK_EQ(out.value[RULE_TARGET_CURTAIN], 100);
+}
+
+static void test_persist(void)
+{
+    const char *src = "{\"rules\":[{\"field\":\"light\",\"below\":50,\"target\":\"led\",\"value\":80}]}";
+    CHECK_EQ(rules_load(src, true, NULL), ESP_OK);
+    rules_stats_t stats;
+    rules_get_stats(&stats);
+    CHECK(stats.from_nvs);
+    CHECK_EQ(stats.rule_count, 1);
+
+    // 恢复默认时删除 NVS 中的规则
+    CHECK_EQ(rules_load(NULL, true, NULL), ESP_OK);
+    rules_get_stats(&stats);
+    CHECK(!stats.from_nvs);
+    CHECK_EQ(stats.rule_count, 4);
+}
+
+static void bench(uint32_t iterations)
+{
+    CHECK_EQ(rules_load(NULL, false, NULL), ESP_OK);
+
+    rules_bench_t r;
+    CHECK_EQ(rules_benchmark(0, &r), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(rules_benchmark(iterations, &r), ESP_OK);
+    CHECK_EQ(r.iterations, iterations);
+    CHECK_EQ(r.rule_count, 4);
+
+    printf("iterations: %lu x %lu rules in %lld us\n", (unsigned long)r.iterations,
+           (unsigned long)r.rule_count, (long long)r.elapsed_us);
+    printf("  %.1f ns/eval, %lu evals/s, %lu rules/s\n",
+           (double)r.elapsed_us * 1000.0 / r.iterations, (unsigned long)r.evals_per_sec,
+           (unsigned long)r.rules_per_sec);
+}
+
+int main(int argc, char **argv)
+{
+    int iterations = (argc > 1) ? atoi(argv[1]) : DEFAULT_ITERATIONS;
+    if (iterations <= 0) {
+        iterations = DEFAULT_ITERATIONS;
+    }
+
+    CHECK_EQ(rules_load(NULL, false, NULL), ESP_ERR_INVALID_STATE);
+    CHECK_EQ(rules_init(), ESP_OK);
+
+    s_data.humidity = 50.0f;
+    s_data.smoke = 800;
+    test_defaults();
+    test_sync();
+    test_compile();
+    test_persist();
+    bench((uint32_t)iterations);
+    return HOST_TEST_RESULT("rules");
+}
@@ -0,0 +1,356 @@
+/**
+ * @file test_sensor_filter.c
+ * @brief 信号调理主机测试：手算用例 + 黄金轨迹 + 基准
+ *
+ * 用法: test_sensor_filter <轨迹目录> [--write]
+ * 四个通道使用与 application.c init_filters() 相同的 config.h 参数。
+ * 黄金轨迹 filter_<通道>.txt 每行为 "真值 输入 输出 是否接受"，测试逐行比对输出与接受标志，
+ * 并打印滤波前后相对真值的 RMS 误差与最大偏差；--write 用当前实现重新生成轨迹
+ * (仅在有意改变滤波行为时使用，提交前逐段核对差异)。
+ * 基准：单样本耗时 (ns)。
+ */
+
+#include "host_test.h"
+#include "sensor_filter.h"
+#include "config.h"
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+HOST_TEST_DEFINE_GLOBALS();
+
+#define TRACE_LEN        600
+#define BENCH_SAMPLES    2000000
+
+typedef enum {
+    CH_TEMPERATURE = 0,
+    CH_HUMIDITY,
+    CH_LIGHT,
+    CH_SMOKE,
+    CH_MAX,
+} channel_t;
+
+static const char *const s_names[CH_MAX] = {"temperature", "humidity", "light", "smoke"};
+
+static sensor_filter_cfg_t channel_cfg(channel_t ch)
+{
+    switch (ch) {
+        case CH_TEMPERATURE:
+            return (sensor_filter_cfg_t){
+                .median_window = FILTER_TEMP_MEDIAN,
+                .ema_shift = FILTER_TEMP_EMA_SHIFT,
+                .max_slew = FILTER_TEMP_SLEW,
+                .outlier_thresh = FILTER_TEMP_OUTLIER,
+                .outlier_max_run = FILTER_OUTLIER_MAX_RUN,
+            };
+        case CH_HUMIDITY:
+            return (sensor_filter_cfg_t){
+                .median_window = FILTER_HUMI_MEDIAN,
+                .ema_shift = FILTER_HUMI_EMA_SHIFT,
+                .max_slew = FILTER_HUMI_SLEW,
+                .outlier_thresh = FILTER_HUMI_OUTLIER,
+                .outlier_max_run = FILTER_OUTLIER_MAX_RUN,
+            };
+        case CH_LIGHT:
+            return (sensor_filter_cfg_t){ .median_window = FILTER_LIGHT_MEDIAN };
+        default:
+            return (sensor_filter_cfg_t){ .median_window = FILTER_SMOKE_MEDIAN };
+    }
+}
+
+// ==================== 手算用例 ====================
+
+static int32_t feed(sensor_filter_t *f, int32_t in, bool *accepted)
+{
+    int32_t out = 0;
+    bool ok = sensor_filter_update(f, in, &out);
+    if (accepted != NULL) {
+        *accepted = ok;
+    }
+    return out;
+}
+
+static void test_temperature_cases(void)
+{
+    sensor_filter_cfg_t cfg = channel_cfg(CH_TEMPERATURE);
+    sensor_filter_t f;
+    sensor_filter_init(&f, &cfg);
+    bool ok = false;
+
+    // 首个样本直接作为输出
+    CHECK_EQ(feed(&f, 250, &ok), 250);
+    CHECK(ok);
+    CHECK_EQ(feed(&f, 250, NULL), 250);
+    CHECK_EQ(feed(&f, 250, NULL), 250);
+
+    // 单点毛刺被剔除，输出保持
+    CHECK_EQ(feed(&f, 900, &ok), 250);
+    CHECK(!ok);
+    CHECK_EQ(f.rejected, 1);
+    CHECK_EQ(feed(&f, 251, &ok), 250);
+    CHECK(ok);
+
+    // 真实阶跃：连续 FILTER_OUTLIER_MAX_RUN 次剔除后接受，输出按斜率上限爬升
+    for (int i = 0; i < FILTER_OUTLIER_MAX_RUN; i++) {
+        CHECK_EQ(feed(&f, 320, &ok), 250);
+        CHECK(!ok);
+    }
+    CHECK_EQ(feed(&f, 320, &ok), 250 + FILTER_TEMP_SLEW);
+    CHECK(ok);
+    CHECK_EQ(feed(&f, 320, NULL), 250 + 2 * FILTER_TEMP_SLEW);
+    CHECK_EQ(feed(&f, 320, NULL), 250 + 3 * FILTER_TEMP_SLEW);
+    CHECK_EQ(feed(&f, 320, NULL), 320);
+
+    // 中值延迟一个样本，EMA (alpha = 1/2) 逐步收敛，无稳态误差
+    CHECK_EQ(feed(&f, 324, NULL), 320);
+    CHECK_EQ(feed(&f, 324, NULL), 322);
+    CHECK_EQ(feed(&f, 324, NULL), 323);
+    CHECK_EQ(feed(&f, 324, NULL), 323);
+    CHECK_EQ(feed(&f, 324, NULL), 324);
+
+    // 复位后重新以首样本为初值，统计保留
+    uint32_t rejected = f.rejected;
+    sensor_filter_reset(&f);
+    CHECK_EQ(feed(&f, 180, NULL), 180);
+    CHECK_EQ(f.rejected, rejected);
+}
+
+static void test_median_cases(void)
+{
+    sensor_filter_cfg_t cfg = channel_cfg(CH_LIGHT);
+    sensor_filter_t f;
+    sensor_filter_init(&f, &cfg);
+
+    CHECK_EQ(feed(&f, 100, NULL), 100);
+    CHECK_EQ(feed(&f, 100, NULL), 100);
+    CHECK_EQ(feed(&f, 65535, NULL), 100);   // 单点毛刺
+    CHECK_EQ(feed(&f, 102, NULL), 102);
+    CHECK_EQ(feed(&f, 0, NULL), 102);
+    CHECK_EQ(feed(&f, 400, NULL), 102);     // 阶跃延迟一个样本
+    CHECK_EQ(feed(&f, 400, NULL), 400);
+
+    // 窗口超过上限时截断，所有级关闭时原样输出
+    cfg.median_window = 15;
+    sensor_filter_init(&f, &cfg);
+    CHECK_EQ(f.cfg.median_window, SENSOR_FILTER_MEDIAN_MAX);
+    sensor_filter_cfg_t off = {0};
+    sensor_filter_init(&f, &off);
+    CHECK_EQ(feed(&f, -5, NULL), -5);
+    CHECK_EQ(feed(&f, 70000, NULL), 70000);
+}
+
+// ==================== 黄金轨迹 ====================
+
+typedef struct {
+    int32_t clean;
+    int32_t in;
+    int32_t out;
+    bool accepted;
+} trace_row_t;
+
+static uint32_t s_seed;
+
+static int32_t rnd(int32_t lo, int32_t hi)
+{
+    s_seed = s_seed * 1103515245u + 12345u;
+    return lo + (int32_t)((s_seed >> 16) % (uint32_t)(hi - lo + 1));
+}
+
+// 真值 + 传感器噪声 + 毛刺/掉线，取值范围与各驱动的原始读数一致
+static void synthesize(channel_t ch, trace_row_t *rows)
+{
+    s_seed = 2024u + (uint32_t)ch;
+    for (int t = 0; t < TRACE_LEN; t++) {
+        double phase = 2.0 * M_PI * t / TRACE_LEN;
+        int32_t clean = 0;
+        int32_t in = 0;
+        switch (ch) {
+            case CH_TEMPERATURE:    // 0.1℃，第 300 个样本起开暖风机
+                clean = 250 + (int32_t)lround(10.0 * sin(phase)) + (t >= 300 ? 70 : 0);
+                in = clean + rnd(-1, 1);
+                if (rnd(0, 99) < 3) {
+                    in = (rnd(0, 1) != 0) ? clean + rnd(80, 300) : 0;   // 毛刺 / 读数为 0
+                }
+                break;
+            case CH_HUMIDITY:       // 0.1%，DHT11 整数湿度
+                clean = 550 + (int32_t)lround(60.0 * sin(phase));
+                in = (clean + rnd(-10, 10)) / 10 * 10;
+                if (rnd(0, 99) < 3) {
+                    in = rnd(0, 1000);
+                }
+                break;
+            case CH_LIGHT:          // lux，日光灯闪烁 + I2C 错误读数
+                clean = (t >= 200 && t < 450) ? 420 : 80;
+                in = clean + rnd(-6, 6);
+                if (rnd(0, 99) < 2) {
+                    in = (rnd(0, 1) != 0) ? 65535 : 0;
+                }
+                break;
+            default:                // MQ2 ADC，第 400 个样本起真实烟雾
+                clean = (t >= 400) ? 2600 : 800;
+                in = clean + rnd(-20, 20);
+                if (rnd(0, 99) < 2) {
+                    in = 4095;
+                }
+                break;
+        }
+        rows[t].clean = clean;
+        rows[t].in = in;
+    }
+}
+
+static void run_filter(channel_t ch, trace_row_t *rows)
+{
+    sensor_filter_cfg_t cfg = channel_cfg(ch);
+    sensor_filter_t f;
+    sensor_filter_init(&f, &cfg);
+    for (int t = 0; t < TRACE_LEN; t++) {
+        rows[t].accepted = sensor_filter_update(&f, rows[t].in, &rows[t].out);
+    }
+}
+
+static int write_trace(const char *path, channel_t ch, const trace_row_t *rows)
+{
+    FILE *f = fopen(path, "w");
+    if (f == NULL) {
+        perror(path);
+        return -1;
+    }
+    fprintf(f, "# sensor_filter golden trace: %s (config.h 参数)\n", s_names[ch]);
+    fprintf(f, "# clean in out accepted\n");
+    for (int t = 0; t < TRACE_LEN; t++) {
+        fprintf(f, "%d %d %d %d\n", rows[t].clean, rows[t].in, rows[t].out, rows[t].accepted);
+    }
+    fclose(f);
+    return 0;
+}
+
+static int read_trace(const char *path, trace_row_t *rows)
+{
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        perror(path);
+        return -1;
+    }
+    char line[128];
+    int n = 0;
+    while (n < TRACE_LEN && fgets(line, sizeof(line), f) != NULL) {
+        if (line[0] == '#') {
+            continue;
+        }
+        int accepted = 0;
+        if (sscanf(line, "%d %d %d %d", &rows[n].clean, &rows[n].in, &rows[n].out,
+                   &accepted) != 4) {
+            break;
+        }
+        rows[n].accepted = (accepted != 0);
+        n++;
+    }
+    fclose(f);
+    return n;
+}
+
+static void report_error(channel_t ch, const trace_row_t *rows)
+{
+    double in_sq = 0;
+    double out_sq = 0;
+    int32_t in_max = 0;
+    int32_t out_max = 0;
+    int rejected = 0;
+    for (int t = 0; t < TRACE_LEN; t++) {
+        int32_t ein = abs(rows[t].in - rows[t].clean);
+        int32_t eout = abs(rows[t].out - rows[t].clean);
+        in_sq += (double)ein * ein;
+        out_sq += (double)eout * eout;
+        in_max = (ein > in_max) ? ein : in_max;
+        out_max = (eout > out_max) ? eout : out_max;
+        rejected += !rows[t].accepted;
+    }
+    printf("  %-12s rms error %8.1f -> %6.1f   max %6d -> %5d   rejected %d\n",
+           s_names[ch], sqrt(in_sq / TRACE_LEN), sqrt(out_sq / TRACE_LEN),
+           in_max, out_max, rejected);
+}
+
+static void test_golden(const char *dir, bool write)
+{
+    static trace_row_t expected[TRACE_LEN];
+    static trace_row_t actual[TRACE_LEN];
+
+    for (channel_t ch = 0; ch < CH_MAX; ch++) {
+        char path[512];
+        snprintf(path, sizeof(path), "%s/filter_%s.txt", dir, s_names[ch]);
+
+        if (write) {
+            synthesize(ch, actual);
+            run_filter(ch, actual);
+            CHECK_EQ(write_trace(path, ch, actual), 0);
+            report_error(ch, actual);
+            continue;
+        }
+
+        int n = read_trace(path, expected);
+        CHECK_EQ(n, TRACE_LEN);
+        if (n != TRACE_LEN) {
+            continue;
+        }
+        memcpy(actual, expected, sizeof(actual));
+        run_filter(ch, actual);
+
+        int mismatches = 0;
+        for (int t = 0; t < TRACE_LEN; t++) {
+            if (actual[t].out != expected[t].out || actual[t].accepted != expected[t].accepted) {
+                if (mismatches++ == 0) {
+                    fprintf(stderr, "%s: first mismatch at sample %d: in %d, out %d (%d), "
+                            "accepted %d (%d)\n", s_names[ch], t, expected[t].in,
+                            actual[t].out, expected[t].out, actual[t].accepted,
+                            expected[t].accepted);
+                }
+            }
+        }
+        CHECK_EQ(mismatches, 0);
+        report_error(ch, actual);
+    }
+}
+
+// ==================== 基准 ====================
+
+static void bench(void)
+{
+    static trace_row_t rows[TRACE_LEN];
+    printf("per-sample cost (%d samples):\n", BENCH_SAMPLES);
+    for (channel_t ch = 0; ch < CH_MAX; ch++) {
+        synthesize(ch, rows);
+        sensor_filter_cfg_t cfg = channel_cfg(ch);
+        sensor_filter_t f;
+        sensor_filter_init(&f, &cfg);
+
+        int64_t sink = 0;
+        int64_t start = host_now_ns();
+        for (int i = 0; i < BENCH_SAMPLES; i++) {
+            int32_t out = 0;
+            sensor_filter_update(&f, rows[i % TRACE_LEN].in, &out);
+            sink += out;
+        }
+        int64_t ns = host_now_ns() - start;
+        printf("  %-12s %5.1f ns/sample (median %u, ema %u, slew %d, outlier %d) sink=%lld\n",
+               s_names[ch], (double)ns / BENCH_SAMPLES, cfg.median_window, cfg.ema_shift,
+               (int)cfg.max_slew, (int)cfg.outlier_thresh, (long long)sink);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <trace dir> [--write]\n", argv[0]);
+        return 2;
+    }
+    bool write = (argc > 2 && strcmp(argv[2], "--write") == 0);
+
+    test_temperature_cases();
+    test_median_cases();
+    printf("golden traces (%d samples each):\n", TRACE_LEN);
+    test_golden(argv[1], write);
+    bench();
+    return HOST_TEST_RESULT("sensor_filter");
+}
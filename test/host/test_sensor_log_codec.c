@@ -0,0 +1,291 @@
+/**
+ * @file test_sensor_log_codec.c
+ * @brief 传感器归档编解码主机测试与基准
+ *
+ * 用法: test_sensor_log_codec [重复次数]
+ * 校验：合成的一天 (10 秒一条，与 application.c 的归档周期相同) 按 Flash 页编码后逐条回读，
+ * 浮点按位相等；时间基准跳变 (上电秒数 → 墙钟)、时间回退、NaN、ADC 回绕；页满回滚、CRC 校验。
+ * 基准：压缩率 (相对 sizeof(sensor_log_record_t)) 与编码/解码吞吐。
+ */
+
+#include "host_test.h"
+#include "sensor_log_codec.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+HOST_TEST_DEFINE_GLOBALS();
+
+#define PAGE_SIZE        4096      // 与 SENSOR_LOG_PAGE_SIZE 相同
+#define PAGE_HDR_SIZE    sizeof(sensor_log_page_hdr_t)
+#define PAGE_PAYLOAD     (PAGE_SIZE - PAGE_HDR_SIZE)
+#define DAY_RECORDS      8640      // 24h / 10s
+#define DEFAULT_REPEAT   50
+
+static sensor_log_record_t s_day[DAY_RECORDS];
+
+// 温度 0.1℃ 量化、湿度整数 (滤波器输出)，光照为 BH1750 原始值 / 1.2，MQ2 带噪声
+static void make_day(uint32_t start_ts)
+{
+    uint32_t seed = 12345;
+    for (int i = 0; i < DAY_RECORDS; i++) {
+        seed = seed * 1103515245u + 12345u;
+        double phase = 2.0 * M_PI * i / DAY_RECORDS;
+        int noise = (int)((seed >> 16) % 31) - 15;
+        double sun = sin(phase - M_PI / 2);
+
+        s_day[i].ts = start_ts + (uint32_t)i * 10;
+        s_day[i].temperature = roundf((float)(25.0 + 4.0 * sun) * 10.0f) / 10.0f;
+        s_day[i].humidity = roundf((float)(55.0 - 10.0 * sun));
+        uint32_t raw = (sun > 0) ? (uint32_t)(sun * 600.0) + (uint32_t)(noise + 15) : 0;
+        s_day[i].light = (float)raw / 1.2f;
+        s_day[i].smoke = (uint32_t)(800 + noise);
+    }
+    // 偶尔一次采样延迟，时间戳二阶差分非零
+    s_day[100].ts += 1;
+    s_day[5000].ts += 3;
+}
+
+static bool record_equal(const sensor_log_record_t *a, const sensor_log_record_t *b)
+{
+    return a->ts == b->ts && a->smoke == b->smoke &&
+           memcmp(&a->temperature, &b->temperature, sizeof(float)) == 0 &&
+           memcmp(&a->humidity, &b->humidity, sizeof(float)) == 0 &&
+           memcmp(&a->light, &b->light, sizeof(float)) == 0;
+}
+
+/**
+ * @brief 把 records 依次编码进若干页 (与 sensor_log_append 相同的换页方式)
+ *
+ * @return 页数；pages 为 NULL 时只统计
+ */
+static int encode_pages(const sensor_log_record_t *records, int count, uint8_t *pages,
+                        int max_pages, size_t *encoded_bytes)
+{
+    static uint8_t scratch[PAGE_SIZE];
+    int page_count = 0;
+    uint8_t *page = pages ? pages : scratch;
+    sensor_log_encoder_t enc;
+    sensor_log_encoder_init(&enc, page + PAGE_HDR_SIZE, PAGE_PAYLOAD);
+    *encoded_bytes = 0;
+
+    for (int i = 0; i < count; i++) {
+        if (sensor_log_encoder_append(&enc, &records[i])) {
+            continue;
+        }
+        sensor_log_page_finalize(page, (uint32_t)page_count, &enc);
+        *encoded_bytes += sensor_log_encoder_bytes(&enc);
+        page_count++;
+        if (page_count >= max_pages) {
+            return -1;
+        }
+        page = pages ? pages + (size_t)page_count * PAGE_SIZE : scratch;
+        sensor_log_encoder_init(&enc, page + PAGE_HDR_SIZE, PAGE_PAYLOAD);
+        if (!sensor_log_encoder_append(&enc, &records[i])) {
+            return -1;
+        }
+    }
+    if (enc.count > 0) {
+        sensor_log_page_finalize(page, (uint32_t)page_count, &enc);
+        *encoded_bytes += sensor_log_encoder_bytes(&enc);
+        page_count++;
+    }
+    return page_count;
+}
+
+// 校验并解码各页，返回记录数 (页损坏或解码失败返回 -1)
+static int decode_pages(const uint8_t *pages, int page_count, sensor_log_record_t *out,
+                        int max_records)
+{
+    int n = 0;
+    for (int p = 0; p < page_count; p++) {
+        const uint8_t *page = pages + (size_t)p * PAGE_SIZE;
+        sensor_log_page_hdr_t hdr;
+        if (!sensor_log_page_verify(page, PAGE_SIZE, &hdr) || hdr.seq != (uint32_t)p) {
+            return -1;
+        }
+        sensor_log_decoder_t dec;
+        sensor_log_decoder_init(&dec, page + PAGE_HDR_SIZE, hdr.payload_len, hdr.count);
+        for (uint16_t i = 0; i < hdr.count; i++) {
+            if (n >= max_records || !sensor_log_decoder_next(&dec, &out[n])) {
+                return -1;
+            }
+            if (i == 0 && out[n].ts != hdr.first_ts) {
+                return -1;
+            }
+            n++;
+        }
+        sensor_log_record_t extra;
+        if (sensor_log_decoder_next(&dec, &extra)) {
+            return -1;
+        }
+    }
+    return n;
+}
+
+static int roundtrip(const sensor_log_record_t *records, int count)
+{
+    int max_pages = count / 8 + 2;
+    uint8_t *pages = calloc((size_t)max_pages, PAGE_SIZE);
+    sensor_log_record_t *out = calloc((size_t)count, sizeof(*out));
+    size_t bytes = 0;
+    int mismatches = -1;
+
+    int page_count = pages && out ? encode_pages(records, count, pages, max_pages, &bytes) : -1;
+    if (page_count > 0 && decode_pages(pages, page_count, out, count) == count) {
+        mismatches = 0;
+        for (int i = 0; i < count; i++) {
+            if (!record_equal(&records[i], &out[i])) {
+                if (mismatches++ == 0) {
+                    fprintf(stderr, "record %d differs: ts %u/%u smoke %u/%u\n", i,
+                            records[i].ts, out[i].ts, records[i].smoke, out[i].smoke);
+                }
+            }
+        }
+    }
+    free(pages);
+    free(out);
+    return mismatches;
+}
+
+static void test_day(void)
+{
+    make_day(SENSOR_LOG_TS_WALL_MIN + 86400 * 300);
+    CHECK_EQ(roundtrip(s_day, DAY_RECORDS), 0);
+
+    // 未校时：上电秒数
+    make_day(12);
+    CHECK_EQ(roundtrip(s_day, DAY_RECORDS), 0);
+}
+
+static void test_edges(void)
+{
+    sensor_log_record_t r[8] = {
+        {.ts = 30, .temperature = 24.5f, .humidity = 60.0f, .light = 10.0f, .smoke = 4095},
+        {.ts = 40, .temperature = NAN, .humidity = 60.0f, .light = 0.0f, .smoke = 0},
+        // 校时：时间戳从上电秒数跳到墙钟
+        {.ts = SENSOR_LOG_TS_WALL_MIN + 5000, .temperature = -INFINITY, .humidity = 0.0f,
+         .light = 65535.0f, .smoke = 0xFFFFFFFFu},
+        {.ts = SENSOR_LOG_TS_WALL_MIN + 5010, .temperature = -0.0f, .humidity = 100.0f,
+         .light = 1e-30f, .smoke = 1},
+        // 校时回拨
+        {.ts = SENSOR_LOG_TS_WALL_MIN + 4000, .temperature = 24.6f, .humidity = 61.0f,
+         .light = 12.5f, .smoke = 800},
+        {.ts = SENSOR_LOG_TS_WALL_MIN + 4000, .temperature = 24.6f, .humidity = 61.0f,
+         .light = 12.5f, .smoke = 800},
+        {.ts = 0, .temperature = 0.0f, .humidity = 0.0f, .light = 0.0f, .smoke = 0},
+        {.ts = 0xFFFFFFF0u, .temperature = 1.0f, .humidity = 2.0f, .light = 3.0f, .smoke = 5},
+    };
+    CHECK_EQ(roundtrip(r, 8), 0);
+}
+
+static void test_page(void)
+{
+    static uint8_t page[PAGE_SIZE];
+    uint8_t small[24];
+    sensor_log_encoder_t enc;
+
+    // 空间不足时编码器状态不变
+    sensor_log_encoder_init(&enc, small, sizeof(small));
+    sensor_log_record_t rec = {.ts = 100, .temperature = 25.1f, .humidity = 50.0f,
+                               .light = 321.7f, .smoke = 812};
+    int appended = 0;
+    while (sensor_log_encoder_append(&enc, &rec)) {
+        appended++;
+        rec.ts += 10;
+        rec.temperature += 0.1f;
+        rec.smoke += 7;
+    }
+    sensor_log_encoder_t before = enc;
+    CHECK(appended > 0);
+    CHECK(!sensor_log_encoder_append(&enc, &rec));
+    CHECK(memcmp(&before, &enc, sizeof(enc)) == 0);
+    CHECK(sensor_log_encoder_bytes(&enc) <= sizeof(small));
+
+    // CRC：任意一位翻转都被发现；载荷长度越界、空页、魔数错误均无效
+    sensor_log_encoder_init(&enc, page + PAGE_HDR_SIZE, PAGE_PAYLOAD);
+    make_day(SENSOR_LOG_TS_WALL_MIN);
+    for (int i = 0; i < 50; i++) {
+        CHECK(sensor_log_encoder_append(&enc, &s_day[i]));
+    }
+    sensor_log_page_finalize(page, 7, &enc);
+    sensor_log_page_hdr_t hdr;
+    CHECK(sensor_log_page_verify(page, PAGE_SIZE, &hdr));
+    CHECK_EQ(hdr.seq, 7);
+    CHECK_EQ(hdr.count, 50);
+
+    size_t used = PAGE_HDR_SIZE + hdr.payload_len;
+    int undetected = 0;
+    for (size_t bit = 0; bit < used * 8; bit++) {
+        page[bit / 8] ^= (uint8_t)(1u << (bit % 8));
+        if (sensor_log_page_verify(page, PAGE_SIZE, NULL)) {
+            undetected++;
+        }
+        page[bit / 8] ^= (uint8_t)(1u << (bit % 8));
+    }
+    CHECK_EQ(undetected, 0);
+    CHECK(sensor_log_page_verify(page, PAGE_SIZE, NULL));
+    CHECK(!sensor_log_page_verify(page, used - 1, NULL));
+
+    // 标准 CRC32 校验值
+    CHECK_EQ(sensor_log_crc32(0, "123456789", 9), 0xCBF43926u);
+}
+
+static void bench(int repeat)
+{
+    make_day(SENSOR_LOG_TS_WALL_MIN + 86400 * 300);
+
+    int max_pages = DAY_RECORDS / 8 + 2;
+    uint8_t *pages = calloc((size_t)max_pages, PAGE_SIZE);
+    sensor_log_record_t *out = calloc(DAY_RECORDS, sizeof(*out));
+    CHECK(pages != NULL && out != NULL);
+    if (pages == NULL || out == NULL) {
+        free(pages);
+        free(out);
+        return;
+    }
+
+    size_t bytes = 0;
+    int page_count = 0;
+    int64_t start = host_now_ns();
+    for (int r = 0; r < repeat; r++) {
+        page_count = encode_pages(s_day, DAY_RECORDS, pages, max_pages, &bytes);
+    }
+    int64_t encode_ns = host_now_ns() - start;
+
+    int decoded = 0;
+    start = host_now_ns();
+    for (int r = 0; r < repeat; r++) {
+        decoded = decode_pages(pages, page_count, out, DAY_RECORDS);
+    }
+    int64_t decode_ns = host_now_ns() - start;
+    CHECK_EQ(decoded, DAY_RECORDS);
+
+    double raw = (double)DAY_RECORDS * sizeof(sensor_log_record_t);
+    double total = (double)DAY_RECORDS * repeat;
+    printf("one day @10s: %d records, %d pages, %.0f -> %zu bytes\n",
+           DAY_RECORDS, page_count, raw, bytes);
+    printf("  ratio %.2fx, %.2f bytes/record, %.0f days per 1MB partition\n",
+           raw / (double)bytes, (double)bytes / DAY_RECORDS,
+           (1024.0 * 1024.0 / PAGE_SIZE) / page_count);
+    printf("  encode %.1f ns/record (%.1f MB/s raw), decode %.1f ns/record (%.1f MB/s raw)\n",
+           encode_ns / total, raw * repeat / (encode_ns / 1e3),
+           decode_ns / total, raw * repeat / (decode_ns / 1e3));
+
+    free(pages);
+    free(out);
+}
+
+int main(int argc, char **argv)
+{
+    int repeat = (argc > 1) ? atoi(argv[1]) : DEFAULT_REPEAT;
+    if (repeat <= 0) {
+        repeat = DEFAULT_REPEAT;
+    }
+
+    test_day();
+    test_edges();
+    test_page();
+    bench(repeat);
+    return HOST_TEST_RESULT("sensor_log_codec");
+}
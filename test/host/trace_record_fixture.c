@@ -0,0 +1,172 @@
+/**
+ * @file trace_record_fixture.c
+ * @brief 生成轨迹回放测试数据
+ *
+ * 以 hal_sim 运行控制回路并开启轨迹记录 (调用顺序同 application.c 的采样回调与
+ * 控制任务)，导出为 trace.bin；另写一份把最后一条风扇输出改掉的 trace_tampered.bin，
+ * 回放工具对前者应无不一致，对后者应报告不一致。
+ *
+ * 用法: trace_record_fixture <输出目录>
+ */
+
+#include "app_state.h"
+#include "app_control.h"
+#include "config.h"
+#include "hal.h"
+#include "hal_sim.h"
+#include "trace.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FIXTURE_CAPACITY 4096
+
+static bool on_smoke_threshold(uint32_t value, int64_t detect_us, void *ctx)
+{
+    app_control_smoke_alarm(value, detect_us);
+    return false;
+}
+
+static void control_once(void)
+{
+    if (app_state_lock() == ESP_OK) {
+        app_control_process(app_state_get());
+        app_state_unlock();
+    }
+}
+
+// 每个读数：记录 → 写入共享状态 → 控制任务被唤醒执行一次
+static void sample(trace_sensor_t id, float value)
+{
+    int32_t fixed = (id == TRACE_SENSOR_TEMPERATURE || id == TRACE_SENSOR_HUMIDITY) ?
+                    lroundf(value * TRACE_CLIMATE_SCALE) : lroundf(value);
+    trace_record(TRACE_EV_SENSOR, (uint8_t)id, fixed);
+
+    sensor_data_t *data = app_state_get();
+    if (app_state_lock() == ESP_OK) {
+        switch (id) {
+            case TRACE_SENSOR_TEMPERATURE: data->temperature = value; break;
+            case TRACE_SENSOR_HUMIDITY:    data->humidity = value; break;
+            case TRACE_SENSOR_LIGHT:       data->light = value; break;
+            case TRACE_SENSOR_SMOKE:       data->smoke = (uint32_t)value; break;
+        }
+        app_state_unlock();
+    }
+    control_once();
+}
+
+static void step(float temperature, float light, uint32_t smoke)
+{
+    hal_sim_sample_t in = {
+        .temperature = temperature,
+        .humidity = 55.0f,
+        .light = light,
+        .smoke = smoke,
+    };
+    hal_sim_set_inputs(&in);
+
+    float t = 0, h = 0, lux = 0;
+    uint32_t s = 0;
+    if (hal_climate_read(&t, &h) == ESP_OK) {
+        sample(TRACE_SENSOR_TEMPERATURE, t);
+        sample(TRACE_SENSOR_HUMIDITY, h);
+    }
+    if (hal_light_read(&lux, NULL) == ESP_OK) {
+        sample(TRACE_SENSOR_LIGHT, lux);
+    }
+    if (hal_smoke_read(&s) == ESP_OK) {
+        sample(TRACE_SENSOR_SMOKE, (float)s);
+    }
+}
+
+static int write_file(const char *dir, const char *name, const trace_file_hdr_t *hdr,
+                      const trace_record_t *records)
+{
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    FILE *f = fopen(path, "wb");
+    if (f == NULL) {
+        perror(path);
+        return -1;
+    }
+    int ok = fwrite(hdr, sizeof(*hdr), 1, f) == 1 &&
+             fwrite(records, sizeof(*records), hdr->count, f) == hdr->count;
+    fclose(f);
+    printf("%s: %lu records\n", path, (unsigned long)hdr->count);
+    return ok ? 0 : -1;
+}
+
+int main(int argc, char **argv)
+{
+    const char *dir = (argc > 1) ? argv[1] : ".";
+
+    if (trace_init(FIXTURE_CAPACITY) != ESP_OK) {
+        return 1;
+    }
+    hal_status_t status;
+    hal_register(hal_sim_ops());
+    hal_init(&status);
+    app_state_init();
+    hal_smoke_alarm_enable(app_state_get()->smoke_threshold, SMOKE_ALARM_HYSTERESIS,
+                           on_smoke_threshold, NULL);
+    app_control_init();
+
+    // 一天的缩影：夜间开灯、午后升温分档、一次烟雾报警、手动模式下的 HTTP 命令
+    step(24.0f, 40.0f, 700);
+    step(24.5f, 45.0f, 710);
+    step(26.0f, 300.0f, 720);
+    step(30.5f, 400.0f, 700);
+    step(32.4f, 420.0f, 690);
+    step(35.5f, 430.0f, 700);
+    step(33.0f, 400.0f, 700);
+    step(29.0f, 380.0f, 700);
+    step(29.0f, 380.0f, SMOKE_THRESHOLD + 300);
+    step(29.0f, 380.0f, SMOKE_THRESHOLD + 100);
+    step(28.5f, 360.0f, 900);
+    step(27.0f, 90.0f, 800);
+    step(26.0f, 70.0f, 760);
+
+    if (app_state_lock() == ESP_OK) {
+        sensor_data_t *data = app_state_get();
+        app_control_set_mode(data, CONTROL_MODE_MANUAL);
+        trace_record(TRACE_EV_HTTP, TRACE_HTTP_MODE, CONTROL_MODE_MANUAL);
+        data->fan_state = 1;
+        data->fan_speed = FAN_SPEED_MEDIUM;
+        trace_record(TRACE_EV_HTTP, TRACE_HTTP_FAN, (1 << 8) | FAN_SPEED_MEDIUM);
+        app_state_unlock();
+    }
+    control_once();
+    step(25.0f, 60.0f, 740);
+    app_control_handle_voice_command(VR_CMD_WAKE_UP);
+    app_control_handle_voice_command(VR_CMD_LIGHT_OFF);
+    control_once();
+    step(25.0f, 60.0f, 730);
+
+    trace_file_hdr_t hdr;
+    if (trace_export_begin(&hdr) != ESP_OK) {
+        return 1;
+    }
+    trace_record_t *records = calloc(hdr.count, sizeof(trace_record_t));
+    if (records == NULL || trace_export_read(0, records, hdr.count) != hdr.count) {
+        return 1;
+    }
+    trace_export_end();
+
+    if (write_file(dir, "trace.bin", &hdr, records) != 0) {
+        return 1;
+    }
+
+    // 篡改最后一条风扇输出，回放应在其后的第一条输入处报告不一致
+    for (uint32_t i = hdr.count; i-- > 0;) {
+        if (records[i].event == TRACE_EV_ACTUATOR && records[i].id == TRACE_ACT_FAN) {
+            records[i].value = (records[i].value == 0) ? FAN_SPEED_LOW : 0;
+            break;
+        }
+    }
+    if (write_file(dir, "trace_tampered.bin", &hdr, records) != 0) {
+        return 1;
+    }
+    free(records);
+    return 0;
+}
@@ -0,0 +1,81 @@
+/**
+ * @file trace_replay_main.c
+ * @brief 轨迹回放命令行工具
+ *
+ * 用法: trace_replay <trace.bin>
+ * trace.bin 为 GET /api/trace 导出的原始数据。回放完成后打印结果，
+ * 存在不一致时退出码为 1，文件无法读取或格式错误时为 2。
+ */
+
+#include "trace_replay.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+static const char *const s_actuator_names[TRACE_ACT_MAX] = {
+    [TRACE_ACT_LED] = "led",
+    [TRACE_ACT_FAN] = "fan",
+    [TRACE_ACT_CURTAIN] = "curtain",
+    [TRACE_ACT_BUZZER] = "buzzer",
+    [TRACE_ACT_RGB_COLOR] = "rgb_color",
+    [TRACE_ACT_RGB_RGB] = "rgb_rgb",
+    [TRACE_ACT_RGB_BRIGHTNESS] = "rgb_brightness",
+};
+
+static uint8_t *load_file(const char *path, size_t *len)
+{
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        return NULL;
+    }
+    uint8_t *data = NULL;
+    long size = 0;
+    if (fseek(f, 0, SEEK_END) == 0 && (size = ftell(f)) > 0 && fseek(f, 0, SEEK_SET) == 0) {
+        data = malloc((size_t)size);
+        if (data != NULL && fread(data, 1, (size_t)size, f) != (size_t)size) {
+            free(data);
+            data = NULL;
+        }
+    }
+    fclose(f);
+    *len = (size_t)size;
+    return data;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s <trace.bin>\n", argv[0]);
+        return 2;
+    }
+
+    size_t len = 0;
+    uint8_t *data = load_file(argv[1], &len);
+    if (data == NULL) {
+        fprintf(stderr, "cannot read %s\n", argv[1]);
+        return 2;
+    }
+
+    trace_replay_result_t r;
+    esp_err_t ret = trace_replay_run(data, len, &r);
+    free(data);
+    if (ret != ESP_OK) {
+        fprintf(stderr, "%s: invalid trace (%s)\n", argv[1], esp_err_to_name(ret));
+        return 2;
+    }
+
+    printf("records:        %lu (inputs %lu, actuator %lu)\n", (unsigned long)r.records,
+           (unsigned long)r.inputs, (unsigned long)r.actuator_expected);
+    printf("control runs:   %lu\n", (unsigned long)r.control_runs);
+    printf("span:           %.1f s replayed in %.3f ms\n", r.span_ms / 1000.0,
+           r.elapsed_us / 1000.0);
+    printf("beeps:          %lu recorded, %lu replayed (not compared)\n",
+           (unsigned long)r.beeps_expected, (unsigned long)r.beeps_replayed);
+    printf("mismatches:     %lu\n", (unsigned long)r.mismatches);
+    if (r.mismatches > 0) {
+        const char *name = (r.first_mismatch_actuator < TRACE_ACT_MAX) ?
+                           s_actuator_names[r.first_mismatch_actuator] : "?";
+        printf("first mismatch: %s at %lu ms\n", name, (unsigned long)r.first_mismatch_ms);
+        return 1;
+    }
+    return 0;
+}